@@ -58,6 +58,9 @@ class Patch:
     self.j2_flux = "far"
     self.k1_flux = "far"
     self.k2_flux = "far"
+    self.share = 0.0
+    self.relative_cost = 0.0
+    self.flags = []
     self.dim_set = False
 
   def setOverlap(self, overlap):
@@ -575,3 +578,28 @@ class Mesh:
     self.setJ2Flux(flux)
     self.setK1Flux(flux)
     self.setK2Flux(flux)
+
+  def readProfile(self, file_name):
+    # per-patch data written by PatchProfiler::writeCsv (<telemetry-output>_patches.csv)
+    f = open(file_name, "r")
+    for line in f:
+      if line.startswith("#"):
+        continue
+      words = [word.strip() for word in line.split(",")]
+      if len(words) < 20:
+        continue
+      index = int(words[0])
+      if index < len(self.patches):
+        self.patches[index].share = float(words[10])
+        self.patches[index].relative_cost = float(words[13])
+        self.patches[index].flags = words[19].split()
+    f.close()
+
+  def hotspots(self, flag = ""):
+    # patch indices sorted by their share of the run time, optionally only with a given flag
+    indices = []
+    for patch in self.patches:
+      if flag == "" or flag in patch.flags:
+        indices.append(patch.index)
+    indices.sort(key = lambda i: self.patches[i].share, reverse = True)
+    return indices
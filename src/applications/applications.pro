@@ -25,8 +25,31 @@ CONFIG   += ordered recursive
 CONFIG += debug_and_release
 
 SUBDIRS += drnumBasicAero \
-    testBlockObjects
+    drnumIteratorBenchmark \
+    drnumLevelSetBenchmark \
+    drnumLevelSetPreprocessor \
+    testBlockObjects \
+    testGridPartitioner \
+    testSplitFaces \
+    testActiveRanges \
+    testMovingLevelSet \
+    testLevelSetBatch
 
 drnumBasicAero.file = drnumBasicAero/drnumBasicAero.pro
 
+drnumIteratorBenchmark.file = drnumIteratorBenchmark/drnumIteratorBenchmark.pro
+
+drnumLevelSetBenchmark.file = drnumLevelSetBenchmark/drnumLevelSetBenchmark.pro
+
+drnumLevelSetPreprocessor.file = drnumLevelSetPreprocessor/drnumLevelSetPreprocessor.pro
+
 testBlockObjects.file = testBlockObjects/testBlockObjects.pro
+
+testGridPartitioner.file = testGridPartitioner/testGridPartitioner.pro
+
+testSplitFaces.file = testSplitFaces/testSplitFaces.pro
+
+testActiveRanges.file = testActiveRanges/testActiveRanges.pro
+
+testMovingLevelSet.file = testMovingLevelSet/testMovingLevelSet.pro
+testLevelSetBatch.file = testLevelSetBatch/testLevelSetBatch.pro
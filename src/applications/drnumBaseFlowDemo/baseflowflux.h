@@ -16,6 +16,7 @@
 #include "fluxes/compressiblefarfieldflux.h"
 #include "fluxes/compressibleviscflux.h"
 #include "fluxes/compressiblesmagorinskyflux.h"
+#include "fluxes/compressibleflux.h"
 #include "perfectgas.h"
 #include "compressiblevariables.h"
 #include "rungekutta.h"
@@ -27,12 +28,14 @@ class BaseFlowFlux
   typedef CompressibleSmagorinskyFlux<5, 2400, PerfectGas> viscous_t;
   typedef CompressibleSlipFlux<5, reconstruction_t, PerfectGas> wall_t;
   typedef CompressibleFarfieldFlux<5, Upwind1<5>, PerfectGas> farfield_t;
+  typedef CompressibleFlux<5, PerfectGas> split_t;
 
   reconstruction_t m_Reconstruction;
   euler_t          m_EulerFlux;
   viscous_t        m_ViscFlux;
   wall_t           m_WallFlux;
   farfield_t       m_FarfieldFlux;
+  split_t          m_SplitFlux;
 
   real   m_U;
   real   m_P;
@@ -185,4 +188,10 @@ inline void BaseFlowFlux::zWallM(PATCH *P, size_t i, size_t j, size_t k, real x,
   m_FarfieldFlux.zWallM(P, i, j, k, x, y, z, A, flux);
 }
 
+template <typename PATCH>
+inline void BaseFlowFlux::splitFlux(PATCH *P, splitface_t sf, real* flux)
+{
+  m_SplitFlux.splitFlux(P, sf, flux);
+}
+
 #endif // BASEFLOWFLUX_H
@@ -149,7 +149,7 @@ void run()
 
   int write_counter = 0;
   int iter = 0;
-  real t = 0;
+  acc_real t = 0;
 
   QString restart_file = config.getValue<QString>("restart-file");
   if (restart_file.toLower() != "none") {
@@ -167,7 +167,7 @@ void run()
   QVector<TimeAverage> centre_averages, vertical_averages;
 
   startTiming();
-  real next_write_time = t + write_interval;
+  acc_real next_write_time = t + write_interval;
 
   while (t < total_time) {
 
@@ -255,9 +255,9 @@ void run()
       real CFL_max = 0;
       real rho_min = 1000;
       real rho_max = 0;
-      real max_norm_allpatches = 0.;
-      real l2_norm_allpatches;
-      real ql2_norm_allpatches = 0.;
+      acc_real max_norm_allpatches = 0.;
+      acc_real l2_norm_allpatches;
+      acc_real ql2_norm_allpatches = 0.;
 
 #ifdef GPU
       runge_kutta.copyDonorData(0);
@@ -287,7 +287,7 @@ void run()
             }
           }
         }
-        real max_norm, l2_norm;
+        acc_real max_norm, l2_norm;
         patch.computeVariableDifference(0, 0, 1, 0, max_norm, l2_norm);
         if (max_norm > max_norm_allpatches) {
           max_norm_allpatches = max_norm;
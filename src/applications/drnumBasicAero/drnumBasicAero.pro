@@ -27,9 +27,16 @@ INSTALLS += drnum_app
 
 include (../drnum_app.pri)
 
-SOURCES      = main.cpp main.cu
+SOURCES      = main.cpp main.cu \
+               eaiteratorregistry.cpp \
+               eaiterators_ausmdv.cpp \
+               eaiterators_ausmplus.cpp \
+               eaiterators_kt.cpp \
+               eaiterators_knp.cpp \
+               eaiterators_roe.cpp \
+               eaiterators_vanleer.cpp
 SOURCES     -= main.cu
-HEADERS      = main.h
+HEADERS      = main.h eaflux.h eaiteratorregistry.h
 CUDA_SOURCES = main.cu
 
 
@@ -0,0 +1,461 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef EAFLUX_H
+#define EAFLUX_H
+
+#include "reconstruction/upwind1.h"
+#include "reconstruction/upwind2.h"
+#include "reconstruction/minmod.h"
+#include "reconstruction/secondorder.h"
+#include "fluxes/vanleer.h"
+#include "fluxes/compressiblefarfieldflux.h"
+#include "fluxes/compressiblesmagorinskyflux.h"
+#include "fluxes/compressiblecachedviscflux.h"
+#include "fluxes/compressibleslipflux.h"
+#include "perfectgas.h"
+
+#ifdef GPU
+#include "iterators/gpu_cartesianiterator.h"
+#else
+#include "iterators/cartesianiterator.h"
+#endif
+
+#include "iteratorfeeder.h"
+
+#define NUM_VARS 5
+
+/**
+ * Bits of the boundary condition and viscosity switches of the external aerodynamics solver.
+ * The wall bits follow the order of the boundary code words in the solver codes:
+ * "fx fy fz xm xp ym yp zm zp 0", where each boundary is either "wall" or "far".
+ */
+struct EaBC
+{
+  enum { XM = 1, XP = 2, YM = 4, YP = 8, ZM = 16, ZP = 32, VISCOUS = 64 };
+
+  static unsigned int fromConfig(int xp, int xm, int yp, int ym, int zp, int zm);
+  static unsigned int fromCodes(const CodeString& solver_codes);
+};
+
+inline unsigned int EaBC::fromConfig(int xp, int xm, int yp, int ym, int zp, int zm)
+{
+  unsigned int bc = 0;
+  if (xm == 1) bc |= XM;
+  if (xp == 1) bc |= XP;
+  if (ym == 1) bc |= YM;
+  if (yp == 1) bc |= YP;
+  if (zm == 1) bc |= ZM;
+  if (zp == 1) bc |= ZP;
+  return bc;
+}
+
+inline unsigned int EaBC::fromCodes(const CodeString& solver_codes)
+{
+  CodeString cs = solver_codes;
+  unsigned int bc = 0;
+  for (size_t i_bc = 0; i_bc < 6; ++i_bc) {
+    bool success;
+    string word = cs.accessCodeWord(i_bc + 3, success);
+    if (success && word == "wall") {
+      bc |= (1 << i_bc);
+    }
+  }
+  return bc;
+}
+
+
+/**
+ * Flux of the external aerodynamics solver.
+ * The Euler flux defaults to VanLeer; other fluxes can be selected at run-time
+ * through EaIteratorRegistry (see eaiteratorregistry.h).
+ */
+template <typename TReconstruction, typename TEuler = VanLeer<NUM_VARS, TReconstruction, PerfectGas> >
+class EaFlux
+{
+
+protected:
+
+  typedef TEuler euler_t;
+
+  typedef CompressibleSlipFlux<NUM_VARS, Upwind1<NUM_VARS>, PerfectGas>     wall_t;
+#ifdef GPU
+  typedef CompressibleSmagorinskyFlux<NUM_VARS, 2000, PerfectGas>    viscous_t;
+#else
+  typedef CompressibleCachedSmagorinskyFlux<NUM_VARS, 2000, PerfectGas> viscous_t;
+#endif
+  typedef CompressibleFarfieldFlux<NUM_VARS, Upwind1<NUM_VARS>, PerfectGas> farfield_t;
+  typedef CompressibleFlux<NUM_VARS, PerfectGas>                     split_t;
+
+  TReconstruction  m_Reconstruction;
+  euler_t          m_EulerFlux;
+  viscous_t        m_ViscFlux;
+  farfield_t       m_FarfieldFlux;
+  wall_t           m_WallFlux;
+  split_t          m_SplitFlux;
+  bool             m_Inviscid;
+  int              m_XPlusBC;
+  int              m_XMinusBC;
+  int              m_YPlusBC;
+  int              m_YMinusBC;
+  int              m_ZPlusBC;
+  int              m_ZMinusBC;
+
+
+public: // methods
+
+  EaFlux(real u, real v, real p, real T, bool inviscid);
+  EaFlux();
+
+  void setBCs(int xp, int xm, int yp, int ym, int zp, int zm);
+  void setBCs(unsigned int bc);
+
+#ifndef GPU
+  typedef ViscousGradients gradient_cache_t;
+  template <typename PATCH> void computeGradients(PATCH *P, ViscousGradients* gradients);
+#endif
+
+  template <typename PATCH> CUDA_DH void xField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+  template <typename PATCH> CUDA_DH void yField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+  template <typename PATCH> CUDA_DH void zField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+
+  template <typename PATCH> CUDA_DH void xWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+  template <typename PATCH> CUDA_DH void yWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+  template <typename PATCH> CUDA_DH void zWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+  template <typename PATCH> CUDA_DH void xWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+  template <typename PATCH> CUDA_DH void yWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+  template <typename PATCH> CUDA_DH void zWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+
+  template <typename PATCH> CUDA_DH void splitFlux(PATCH *P, splitface_t sf, real* flux);
+
+};
+
+
+template <typename TReconstruction, typename TEuler>
+EaFlux<TReconstruction, TEuler>::EaFlux(real u, real v, real p, real T, bool inviscid)
+{
+  m_FarfieldFlux.setFarfield(p, T, u, v, 0);
+  m_Inviscid = inviscid;
+  m_XPlusBC  = 0;
+  m_XMinusBC = 0;
+  m_YPlusBC  = 0;
+  m_YMinusBC = 0;
+  m_ZPlusBC  = 0;
+  m_ZMinusBC = 0;
+}
+
+template <typename TReconstruction, typename TEuler>
+EaFlux<TReconstruction, TEuler>::EaFlux()
+{
+}
+
+template <typename TReconstruction, typename TEuler>
+void EaFlux<TReconstruction, TEuler>::setBCs(int xp, int xm, int yp, int ym, int zp, int zm) {
+  m_XPlusBC  = xp;
+  m_XMinusBC = xm;
+  m_YPlusBC  = yp;
+  m_YMinusBC = ym;
+  m_ZPlusBC  = zp;
+  m_ZMinusBC = zm;
+}
+
+template <typename TReconstruction, typename TEuler>
+void EaFlux<TReconstruction, TEuler>::setBCs(unsigned int bc)
+{
+  setBCs((bc & EaBC::XP) != 0, (bc & EaBC::XM) != 0, (bc & EaBC::YP) != 0, (bc & EaBC::YM) != 0, (bc & EaBC::ZP) != 0, (bc & EaBC::ZM) != 0);
+}
+
+#ifndef GPU
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::computeGradients(PATCH *P, ViscousGradients* gradients)
+{
+  if (!m_Inviscid) m_ViscFlux.computeGradients(P, gradients);
+}
+#endif
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::xField
+(
+  PATCH *patch,
+  size_t i, size_t j, size_t k,
+  real x, real y, real z,
+  real A, real* flux
+)
+{
+  m_EulerFlux.xField(patch, i, j, k, x, y, z, A, flux);
+  if (!m_Inviscid) m_ViscFlux.xField(patch, i, j, k, x, y, z, A, flux);
+}
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::yField
+(
+  PATCH *patch,
+  size_t i, size_t j, size_t k,
+  real x, real y, real z,
+  real A, real* flux
+)
+{
+  m_EulerFlux.yField(patch, i, j, k, x, y, z, A, flux);
+  if (!m_Inviscid) m_ViscFlux.yField(patch, i, j, k, x, y, z, A, flux);
+}
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::zField
+(
+  PATCH *patch,
+  size_t i, size_t j, size_t k,
+  real x, real y, real z,
+  real A, real* flux
+)
+{
+  m_EulerFlux.zField(patch, i, j, k, x, y, z, A, flux);
+  if (!m_Inviscid) m_ViscFlux.zField(patch, i, j, k, x, y, z, A, flux);
+}
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::xWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+{
+  if (m_XPlusBC == 1) {
+    m_WallFlux.xWallP(P, i, j, k, x, y, z, A, flux);
+  } else {
+    m_FarfieldFlux.xWallP(P, i, j, k, x, y, z, A, flux);
+  }
+}
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::yWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+{
+  if (m_YPlusBC == 1) {
+    m_WallFlux.yWallP(P, i, j, k, x, y, z, A, flux);
+  } else {
+    m_FarfieldFlux.yWallP(P, i, j, k, x, y, z, A, flux);
+  }
+}
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::zWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+{
+  if (m_ZPlusBC == 1) {
+    m_WallFlux.zWallP(P, i, j, k, x, y, z, A, flux);
+  } else {
+    m_FarfieldFlux.zWallP(P, i, j, k, x, y, z, A, flux);
+  }
+}
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::xWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+{
+  if (m_XMinusBC == 1) {
+    m_WallFlux.xWallM(P, i, j, k, x, y, z, A, flux);
+  } else {
+    m_FarfieldFlux.xWallM(P, i, j, k, x, y, z, A, flux);
+  }
+}
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::yWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+{
+  if (m_YMinusBC == 1) {
+    m_WallFlux.yWallM(P, i, j, k, x, y, z, A, flux);
+  }
+  else {
+    m_FarfieldFlux.yWallM(P, i, j, k, x, y, z, A, flux);
+  }
+}
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::zWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+{
+  if (m_ZMinusBC == 1) {
+    m_WallFlux.zWallM(P, i, j, k, x, y, z, A, flux);
+  } else {
+    m_FarfieldFlux.zWallM(P, i, j, k, x, y, z, A, flux);
+  }
+}
+
+template <typename TReconstruction, typename TEuler>
+template <typename PATCH>
+inline void EaFlux<TReconstruction, TEuler>::splitFlux(PATCH *P, splitface_t sf, real* flux)
+{
+  m_SplitFlux.splitFlux(P, sf, flux);
+  if (!m_Inviscid) m_ViscFlux.splitFlux(P, sf, flux);
+}
+
+/**
+ * EaFlux with the viscosity switch resolved at compile time.
+ * The face loops of CartesianIterator are fully inlined without any branching for both cases.
+ * The boundary types (wall or far-field) of the individual sides are only needed on the patch
+ * boundaries and remain run-time switches (see EaFlux::setBCs).
+ */
+template <typename TReconstruction, bool VISCOUS>
+class EaStaticFlux : public EaFlux<TReconstruction>
+{
+
+public: // methods
+
+  EaStaticFlux(real u, real v, real p, real T) : EaFlux<TReconstruction>(u, v, p, T, !VISCOUS) {}
+  EaStaticFlux() {}
+
+#ifndef GPU
+  template <typename PATCH> void computeGradients(PATCH *P, ViscousGradients* gradients);
+#endif
+
+  template <typename PATCH> CUDA_DH void xField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+  template <typename PATCH> CUDA_DH void yField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+  template <typename PATCH> CUDA_DH void zField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
+
+  template <typename PATCH> CUDA_DH void splitFlux(PATCH *P, splitface_t sf, real* flux);
+
+};
+
+#ifndef GPU
+template <typename TReconstruction, bool VISCOUS>
+template <typename PATCH>
+inline void EaStaticFlux<TReconstruction, VISCOUS>::computeGradients(PATCH *P, ViscousGradients* gradients)
+{
+  if (VISCOUS) this->m_ViscFlux.computeGradients(P, gradients);
+}
+#endif
+
+template <typename TReconstruction, bool VISCOUS>
+template <typename PATCH>
+inline void EaStaticFlux<TReconstruction, VISCOUS>::xField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+{
+  this->m_EulerFlux.xField(P, i, j, k, x, y, z, A, flux);
+  if (VISCOUS) this->m_ViscFlux.xField(P, i, j, k, x, y, z, A, flux);
+}
+
+template <typename TReconstruction, bool VISCOUS>
+template <typename PATCH>
+inline void EaStaticFlux<TReconstruction, VISCOUS>::yField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+{
+  this->m_EulerFlux.yField(P, i, j, k, x, y, z, A, flux);
+  if (VISCOUS) this->m_ViscFlux.yField(P, i, j, k, x, y, z, A, flux);
+}
+
+template <typename TReconstruction, bool VISCOUS>
+template <typename PATCH>
+inline void EaStaticFlux<TReconstruction, VISCOUS>::zField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+{
+  this->m_EulerFlux.zField(P, i, j, k, x, y, z, A, flux);
+  if (VISCOUS) this->m_ViscFlux.zField(P, i, j, k, x, y, z, A, flux);
+}
+
+template <typename TReconstruction, bool VISCOUS>
+template <typename PATCH>
+inline void EaStaticFlux<TReconstruction, VISCOUS>::splitFlux(PATCH *P, splitface_t sf, real* flux)
+{
+  this->m_SplitFlux.splitFlux(P, sf, flux);
+  if (VISCOUS) this->m_ViscFlux.splitFlux(P, sf, flux);
+}
+
+
+/**
+ * Creates specialised iterators for IteratorFeeder::createIterators.
+ * There are two cases (inviscid and viscous); the boundary types of a patch group are taken
+ * from the boundary code words of its solver codes and the global boundary conditions
+ * (xplus-bc, ...), see EaBC.
+ */
+template <typename TReconstruction>
+class EaIteratorCreator
+{
+
+  real m_U;
+  real m_V;
+  real m_P;
+  real m_T;
+  bool m_Inviscid;
+  unsigned int m_BCs;
+  int  m_CudaDevice;
+  int  m_ThreadLimit;
+
+
+public: // methods
+
+  static const unsigned int num_cases = 2;
+
+  EaIteratorCreator(real u, real v, real p, real T, bool inviscid);
+
+  void setBCs(int xp, int xm, int yp, int ym, int zp, int zm);
+  void setDevice(int cuda_device, int thread_limit);
+
+  unsigned int caseIndex(const CodeString& solver_codes);
+
+  template <unsigned int CASE> PatchIterator* create(const CodeString& solver_codes);
+
+};
+
+template <typename TReconstruction>
+EaIteratorCreator<TReconstruction>::EaIteratorCreator(real u, real v, real p, real T, bool inviscid)
+{
+  m_U = u;
+  m_V = v;
+  m_P = p;
+  m_T = T;
+  m_Inviscid = inviscid;
+  m_BCs = 0;
+  m_CudaDevice = 0;
+  m_ThreadLimit = 0;
+}
+
+template <typename TReconstruction>
+void EaIteratorCreator<TReconstruction>::setBCs(int xp, int xm, int yp, int ym, int zp, int zm)
+{
+  m_BCs = EaBC::fromConfig(xp, xm, yp, ym, zp, zm);
+}
+
+template <typename TReconstruction>
+void EaIteratorCreator<TReconstruction>::setDevice(int cuda_device, int thread_limit)
+{
+  m_CudaDevice = cuda_device;
+  m_ThreadLimit = thread_limit;
+}
+
+template <typename TReconstruction>
+unsigned int EaIteratorCreator<TReconstruction>::caseIndex(const CodeString&)
+{
+  return m_Inviscid ? 0 : 1;
+}
+
+template <typename TReconstruction>
+template <unsigned int CASE>
+PatchIterator* EaIteratorCreator<TReconstruction>::create(const CodeString& solver_codes)
+{
+  typedef EaStaticFlux<TReconstruction, CASE == 1> flux_t;
+  flux_t flux(m_U, m_V, m_P, m_T);
+  flux.setBCs(m_BCs | EaBC::fromCodes(solver_codes));
+#ifdef GPU
+  return new GPU_CartesianIterator<NUM_VARS, flux_t>(flux, m_CudaDevice, m_ThreadLimit);
+#else
+  return new CartesianIterator<NUM_VARS, flux_t>(flux);
+#endif
+}
+
+#endif // EAFLUX_H
@@ -0,0 +1,85 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#ifndef GPU
+
+#include "eaiteratorregistry.h"
+
+EaIteratorRegistry::EaIteratorRegistry()
+{
+  registerAusmDVIterators(*this);
+  registerAusmPlusIterators(*this);
+  registerVanLeerIterators(*this);
+  registerRoeIterators(*this);
+  registerKTIterators(*this);
+  registerKNPIterators(*this);
+}
+
+void EaIteratorRegistry::add(string flux, string reconstruction, factory_t factory)
+{
+  m_Factories[key(flux, reconstruction)] = factory;
+}
+
+bool EaIteratorRegistry::exists(string flux, string reconstruction)
+{
+  return m_Factories.find(key(flux, reconstruction)) != m_Factories.end();
+}
+
+void EaIteratorRegistry::printEntries()
+{
+  cout << "available flux/reconstruction combinations:" << endl;
+  for (map<string, factory_t>::iterator i = m_Factories.begin(); i != m_Factories.end(); ++i) {
+    cout << "  " << i->first << endl;
+  }
+}
+
+PatchIterator* EaIteratorRegistry::create(string flux, string reconstruction, const EaParameters& parameters, unsigned int bc)
+{
+  map<string, factory_t>::iterator i = m_Factories.find(key(flux, reconstruction));
+  if (i == m_Factories.end()) {
+    printEntries();
+    ERROR("unknown flux/reconstruction combination");
+  }
+  return i->second(parameters, bc);
+}
+
+void EaIteratorRegistry::createIterators(PatchGrid& patch_grid, IteratorFeeder& feeder, string flux, string reconstruction,
+                                         const EaParameters& parameters, unsigned int global_bc)
+{
+  PatchGroups* patch_groups = patch_grid.getPatchGroups();
+  for (size_t i_pg = 0 ; i_pg < patch_groups->accessNumPatchGroups(); ++i_pg) {
+    SinglePatchGroup* spg = patch_groups->accessSinglePatchGroup(i_pg);
+    CodeString cs = spg->m_SolverCodes;
+    bool exists = false;
+    for (size_t i_it = 0; i_it < feeder.numIterators(); ++i_it) {
+      if (feeder.getIterator(i_it)->getCodeString() == cs) {
+        exists = true;
+      }
+    }
+    if (!exists) {
+      PatchIterator* iterator = create(flux, reconstruction, parameters, global_bc | EaBC::fromCodes(cs));
+      iterator->setCodeString(cs);
+      feeder.addIterator(iterator);
+    }
+  }
+}
+
+#endif // GPU
@@ -0,0 +1,132 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef EAITERATORREGISTRY_H
+#define EAITERATORREGISTRY_H
+
+#ifndef GPU
+
+#include "eaflux.h"
+#include "fluxes/ausmdv.h"
+#include "fluxes/ausmplus.h"
+#include "fluxes/roe.h"
+#include "fluxes/kt.h"
+#include "fluxes/knp.h"
+#include "reconstruction/vanalbada.h"
+#include "reconstruction/vanleerlim.h"
+#include "reconstruction/roelim.h"
+
+#include <map>
+
+/**
+ * Free stream state and switches for iterators created by EaIteratorRegistry.
+ */
+struct EaParameters
+{
+  real u;
+  real v;
+  real p;
+  real T;
+  bool inviscid;
+};
+
+
+/**
+ * Registry of pre-instantiated CPU iterators for all combinations of Euler fluxes
+ * and reconstructions. This allows to select the scheme with the control parameters
+ * "euler-flux" and "reconstruction" without recompiling. The combinations of one flux
+ * are instantiated in a separate translation unit (eaiterators_<flux>.cpp) in order
+ * to keep the compile time of the individual units manageable.
+ */
+class EaIteratorRegistry
+{
+
+public: // data types
+
+  typedef PatchIterator* (*factory_t)(const EaParameters& parameters, unsigned int bc);
+
+
+private: // attributes
+
+  map<string, factory_t> m_Factories;
+
+
+private: // methods
+
+  string key(string flux, string reconstruction) { return flux + " " + reconstruction; }
+
+
+public: // methods
+
+  /**
+   * Constructor; registers all available combinations.
+   */
+  EaIteratorRegistry();
+
+  void add(string flux, string reconstruction, factory_t factory);
+  bool exists(string flux, string reconstruction);
+  void printEntries();
+
+  /**
+   * Create an iterator.
+   * @param flux the name of the Euler flux (e.g. "ausm-plus")
+   * @param reconstruction the name of the reconstruction (e.g. "minmod")
+   * @param parameters free stream state and viscosity switch
+   * @param bc wall/far-field bits of the boundaries (see EaBC)
+   * @return the new iterator
+   */
+  PatchIterator* create(string flux, string reconstruction, const EaParameters& parameters, unsigned int bc);
+
+  /**
+   * Create one iterator per distinct solver code string of the patch groups.
+   * The boundary bits are taken from the solver codes and the global boundary conditions.
+   * The new iterators are added to the feeder, but still have to be fed.
+   * @param patch_grid the PatchGrid to build iterators for
+   * @param feeder the IteratorFeeder to add the iterators to
+   * @param flux the name of the Euler flux
+   * @param reconstruction the name of the reconstruction
+   * @param parameters free stream state and viscosity switch
+   * @param global_bc boundary bits applying to all patches (see EaBC::fromConfig)
+   */
+  void createIterators(PatchGrid& patch_grid, IteratorFeeder& feeder, string flux, string reconstruction,
+                       const EaParameters& parameters, unsigned int global_bc);
+
+};
+
+
+template <typename TReconstruction, typename TEuler>
+PatchIterator* createEaIterator(const EaParameters& parameters, unsigned int bc)
+{
+  EaFlux<TReconstruction, TEuler> flux(parameters.u, parameters.v, parameters.p, parameters.T, parameters.inviscid);
+  flux.setBCs(bc);
+  return new CartesianIterator<NUM_VARS, EaFlux<TReconstruction, TEuler> >(flux);
+}
+
+// explicit instantiation units
+void registerAusmDVIterators(EaIteratorRegistry& registry);
+void registerAusmPlusIterators(EaIteratorRegistry& registry);
+void registerVanLeerIterators(EaIteratorRegistry& registry);
+void registerRoeIterators(EaIteratorRegistry& registry);
+void registerKTIterators(EaIteratorRegistry& registry);
+void registerKNPIterators(EaIteratorRegistry& registry);
+
+#endif // GPU
+
+#endif // EAITERATORREGISTRY_H
@@ -0,0 +1,36 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#ifndef GPU
+
+#include "eaiteratorregistry.h"
+
+void registerAusmDVIterators(EaIteratorRegistry& registry)
+{
+  registry.add("ausmdv", "first-order", createEaIterator<Upwind1<NUM_VARS>, AusmDV<NUM_VARS, Upwind1<NUM_VARS>, PerfectGas> >);
+  registry.add("ausmdv", "minmod", createEaIterator<Upwind2<NUM_VARS, MinMod>, AusmDV<NUM_VARS, Upwind2<NUM_VARS, MinMod>, PerfectGas> >);
+  registry.add("ausmdv", "van-albada", createEaIterator<Upwind2<NUM_VARS, VanAlbada>, AusmDV<NUM_VARS, Upwind2<NUM_VARS, VanAlbada>, PerfectGas> >);
+  registry.add("ausmdv", "second-order", createEaIterator<Upwind2<NUM_VARS, SecondOrder>, AusmDV<NUM_VARS, Upwind2<NUM_VARS, SecondOrder>, PerfectGas> >);
+  registry.add("ausmdv", "van-leer", createEaIterator<Upwind2<NUM_VARS, VanLeerLim>, AusmDV<NUM_VARS, Upwind2<NUM_VARS, VanLeerLim>, PerfectGas> >);
+  registry.add("ausmdv", "roe", createEaIterator<Upwind2<NUM_VARS, RoeLim>, AusmDV<NUM_VARS, Upwind2<NUM_VARS, RoeLim>, PerfectGas> >);
+}
+
+#endif // GPU
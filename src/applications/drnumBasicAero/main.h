@@ -40,6 +40,10 @@
 #include "compressiblevariablesandg.h"
 #include "rungekutta.h"
 #include "discretelevelset.h"
+#include "levelsetfile.h"
+#include "bricklevelset.h"
+#include "splitfacebuilder.h"
+#include "splitfacefile.h"
 #include "simplelevelsets.h"
 #include "compressiblelsslip.h"
 #include "compressiblelschamber.h"
@@ -55,218 +59,26 @@
 #include "gpu_cartesianlevelsetbc.h"
 #else
 #include "iterators/cartesianiterator.h"
+#include "cpu_cartesianlevelsetbc.h"
 #endif
 
 #include "rungekutta.h"
 #include "iteratorfeeder.h"
 #include "cubeincartisianpatch.h"
+#include "sampler.h"
+#include "telemetry.h"
+#include "patchprofiler.h"
+#include "fieldstatistics.h"
+#include "patchactivitycontroller.h"
+#include "gridpartitioner.h"
+#include "levelsetforces.h"
 
 #include <QTime>
 
 #include "configmap.h"
 
-#define NUM_VARS 6
-
-template <typename TReconstruction>
-class EaFlux
-{
-
-protected:
-
-  //typedef AusmDV<NUM_VARS, reconstruction_t, PerfectGas> euler_t;
-  typedef VanLeer<NUM_VARS, TReconstruction, PerfectGas> euler_t;
-  //typedef Roe<NUM_VARS, TReconstruction, PerfectGas> euler_t;
-  //typedef AusmPlus<NUM_VARS, TReconstruction, PerfectGas> euler_t;
-  //typedef KT<NUM_VARS, 10000, TReconstruction, PerfectGas> euler_t;
-  //typedef KNP<NUM_VARS, TReconstruction, PerfectGas> euler_t;
-
-  typedef CompressibleSlipFlux<NUM_VARS, Upwind1<NUM_VARS>, PerfectGas>     wall_t;
-  typedef CompressibleSmagorinskyFlux<NUM_VARS, 2000, PerfectGas>    viscous_t;
-  typedef CompressibleFarfieldFlux<NUM_VARS, Upwind1<NUM_VARS>, PerfectGas> farfield_t;
-  typedef CompressibleFlux<NUM_VARS, PerfectGas>                     split_t;
-
-  TReconstruction  m_Reconstruction;
-  euler_t          m_EulerFlux;
-  viscous_t        m_ViscFlux;
-  farfield_t       m_FarfieldFlux;
-  wall_t           m_WallFlux;
-  split_t          m_SplitFlux;
-  bool             m_Inviscid;
-  int              m_XPlusBC;
-  int              m_XMinusBC;
-  int              m_YPlusBC;
-  int              m_YMinusBC;
-  int              m_ZPlusBC;
-  int              m_ZMinusBC;
-
-
-public: // methods
-
-  EaFlux(real u, real v, real p, real T, bool inviscid);
-  EaFlux();
-
-  void setBCs(int xp, int xm, int yp, int ym, int zp, int zm);
-
-  template <typename PATCH> CUDA_DH void xField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
-  template <typename PATCH> CUDA_DH void yField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
-  template <typename PATCH> CUDA_DH void zField(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
-
-  template <typename PATCH> CUDA_DH void xWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
-  template <typename PATCH> CUDA_DH void yWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
-  template <typename PATCH> CUDA_DH void zWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
-  template <typename PATCH> CUDA_DH void xWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
-  template <typename PATCH> CUDA_DH void yWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
-  template <typename PATCH> CUDA_DH void zWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
-
-  template <typename PATCH> CUDA_DH void splitFlux(PATCH *P, splitface_t sf, real* flux);
-
-};
-
-
-template <typename TReconstruction>
-EaFlux<TReconstruction>::EaFlux(real u, real v, real p, real T, bool inviscid)
-{
-  m_FarfieldFlux.setFarfield(p, T, u, v, 0);
-  m_Inviscid = inviscid;
-  m_XPlusBC  = 0;
-  m_XMinusBC = 0;
-  m_YPlusBC  = 0;
-  m_YMinusBC = 0;
-  m_ZPlusBC  = 0;
-  m_ZMinusBC = 0;
-}
-
-template <typename TReconstruction>
-EaFlux<TReconstruction>::EaFlux()
-{
-}
-
-template<typename TReconstruction>
-void EaFlux<TReconstruction>::setBCs(int xp, int xm, int yp, int ym, int zp, int zm) {
-  m_XPlusBC  = xp;
-  m_XMinusBC = xm;
-  m_YPlusBC  = yp;
-  m_YMinusBC = ym;
-  m_ZPlusBC  = zp;
-  m_ZMinusBC = zm;
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::xField
-(
-  PATCH *patch,
-  size_t i, size_t j, size_t k,
-  real x, real y, real z,
-  real A, real* flux
-)
-{
-  m_EulerFlux.xField(patch, i, j, k, x, y, z, A, flux);
-  if (!m_Inviscid) m_ViscFlux.xField(patch, i, j, k, x, y, z, A, flux);
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::yField
-(
-  PATCH *patch,
-  size_t i, size_t j, size_t k,
-  real x, real y, real z,
-  real A, real* flux
-)
-{
-  m_EulerFlux.yField(patch, i, j, k, x, y, z, A, flux);
-  if (!m_Inviscid) m_ViscFlux.yField(patch, i, j, k, x, y, z, A, flux);
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::zField
-(
-  PATCH *patch,
-  size_t i, size_t j, size_t k,
-  real x, real y, real z,
-  real A, real* flux
-)
-{
-  m_EulerFlux.zField(patch, i, j, k, x, y, z, A, flux);
-  if (!m_Inviscid) m_ViscFlux.zField(patch, i, j, k, x, y, z, A, flux);
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::xWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
-{
-  if (m_XPlusBC == 1) {
-    m_WallFlux.xWallP(P, i, j, k, x, y, z, A, flux);
-  } else {
-    m_FarfieldFlux.xWallP(P, i, j, k, x, y, z, A, flux);
-  }
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::yWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
-{
-  if (m_YPlusBC == 1) {
-    m_WallFlux.yWallP(P, i, j, k, x, y, z, A, flux);
-  } else {
-    m_FarfieldFlux.yWallP(P, i, j, k, x, y, z, A, flux);
-  }
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::zWallP(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
-{
-  if (m_ZPlusBC == 1) {
-    m_WallFlux.zWallP(P, i, j, k, x, y, z, A, flux);
-  } else {
-    m_FarfieldFlux.zWallP(P, i, j, k, x, y, z, A, flux);
-  }
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::xWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
-{
-  if (m_XMinusBC == 1) {
-    m_WallFlux.xWallM(P, i, j, k, x, y, z, A, flux);
-  } else {
-    m_FarfieldFlux.xWallM(P, i, j, k, x, y, z, A, flux);
-  }
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::yWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
-{
-  if (m_YMinusBC == 1) {
-    m_WallFlux.yWallM(P, i, j, k, x, y, z, A, flux);
-  }
-  else {
-    m_FarfieldFlux.yWallM(P, i, j, k, x, y, z, A, flux);
-  }
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::zWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
-{
-  if (m_ZMinusBC == 1) {
-    m_WallFlux.zWallM(P, i, j, k, x, y, z, A, flux);
-  } else {
-    m_FarfieldFlux.zWallM(P, i, j, k, x, y, z, A, flux);
-  }
-}
-
-template <typename TReconstruction>
-template <typename PATCH>
-inline void EaFlux<TReconstruction>::splitFlux(PATCH *P, splitface_t sf, real* flux)
-{
-  m_SplitFlux.splitFlux(P, sf, flux);
-  if (!m_Inviscid) m_ViscFlux.splitFlux(P, sf, flux);
-}
+#include "eaflux.h"
+#include "eaiteratorregistry.h"
 
 void sync(Patch *patch, ExternalExchangeList *of2dn_list, ExternalExchangeList *dn2of_list, Barrier *barrier, SharedMemory *shmem, bool &write_flag, bool &stop_flag, real &dt)
 {
@@ -336,7 +148,7 @@ void run()
   real L              = config.getValue<real>("reference-length");
   real time           = L/uabs;
   real cfl_target     = config.getValue<real>("CFL-number");
-  real t_write        = 0;
+  acc_real t_write    = 0;
   real write_interval = config.getValue<real>("write-interval")*time;
   real total_time     = config.getValue<real>("total-time")*time;
   bool mesh_preview   = config.getValue<bool>("mesh-preview");
@@ -395,16 +207,63 @@ void run()
   real u      = uabs*cos(alpha);
   real v      = uabs*sin(alpha);
 
+  // running statistics (mean, RMS, Reynolds stresses) in additional fields
+  bool statistics = false;
+  if (config.exists("statistics")) {
+    statistics = config.getValue<bool>("statistics");
+#ifdef GPU
+    if (statistics) {
+      cout << "Field statistics are not available for GPU runs." << endl;
+      statistics = false;
+    }
+#endif
+  }
+  size_t num_stat_fields = 0;
+  if (statistics) {
+    num_stat_fields = FieldStatistics::numFields(NUM_VARS, 1);
+  }
+
   // Patch grid
   PatchGrid patch_grid;
   //.. general settings (apply to all subsequent patches)
-  patch_grid.setNumberOfFields(3);
+  patch_grid.setNumberOfFields(3 + num_stat_fields);
   patch_grid.setNumberOfVariables(NUM_VARS);
   patch_grid.defineVectorVar(1);
   patch_grid.setInterpolateData();
   patch_grid.setNumSeekLayers(2);  /// @todo check default = 2
   patch_grid.setTransferType("padded_direct");
-  patch_grid.readGrid("patches/standard.grid", scale);
+  bool partitioning = false;
+  if (config.exists("patch-partitioning")) {
+    partitioning = config.getValue<bool>("patch-partitioning");
+    if (partitioning && code_coupling) {
+      cout << "Patch partitioning is not available with code coupling (patch indices would change)." << endl;
+      partitioning = false;
+    }
+  }
+  if (partitioning) {
+    // split large and merge small patches to fit a cache budget per thread
+    int num_threads = 1;
+#ifdef OPEN_MP
+    num_threads = omp_get_max_threads();
+#endif
+    size_t cache_size = 1024*1024;
+    if (config.exists("partition-cache-size")) {
+      cache_size = config.getValue<int>("partition-cache-size");
+    }
+    size_t bytes_per_cell = (3 + num_stat_fields)*NUM_VARS*sizeof(real) + NUM_VARS*sizeof(acc_real);
+    GridPartitioner partitioner(2);
+    partitioner.setCacheBudget(cache_size, num_threads, bytes_per_cell);
+    partitioner.readGrid("patches/standard.grid");
+    partitioner.partition();
+    cout << "patch partitioning: " << partitioner.numSplits() << " splits, " << partitioner.numMerges() << " merges, ";
+    cout << partitioner.numPatches() << " patches (" << partitioner.minCells() << " to " << partitioner.maxCells() << " cells)" << endl;
+    if (config.exists("partitioned-grid-file")) {
+      partitioner.writeGrid(qPrintable(config.getValue<QString>("partitioned-grid-file")));
+    }
+    partitioner.createPatches(&patch_grid, scale);
+  } else {
+    patch_grid.readGrid("patches/standard.grid", scale);
+  }
   patch_grid.computeDependencies(true);
 
   // Time step
@@ -433,7 +292,9 @@ void run()
     }
   }
 
-#ifdef GPU
+  typedef LevelSetForces<NUM_VARS, BrickLevelSet, PerfectGas> forces_t;
+  forces_t *forces = NULL;
+
   if (config.exists("chamber")) {
     if (config.getValue<bool>("chamber")) {
       real x0 = config.getValue<real>("chamber-x");
@@ -448,27 +309,99 @@ void run()
       typedef CompressibleLsChamber<PerfectGas> bc_t;
       bc_t bc(p0, T0);
       patch_grid.writeToVtk(0, "VTK-drnum/chamber", GenericLevelSetPlotVars<ls_t>(ls), -1);
-      runge_kutta.addPostOperation(new GPU_CartesianLevelSetBC<NUM_VARS, 1, ls_t, bc_t>(&patch_grid, ls, bc, cuda_device, thread_limit));
+#ifdef GPU
+      runge_kutta.addPostOperation(new GPU_CartesianLevelSetBC<NUM_VARS, 0, ls_t, bc_t>(&patch_grid, ls, bc, cuda_device, thread_limit));
+#else
+      runge_kutta.addPostOperation(new CPU_CartesianLevelSetBC<NUM_VARS, 0, ls_t, bc_t>(&patch_grid, ls, bc));
+#endif
     }
   }
 
   if (config.exists("geometry")) {
     QString file_name = config.getValue<QString>("geometry");
-    QTime t_levelSet;
-    t_levelSet.start();
-    cout << endl << "Starting Level Set Computation" << endl;
-    DiscreteLevelSet<NUM_VARS,5> ls_wall(&patch_grid);
-    ls_wall.readGeometry(file_name);
-    cout << endl << "Discrete Level Set Runtime -> " << t_levelSet.elapsed()/1000. << endl;
-    patch_grid.writeToVtk(0, "VTK-drnum/levelset", LevelSetPlotVars<5>(), -1);
+
+    // level set cache (see drnumLevelSetPreprocessor)
+    // G is computed in the scratch field 2 and then moved into sparse bricks (see BrickLevelSet)
+    QString levelset_file_name = "";
+    if (config.exists("level-set-file")) {
+      levelset_file_name = config.getValue<QString>("level-set-file");
+    }
+    LevelSetFile *levelset_file = NULL;
+    if (!levelset_file_name.isEmpty()) {
+      levelset_file = new LevelSetFile(&patch_grid, qPrintable(file_name));
+    }
+    if (levelset_file && levelset_file->read(qPrintable(levelset_file_name), 0, 2)) {
+      cout << endl << "Level set loaded from " << qPrintable(levelset_file_name) << endl;
+    } else {
+      QTime t_levelSet;
+      t_levelSet.start();
+      cout << endl << "Starting Level Set Computation" << endl;
+      DiscreteLevelSet<NUM_VARS,0> ls_wall(&patch_grid);
+      ls_wall.setField(2);
+      ls_wall.readGeometry(file_name);
+      cout << endl << "Discrete Level Set Runtime -> " << t_levelSet.elapsed()/1000. << endl;
+      if (levelset_file) {
+        levelset_file->write(qPrintable(levelset_file_name), 0, 2);
+      }
+    }
+    delete levelset_file;
+    patch_grid.writeToVtk(2, "VTK-drnum/levelset", LevelSetPlotVars<0>(), -1);
+    // the band has to cover the boundary cells (two layers) and their gradient stencils (one more layer);
+    // inner cells in constant tiles are skipped by the boundary condition
+    BrickLevelSet ls;
+    ls.build(&patch_grid, 2, 0, 4);
+    cout << "level set bricks: " << ls.numStoredBricks() << " of " << ls.numBricks() << " stored (";
+    cout << ls.storedBytes()/1024 << " kB)" << endl;
+#ifdef GPU
+    ls.copyToDevice();
     typedef CompressibleLsSlip<GPU_CartesianPatch, PerfectGas> bc_t;
-    typedef StoredLevelSet ls_t;
+#else
+    typedef CompressibleLsSlip<CartesianPatch, PerfectGas> bc_t;
+#endif
+    typedef BrickLevelSet ls_t;
     bc_t bc;
-    ls_t ls(5);
-    runge_kutta.addPostOperation(new GPU_CartesianLevelSetBC<NUM_VARS, 1, ls_t, bc_t>(&patch_grid, ls, bc, cuda_device, thread_limit));
-  }
+
+    // split faces of the immersed boundary (optional, cached like the level set)
+    if (config.exists("split-faces") && config.getValue<bool>("split-faces")) {
+      QString split_face_file_name = "";
+      if (config.exists("split-face-file")) {
+        split_face_file_name = config.getValue<QString>("split-face-file");
+      }
+      SplitFaceFile split_face_file(&patch_grid, qPrintable(file_name));
+      if (!split_face_file_name.isEmpty() && split_face_file.read(qPrintable(split_face_file_name))) {
+        cout << "Split faces loaded from " << qPrintable(split_face_file_name) << endl;
+      } else {
+        SplitFaceBuilder<ls_t> split_faces(&patch_grid, ls);
+        split_faces.build();
+        if (!split_face_file_name.isEmpty()) {
+          split_face_file.write(qPrintable(split_face_file_name));
+        }
+      }
+    }
+#ifdef GPU
+    runge_kutta.addPostOperation(new GPU_CartesianLevelSetBC<NUM_VARS, 0, ls_t, bc_t>(&patch_grid, ls, bc, cuda_device, thread_limit));
+#else
+    runge_kutta.addPostOperation(new CPU_CartesianLevelSetBC<NUM_VARS, 0, ls_t, bc_t>(&patch_grid, ls, bc));
 #endif
 
+    // surface integration of forces and moments
+    real A_ref = 1.0;
+    if (config.exists("reference-area")) {
+      A_ref = config.getValue<real>("reference-area");
+    }
+    vec3_t x_ref(0, 0, 0);
+    if (config.exists("moment-reference-x")) {
+      x_ref[0] = config.getValue<real>("moment-reference-x");
+      x_ref[1] = config.getValue<real>("moment-reference-y");
+      x_ref[2] = config.getValue<real>("moment-reference-z");
+    }
+    real rho = p/(PerfectGas::R()*T);
+    forces = new forces_t(&patch_grid, ls, !config.getValue<bool>("inviscid"));
+    forces->setReference(p, 0.5*rho*uabs*uabs, A_ref, L, x_ref);
+    forces->setup();
+    cout << forces->numFaces() << " surface faces for force integration" << endl;
+  }
+
   if (mesh_preview) {
     patch_grid.writeToVtk(0, "VTK-drnum/step", CompressibleVariables<PerfectGas>(), 0);
     exit(EXIT_SUCCESS);
@@ -476,48 +409,108 @@ void run()
 
   QString reconstruction = config.getValue<QString>("reconstruction");
 
-  PatchIterator *iterator;
-
   bool inviscid = config.getValue<bool>("inviscid");
 
-  if (reconstruction == "second-order") {
-    EaFlux<Upwind2<NUM_VARS, SecondOrder> > flux(u, v, p, T, inviscid);
-    flux.setBCs(xp_bc, xm_bc, yp_bc, ym_bc, zp_bc, zm_bc);
+  // one compile-time specialised iterator per solver code combination (default),
+  // or a single iterator resolving boundary conditions at run-time
+  bool specialised_iterators = true;
+  if (config.exists("specialised-iterators")) {
+    specialised_iterators = config.getValue<bool>("specialised-iterators");
+  }
+
+  // run-time selection of the Euler flux (CPU only); the default is VanLeer
+  QString euler_flux = "";
+  if (config.exists("euler-flux")) {
+    euler_flux = config.getValue<QString>("euler-flux");
+  }
+
+  IteratorFeeder iterator_feeder;
+
+  if (!euler_flux.isEmpty()) {
+#ifdef GPU
+    ERROR("run-time selection of the Euler flux (euler-flux) is not available for GPU runs");
+#else
+    EaIteratorRegistry registry;
+    if (!registry.exists(qPrintable(euler_flux), qPrintable(reconstruction))) {
+      registry.printEntries();
+      ERROR("unknown combination of euler-flux and reconstruction");
+    }
+    EaParameters parameters;
+    parameters.u = u;
+    parameters.v = v;
+    parameters.p = p;
+    parameters.T = T;
+    parameters.inviscid = inviscid;
+    registry.createIterators(patch_grid, iterator_feeder, qPrintable(euler_flux), qPrintable(reconstruction),
+                             parameters, EaBC::fromConfig(xp_bc, xm_bc, yp_bc, ym_bc, zp_bc, zm_bc));
+    cout << "Euler flux: " << qPrintable(euler_flux) << ", reconstruction: " << qPrintable(reconstruction) << endl;
+#endif
+  } else if (specialised_iterators) {
+    if (reconstruction == "second-order") {
+      EaIteratorCreator<Upwind2<NUM_VARS, SecondOrder> > creator(u, v, p, T, inviscid);
+      creator.setBCs(xp_bc, xm_bc, yp_bc, ym_bc, zp_bc, zm_bc);
+#ifdef GPU
+      creator.setDevice(cuda_device, thread_limit);
+#endif
+      iterator_feeder.createIterators(patch_grid, creator);
+    } else if (reconstruction == "minmod") {
+      EaIteratorCreator<Upwind2<NUM_VARS, MinMod> > creator(u, v, p, T, inviscid);
+      creator.setBCs(xp_bc, xm_bc, yp_bc, ym_bc, zp_bc, zm_bc);
+#ifdef GPU
+      creator.setDevice(cuda_device, thread_limit);
+#endif
+      iterator_feeder.createIterators(patch_grid, creator);
+    } else {
+      EaIteratorCreator<Upwind1<NUM_VARS> > creator(u, v, p, T, inviscid);
+      creator.setBCs(xp_bc, xm_bc, yp_bc, ym_bc, zp_bc, zm_bc);
+#ifdef GPU
+      creator.setDevice(cuda_device, thread_limit);
+#endif
+      iterator_feeder.createIterators(patch_grid, creator);
+    }
+    cout << iterator_feeder.numIterators() << " specialised iterator(s) have been created" << endl;
+  } else {
+    PatchIterator *iterator;
+    if (reconstruction == "second-order") {
+      EaFlux<Upwind2<NUM_VARS, SecondOrder> > flux(u, v, p, T, inviscid);
+      flux.setBCs(xp_bc, xm_bc, yp_bc, ym_bc, zp_bc, zm_bc);
 #ifdef GPU
-    iterator = new GPU_CartesianIterator<NUM_VARS, EaFlux<Upwind2<NUM_VARS, SecondOrder> > >(flux, cuda_device, thread_limit);
+      iterator = new GPU_CartesianIterator<NUM_VARS, EaFlux<Upwind2<NUM_VARS, SecondOrder> > >(flux, cuda_device, thread_limit);
 #else
-    iterator = new CartesianIterator<NUM_VARS, EaFlux<Upwind2<NUM_VARS, SecondOrder> > >(flux);
+      iterator = new CartesianIterator<NUM_VARS, EaFlux<Upwind2<NUM_VARS, SecondOrder> > >(flux);
 #endif
 
-  } else if (reconstruction == "minmod") {
-    EaFlux<Upwind2<NUM_VARS, MinMod> > flux(u, v, p, T, inviscid);
+    } else if (reconstruction == "minmod") {
+      EaFlux<Upwind2<NUM_VARS, MinMod> > flux(u, v, p, T, inviscid);
+      flux.setBCs(xp_bc, xm_bc, yp_bc, ym_bc, zp_bc, zm_bc);
 #ifdef GPU
-    iterator = new GPU_CartesianIterator<NUM_VARS, EaFlux<Upwind2<NUM_VARS, MinMod> > >(flux, cuda_device, thread_limit);
+      iterator = new GPU_CartesianIterator<NUM_VARS, EaFlux<Upwind2<NUM_VARS, MinMod> > >(flux, cuda_device, thread_limit);
 #else
-    iterator = new CartesianIterator<NUM_VARS, EaFlux<Upwind2<NUM_VARS, MinMod> > >(flux);
+      iterator = new CartesianIterator<NUM_VARS, EaFlux<Upwind2<NUM_VARS, MinMod> > >(flux);
 #endif
 
-  } else {
-    EaFlux<Upwind1<NUM_VARS> > flux(u, v, p, T, inviscid);
-    flux.setBCs(xp_bc, xm_bc, yp_bc, ym_bc, zp_bc, zm_bc);
+    } else {
+      EaFlux<Upwind1<NUM_VARS> > flux(u, v, p, T, inviscid);
+      flux.setBCs(xp_bc, xm_bc, yp_bc, ym_bc, zp_bc, zm_bc);
 #ifdef GPU
-    iterator = new GPU_CartesianIterator<NUM_VARS, EaFlux<Upwind1<NUM_VARS> > >(flux, cuda_device, thread_limit);
+      iterator = new GPU_CartesianIterator<NUM_VARS, EaFlux<Upwind1<NUM_VARS> > >(flux, cuda_device, thread_limit);
 #else
-    iterator = new CartesianIterator<NUM_VARS, EaFlux<Upwind1<NUM_VARS> > >(flux);
+      iterator = new CartesianIterator<NUM_VARS, EaFlux<Upwind1<NUM_VARS> > >(flux);
 #endif
+    }
+    iterator->setCodeString(CodeString("fx fy fz far far far far far  far 0"));
+    iterator_feeder.addIterator(iterator);
   }
 
-  iterator->setCodeString(CodeString("fx fy fz far far far far far  far 0"));
-
-  IteratorFeeder iterator_feeder;
-  iterator_feeder.addIterator(iterator);
   iterator_feeder.feed(patch_grid);
 
-  runge_kutta.addIterator(iterator);
+  for (size_t i_it = 0; i_it < iterator_feeder.numIterators(); ++i_it) {
+    runge_kutta.addIterator(iterator_feeder.getIterator(i_it));
+  }
 
   int write_counter = 0;
   int iter = 0;
-  real t = 0;
+  acc_real t = 0;
 
   SharedMemory         *shmem = NULL;
   Barrier              *barrier = NULL;
@@ -555,7 +548,14 @@ void run()
     sync(coupling_patch, of2dn_list, dn2of_list, barrier, shmem, write_flag, stop_flag, dt);
     write_interval = MAX_REAL;
     total_time = MAX_REAL;
-    iterator->deactivatePatch(coupling_patch_id);
+    for (size_t i_it = 0; i_it < iterator_feeder.numIterators(); ++i_it) {
+      PatchIterator *iterator = iterator_feeder.getIterator(i_it);
+      for (size_t i_patch = 0; i_patch < iterator->numPatches(); ++i_patch) {
+        if (iterator->getPatch(i_patch) == coupling_patch) {
+          iterator->deactivatePatch(i_patch);
+        }
+      }
+    }
   }
 
   QString restart_file = config.getValue<QString>("restart-file");
@@ -567,6 +567,58 @@ void run()
     }
   }
 
+  FieldStatistics *field_statistics = NULL;
+  if (statistics) {
+    int statistics_interval = 1;
+    if (config.exists("statistics-interval")) {
+      statistics_interval = config.getValue<int>("statistics-interval");
+    }
+    field_statistics = new FieldStatistics(&patch_grid, 3, statistics_interval, config.getValue<int>("num-rk-steps"));
+    field_statistics->setDensityVar(0);
+    if (restart_file.toLower() != "none" && !start_from_zero) {
+      field_statistics->read("data/statistics", write_counter);
+    }
+    runge_kutta.addPostOperation(field_statistics);
+  }
+
+  // freeze quiescent patches (e.g. in the far field) and reactivate them on demand
+  PatchActivityController *patch_activity = NULL;
+  if (config.exists("patch-freezing")) {
+    if (config.getValue<bool>("patch-freezing")) {
+#ifdef GPU
+      cout << "Patch freezing is not available for GPU runs." << endl;
+#else
+      real   freeze_threshold = 5e-5;
+      real   freeze_tolerance = 2e-4;
+      size_t freeze_steps     = 100;
+      if (config.exists("freeze-threshold")) {
+        freeze_threshold = config.getValue<real>("freeze-threshold");
+      }
+      if (config.exists("freeze-tolerance")) {
+        freeze_tolerance = config.getValue<real>("freeze-tolerance");
+      }
+      if (config.exists("freeze-steps")) {
+        freeze_steps = config.getValue<int>("freeze-steps");
+      }
+      patch_activity = new PatchActivityController(&patch_grid, freeze_threshold, freeze_steps, freeze_tolerance);
+      patch_activity->addIterators(iterator_feeder);
+      real var_ref[NUM_VARS];
+      PerfectGas::primitiveToConservative(p, T, u, v, 0, var_ref);
+      real u_ref = max(uabs, real(0.1)*sqrt(PerfectGas::gamma()*PerfectGas::R()*T));
+      real scale[NUM_VARS];
+      scale[0] = var_ref[0];
+      scale[1] = var_ref[0]*u_ref;
+      scale[2] = var_ref[0]*u_ref;
+      scale[3] = var_ref[0]*u_ref;
+      scale[4] = var_ref[4];
+      patch_activity->setReferenceScale(scale);
+      if (coupling_patch) {
+        patch_activity->exclude(coupling_patch);
+      }
+#endif
+    }
+  }
+
   // set inside of bodies at rest (if requested)
   bool inside_at_rest = config.getValue<bool>("inside-at-rest");
   if (inside_at_rest) {
@@ -582,8 +634,43 @@ void run()
     }
   }
 
+  // probes, lines and planes (optional)
+  Sampler *sampler = NULL;
+  if (config.exists("sampler-definition")) {
+    size_t sampler_interval = 1;
+    if (config.exists("sampler-interval")) {
+      sampler_interval = config.getValue<int>("sampler-interval");
+    }
+    QString sampler_file = config.getValue<QString>("sampler-definition");
+    sampler = new Sampler(&patch_grid, "data/samples.bin", sampler_interval);
+    sampler->readDefinition(qPrintable(sampler_file));
+    sampler->setup();
+    cout << sampler->numPoints() << " sampling points have been set up" << endl;
+  }
+
+  // run-time telemetry (summary as JSON, per-step history as CSV, optional Chrome trace)
+  QString telemetry_output = "";
+  if (config.exists("telemetry-output")) {
+    telemetry_output = config.getValue<QString>("telemetry-output");
+    global_telemetry.setOutput(qPrintable(telemetry_output));
+    if (config.exists("telemetry-trace")) {
+      if (config.getValue<bool>("telemetry-trace")) {
+        global_telemetry.enableTrace();
+      }
+    }
+    if (config.exists("telemetry-counters")) {
+      if (config.getValue<bool>("telemetry-counters")) {
+        if (!global_telemetry.enableCounters()) {
+          cout << "Hardware counters are not available (check /proc/sys/kernel/perf_event_paranoid)." << endl;
+        }
+      }
+    }
+  }
+
 #ifdef GPU
-  iterator->updateDevice();
+  for (size_t i_it = 0; i_it < iterator_feeder.numIterators(); ++i_it) {
+    iterator_feeder.getIterator(i_it)->updateDevice();
+  }
 #endif
 
   startTiming();
@@ -592,9 +679,14 @@ void run()
 
     QTime step_start = QTime::currentTime();
     runge_kutta(dt);
+    if (patch_activity) {
+      ScopedTimer timer("patch-activity");
+      patch_activity->update();
+    }
     int msecs_drnum = step_start.msecsTo(QTime::currentTime());
     real dt_new = dt;
     if (coupling_patch) {
+      ScopedTimer timer("sync");
       sync(coupling_patch, of2dn_list, dn2of_list, barrier, shmem, write_flag, stop_flag, dt_new);
     }
     int msecs_total = step_start.msecsTo(QTime::currentTime());
@@ -602,19 +694,40 @@ void run()
     t += dt;
     t_write += dt;
 
+    if (forces) {
+      ScopedTimer timer("forces");
+      forces->compute();
+      forces->write("data/forces.dat", t);
+    }
+
+    if (sampler) {
+      ScopedTimer timer("sampler");
+#ifdef GPU
+      /// @todo copy only patches holding sampling points
+      if (sampler->due()) {
+        for (size_t i_it = 0; i_it < iterator_feeder.numIterators(); ++i_it) {
+          iterator_feeder.getIterator(i_it)->updateHost();
+        }
+      }
+#endif
+      sampler->sample(t);
+    }
+
     if (t_write >= write_interval || write_flag) {
 
       // Do some diagnose on patches
       real CFL_max = 0;
       real rho_min = 1000;
       real rho_max = 0;
-      real max_norm_allpatches = 0.;
-      real l2_norm_allpatches;
-      real ql2_norm_allpatches = 0.;
+      acc_real max_norm_allpatches = 0.;
+      acc_real l2_norm_allpatches;
+      acc_real ql2_norm_allpatches = 0.;
 
 #ifdef GPU
       runge_kutta.copyDonorData(0);
-      iterator->updateHost();
+      for (size_t i_it = 0; i_it < iterator_feeder.numIterators(); ++i_it) {
+        iterator_feeder.getIterator(i_it)->updateHost();
+      }
 #endif
 
       for (size_t i_p = 0; i_p < patch_grid.getNumPatches(); i_p++) {
@@ -640,7 +753,7 @@ void run()
             }
           }
         }
-        real max_norm, l2_norm;
+        acc_real max_norm, l2_norm;
         patch.computeVariableDifference(0, 0, 1, 0, max_norm, l2_norm);
         if (max_norm > max_norm_allpatches) {
           max_norm_allpatches = max_norm;
@@ -653,7 +766,11 @@ void run()
       cout << iter << " iterations,  t=" << t/time << "*L/u_oo,  dt: " << dt;
       cout << "  CFL: " << CFL_max;
       cout << "  max: " << max_norm_allpatches << "  L2: " << l2_norm_allpatches;
-      cout << "  min(rho): " << rho_min << "  max(rho): " << rho_max << endl;
+      cout << "  min(rho): " << rho_min << "  max(rho): " << rho_max;
+      if (patch_activity) {
+        cout << "  frozen patches: " << patch_activity->numFrozenPatches();
+      }
+      cout << endl;
       printTiming();
 
       t_write -= write_interval;
@@ -667,8 +784,13 @@ void run()
 
       ++write_counter;
       if (config.getValue<bool>("file-output")) {
-        patch_grid.writeToVtk(0, "VTK-drnum/step", CompressibleVariablesAndG<PerfectGas>(), write_counter);
+        ScopedTimer timer("output");
+        patch_grid.writeToVtk(0, "VTK-drnum/step", CompressibleVariables<PerfectGas>(), write_counter);
         patch_grid.writeData(0, "data/step", t, write_counter);
+        if (field_statistics) {
+          field_statistics->write("data/statistics", write_counter);
+          patch_grid.writeToVtk(3, "VTK-drnum/mean", CompressibleVariables<PerfectGas>(), write_counter);
+        }
       }
     } else {
       ++iter;
@@ -681,6 +803,7 @@ void run()
     if (coupling_patch) {
       dt = dt_new;
     }
+    global_telemetry.nextStep();
 
     {
       ConfigMap config;
@@ -688,7 +811,7 @@ void run()
       if (config.exists("single-iteration")) {
         if (config.getValue<bool>("single-iteration")) {
           if (config.getValue<bool>("file-output")) {
-            patch_grid.writeToVtk(0, "VTK-drnum/final", CompressibleVariablesAndG<PerfectGas>(), -1);
+            patch_grid.writeToVtk(0, "VTK-drnum/final", CompressibleVariables<PerfectGas>(), -1);
           }
           exit(0);
         }
@@ -700,9 +823,18 @@ void run()
   stopTiming();
   cout << iter << " iterations" << endl;
 
+  if (!telemetry_output.isEmpty()) {
+    PatchProfiler profiler(&patch_grid);
+    profiler.analyse();
+    profiler.printReport();
+    profiler.writeCsv(qPrintable(telemetry_output + "_patches.csv"));
+  }
+
 #ifdef GPU
   runge_kutta.copyDonorData(0);
-  iterator->updateHost();
+  for (size_t i_it = 0; i_it < iterator_feeder.numIterators(); ++i_it) {
+    iterator_feeder.getIterator(i_it)->updateHost();
+  }
 #endif
 
   {
@@ -712,6 +844,8 @@ void run()
       patch_grid.writeToVtk(0, "VTK-drnum/final", CompressibleVariables<PerfectGas>(), -1);
     }
   }
+
+  delete patch_activity;
 }
 
 #endif // EXTERNAL_AERO_H
@@ -229,7 +229,7 @@ void run()
   real L              = config.getValue<real>("reference-length");
   real time           = L/uabs;
   real cfl_target     = config.getValue<real>("CFL-number");
-  real t_write        = 0;
+  acc_real t_write    = 0;
   real write_interval = config.getValue<real>("write-interval")*time;
   real total_time     = config.getValue<real>("total-time")*time;
   bool mesh_preview   = config.getValue<bool>("mesh-preview");
@@ -340,7 +340,7 @@ void run()
   int write_counter = 0;
   int iter = 0;
   int print_out = 0;
-  real t = 0;
+  acc_real t = 0;
 
   QString restart_file = config.getValue<QString>("restart-file");
   if (restart_file.toLower() != "none") {
@@ -399,9 +399,9 @@ void run()
       real CFL_max = 0;
       real rho_min = 1000;
       real rho_max = 0;
-      real max_norm_allpatches = 0.;
-      real l2_norm_allpatches;
-      real ql2_norm_allpatches = 0.;
+      acc_real max_norm_allpatches = 0.;
+      acc_real l2_norm_allpatches;
+      acc_real ql2_norm_allpatches = 0.;
 
 #ifdef GPU
       runge_kutta.copyDonorData(0);
@@ -431,7 +431,7 @@ void run()
             }
           }
         }
-        real max_norm, l2_norm;
+        acc_real max_norm, l2_norm;
         patch.computeVariableDifference(0, 0, 1, 0, max_norm, l2_norm);
         if (max_norm > max_norm_allpatches) {
           max_norm_allpatches = max_norm;
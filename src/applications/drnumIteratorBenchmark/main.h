@@ -0,0 +1,189 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef ITERATOR_BENCHMARK_H
+#define ITERATOR_BENCHMARK_H
+
+#include "../drnumBasicAero/eaflux.h"
+
+#include "patchgrid.h"
+#include "cartesianpatch.h"
+#include "telemetry.h"
+
+#include <fstream>
+
+/**
+ * Timing benchmark for compile-time specialised iterators.
+ *
+ * A block of 2x2x2 Cartesian patches is created; the patches touching x-minus or z-minus
+ * carry "wall" boundary codes, which results in four patch groups with different solver codes.
+ * The same number of explicit steps is then computed twice:
+ *  - with one iterator per patch group using EaFlux, where boundary conditions and the
+ *    viscous switch are checked at run-time,
+ *  - with the iterators built by EaIteratorCreator, where the viscous switch is resolved at
+ *    compile time and the boundary types are fixed per iterator.
+ * Wall times and the maximal difference of the results are reported.
+ *
+ * Usage: drnumIteratorBenchmark [cells per patch edge] [number of steps] [inviscid (0/1)]
+ */
+
+typedef Upwind2<NUM_VARS, SecondOrder> benchmark_reconstruction_t;
+
+/**
+ * Write a grid file with 2x2x2 Cartesian patches covering [-L,L]^3.
+ */
+void writeGrid(string file_name, real L, int N)
+{
+  ofstream grid(file_name.c_str());
+  int index = 0;
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      for (int k = 0; k < 2; ++k) {
+        string xm = i == 0 ? "wall" : "far";
+        string zm = k == 0 ? "wall" : "far";
+        grid << "1001 // index=" << index << " name='benchmark'\n{\n";
+        grid << "  " << -L + i*L << " " << -L + j*L << " " << -L + k*L << "\n";
+        grid << "  1 0 0\n";
+        grid << "  0 1 0\n";
+        grid << "  1\n";
+        grid << "  " << N << " " << N << " " << N << "\n";
+        grid << "  0 0 0 0 0 0\n";
+        grid << "  " << L << " " << L << " " << L << "\n";
+        grid << "  fx fy fz\n";
+        grid << "  " << xm << " far far far " << zm << " far\n";
+        grid << "  0\n";
+        grid << "}\n";
+        ++index;
+      }
+    }
+  }
+  grid << "0\n";
+}
+
+/**
+ * Free stream with a Gaussian pressure pulse in the centre of the domain.
+ */
+void initialise(PatchGrid& patch_grid, real u, real p, real T)
+{
+  for (size_t i_patch = 0; i_patch < patch_grid.getNumPatches(); ++i_patch) {
+    Patch* patch = patch_grid.getPatch(i_patch);
+    for (size_t i_cell = 0; i_cell < patch->variableSize(); ++i_cell) {
+      vec3_t x = patch->xyzoCell(i_cell);
+      real var[NUM_VARS];
+      PerfectGas::primitiveToConservative(p*(1 + 0.1*exp(-10*x.abs2())), T, u, 0, 0, var);
+      patch->setVarset(0, i_cell, var);
+      patch->setVarset(1, i_cell, var);
+    }
+  }
+}
+
+/**
+ * Iterators with run-time boundary conditions; one per patch group.
+ */
+void createRuntimeIterators(PatchGrid& patch_grid, IteratorFeeder& feeder, real u, real p, real T, bool inviscid)
+{
+  PatchGroups* patch_groups = patch_grid.getPatchGroups();
+  for (size_t i_pg = 0 ; i_pg < patch_groups->accessNumPatchGroups(); ++i_pg) {
+    SinglePatchGroup* spg = patch_groups->accessSinglePatchGroup(i_pg);
+    EaFlux<benchmark_reconstruction_t> flux(u, 0, p, T, inviscid);
+    flux.setBCs(EaBC::fromCodes(spg->m_SolverCodes));
+    PatchIterator* iterator = new CartesianIterator<NUM_VARS, EaFlux<benchmark_reconstruction_t> >(flux);
+    iterator->setCodeString(spg->m_SolverCodes);
+    feeder.addIterator(iterator);
+  }
+}
+
+/**
+ * Compute a number of explicit steps and return the wall time.
+ */
+double runCase(PatchGrid& patch_grid, bool specialised, int num_steps, real u, real p, real T, bool inviscid)
+{
+  initialise(patch_grid, u, p, T);
+  IteratorFeeder feeder;
+  if (specialised) {
+    EaIteratorCreator<benchmark_reconstruction_t> creator(u, 0, p, T, inviscid);
+    feeder.createIterators(patch_grid, creator);
+  } else {
+    createRuntimeIterators(patch_grid, feeder, u, p, T, inviscid);
+  }
+  feeder.feed(patch_grid);
+
+  CartesianPatch* patch = dynamic_cast<CartesianPatch*>(patch_grid.getPatch(0));
+  real dt = 0.2*patch->dx()/(fabs(u) + sqrt(PerfectGas::gamma()*PerfectGas::R()*T));
+
+  double start_time = Telemetry::wallTime();
+  for (int i_step = 0; i_step < num_steps; ++i_step) {
+    for (size_t i_it = 0; i_it < feeder.numIterators(); ++i_it) {
+      feeder.getIterator(i_it)->copyField(0, 1);
+    }
+    for (size_t i_it = 0; i_it < feeder.numIterators(); ++i_it) {
+      feeder.getIterator(i_it)->computeAll(dt);
+    }
+  }
+  double run_time = Telemetry::wallTime() - start_time;
+
+  for (size_t i_it = 0; i_it < feeder.numIterators(); ++i_it) {
+    delete feeder.getIterator(i_it);
+  }
+  return run_time;
+}
+
+void run(int N, int num_steps, bool inviscid)
+{
+  string grid_file = "iterator_benchmark.grid";
+  writeGrid(grid_file, 1.0, N);
+
+  PatchGrid patch_grid;
+  patch_grid.setNumberOfFields(3);
+  patch_grid.setNumberOfVariables(NUM_VARS);
+  patch_grid.readGrid(grid_file);
+
+  real p = 1e5;
+  real T = 300;
+  real u = 0.5*sqrt(PerfectGas::gamma()*PerfectGas::R()*T);
+
+  cout << 8*N*N*N << " cells, " << patch_grid.getPatchGroups()->accessNumPatchGroups() << " patch groups, ";
+  cout << num_steps << " steps, " << (inviscid ? "inviscid" : "viscous") << endl;
+
+  double time_runtime = runCase(patch_grid, false, num_steps, u, p, T, inviscid);
+  for (size_t i_patch = 0; i_patch < patch_grid.getNumPatches(); ++i_patch) {
+    patch_grid.getPatch(i_patch)->copyField(0, 2);
+  }
+  double time_static = runCase(patch_grid, true, num_steps, u, p, T, inviscid);
+
+  real max_diff = 0;
+  for (size_t i_patch = 0; i_patch < patch_grid.getNumPatches(); ++i_patch) {
+    Patch* patch = patch_grid.getPatch(i_patch);
+    for (size_t i_var = 0; i_var < NUM_VARS; ++i_var) {
+      real* var1 = patch->getVariable(0, i_var);
+      real* var2 = patch->getVariable(2, i_var);
+      for (size_t i_cell = 0; i_cell < patch->variableSize(); ++i_cell) {
+        max_diff = max(max_diff, real(fabs(var1[i_cell] - var2[i_cell])/max(real(1), real(fabs(var2[i_cell])))));
+      }
+    }
+  }
+
+  cout << "  run-time branches  : " << time_runtime << " s" << endl;
+  cout << "  specialised        : " << time_static << " s" << endl;
+  cout << "  speed-up           : " << time_runtime/time_static << endl;
+  cout << "  max. rel. deviation: " << max_diff << endl;
+}
+
+#endif // ITERATOR_BENCHMARK_H
@@ -3,11 +3,11 @@ class EaFlux
 
 protected:
 
-  typedef AusmPlus<5, reconstruction_t, PerfectGas>           euler_t;
-  typedef CompressibleSlipFlux<5, Upwind1<5>, PerfectGas>     wall_t;
-  typedef CompressibleViscFlux<5, PerfectGas>                 viscous_t;
-  typedef CompressibleFarfieldFlux<5, Upwind1<5>, PerfectGas> farfield_t;
-  typedef CompressibleFlux<5, PerfectGas>                     split_t;
+  typedef AusmPlus<5, reconstruction_t, gas_t>           euler_t;
+  typedef CompressibleSlipFlux<5, Upwind1<5>, gas_t>     wall_t;
+  typedef CompressibleViscFlux<5, gas_t>                 viscous_t;
+  typedef CompressibleFarfieldFlux<5, Upwind1<5>, gas_t> farfield_t;
+  typedef CompressibleFlux<5, gas_t>                     split_t;
 
   reconstruction_t m_Reconstruction;
   euler_t          m_EulerFlux;
@@ -13,18 +13,17 @@
 #include "fluxes/compressibleslipflux.h"
 #include "fluxes/compressiblefarfieldflux.h"
 #include "fluxes/compressibleviscflux.h"
-#include "perfectgas.h"
 #include "compressiblevariables.h"
 #include "rungekutta.h"
 
 class JetFlux
 {
 
-  typedef VanLeer<5, reconstruction_t, PerfectGas>              euler_t;
-  typedef CompressibleViscFlux<5, PerfectGas>                   viscous_t;
-  typedef CompressibleSlipFlux<5, reconstruction_t, PerfectGas> wall_t;
-  typedef CompressibleFarfieldFlux<5, Upwind1<5>, PerfectGas>   farfield_t;
-  typedef CompressibleFlux<5, PerfectGas>                       split_t;
+  typedef VanLeer<5, reconstruction_t, gas_t>              euler_t;
+  typedef CompressibleViscFlux<5, gas_t>                   viscous_t;
+  typedef CompressibleSlipFlux<5, reconstruction_t, gas_t> wall_t;
+  typedef CompressibleFarfieldFlux<5, Upwind1<5>, gas_t>   farfield_t;
+  typedef CompressibleFlux<5, gas_t>                       split_t;
 
   reconstruction_t m_Reconstruction;
   euler_t          m_EulerFlux;
@@ -165,7 +164,7 @@ inline void JetFlux::xWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real
     real var[5];
     real p, T, u, v, w;
     P->getVar(dim, 0, i, j, k, var);
-    PerfectGas::conservativeToPrimitive(var, p, T, u, v, w);
+    gas_t::conservativeToPrimitive(var, p, T, u, v, w);
     real y0 = 0.5*P->sizeJ()*P->dy();
     real z0 = 0.5*P->sizeK()*P->dz();
     real rr = sqr(y - y0) + sqr(z - z0);
@@ -183,11 +182,13 @@ inline void JetFlux::xWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real
       w = 0;
       T = m_Tfar;
     }
-    flux[0] = A*p/(PerfectGas::R()*T)*u;
+    real var_b[5];
+    gas_t::primitiveToConservative(p, T, u, v, w, var_b);
+    flux[0] = A*var_b[0]*u;
     flux[1] = flux[0]*u + A*p;
     flux[2] = flux[0]*v;
     flux[3] = flux[0]*w;
-    flux[4] = flux[0]*(PerfectGas::cp()*T + 0.5*(u*u + v*v + w*w));
+    flux[4] = A*u*(var_b[4] + p);
   }
 }
 
@@ -34,7 +34,7 @@
 #include "fluxes/compressiblefarfieldflux.h"
 #include "fluxes/compressibleviscflux.h"
 #include "fluxes/compressibleslipflux.h"
-#include "perfectgas.h"
+#include "thermallyperfectgas.h"
 #include "compressiblevariables.h"
 #include "rungekutta.h"
 #include "externalexchangelist.h"
@@ -52,6 +52,7 @@
 #include "configmap.h"
 
 typedef Upwind2<5, VanAlbada> reconstruction_t;
+typedef ThermallyPerfectGas   gas_t;
 
 #include "jetflux.h"
 #include "eaflux.h"
@@ -70,12 +71,19 @@ void run()
   real p_jet          = config.getValue<real>("p-jet");
   real T_far          = config.getValue<real>("T-far");
   real T_jet          = config.getValue<real>("T-jet");
-  real u_far          = Ma_far*sqrt(PerfectGas::gamma()*PerfectGas::R()*T_far);
-  real u_jet          = Ma_jet*sqrt(PerfectGas::gamma()*PerfectGas::R()*T_jet);
+
+  // the gas tables have to cover the hot jet; requests without a state refer to the far field
+  gas_t::setup("air", 200, max(real(3000), real(1.5)*T_jet), false, T_far);
+#ifdef GPU
+  gas_t::updateDevice();
+#endif
+
+  real u_far          = Ma_far*sqrt(gas_t::table().gamma(T_far)*gas_t::R()*T_far);
+  real u_jet          = Ma_jet*sqrt(gas_t::table().gamma(T_jet)*gas_t::R()*T_jet);
   real L              = 2*config.getValue<real>("radius");
   real time           = L/u_jet;
   real cfl_target     = config.getValue<real>("CFL");
-  real t_write        = 0;
+  acc_real t_write    = 0;
   real write_interval = config.getValue<real>("write-interval")*time;
   real total_time     = config.getValue<real>("total-time")*time;
   int  jet_patch_id   = config.getValue<int>("jet-patch");
@@ -105,8 +113,8 @@ void run()
   patch_grid.computeDependencies(true);
 
   // Time step
-  real ch_speed1 = u_jet + sqrt(PerfectGas::gamma()*PerfectGas::R()*T_jet);
-  real ch_speed2 = u_far + sqrt(PerfectGas::gamma()*PerfectGas::R()*T_far);
+  real ch_speed1 = u_jet + sqrt(gas_t::table().gamma(T_jet)*gas_t::R()*T_jet);
+  real ch_speed2 = u_far + sqrt(gas_t::table().gamma(T_far)*gas_t::R()*T_far);
   real ch_speed  = max(ch_speed1, ch_speed2);
   real dt        = cfl_target*patch_grid.computeMinChLength()/ch_speed;
 
@@ -115,10 +123,10 @@ void run()
 
   // Initialize
   real init_var[5];
-  PerfectGas::primitiveToConservative(p_far, T_far, 0, u_far, u_far, init_var);
+  gas_t::primitiveToConservative(p_far, T_far, 0, u_far, u_far, init_var);
   patch_grid.setFieldToConst(0, init_var);
 
-  patch_grid.writeToVtk(0, "VTK/step", CompressibleVariables<PerfectGas>(), 0);
+  patch_grid.writeToVtk(0, "VTK/step", CompressibleVariables<gas_t>(), 0);
 
   if (mesh_preview) {
     exit(EXIT_SUCCESS);
@@ -155,7 +163,7 @@ void run()
 
   int write_counter = 0;
   int iter = 0;
-  real t = 0;
+  acc_real t = 0;
 
 #ifdef GPU
   iterator_std.updateDevice();
@@ -176,9 +184,9 @@ void run()
       real CFL_max = 0;
       real rho_min = 1000;
       real rho_max = 0;
-      real max_norm_allpatches = 0.;
-      real l2_norm_allpatches;
-      real ql2_norm_allpatches = 0.;
+      acc_real max_norm_allpatches = 0.;
+      acc_real l2_norm_allpatches;
+      acc_real ql2_norm_allpatches = 0.;
 
 #ifdef GPU
       runge_kutta.copyDonorData(0);
@@ -198,8 +206,8 @@ void run()
               patch.getVar(dim, 0, i, j, k, var);
               rho_min = min(var[0], rho_min);
               rho_max = max(var[0], rho_max);
-              PerfectGas::conservativeToPrimitive(var, p, T, u, v, w);
-              real a = sqrt(PerfectGas::gamma()*PerfectGas::R()*T);
+              gas_t::conservativeToPrimitive(var, p, T, u, v, w);
+              real a = sqrt(gas_t::gamma(var)*gas_t::R()*T);
               CFL_max = max(CFL_max, fabs(u)*dt/patch.dx());
               CFL_max = max(CFL_max, fabs(u+a)*dt/patch.dx());
               CFL_max = max(CFL_max, fabs(u-a)*dt/patch.dx());
@@ -208,7 +216,7 @@ void run()
             }
           }
         }
-        real max_norm, l2_norm;
+        acc_real max_norm, l2_norm;
         patch.computeVariableDifference(0, 0, 1, 0, max_norm, l2_norm);
         if (max_norm > max_norm_allpatches) {
           max_norm_allpatches = max_norm;
@@ -233,7 +241,7 @@ void run()
       dt *= cfl_target/CFL_max;
 
       ++write_counter;
-      patch_grid.writeToVtk(0, "VTK/step", CompressibleVariables<PerfectGas>(), write_counter);
+      patch_grid.writeToVtk(0, "VTK/step", CompressibleVariables<gas_t>(), write_counter);
       t_write -= write_interval;
       if (t > 80.0) {
         write_interval = 0.05;
@@ -252,7 +260,7 @@ void run()
   iterator_std.updateHost();
 #endif
 
-  patch_grid.writeToVtk(0, "VTK/final", CompressibleVariables<PerfectGas>(), -1);
+  patch_grid.writeToVtk(0, "VTK/final", CompressibleVariables<gas_t>(), -1);
 }
 
 #endif // EXTERNAL_AERO_H
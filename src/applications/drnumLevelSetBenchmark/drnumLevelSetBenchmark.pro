@@ -0,0 +1,33 @@
+# ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+# +                                                                      +
+# + This file is part of DrNUM.                                          +
+# +                                                                      +
+# + Copyright 2013 numrax GmbH, enGits GmbH                              +
+# +                                                                      +
+# + DrNUM is free software: you can redistribute it and/or modify        +
+# + it under the terms of the GNU General Public License as published by +
+# + the Free Software Foundation, either version 3 of the License, or    +
+# + (at your option) any later version.                                  +
+# +                                                                      +
+# + DrNUM is distributed in the hope that it will be useful,             +
+# + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+# + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+# + GNU General Public License for more details.                         +
+# +                                                                      +
+# + You should have received a copy of the GNU General Public License    +
+# + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+# +                                                                      +
+# ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+TEMPLATE = app
+CONFIG += console
+
+drnum_app.path  = ../../../bin
+drnum_app.files = drnumLevelSetBenchmark
+INSTALLS += drnum_app
+
+include (../drnum_app.pri)
+
+SOURCES      = main.cpp
+HEADERS      = main.h
+
+
@@ -0,0 +1,52 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef GPU
+#include "main.h"
+#endif
+
+int main(int argc, char** argv)
+{
+#ifdef GPU
+  cout << "The level set benchmark is a CPU application." << endl;
+#else
+  int N = 32;
+  int N_surf = 200;
+  real band_width = 3;
+  if (argc > 1) {
+    N = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    N_surf = atoi(argv[2]);
+  }
+  if (argc > 3) {
+    band_width = atof(argv[3]);
+  }
+#ifdef OPEN_MP
+  int num_threads = omp_get_max_threads();
+#else
+  int num_threads = 1;
+#endif
+  cout << endl;
+  cout << "*** NUMBER THREADS: " << num_threads << endl;
+  cout << endl;
+  run(N, N_surf, band_width);
+#endif
+}
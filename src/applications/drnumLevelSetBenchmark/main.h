@@ -0,0 +1,205 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef LEVELSET_BENCHMARK_H
+#define LEVELSET_BENCHMARK_H
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "cartesianpatch.h"
+#include "discretelevelset.h"
+#include "telemetry.h"
+
+#include <fstream>
+#include <iomanip>
+
+/**
+ * Timing and accuracy benchmark for DiscreteLevelSet.
+ *
+ * Synthetic sphere and torus STL files are written, a block of 2x2x2 Cartesian patches
+ * is created around them and the level set is computed. The result is compared to the
+ * analytic distance functions.
+ *
+ * Usage: drnumLevelSetBenchmark [cells per patch edge] [surface resolution] [band width]
+ */
+
+/// analytic signed distance of the test geometries
+real sphereDistance(vec3_t x)
+{
+  return x.abs() - 1.0;
+}
+
+real torusDistance(vec3_t x)
+{
+  real R = 1.0;
+  real r = 0.35;
+  real rho = sqrt(x[0]*x[0] + x[1]*x[1]) - R;
+  return sqrt(rho*rho + x[2]*x[2]) - r;
+}
+
+void writeFacet(ofstream& stl, vec3_t a, vec3_t b, vec3_t c, vec3_t centre)
+{
+  vec3_t u = b - a;
+  vec3_t v = c - a;
+  vec3_t n = u.cross(v);
+  if (n.abs() < 1e-12) {
+    return; // degenerated (pole)
+  }
+  n.normalise();
+  vec3_t x = a + b + c;
+  x *= 1.0/3.0;
+  vec3_t out = x - centre;
+  if (n*out < 0) {
+    swap(b, c);
+    n *= -1;
+  }
+  stl << "facet normal " << n[0] << " " << n[1] << " " << n[2] << "\n";
+  stl << "  outer loop\n";
+  stl << "    vertex " << a[0] << " " << a[1] << " " << a[2] << "\n";
+  stl << "    vertex " << b[0] << " " << b[1] << " " << b[2] << "\n";
+  stl << "    vertex " << c[0] << " " << c[1] << " " << c[2] << "\n";
+  stl << "  endloop\n";
+  stl << "endfacet\n";
+}
+
+/**
+ * Write a triangulated sphere (radius 1) or torus (R = 1, r = 0.35) as ASCII STL.
+ * @param file_name the name of the file
+ * @param torus sphere if false, torus if true
+ * @param N number of subdivisions in the first parameter direction (2*N in the second)
+ */
+void writeSurface(string file_name, bool torus, int N)
+{
+  ofstream stl(file_name.c_str());
+  stl << setprecision(10);
+  stl << "solid benchmark\n";
+  for (int i1 = 0; i1 < N; ++i1) {
+    for (int i2 = 0; i2 < 2*N; ++i2) {
+      vec3_t x[4];
+      vec3_t c[4];
+      for (int l = 0; l < 4; ++l) {
+        int j1 = i1 + (l == 1 || l == 2);
+        int j2 = i2 + (l >= 2);
+        real phi = 2*M_PI*j2/(2*N);
+        if (torus) {
+          real theta = 2*M_PI*j1/N;
+          real R = 1.0;
+          real r = 0.35;
+          c[l] = vec3_t(R*cos(phi), R*sin(phi), 0);
+          x[l] = vec3_t((R + r*cos(theta))*cos(phi), (R + r*cos(theta))*sin(phi), r*sin(theta));
+        } else {
+          real theta = M_PI*j1/N;
+          c[l] = vec3_t(0, 0, 0);
+          x[l] = vec3_t(sin(theta)*cos(phi), sin(theta)*sin(phi), cos(theta));
+        }
+      }
+      vec3_t centre = c[0] + c[1] + c[2] + c[3];
+      centre *= 0.25;
+      writeFacet(stl, x[0], x[1], x[2], centre);
+      writeFacet(stl, x[0], x[2], x[3], centre);
+    }
+  }
+  stl << "endsolid benchmark\n";
+}
+
+/**
+ * Write a grid file with 2x2x2 Cartesian patches covering [-L,L]^3.
+ */
+void writeGrid(string file_name, real L, int N)
+{
+  ofstream grid(file_name.c_str());
+  int index = 0;
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      for (int k = 0; k < 2; ++k) {
+        grid << "1001 // index=" << index << " name='benchmark'\n{\n";
+        grid << "  " << -L + i*L << " " << -L + j*L << " " << -L + k*L << "\n";
+        grid << "  1 0 0\n";
+        grid << "  0 1 0\n";
+        grid << "  1\n";
+        grid << "  " << N << " " << N << " " << N << "\n";
+        grid << "  0 0 0 0 0 0\n";
+        grid << "  " << L << " " << L << " " << L << "\n";
+        grid << "  fx fy fz\n";
+        grid << "  far far far far far far\n";
+        grid << "  0\n";
+        grid << "}\n";
+        ++index;
+      }
+    }
+  }
+  grid << "0\n";
+}
+
+void runCase(string name, bool torus, int N, int N_surf, real band_width)
+{
+  cout << "\n" << name << " (" << 8*N*N*N << " cells)" << endl;
+
+  string stl_file  = "levelset_benchmark_" + name + ".stl";
+  string grid_file = "levelset_benchmark.grid";
+  writeSurface(stl_file, torus, N_surf);
+  writeGrid(grid_file, 2.0, N);
+
+  PatchGrid patch_grid;
+  patch_grid.setNumberOfFields(1);
+  patch_grid.setNumberOfVariables(5);
+  patch_grid.readGrid(grid_file);
+
+  DiscreteLevelSet<5,4> level_set(&patch_grid);
+  level_set.setBandWidth(band_width);
+  double start_time = Telemetry::wallTime();
+  level_set.readGeometry(stl_file.c_str());
+  double run_time = Telemetry::wallTime() - start_time;
+
+  real h = 0;
+  real err_max = 0;
+  real err_band = 0;
+  size_t wrong_sign = 0;
+  for (size_t i_patch = 0; i_patch < patch_grid.getNumPatches(); ++i_patch) {
+    CartesianPatch* patch = dynamic_cast<CartesianPatch*>(patch_grid.getPatch(i_patch));
+    h = patch->dx();
+    for (size_t i_cell = 0; i_cell < patch->variableSize(); ++i_cell) {
+      vec3_t x = patch->xyzoCell(i_cell);
+      real G_exact = torus ? torusDistance(x) : sphereDistance(x);
+      real G = patch->getVariable(0, 4)[i_cell];
+      real err = fabs(G - G_exact);
+      err_max = max(err_max, err);
+      if (fabs(G_exact) < band_width*h) {
+        err_band = max(err_band, err);
+      }
+      if (G*G_exact < 0 && fabs(G_exact) > h) {
+        ++wrong_sign;
+      }
+    }
+  }
+  cout << "  wall time          : " << run_time << " s" << endl;
+  cout << "  exact queries      : " << level_set.numExactQueries() << endl;
+  cout << "  max. error (band)  : " << err_band/h << "*h" << endl;
+  cout << "  max. error (all)   : " << err_max/h << "*h" << endl;
+  cout << "  wrong sign (>h)    : " << wrong_sign << endl;
+}
+
+void run(int N, int N_surf, real band_width)
+{
+  runCase("sphere", false, N, N_surf, band_width);
+  runCase("torus", true, N, N_surf, band_width);
+}
+
+#endif // LEVELSET_BENCHMARK_H
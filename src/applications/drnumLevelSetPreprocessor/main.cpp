@@ -0,0 +1,40 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef GPU
+#include "main.h"
+#endif
+
+int main(int argc, char** argv)
+{
+#ifdef GPU
+  cout << "The level set preprocessor is a CPU application." << endl;
+#else
+#ifdef OPEN_MP
+  int num_threads = omp_get_max_threads();
+#else
+  int num_threads = 1;
+#endif
+  cout << endl;
+  cout << "*** NUMBER THREADS: " << num_threads << endl;
+  cout << endl;
+  run(argc, argv);
+#endif
+}
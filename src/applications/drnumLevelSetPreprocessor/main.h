@@ -0,0 +1,84 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef LEVELSET_PREPROCESSOR_H
+#define LEVELSET_PREPROCESSOR_H
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "discretelevelset.h"
+#include "levelsetfile.h"
+#include "configmap.h"
+
+/**
+ * Compute the level set of a geometry on a grid once and store it in a level set file
+ * (see LevelSetFile), which is then loaded by drnumBasicAero at startup.
+ *
+ * Usage:
+ *  drnumLevelSetPreprocessor
+ *    reads "geometry", "scale" and "level-set-file" from the control files of drnumBasicAero
+ *    and the grid from "patches/standard.grid"
+ *  drnumLevelSetPreprocessor <grid file> <geometry file> <level set file> [scale]
+ */
+void run(int argc, char** argv)
+{
+  QString grid_file     = "patches/standard.grid";
+  QString geometry_file = "";
+  QString levelset_file = "data/levelset.dls";
+  real    scale         = 1.0;
+  if (argc > 1) {
+    if (argc < 4) {
+      cout << "usage: drnumLevelSetPreprocessor [<grid file> <geometry file> <level set file> [scale]]" << endl;
+      exit(EXIT_FAILURE);
+    }
+    grid_file     = argv[1];
+    geometry_file = argv[2];
+    levelset_file = argv[3];
+    if (argc > 4) {
+      scale = atof(argv[4]);
+    }
+  } else {
+    ConfigMap config;
+    config.addDirectory("control");
+    geometry_file = config.getValue<QString>("geometry");
+    scale         = config.getValue<real>("scale");
+    if (config.exists("level-set-file")) {
+      levelset_file = config.getValue<QString>("level-set-file");
+    }
+  }
+
+  PatchGrid patch_grid;
+  patch_grid.setNumberOfFields(1);
+  patch_grid.setNumberOfVariables(1);
+  patch_grid.readGrid(qPrintable(grid_file), scale);
+
+  LevelSetFile levelset(&patch_grid, qPrintable(geometry_file));
+  if (levelset.read(qPrintable(levelset_file), 0)) {
+    cout << qPrintable(levelset_file) << " is up to date." << endl;
+    return;
+  }
+
+  DiscreteLevelSet<1,0> ls(&patch_grid);
+  ls.readGeometry(geometry_file);
+  levelset.write(qPrintable(levelset_file), 0);
+  cout << "level set written to " << qPrintable(levelset_file) << endl;
+}
+
+#endif // LEVELSET_PREPROCESSOR_H
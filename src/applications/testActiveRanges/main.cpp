@@ -0,0 +1,45 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef GPU
+#include "main.h"
+#endif
+
+int main(int argc, char** argv)
+{
+#ifdef GPU
+  cout << "The active range test is a CPU application." << endl;
+  return 0;
+#else
+  int  N = 48;
+  real R = 0.45;
+  int  num_sweeps = 10;
+  if (argc > 1) {
+    N = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    R = atof(argv[2]);
+  }
+  if (argc > 3) {
+    num_sweeps = atoi(argv[3]);
+  }
+  return run(N, R, num_sweeps);
+#endif
+}
@@ -0,0 +1,164 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef TESTACTIVERANGES_H
+#define TESTACTIVERANGES_H
+
+#include "../drnumBasicAero/eaflux.h"
+
+#include "patchgrid.h"
+#include "cartesianpatch.h"
+#include "reconstruction/vanalbada.h"
+#include "telemetry.h"
+
+/**
+ * Check and timing of the active range sweeps of CartesianIterator.
+ *
+ * A patch of N^3 cells with a deactivated sphere (about 38% of the cells for the
+ * default radius) is computed twice with a viscous EaFlux:
+ *  - with the active ranges of CartesianPatch::updateActiveRanges,
+ *  - with ranges covering complete (i,j) lines, i.e. every face of the patch, as the
+ *    iterator did before the ranges had been introduced.
+ * Since the faces of active cells are evaluated in the same order, the results have to
+ * be bitwise identical. The wall times of both sweeps are reported.
+ *
+ * Usage: testActiveRanges [cells per edge] [sphere radius] [number of sweeps]
+ * The exit code is 1 if the results differ (or nothing has been computed at all).
+ */
+
+typedef EaFlux<Upwind2<NUM_VARS, VanAlbada> > test_flux_t;
+
+/**
+ * A Cartesian patch, which can be told to sweep over all faces.
+ */
+class FullSweepPatch : public CartesianPatch
+{
+
+public:
+
+  FullSweepPatch(PatchGrid* patch_grid) : CartesianPatch(patch_grid) {}
+
+  /**
+   * Replace the active ranges by complete (i,j) lines. The active mask must not be changed afterwards.
+   */
+  void sweepAll()
+  {
+    updateActiveRanges();
+    size_t num_lines = sizeI()*sizeJ();
+    m_ActiveRangeK1.resize(num_lines);
+    m_ActiveRangeK2.resize(num_lines);
+    for (size_t i_line = 0; i_line < num_lines; ++i_line) {
+      m_ActiveRangeStart[i_line] = i_line;
+      m_ActiveRangeK1[i_line] = 0;
+      m_ActiveRangeK2[i_line] = sizeK();
+    }
+    m_ActiveRangeStart[num_lines] = num_lines;
+  }
+
+};
+
+void setupPatch(CartesianPatch& patch, int N, real R)
+{
+  patch.setIndex(0);
+  patch.setNumberOfFields(2);
+  patch.setNumberOfVariables(NUM_VARS);
+  patch.resize(N, N, N);
+  patch.setupMetrics(1, 1, 1);
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j < N; ++j) {
+      for (int k = 0; k < N; ++k) {
+        real x = (i + 0.5)/N;
+        real y = (j + 0.5)/N;
+        real z = (k + 0.5)/N;
+        real var[NUM_VARS];
+        PerfectGas::primitiveToConservative(1e5*(1 + 0.1*x*y), 300 + 50*sin(3*x)*cos(2*z), 30*sin(2*y) + 10*z, 20*cos(3*z)*x, 15*sin(x + y), var);
+        for (size_t i_var = 0; i_var < NUM_VARS; ++i_var) {
+          patch.f(0, i_var, i, j, k) = var[i_var];
+          patch.f(1, i_var, i, j, k) = var[i_var];
+        }
+        if (sqr(x - 0.5) + sqr(y - 0.5) + sqr(z - 0.5) < R*R) {
+          patch.deactivate(i, j, k);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Compute a number of sweeps and return the wall time.
+ */
+double sweep(CartesianPatch& patch, int num_sweeps)
+{
+  test_flux_t flux(30, 0, 1e5, 300, false);
+  CartesianIterator<NUM_VARS, test_flux_t> iterator(flux);
+  iterator.addPatch(&patch);
+  vector<size_t> patches(1, 0);
+  real dt = 0.2*patch.dx()/sqrt(PerfectGas::gamma()*PerfectGas::R()*350);
+  double start_time = Telemetry::wallTime();
+  for (int i_sweep = 0; i_sweep < num_sweeps; ++i_sweep) {
+    iterator.compute(dt, patches);
+  }
+  return Telemetry::wallTime() - start_time;
+}
+
+int run(int N, real R, int num_sweeps)
+{
+  PatchGrid patch_grid;
+  patch_grid.setNumberOfFields(2);
+  patch_grid.setNumberOfVariables(NUM_VARS);
+  CartesianPatch ranges_patch(&patch_grid);
+  setupPatch(ranges_patch, N, R);
+  FullSweepPatch full_patch(&patch_grid);
+  setupPatch(full_patch, N, R);
+  full_patch.sweepAll();
+
+  double time_full   = sweep(full_patch, num_sweeps);
+  double time_ranges = sweep(ranges_patch, num_sweeps);
+
+  // field 1 still holds the initial solution
+  size_t num_diff    = 0;
+  size_t num_changed = 0;
+  real*  var0 = ranges_patch.getField(1);
+  real*  var1 = ranges_patch.getField(0);
+  real*  var2 = full_patch.getField(0);
+  for (size_t i = 0; i < ranges_patch.fieldSize(); ++i) {
+    if (var1[i] != var2[i]) {
+      ++num_diff;
+    }
+    if (var1[i] != var0[i]) {
+      ++num_changed;
+    }
+  }
+
+  cout << N << "^3 cells, " << ranges_patch.numActiveCells() << " active, " << num_sweeps << " sweeps" << endl;
+  cout << "  all faces          : " << time_full << " s" << endl;
+  cout << "  active ranges      : " << time_ranges << " s" << endl;
+  cout << "  speed-up           : " << time_full/time_ranges << endl;
+  cout << "  changed values     : " << num_changed << " of " << ranges_patch.fieldSize() << endl;
+  cout << "  differing values   : " << num_diff << endl;
+  if (num_diff > 0 || num_changed == 0) {
+    cout << "  FAILED" << endl;
+    return 1;
+  }
+  cout << "all checks passed" << endl;
+  return 0;
+}
+
+#endif // TESTACTIVERANGES_H
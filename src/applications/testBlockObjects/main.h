@@ -33,6 +33,7 @@
 #include "fluxes/compressiblefarfieldflux.h"
 #include "fluxes/compressibleviscflux.h"
 #include "fluxes/compressibleslipflux.h"
+#include "fluxes/compressibleflux.h"
 #include "perfectgas.h"
 #include "compressiblevariables.h"
 #include "compressiblevariablesandg.h"
@@ -84,17 +85,19 @@ protected:
   //typedef Upwind2<SecondOrder>                           reconstruction_t;
 
   typedef Upwind2<5,VanAlbada>                              reconstruction_t;
-  typedef AusmPlus<reconstruction_t, PerfectGas>            euler_t;
+  typedef AusmPlus<5, reconstruction_t, PerfectGas>         euler_t;
   //typedef KNP<reconstruction_t, PerfectGas>               euler_t;
   typedef CompressibleSlipFlux<5, Upwind1<5>, PerfectGas>      wall_t;
   typedef CompressibleViscFlux<5, PerfectGas>                  viscous_t;
   typedef CompressibleFarfieldFlux<5, Upwind1<5>, PerfectGas>  farfield_t;
+  typedef CompressibleFlux<5, PerfectGas>                      split_t;
 
   reconstruction_t m_Reconstruction;
   euler_t          m_EulerFlux;
   viscous_t        m_ViscFlux;
   farfield_t       m_FarfieldFlux;
   wall_t           m_WallFlux;
+  split_t          m_SplitFlux;
 
 
 public: // methods
@@ -113,6 +116,8 @@ public: // methods
   template <typename PATCH> CUDA_DH void yWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
   template <typename PATCH> CUDA_DH void zWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux);
 
+  template <typename PATCH> CUDA_DH void splitFlux(PATCH *P, splitface_t sf, real* flux);
+
 };
 
 
@@ -200,6 +205,12 @@ inline void EaFlux::zWallM(PATCH *P, size_t i, size_t j, size_t k, real x, real
   m_FarfieldFlux.zWallM(P, i, j, k, x, y, z, A, flux);
 }
 
+template <typename PATCH>
+inline void EaFlux::splitFlux(PATCH *P, splitface_t sf, real* flux)
+{
+  m_SplitFlux.splitFlux(P, sf, flux);
+}
+
 
 class EaWFluxZM : public EaFlux
 {
@@ -307,7 +318,7 @@ void run()
   real L              = 10.0;
   real time           = L/uabs;
   real cfl_target     = 1.0;
-  real t_write        = 0;
+  acc_real t_write    = 0;
 
   //real write_interval = 1.0*time;
   real write_interval = 0.02*time;
@@ -458,7 +469,7 @@ void run()
 
   int write_counter = 0;
   int iter = 0;
-  real t = 0;
+  acc_real t = 0;
 
   cout << "std:" << iterator_std.numPatches() << endl;
 //  cout << "wzm:" << iterator_wzm.numPatches() << endl;
@@ -482,9 +493,9 @@ void run()
       real CFL_max = 0;
       real rho_min = 1000;
       real rho_max = 0;
-      real max_norm_allpatches = 0.;
-      real l2_norm_allpatches;
-      real ql2_norm_allpatches = 0.;
+      acc_real max_norm_allpatches = 0.;
+      acc_real l2_norm_allpatches;
+      acc_real ql2_norm_allpatches = 0.;
 
 #ifdef GPU
       runge_kutta.copyDonorData(0);
@@ -515,7 +526,7 @@ void run()
             }
           }
         }
-        real max_norm, l2_norm;
+        acc_real max_norm, l2_norm;
         patch.computeVariableDifference(0, 0, 1, 0, max_norm, l2_norm);
         if (max_norm > max_norm_allpatches) {
           max_norm_allpatches = max_norm;
@@ -0,0 +1,41 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef GPU
+#include "main.h"
+#endif
+
+int main(int argc, char** argv)
+{
+#ifdef GPU
+  cout << "The grid partitioner test is a CPU application." << endl;
+  return 0;
+#else
+  int num_steps = 20;
+  size_t max_cells = 2000;
+  if (argc > 1) {
+    num_steps = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    max_cells = atoi(argv[2]);
+  }
+  return run(num_steps, max_cells);
+#endif
+}
@@ -0,0 +1,299 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef TESTGRIDPARTITIONER_H
+#define TESTGRIDPARTITIONER_H
+
+#include "../drnumBasicAero/eaflux.h"
+
+#include "patchgrid.h"
+#include "cartesianpatch.h"
+#include "rungekutta.h"
+#include "iteratorfeeder.h"
+#include "gridpartitioner.h"
+
+#include <sstream>
+
+/**
+ * Checks for GridPartitioner.
+ *
+ *  - split  : a single 48x20x16 patch is split into sub-patches; the same number of
+ *             Runge-Kutta steps is computed on the original and on the split grid and
+ *             the solutions are compared cell by cell,
+ *  - merge  : merging the split grid again has to restore the original patch description,
+ *  - reject : a patch lying completely inside another one must not be merged, while a
+ *             patch extending the first one must be merged into one patch of 20 cells.
+ *
+ * Usage: testGridPartitioner [number of steps] [max. cells per patch]
+ * The exit code is the number of failed checks.
+ */
+
+/// limited, since round-off differences between the grids are amplified by an unlimited scheme
+typedef Upwind2<NUM_VARS, MinMod> test_reconstruction_t;
+
+/**
+ * Grid file with a single patch of 48x20x16 cells and one wall.
+ */
+string bigGrid()
+{
+  ostringstream grid;
+  grid << "1001 // index=0 name='big'\n{\n";
+  grid << "  0 0 0\n";
+  grid << "  1 0 0\n";
+  grid << "  0 1 0\n";
+  grid << "  1\n";
+  grid << "  48 20 16\n";
+  grid << "  0 0 0 0 0 0\n";
+  grid << "  3 1.25 1\n";
+  grid << "  fx fy fz\n";
+  grid << "  far far wall far far far\n";
+  grid << "  0\n";
+  grid << "}\n";
+  grid << "0\n";
+  return grid.str();
+}
+
+/**
+ * Grid file with a patch of 16x8x8 cells and a second patch of 8x8x8 cells
+ * starting at x0 in the same cell raster.
+ */
+string pairGrid(real x0, string seek_layers)
+{
+  ostringstream grid;
+  grid << "1001 // index=0 name='first'\n{\n";
+  grid << "  0 0 0\n  1 0 0\n  0 1 0\n  1\n";
+  grid << "  16 8 8\n";
+  grid << "  0 2 0 0 0 0\n";
+  grid << "  1.0 0.5 0.5\n";
+  grid << "  fx fy fz\n";
+  grid << "  far far far far far far\n";
+  grid << "  0\n}\n";
+  grid << "1001 // index=1 name='second'\n{\n";
+  grid << "  " << x0 << " 0 0\n  1 0 0\n  0 1 0\n  1\n";
+  grid << "  8 8 8\n";
+  grid << "  " << seek_layers << "\n";
+  grid << "  0.5 0.5 0.5\n";
+  grid << "  fx fy fz\n";
+  grid << "  far far far far far far\n";
+  grid << "  0\n}\n";
+  grid << "0\n";
+  return grid.str();
+}
+
+void setupPatchGrid(PatchGrid& patch_grid)
+{
+  patch_grid.setNumberOfFields(3);
+  patch_grid.setNumberOfVariables(NUM_VARS);
+  patch_grid.defineVectorVar(1);
+  patch_grid.setInterpolateData();
+  patch_grid.setNumSeekLayers(2);
+  patch_grid.setTransferType("padded_direct");
+}
+
+/**
+ * Free stream with a Gaussian pressure pulse; compute a number of Runge-Kutta steps.
+ */
+void runCase(PatchGrid& patch_grid, int num_steps)
+{
+  patch_grid.computeDependencies(true);
+
+  real p = 1e5;
+  real T = 300;
+  real u = 0.3*sqrt(PerfectGas::gamma()*PerfectGas::R()*T);
+  for (size_t i_patch = 0; i_patch < patch_grid.getNumPatches(); ++i_patch) {
+    Patch* patch = patch_grid.getPatch(i_patch);
+    for (size_t i_cell = 0; i_cell < patch->variableSize(); ++i_cell) {
+      vec3_t x = patch->xyzoCell(i_cell) - vec3_t(1.2, 0.5, 0.5);
+      real var[NUM_VARS];
+      PerfectGas::primitiveToConservative(p*(1 + 0.05*exp(-20*x.abs2())), T, u, 0, 0, var);
+      patch->setVarset(0, i_cell, var);
+    }
+  }
+
+  IteratorFeeder feeder;
+  PatchGroups* patch_groups = patch_grid.getPatchGroups();
+  for (size_t i_pg = 0; i_pg < patch_groups->accessNumPatchGroups(); ++i_pg) {
+    SinglePatchGroup* spg = patch_groups->accessSinglePatchGroup(i_pg);
+    EaFlux<test_reconstruction_t> flux(u, 0, p, T, true);
+    flux.setBCs(EaBC::fromCodes(spg->m_SolverCodes));
+    PatchIterator* iterator = new CartesianIterator<NUM_VARS, EaFlux<test_reconstruction_t> >(flux);
+    iterator->setCodeString(spg->m_SolverCodes);
+    feeder.addIterator(iterator);
+  }
+  feeder.feed(patch_grid);
+
+  RungeKutta runge_kutta;
+  runge_kutta.addAlpha(0.25);
+  runge_kutta.addAlpha(0.5);
+  runge_kutta.addAlpha(1.000);
+  for (size_t i_it = 0; i_it < feeder.numIterators(); ++i_it) {
+    runge_kutta.addIterator(feeder.getIterator(i_it));
+  }
+  CartesianPatch* patch = dynamic_cast<CartesianPatch*>(patch_grid.getPatch(0));
+  real dt = 0.4*patch->dx()/(u + sqrt(PerfectGas::gamma()*PerfectGas::R()*T));
+  for (int i_step = 0; i_step < num_steps; ++i_step) {
+    runge_kutta(dt);
+  }
+  runge_kutta.copyDonorData(0);
+
+  for (size_t i_it = 0; i_it < feeder.numIterators(); ++i_it) {
+    delete feeder.getIterator(i_it);
+  }
+}
+
+/**
+ * Split the big patch, run both grids and compare the solutions.
+ */
+bool checkSplit(int num_steps, size_t max_cells)
+{
+  GridPartitioner partitioner;
+  istringstream s_grid(bigGrid());
+  partitioner.readGrid(s_grid);
+  partitioner.setPatchSize(max_cells, 0);
+  partitioner.partition();
+  cout << "split  : " << partitioner.numSplits() << " splits, " << partitioner.numPatches() << " patches" << endl;
+
+  PatchGrid grid_orig;
+  setupPatchGrid(grid_orig);
+  istringstream s_orig(bigGrid());
+  grid_orig.readGrid(s_orig);
+  runCase(grid_orig, num_steps);
+
+  PatchGrid grid_split;
+  setupPatchGrid(grid_split);
+  partitioner.createPatches(&grid_split);
+  runCase(grid_split, num_steps);
+
+  // Deviations are scaled with the largest magnitude of each variable in the original solution;
+  // the momentum components share one scale, since the cross-flow components are almost zero.
+  CartesianPatch* orig = dynamic_cast<CartesianPatch*>(grid_orig.getPatch(0));
+  real scale[NUM_VARS];
+  for (size_t i_var = 0; i_var < NUM_VARS; ++i_var) {
+    scale[i_var] = 0;
+    real* var = orig->getVariable(0, i_var);
+    for (size_t i_cell = 0; i_cell < orig->variableSize(); ++i_cell) {
+      scale[i_var] = max(scale[i_var], real(fabs(var[i_cell])));
+    }
+  }
+  scale[1] = max(scale[1], max(scale[2], scale[3]));
+  scale[2] = scale[1];
+  scale[3] = scale[1];
+  real max_diff = 0;
+  for (size_t i_patch = 0; i_patch < grid_split.getNumPatches(); ++i_patch) {
+    CartesianPatch* patch = dynamic_cast<CartesianPatch*>(grid_split.getPatch(i_patch));
+    for (size_t i_cell = 0; i_cell < patch->variableSize(); ++i_cell) {
+      vec3_t x = patch->xyzoCell(i_cell);
+      size_t i_orig = orig->index(int(x[0]/orig->dx()), int(x[1]/orig->dy()), int(x[2]/orig->dz()));
+      if ((orig->xyzoCell(i_orig) - x).abs() > 1e-4*orig->dx()) {
+        cout << "  cell centres of the sub-patches do not match the original patch" << endl;
+        return false;
+      }
+      for (size_t i_var = 0; i_var < NUM_VARS; ++i_var) {
+        real v_orig = orig->getVariable(0, i_var)[i_orig];
+        real v      = patch->getVariable(0, i_var)[i_cell];
+        max_diff = max(max_diff, real(fabs(v - v_orig)/scale[i_var]));
+      }
+    }
+  }
+  cout << "  max. rel. deviation after " << num_steps << " steps: " << max_diff << endl;
+  return max_diff < 1e-5;
+}
+
+/**
+ * Split the big patch and merge the sub-patches again.
+ */
+bool checkMerge(size_t max_cells)
+{
+  GridPartitioner unchanged;
+  istringstream s_orig(bigGrid());
+  unchanged.readGrid(s_orig);
+  ostringstream orig_txt;
+  unchanged.writeGrid(orig_txt);
+
+  GridPartitioner splitter;
+  istringstream s_grid(bigGrid());
+  splitter.readGrid(s_grid);
+  splitter.setPatchSize(max_cells, 0);
+  splitter.partition();
+  ostringstream split_txt;
+  splitter.writeGrid(split_txt);
+
+  GridPartitioner merger;
+  istringstream s_split(split_txt.str());
+  merger.readGrid(s_split);
+  merger.setPatchSize(48*20*16, 48*20*16);
+  merger.partition();
+  ostringstream merged_txt;
+  merger.writeGrid(merged_txt);
+
+  // the header line carries the patch name, which is marked as partitioned
+  string orig_def   = orig_txt.str().substr(orig_txt.str().find('{'));
+  string merged_def = merged_txt.str().substr(merged_txt.str().find('{'));
+
+  cout << "merge  : " << splitter.numPatches() << " patches -> " << merger.numPatches() << " patches" << endl;
+  return merger.numPatches() == 1 && merged_def == orig_def;
+}
+
+/**
+ * A contained patch must be rejected, an extending patch must be merged.
+ */
+bool checkReject()
+{
+  GridPartitioner contained;
+  istringstream s_contained(pairGrid(0.25, "2 2 0 0 0 0"));
+  contained.readGrid(s_contained);
+  contained.setPatchSize(100000, 5000);
+  contained.partition();
+
+  GridPartitioner extend;
+  istringstream s_extend(pairGrid(0.75, "2 0 0 0 0 0"));
+  extend.readGrid(s_extend);
+  extend.setPatchSize(100000, 5000);
+  extend.partition();
+  ostringstream merged_txt;
+  extend.writeGrid(merged_txt);
+
+  cout << "reject : contained " << contained.numMerges() << " merges, extending " << extend.numMerges() << " merges" << endl;
+  return contained.numMerges() == 0 && contained.numPatches() == 2 && extend.numPatches() == 1
+         && merged_txt.str().find("20 8 8") != string::npos;
+}
+
+int run(int num_steps, size_t max_cells)
+{
+  int num_failed = 0;
+  if (!checkSplit(num_steps, max_cells)) {
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  if (!checkMerge(max_cells)) {
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  if (!checkReject()) {
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  if (num_failed == 0) {
+    cout << "all checks passed" << endl;
+  }
+  return num_failed;
+}
+
+#endif // TESTGRIDPARTITIONER_H
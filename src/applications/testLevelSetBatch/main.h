@@ -0,0 +1,199 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef TESTLEVELSETBATCH_H
+#define TESTLEVELSETBATCH_H
+
+#include "spherelevelset.h"
+#include "cartboxlevelset.h"
+#include "cylinderlevelset.h"
+#include "conelevelset.h"
+#include "combilevelsetor.h"
+#include "combilevelsetandnot.h"
+#include "levelsetprogram.h"
+
+#include "sphereobject.h"
+#include "cartboxobject.h"
+#include "cylinderobject.h"
+#include "coneobject.h"
+#include "combiobjector.h"
+#include "combiobjectandnot.h"
+#include "objectprogram.h"
+
+#include <cstdlib>
+
+/**
+ * Checks for the batch evaluation of level sets and objects.
+ *
+ *  - level sets : calcDistances of the sphere, box, cylinder and cone level sets has to
+ *                 return exactly the values of the per-point calcDistance,
+ *  - objects    : checkInside of the sphere, box, cylinder and cone objects has to agree
+ *                 with the per-point isInside,
+ *  - programs   : a combined level set/object evaluated by LevelSetProgram/ObjectProgram
+ *                 has to agree with the per-point evaluation of the combination.
+ *
+ * All checks use the same random points in the box [-2,2]^3.
+ *
+ * Usage: testLevelSetBatch [number of points]
+ * The exit code is the number of failed checks.
+ */
+
+struct TestPoints
+{
+  vector<real> x;
+  vector<real> y;
+  vector<real> z;
+
+  TestPoints(size_t n) : x(n), y(n), z(n)
+  {
+    srand(1);
+    for (size_t i = 0; i < n; ++i) {
+      x[i] = 4*real(rand())/real(RAND_MAX) - 2;
+      y[i] = 4*real(rand())/real(RAND_MAX) - 2;
+      z[i] = 4*real(rand())/real(RAND_MAX) - 2;
+    }
+  }
+
+  size_t size() { return x.size(); }
+};
+
+/**
+ * Compare calcDistances with calcDistance.
+ * @return the number of points with a different value
+ */
+size_t countDistanceMismatches(LevelSetDefinition* levelset, TestPoints& points)
+{
+  size_t n = points.size();
+  vector<real> g(n);
+  levelset->calcDistances(&points.x[0], &points.y[0], &points.z[0], &g[0], n);
+  size_t num_mismatches = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (g[i] != levelset->calcDistance(points.x[i], points.y[i], points.z[i])) {
+      ++num_mismatches;
+    }
+  }
+  return num_mismatches;
+}
+
+/**
+ * Compare checkInside with isInside.
+ * @return the number of points with a different result
+ */
+size_t countInsideMismatches(ObjectDefinition* object, TestPoints& points)
+{
+  size_t n = points.size();
+  vector<char> inside(n);
+  object->checkInside(&points.x[0], &points.y[0], &points.z[0], &inside[0], n);
+  size_t num_mismatches = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if ((inside[i] != 0) != object->isInside(points.x[i], points.y[i], points.z[i])) {
+      ++num_mismatches;
+    }
+  }
+  return num_mismatches;
+}
+
+bool report(string name, size_t num_mismatches, size_t n)
+{
+  cout << name << " : " << num_mismatches << " of " << n << " points differ" << endl;
+  if (num_mismatches > 0) {
+    cout << "  FAILED" << endl;
+    return false;
+  }
+  return true;
+}
+
+int run(size_t n)
+{
+  TestPoints points(n);
+  int num_failed = 0;
+
+  SphereLevelSet   sphere_ls;
+  CartboxLevelSet  box_ls;
+  CylinderLevelSet cylinder_ls;
+  ConeLevelSet     cone_ls;
+  sphere_ls.setParams(0.2, -0.1, 0.3, 1.1);
+  box_ls.setParams(-1.5, 0.5, -0.7, 1.2, -1.0, 0.8);
+  cylinder_ls.setParams(-0.5, 0.2, -1.2, 0.3, 0.4, 1.5, 0.6);
+  cone_ls.setParams(0.1, -1.3, 0.2, 0.5, 1.8, -0.3, 0.9, 0.3);
+
+  if (!report("sphere level set  ", countDistanceMismatches(&sphere_ls, points), n))   ++num_failed;
+  if (!report("box level set     ", countDistanceMismatches(&box_ls, points), n))      ++num_failed;
+  if (!report("cylinder level set", countDistanceMismatches(&cylinder_ls, points), n)) ++num_failed;
+  if (!report("cone level set    ", countDistanceMismatches(&cone_ls, points), n))     ++num_failed;
+
+  SphereObject   sphere_obj;
+  CartboxObject  box_obj;
+  CylinderObject cylinder_obj;
+  ConeObject     cone_obj;
+  sphere_obj.setParams(0.2, -0.1, 0.3, 1.1);
+  box_obj.setParams(-1.5, 0.5, -0.7, 1.2, -1.0, 0.8);
+  cylinder_obj.setParams(-0.5, 0.2, -1.2, 0.3, 0.4, 1.5, 0.6);
+  cone_obj.setParams(0.1, -1.3, 0.2, 0.5, 1.8, -0.3, 0.9, 0.3);
+
+  if (!report("sphere object     ", countInsideMismatches(&sphere_obj, points), n))   ++num_failed;
+  if (!report("box object        ", countInsideMismatches(&box_obj, points), n))      ++num_failed;
+  if (!report("cylinder object   ", countInsideMismatches(&cylinder_obj, points), n)) ++num_failed;
+  if (!report("cone object       ", countInsideMismatches(&cone_obj, points), n))     ++num_failed;
+
+  // (sphere or cone or cylinder) and not box
+  CombiLevelSetOr     ls_or(&sphere_ls, &cone_ls);
+  ls_or.includeLevelSet(&cylinder_ls);
+  CombiLevelSetAndNot ls_combi(&ls_or, &box_ls);
+  {
+    LevelSetProgram program;
+    program.compile(&ls_combi);
+    vector<real> work(program.workspaceSize(n));
+    vector<real> g(n);
+    program.evaluate(&points.x[0], &points.y[0], &points.z[0], &g[0], n, &work[0]);
+    size_t num_mismatches = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (g[i] != ls_combi.calcDistance(points.x[i], points.y[i], points.z[i])) {
+        ++num_mismatches;
+      }
+    }
+    if (!report("level set program ", num_mismatches, n)) ++num_failed;
+  }
+
+  CombiObjectOr     obj_or(&sphere_obj, &cone_obj);
+  obj_or.includeObject(&cylinder_obj);
+  CombiObjectAndNot obj_combi(&obj_or, &box_obj);
+  {
+    ObjectProgram program;
+    program.compile(&obj_combi);
+    vector<char> work(program.workspaceSize(n));
+    vector<char> inside(n);
+    program.evaluate(&points.x[0], &points.y[0], &points.z[0], &inside[0], n, &work[0]);
+    size_t num_mismatches = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if ((inside[i] != 0) != obj_combi.isInside(points.x[i], points.y[i], points.z[i])) {
+        ++num_mismatches;
+      }
+    }
+    if (!report("object program    ", num_mismatches, n)) ++num_failed;
+  }
+
+  if (num_failed == 0) {
+    cout << "all checks passed" << endl;
+  }
+  return num_failed;
+}
+
+#endif // TESTLEVELSETBATCH_H
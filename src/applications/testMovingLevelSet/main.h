@@ -0,0 +1,224 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef TESTMOVINGLEVELSET_H
+#define TESTMOVINGLEVELSET_H
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "cartesianpatch.h"
+#include "perfectgas.h"
+#include "movinglevelset.h"
+#include "spherelevelset.h"
+#include "discretelevelset.h"
+#include "cpu_cartesianlevelsetbc.h"
+#include "compressiblelsslip.h"
+
+#include <set>
+#include <sstream>
+
+/**
+ * Check of the incremental updates of MovingLevelSet.
+ *
+ * A sphere (r = 0.8) translates through a patch of N^3 cells covering [-2,2]^3. One grid
+ * follows the motion with a number of incremental updates (MovingLevelSet::move and
+ * CPU_CartesianLevelSetBC::updateCells); a second grid is initialised directly at the final
+ * position. The following has to be identical on both grids:
+ *  - G in the band of exact values,
+ *  - the active flags,
+ *  - the boundary and inner cell lists of the level set boundary condition.
+ * The deviation of G from the exact distance is reported for information. The body has to
+ * stay clear of the patch boundaries, since the mirror points of the boundary condition
+ * must lie inside the patch.
+ *
+ * Usage: testMovingLevelSet [cells per edge] [number of steps] [displacement per step]
+ * The exit code is the number of failed checks.
+ */
+
+#define G_VAR 5
+
+typedef CompressibleLsSlip<CartesianPatch, PerfectGas> test_slip_t;
+
+/**
+ * Level set boundary condition with access to the cell lists.
+ */
+class TestLevelSetBC : public CPU_CartesianLevelSetBC<6, 1, StoredLevelSet, test_slip_t>
+{
+
+public:
+
+  TestLevelSetBC(PatchGrid* patch_grid) : CPU_CartesianLevelSetBC<6, 1, StoredLevelSet, test_slip_t>(patch_grid, StoredLevelSet(G_VAR), test_slip_t()) {}
+
+  set<size_t> bcCells()
+  {
+    set<size_t> cells;
+    for (int i = 0; i < m_BcCells[0].size(); ++i) {
+      cells.insert(m_BcCells[0][i].index);
+    }
+    return cells;
+  }
+
+  set<size_t> innerCells()
+  {
+    set<size_t> cells;
+    for (int i = 0; i < m_Cells[0].size(); ++i) {
+      cells.insert(m_Patches[0]->index(m_Cells[0][i].i, m_Cells[0][i].j, m_Cells[0][i].k));
+    }
+    return cells;
+  }
+
+};
+
+void setupGrid(PatchGrid& patch_grid, int N)
+{
+  ostringstream grid;
+  grid << "1001 // index=0 name='box'\n{\n";
+  grid << "  -2 -2 -2\n  1 0 0\n  0 1 0\n  1\n";
+  grid << "  " << N << " " << N << " " << N << "\n";
+  grid << "  0 0 0 0 0 0\n";
+  grid << "  4 4 4\n";
+  grid << "  fx fy fz\n";
+  grid << "  far far far far far far\n";
+  grid << "  0\n}\n";
+  grid << "0\n";
+  patch_grid.setNumberOfFields(3);
+  patch_grid.setNumberOfVariables(6);
+  patch_grid.defineVectorVar(1);
+  patch_grid.setInterpolateData();
+  patch_grid.setNumSeekLayers(2);
+  patch_grid.setTransferType("padded_direct");
+  istringstream s_grid(grid.str());
+  patch_grid.readGrid(s_grid);
+  patch_grid.computeDependencies(true);
+
+  Patch* patch = patch_grid.getPatch(0);
+  for (size_t i_cell = 0; i_cell < patch->variableSize(); ++i_cell) {
+    vec3_t x = patch->xyzoCell(i_cell);
+    real var[5];
+    PerfectGas::primitiveToConservative(1e5, 300 + x[0], 50 + x[1], x[2], 0, var);
+    for (size_t i_var = 0; i_var < 5; ++i_var) {
+      patch->getVariable(0, i_var)[i_cell] = var[i_var];
+    }
+  }
+}
+
+/**
+ * Position of the body after a displacement s.
+ */
+CoordTransformVV bodyPosition(real s)
+{
+  CoordTransformVV inertial2body;
+  inertial2body.setVector(vec3_t(-s, -0.3*s, 0.1*s));
+  return inertial2body;
+}
+
+int run(int N, int num_steps, real ds)
+{
+  SphereLevelSet sphere;
+  sphere.setParams(0, 0, 0, 0.8);
+  real band = 0.8;
+  real h    = 0.04;
+  vec3_t x1(-0.8, -0.8, -0.8);
+  vec3_t x2( 0.8,  0.8,  0.8);
+
+  // incremental motion
+  PatchGrid grid_moved;
+  setupGrid(grid_moved, N);
+  MovingLevelSet moved(&grid_moved, G_VAR);
+  moved.sample(&sphere, x1, x2, h, band);
+  moved.initialise(bodyPosition(0));
+  TestLevelSetBC bc_moved(&grid_moved);
+  bc_moved();
+  real s = 0;
+  size_t num_full = 0;
+  for (int i_step = 0; i_step < num_steps; ++i_step) {
+    s += ds;
+    moved.move(bodyPosition(s));
+    bc_moved.updateCells(moved);
+    bc_moved();
+    if (moved.fullUpdate()) {
+      ++num_full;
+    }
+  }
+
+  // reference at the final position
+  PatchGrid grid_ref;
+  setupGrid(grid_ref, N);
+  MovingLevelSet ref(&grid_ref, G_VAR);
+  ref.sample(&sphere, x1, x2, h, band);
+  ref.initialise(bodyPosition(s));
+  TestLevelSetBC bc_ref(&grid_ref);
+  bc_ref();
+
+  CartesianPatch* patch_moved = dynamic_cast<CartesianPatch*>(grid_moved.getPatch(0));
+  CartesianPatch* patch_ref   = dynamic_cast<CartesianPatch*>(grid_ref.getPatch(0));
+  real   max_diff  = 0;
+  real   max_exact = 0;
+  size_t num_flags = 0;
+  bool   finite    = true;
+  for (size_t i_cell = 0; i_cell < patch_ref->variableSize(); ++i_cell) {
+    real G_moved = patch_moved->getVariable(0, G_VAR)[i_cell];
+    real G_ref   = patch_ref->getVariable(0, G_VAR)[i_cell];
+    if (fabs(G_ref) < band) {
+      max_diff = max(max_diff, real(fabs(G_moved - G_ref)));
+      vec3_t x = bodyPosition(s).transform(patch_ref->xyzoCell(i_cell));
+      max_exact = max(max_exact, real(fabs(G_moved - sphere.calcDistance(x[0], x[1], x[2]))));
+    }
+    if ((G_moved < 0) != (G_ref < 0) || patch_moved->getActive()[i_cell] != patch_ref->getActive()[i_cell]) {
+      ++num_flags;
+    }
+    real rho = patch_moved->getVariable(0, 0)[i_cell];
+    if (!(rho == rho)) {
+      finite = false;
+    }
+  }
+
+  int num_failed = 0;
+  cout << N << "^3 cells, " << num_steps << " steps of " << ds << " (" << num_full << " full updates)" << endl;
+  cout << "band   : max. |G - G_ref| = " << max_diff << ", max. |G - G_exact| = " << max_exact << endl;
+  if (max_diff != 0) {
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  cout << "flags  : " << num_flags << " cells with different sign or active flag" << endl;
+  if (num_flags > 0) {
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  bool same_bc    = bc_moved.bcCells() == bc_ref.bcCells();
+  bool same_inner = bc_moved.innerCells() == bc_ref.innerCells();
+  cout << "lists  : " << bc_moved.bcCells().size() << " boundary cells, " << bc_moved.innerCells().size() << " inner cells";
+  cout << (same_bc && same_inner ? " (identical)" : " (different)") << endl;
+  if (!same_bc || !same_inner) {
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  if (!finite) {
+    cout << "state  : non-finite values after the updates" << endl;
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  if (num_failed == 0) {
+    cout << "all checks passed" << endl;
+  }
+  return num_failed;
+}
+
+#endif // TESTMOVINGLEVELSET_H
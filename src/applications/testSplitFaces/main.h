@@ -0,0 +1,269 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef TESTSPLITFACES_H
+#define TESTSPLITFACES_H
+
+#include "../drnumBasicAero/eaflux.h"
+
+#include "patchgrid.h"
+#include "cartesianpatch.h"
+#include "rungekutta.h"
+#include "iteratorfeeder.h"
+#include "splitfacebuilder.h"
+
+#include <sstream>
+
+/**
+ * Checks for the split-face wall flux of CartesianIterator.
+ *
+ * A sphere (r = 0.25) is placed in the centre of a closed box [0,1]^3 with N^3 cells
+ * and slip walls on all sides. The sphere surface is represented by split faces only.
+ *
+ *  - rest     : a fluid at rest has to stay at rest,
+ *  - pulse    : a pressure pulse is computed for a number of steps; the solution has to
+ *               stay finite and the fluid mass and energy have to be conserved, since
+ *               neither the box walls nor the split faces carry a mass or energy flux,
+ *  - closure  : the wall force of a constant pressure has to vanish on the closed sphere.
+ *
+ * Usage: testSplitFaces [cells per edge] [number of steps]
+ * The exit code is the number of failed checks.
+ */
+
+typedef Upwind2<NUM_VARS, MinMod> test_reconstruction_t;
+typedef EaFlux<test_reconstruction_t> test_flux_t;
+
+/**
+ * Analytic sphere; negative inside the body.
+ */
+struct TestSphere
+{
+  real m_X0, m_Y0, m_Z0, m_R;
+
+  TestSphere() {}
+  TestSphere(real x0, real y0, real z0, real R) : m_X0(x0), m_Y0(y0), m_Z0(z0), m_R(R) {}
+
+  real G(CartesianPatch& patch, size_t i, size_t j, size_t k, size_t = 0)
+  {
+    real x, y, z;
+    patch.xyzoIJK(i, j, k, x, y, z);
+    x -= m_X0;
+    y -= m_Y0;
+    z -= m_Z0;
+    return sqrt(x*x + y*y + z*z) - m_R;
+  }
+};
+
+string boxGrid(int N)
+{
+  ostringstream grid;
+  grid << "1001 // index=0 name='box'\n{\n";
+  grid << "  0 0 0\n  1 0 0\n  0 1 0\n  1\n";
+  grid << "  " << N << " " << N << " " << N << "\n";
+  grid << "  0 0 0 0 0 0\n";
+  grid << "  1 1 1\n";
+  grid << "  fx fy fz\n";
+  grid << "  wall wall wall wall wall wall\n";
+  grid << "  0\n}\n";
+  grid << "0\n";
+  return grid.str();
+}
+
+/**
+ * Sum of the conservative variables over all fluid cells.
+ */
+void fluidSums(CartesianPatch* patch, double* sum, bool& finite)
+{
+  for (size_t i_var = 0; i_var < NUM_VARS; ++i_var) {
+    sum[i_var] = 0;
+  }
+  finite = true;
+  for (size_t i_cell = 0; i_cell < patch->variableSize(); ++i_cell) {
+    if (!patch->isInsideCell(i_cell)) {
+      for (size_t i_var = 0; i_var < NUM_VARS; ++i_var) {
+        real v = patch->getVariable(0, i_var)[i_cell];
+        if (!(v == v)) {
+          finite = false;
+        }
+        sum[i_var] += v;
+      }
+    }
+  }
+}
+
+class SplitFaceTest
+{
+
+protected: // attributes
+
+  PatchGrid       m_PatchGrid;
+  CartesianPatch* m_Patch;
+  test_flux_t*    m_Flux;
+  PatchIterator*  m_Iterator;
+  RungeKutta      m_RungeKutta;
+  real            m_P;
+  real            m_T;
+
+
+public: // methods
+
+  SplitFaceTest(int N)
+  {
+    m_P = 1e5;
+    m_T = 300;
+    m_PatchGrid.setNumberOfFields(3);
+    m_PatchGrid.setNumberOfVariables(NUM_VARS);
+    m_PatchGrid.defineVectorVar(1);
+    m_PatchGrid.setInterpolateData();
+    m_PatchGrid.setNumSeekLayers(2);
+    m_PatchGrid.setTransferType("padded_direct");
+    istringstream s_grid(boxGrid(N));
+    m_PatchGrid.readGrid(s_grid);
+    m_PatchGrid.computeDependencies(true);
+    m_Patch = dynamic_cast<CartesianPatch*>(m_PatchGrid.getPatch(0));
+
+    SplitFaceBuilder<TestSphere> split_faces(&m_PatchGrid, TestSphere(0.5, 0.5, 0.5, 0.25));
+    split_faces.build();
+    cout << N << "^3 cells, " << split_faces.numFaces() << " split faces" << endl;
+
+    CodeString codes = m_PatchGrid.getPatchGroups()->accessSinglePatchGroup(0)->m_SolverCodes;
+    m_Flux = new test_flux_t(0, 0, m_P, m_T, true);
+    m_Flux->setBCs(EaBC::fromCodes(codes));
+    m_Iterator = new CartesianIterator<NUM_VARS, test_flux_t>(*m_Flux);
+    m_Iterator->setCodeString(codes);
+    IteratorFeeder feeder;
+    feeder.addIterator(m_Iterator);
+    feeder.feed(m_PatchGrid);
+    m_RungeKutta.addAlpha(0.25);
+    m_RungeKutta.addAlpha(0.5);
+    m_RungeKutta.addAlpha(1.000);
+    m_RungeKutta.addIterator(m_Iterator);
+  }
+
+  ~SplitFaceTest()
+  {
+    delete m_Iterator;
+    delete m_Flux;
+  }
+
+  /**
+   * Initialise with a Gaussian pressure pulse of the given amplitude at x0.
+   */
+  void initialise(real amplitude, vec3_t x0)
+  {
+    for (size_t i_cell = 0; i_cell < m_Patch->variableSize(); ++i_cell) {
+      vec3_t x = m_Patch->xyzoCell(i_cell) - x0;
+      real var[NUM_VARS];
+      PerfectGas::primitiveToConservative(m_P*(1 + amplitude*exp(-100*x.abs2())), m_T, 0, 0, 0, var);
+      m_Patch->setVarset(0, i_cell, var);
+    }
+  }
+
+  void run(int num_steps)
+  {
+    real dt = 0.4*m_Patch->dx()/sqrt(PerfectGas::gamma()*PerfectGas::R()*m_T);
+    for (int i_step = 0; i_step < num_steps; ++i_step) {
+      m_RungeKutta(dt);
+    }
+  }
+
+  bool checkRest(int num_steps)
+  {
+    initialise(0, vec3_t(0, 0, 0));
+    real var0[NUM_VARS];
+    m_Patch->getVarset(0, 0, var0);
+    run(num_steps);
+    real max_diff = 0;
+    for (size_t i_cell = 0; i_cell < m_Patch->variableSize(); ++i_cell) {
+      if (!m_Patch->isInsideCell(i_cell)) {
+        for (size_t i_var = 0; i_var < NUM_VARS; ++i_var) {
+          real scale = i_var == 0 ? var0[0] : var0[4];
+          max_diff = max(max_diff, real(fabs(m_Patch->getVariable(0, i_var)[i_cell] - var0[i_var])/scale));
+        }
+      }
+    }
+    cout << "rest   : max. rel. deviation after " << num_steps << " steps: " << max_diff << endl;
+    return max_diff < 1e-6;
+  }
+
+  bool checkPulse(int num_steps)
+  {
+    initialise(0.3, vec3_t(0.2, 0.3, 0.35));
+    double sum0[NUM_VARS], sum1[NUM_VARS];
+    bool finite0, finite1;
+    fluidSums(m_Patch, sum0, finite0);
+    run(num_steps);
+    fluidSums(m_Patch, sum1, finite1);
+    double mass_err   = fabs(sum1[0] - sum0[0])/sum0[0];
+    double energy_err = fabs(sum1[4] - sum0[4])/sum0[4];
+    cout << "pulse  : after " << num_steps << " steps, rel. change of mass " << mass_err << ", of energy " << energy_err << endl;
+    return finite1 && mass_err < 1e-5 && energy_err < 1e-5;
+  }
+
+  bool checkClosure()
+  {
+    initialise(0, vec3_t(0, 0, 0));
+    splitface_t* split_faces = m_Patch->getSplitFaces();
+    double F[NUM_VARS];
+    for (size_t i_var = 0; i_var < NUM_VARS; ++i_var) {
+      F[i_var] = 0;
+    }
+    double A = 0;
+    for (size_t i = 0; i < m_Patch->getSplitGroupLimit(m_Patch->getNumSplitGroups()); ++i) {
+      if (!split_faces[i].inside) {
+        real flux[NUM_VARS];
+        fill(flux, NUM_VARS, 0);
+        m_Flux->splitFlux(m_Patch, split_faces[i], flux);
+        for (size_t i_var = 0; i_var < NUM_VARS; ++i_var) {
+          F[i_var] += flux[i_var];
+        }
+        A += fabs(split_faces[i].nx) + fabs(split_faces[i].ny) + fabs(split_faces[i].nz);
+      }
+    }
+    double F_max = max(fabs(F[1]), max(fabs(F[2]), fabs(F[3])))/(m_P*A);
+    cout << "closure: mass flux " << F[0] << ", energy flux " << F[4] << ", rel. force " << F_max << endl;
+    return F[0] == 0 && F[4] == 0 && F_max < 1e-5;
+  }
+
+};
+
+int run(int N, int num_steps)
+{
+  int num_failed = 0;
+  SplitFaceTest test(N);
+  if (!test.checkRest(num_steps)) {
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  if (!test.checkPulse(num_steps)) {
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  if (!test.checkClosure()) {
+    cout << "  FAILED" << endl;
+    ++num_failed;
+  }
+  if (num_failed == 0) {
+    cout << "all checks passed" << endl;
+  }
+  return num_failed;
+}
+
+#endif // TESTSPLITFACES_H
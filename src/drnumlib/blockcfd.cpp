@@ -20,6 +20,7 @@
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 
 #include "drnum.h"
+#include "telemetry.h"
 
 unsigned long int global_flops     = 0;
 unsigned long int global_flops_x86 = 0;
@@ -33,31 +34,32 @@ void startTiming()
   global_flops_x86 = 0;
   global_start_time = time(NULL);
   global_last_time = global_start_time;
+  global_telemetry.start();
   cout << "\nTiming started.\n" << endl;
 }
 
 void printTiming()
 {
-  time_t now = time(NULL);
-  cout << now - global_start_time << " seconds since timing began" << endl;
-  cout << now - global_last_time << " seconds since last timing output" << endl;
-  global_last_time = now;
+  global_last_time = time(NULL);
+  global_telemetry.print();
 }
 
 void stopTiming()
 {
-  int secs = time(NULL) - global_start_time;
+  double secs = max(1e-6, global_telemetry.elapsed());
   cout << "\nTiming finished:\n";
   if (global_flops > 0) {
     cout << "  floating point operations                : " << global_flops/1000000     << "*10^6\n";
     cout << "  floating point operations (X86 weighted) : " << global_flops_x86/1000000 << "*10^6\n";
-    cout << "  floating point operations                : " << global_flops/1000000/secs     << " MFlops\n";
-    cout << "  floating point operations (X86 weighted) : " << global_flops_x86/1000000/secs << " MFlops\n";
+    cout << "  floating point operations                : " << 1e-6*global_flops/secs     << " MFlops\n";
+    cout << "  floating point operations (X86 weighted) : " << 1e-6*global_flops_x86/secs << " MFlops\n";
     cout << "  seconds                                  : " << secs << "\n";
   } else {
     cout << "  seconds : " << secs << "\n";
   }
   cout << endl;
+  global_telemetry.print();
+  global_telemetry.writeOutput();
 }
 
 
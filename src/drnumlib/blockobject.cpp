@@ -37,6 +37,8 @@ BlockObject::BlockObject(PatchGrid* patch_grid,
   }
   /// @todo need handling for field index. Allways 0 ?
   m_FieldIndex = 0;
+  m_BlockSize = 8;
+  m_NumCheckedCells = 0;
 }
 
 
@@ -70,6 +72,17 @@ void BlockObject::update(ObjectDefinition *object)
 
   m_ObjectDefinition = object;
 
+  // Flatten the object definition. Note: the definition itself must not be
+  // evaluated from several threads, since combined objects store intermediate
+  // results in their lowest objects (setKnownInside).
+  m_Program.compile(m_ObjectDefinition);
+  size_t max_block_cells = m_BlockSize*m_BlockSize*m_BlockSize;
+  m_NumCheckedCells = 0;
+
+  // Bounds of the object to skip patches and blocks of cells
+  vec3_t box_xyzo_min, box_xyzo_max;
+  bool bounded = m_ObjectDefinition->getBoundingBox(box_xyzo_min, box_xyzo_max);
+
   /**
     * @todo Clear method to give number of cells in patch is missing.
     * variableSize() ???
@@ -90,6 +103,21 @@ void BlockObject::update(ObjectDefinition *object)
 
     Patch* patch = m_PatchGrid->getPatch(i_p);
 
+    // Skip patches, that cannot be hit by the object.
+    if (bounded) {
+      vec3_t patch_xyzo_min = patch->accessBBoxXYZoMin();
+      vec3_t patch_xyzo_max = patch->accessBBoxXYZoMax();
+      bool disjoint = false;
+      for (size_t i = 0; i < 3; ++i) {
+        if (patch_xyzo_min[i] > box_xyzo_max[i] || patch_xyzo_max[i] < box_xyzo_min[i]) {
+          disjoint = true;
+        }
+      }
+      if (disjoint) {
+        continue;
+      }
+    }
+
     // build a scratch size_t list to mark cells affected
     // cell_marker[any_cell] =
     //   0: marks cell as white (fully outside solid object)
@@ -113,20 +141,48 @@ void BlockObject::update(ObjectDefinition *object)
     // Loop for cells of patch to find the ones blocked by object
     // Note 1: dont care black or grey
     // Note 2: dont care subcell-resolution. Take only the cells, whose center is inside
-    /// @todo parallel omp makes program extremely slow ???
-    //#pragma omp parallel for
-    for (size_t l_c = 0; l_c < patch->variableSize(); l_c++) {
-      real xc, yc, zc;
-      patch->xyzoCell(l_c,
-                      xc, yc, zc);
-      if (m_ObjectDefinition->isInside(xc, yc, zc)) {
-        cell_marker[l_c] = max_marker;  // preliminary setting to last group
-        any_hit_in_patch = true;
-      }
-      else {
-        fully_black = false;
+    // Note 3: cells are evaluated in blocks, flags are reduced per thread
+    // Note 4: blocks of Cartesian patches outside the object bounds are skipped
+    CartesianPatch* cart_patch = dynamic_cast<CartesianPatch*>(patch);
+    vector<block_t> blocks;
+    buildBlocks(patch, blocks);
+    size_t num_checked = 0;
+#ifndef DEBUG
+    #pragma omp parallel if(blocks.size() > 1)
+#endif
+    {
+      vector<size_t> cells;
+      vector<real> xc(max_block_cells), yc(max_block_cells), zc(max_block_cells);
+      vector<char> inside(max_block_cells);
+      vector<char> work(m_Program.workspaceSize(max_block_cells));
+
+#ifndef DEBUG
+      #pragma omp for schedule(dynamic) reduction(||:any_hit_in_patch) reduction(&&:fully_black) reduction(+:num_checked)
+#endif
+      for (int i_block = 0; i_block < int(blocks.size()); ++i_block) {
+        if (cart_patch && bounded && !checkBlockOverlap(cart_patch, blocks[i_block], box_xyzo_min, box_xyzo_max)) {
+          fully_black = false;
+          continue;
+        }
+        getBlockCells(patch, blocks[i_block], cells);
+        for (size_t i = 0; i < cells.size(); ++i) {
+          patch->xyzoCell(cells[i],
+                          xc[i], yc[i], zc[i]);
+        }
+        m_Program.evaluate(&xc[0], &yc[0], &zc[0], &inside[0], cells.size(), &work[0]);
+        for (size_t i = 0; i < cells.size(); ++i) {
+          if (inside[i]) {
+            cell_marker[cells[i]] = max_marker;  // preliminary setting to last group
+            any_hit_in_patch = true;
+          }
+          else {
+            fully_black = false;
+          }
+        }
+        num_checked += cells.size();
       }
     }
+    m_NumCheckedCells += num_checked;
 
     // Any hit?
     if (any_hit_in_patch) {
@@ -182,8 +238,10 @@ void BlockObject::update(ObjectDefinition *object)
         //.. Analyse preliminary light grey cells, and decide wether these are
         //   * white: grey_count == 0  =>  reset cell back to fluid (marker = 0)
         //   * grey:  grey_count >  0  =>  set cell to really grey (marker = 1)
-        //#pragma omp parallel for
-        for (size_t l_c = 0; l_c < patch->variableSize(); l_c++) {
+#ifndef DEBUG
+        #pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for (int l_c = 0; l_c < int(num_cells); l_c++) {
           if (cell_marker[l_c] == pre_light_grey) {
             analyseGreyCount(patch, l_c,
                              grey_count[l_c], max_grey_count[l_c],
@@ -580,6 +638,80 @@ void BlockObject::checkRecurrence()
 }
 
 
+void BlockObject::buildBlocks(Patch* patch, vector<block_t>& blocks)
+{
+  blocks.clear();
+  block_t block;
+  CartesianPatch* cart_patch = dynamic_cast<CartesianPatch*>(patch);
+  if (cart_patch) {
+    for (size_t i = 0; i < cart_patch->sizeI(); i += m_BlockSize) {
+      for (size_t j = 0; j < cart_patch->sizeJ(); j += m_BlockSize) {
+        for (size_t k = 0; k < cart_patch->sizeK(); k += m_BlockSize) {
+          block.i1 = i;
+          block.j1 = j;
+          block.k1 = k;
+          block.i2 = min(i + m_BlockSize, cart_patch->sizeI());
+          block.j2 = min(j + m_BlockSize, cart_patch->sizeJ());
+          block.k2 = min(k + m_BlockSize, cart_patch->sizeK());
+          blocks.push_back(block);
+        }
+      }
+    }
+  } else {
+    size_t max_block_cells = m_BlockSize*m_BlockSize*m_BlockSize;
+    for (size_t l = 0; l < patch->variableSize(); l += max_block_cells) {
+      block.i1 = l;
+      block.i2 = min(l + max_block_cells, patch->variableSize());
+      block.j1 = block.k1 = block.j2 = block.k2 = 0;
+      blocks.push_back(block);
+    }
+  }
+}
+
+
+void BlockObject::getBlockCells(Patch* patch, const block_t& block, vector<size_t>& cells)
+{
+  cells.clear();
+  CartesianPatch* cart_patch = dynamic_cast<CartesianPatch*>(patch);
+  if (cart_patch) {
+    for (size_t i = block.i1; i < block.i2; ++i) {
+      for (size_t j = block.j1; j < block.j2; ++j) {
+        for (size_t k = block.k1; k < block.k2; ++k) {
+          cells.push_back(cart_patch->index(i, j, k));
+        }
+      }
+    }
+  } else {
+    for (size_t l_c = block.i1; l_c < block.i2; ++l_c) {
+      cells.push_back(l_c);
+    }
+  }
+}
+
+
+bool BlockObject::checkBlockOverlap(CartesianPatch* patch, const block_t& block,
+                                    const vec3_t& box_xyzo_min, const vec3_t& box_xyzo_max)
+{
+  // Sphere around the cell centres of the block.
+  // Note: the cell centres span a (rotated) box, its diagonal is the diameter.
+  real x1, y1, z1, x2, y2, z2;
+  patch->xyzoCell(patch->index(block.i1, block.j1, block.k1),
+                  x1, y1, z1);
+  patch->xyzoCell(patch->index(block.i2 - 1, block.j2 - 1, block.k2 - 1),
+                  x2, y2, z2);
+  vec3_t xyzo_m(0.5*(x1 + x2), 0.5*(y1 + y2), 0.5*(z1 + z2));
+  real q_radius = 0.25*((x2 - x1)*(x2 - x1) + (y2 - y1)*(y2 - y1) + (z2 - z1)*(z2 - z1));
+
+  // squared distance of the centre from the box
+  real q_dist = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    real delta = max(real(0), max(box_xyzo_min[i] - xyzo_m[i], xyzo_m[i] - box_xyzo_max[i]));
+    q_dist += delta*delta;
+  }
+  return q_dist <= q_radius;
+}
+
+
 void BlockObject::analyseGreyCount(Patch* patch, size_t l_cell,
                                    size_t& grey_count, size_t& max_grey_count,
                                    vec3_t& no_vec)
@@ -606,12 +738,23 @@ void BlockObject::analyseGreyCount(Patch* patch, size_t l_cell,
   no_vec[1] = 0.;
   no_vec[2] = 0.;
 
+  // check all subcells in one batch
+  vector<real> xo_sub(max_grey_count), yo_sub(max_grey_count), zo_sub(max_grey_count);
+  for (size_t i_sub = 0; i_sub < max_grey_count; i_sub++) {
+    xo_sub[i_sub] = xyzo_subcells[i_sub][0];
+    yo_sub[i_sub] = xyzo_subcells[i_sub][1];
+    zo_sub[i_sub] = xyzo_subcells[i_sub][2];
+  }
+  vector<char> inside(max_grey_count);
+  vector<char> work(m_Program.workspaceSize(max_grey_count));
+  m_Program.evaluate(&xo_sub[0], &yo_sub[0], &zo_sub[0], &inside[0], max_grey_count, &work[0]);
+
   for (size_t i_sub = 0; i_sub < max_grey_count; i_sub++) {
-    real xo_sc = xyzo_subcells[i_sub][0];
-    real yo_sc = xyzo_subcells[i_sub][1];
-    real zo_sc = xyzo_subcells[i_sub][2];
+    real xo_sc = xo_sub[i_sub];
+    real yo_sc = yo_sub[i_sub];
+    real zo_sc = zo_sub[i_sub];
 
-    if (m_ObjectDefinition->isInside(xo_sc, yo_sc, zo_sc)) {
+    if (inside[i_sub]) {
       grey_count++;
 
       real delta_xo = xo_sc - xo_c;
@@ -27,7 +27,9 @@ class BlockObject;
 
 #include "genericoperation.h"
 #include "objectdefinition.h"
+#include "objectprogram.h"
 #include "patchgrid.h"
+#include "cartesianpatch.h"
 #include "perfectgas.h"
 
 struct greycell_t
@@ -52,6 +54,16 @@ class BlockObject
   friend class BlockObjectBC;
   friend class CompressibleEulerBOBC;
 
+protected: // data types
+
+  /** Block of cells (Cartesian: index box, otherwise: range i1 .. i2-1 of cells) */
+  struct block_t
+  {
+    size_t i1, j1, k1;
+    size_t i2, j2, k2;
+  };
+
+
 protected: // data
 
   PerfectGas m_Gas;
@@ -65,6 +77,9 @@ protected: // data
   size_t m_GreyResolution;
 
   ObjectDefinition* m_ObjectDefinition;
+  ObjectProgram     m_Program; ///< flattened, thread safe form of m_ObjectDefinition
+  size_t            m_BlockSize; ///< edge length of cell blocks used for culling
+  size_t            m_NumCheckedCells; ///< number of cells checked in the last update
 
   // mem stucture for m_Cells... data;
   //  1st dim: counter index of affected patch
@@ -128,6 +143,16 @@ protected: // methods
   //void copyToDevice();
   //void processFront(vector<vector<pair<vector<size_t>, real> > >& front, real& p_average, real& T_average);
 
+  /** Split a patch into blocks of cells (m_BlockSize^3 for Cartesian patches). */
+  void buildBlocks(Patch* patch, vector<block_t>& blocks);
+
+  /** Get the cell indices of a block. */
+  void getBlockCells(Patch* patch, const block_t& block, vector<size_t>& cells);
+
+  /** Check, if the sphere around the cell centres of a block touches a box in xyzo-coords. */
+  bool checkBlockOverlap(CartesianPatch* patch, const block_t& block,
+                         const vec3_t& box_xyzo_min, const vec3_t& box_xyzo_max);
+
 
 public: // methods
 
@@ -145,6 +170,8 @@ public: // methods
 
   void checkRecurrence();
 
+  size_t getNumCheckedCells() { return m_NumCheckedCells; }
+
   PatchGrid* getPatchGrid() {return m_PatchGrid; }
 
   vector<size_t> getAffectedPatchIDs() { return m_AffectedPatchIDs; }
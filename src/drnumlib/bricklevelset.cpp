@@ -0,0 +1,189 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "bricklevelset.h"
+#include "cartesianpatch.h"
+
+#ifdef CUDA
+#include "cudatools.h"
+#endif
+
+BrickLevelSet::BrickLevelSet()
+{
+  clearData(m_Host);
+  clearData(m_Device);
+  m_NumPatches      = 0;
+  m_NumBricks       = 0;
+  m_NumStoredBricks = 0;
+}
+
+void BrickLevelSet::clearData(data_t& data)
+{
+  data.num_bricks_j = NULL;
+  data.num_bricks_k = NULL;
+  data.brick_start  = NULL;
+  data.brick_index  = NULL;
+  data.tile_value   = NULL;
+  data.values       = NULL;
+}
+
+void BrickLevelSet::build(PatchGrid* patch_grid, size_t i_field, size_t i_var, real num_band_cells)
+{
+  deleteData();
+  m_NumPatches = patch_grid->getNumPatches();
+
+  // temporary brick grids (one per patch)
+  vector<CartesianPatch*>  patches(m_NumPatches, NULL);
+  vector<SparseBrickGrid>  grids(m_NumPatches);
+  for (size_t i_patch = 0; i_patch < m_NumPatches; ++i_patch) {
+    patch_grid->getPatch(i_patch)->setIndex(i_patch);
+    patches[i_patch] = dynamic_cast<CartesianPatch*>(patch_grid->getPatch(i_patch));
+  }
+#ifndef DEBUG
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i_patch = 0; i_patch < int(m_NumPatches); ++i_patch) {
+    CartesianPatch* patch = patches[i_patch];
+    if (patch) {
+      SparseBrickGrid& grid = grids[i_patch];
+      grid.resize(patch->sizeI(), patch->sizeJ(), patch->sizeK(), MAX_REAL);
+      for (size_t i = 0; i < patch->sizeI(); ++i) {
+        for (size_t j = 0; j < patch->sizeJ(); ++j) {
+          for (size_t k = 0; k < patch->sizeK(); ++k) {
+            grid.set(i, j, k, patch->f(i_field, i_var, i, j, k));
+          }
+        }
+      }
+      real h = max(patch->dx(), max(patch->dy(), patch->dz()));
+      grid.prune(num_band_cells*h);
+    }
+  }
+
+  // flat arrays for all patches
+  m_NumBricks       = 0;
+  m_NumStoredBricks = 0;
+  for (size_t i_patch = 0; i_patch < m_NumPatches; ++i_patch) {
+    m_NumBricks       += grids[i_patch].numBricks();
+    m_NumStoredBricks += grids[i_patch].numAllocatedBricks();
+  }
+  m_Host.num_bricks_j = new size_t [m_NumPatches];
+  m_Host.num_bricks_k = new size_t [m_NumPatches];
+  m_Host.brick_start  = new size_t [m_NumPatches];
+  m_Host.brick_index  = new int    [m_NumBricks];
+  m_Host.tile_value   = new real   [m_NumBricks];
+  m_Host.values       = new real   [m_NumStoredBricks*BRICK3];
+  size_t b = 0;
+  size_t i_data = 0;
+  for (size_t i_patch = 0; i_patch < m_NumPatches; ++i_patch) {
+    const SparseBrickGrid& grid = grids[i_patch];
+    m_Host.num_bricks_j[i_patch] = grid.numBricksJ();
+    m_Host.num_bricks_k[i_patch] = grid.numBricksK();
+    m_Host.brick_start[i_patch]  = b;
+    for (size_t bi = 0; bi < grid.numBricksI(); ++bi) {
+      for (size_t bj = 0; bj < grid.numBricksJ(); ++bj) {
+        for (size_t bk = 0; bk < grid.numBricksK(); ++bk) {
+          if (grid.isAllocated(bi, bj, bk)) {
+            m_Host.brick_index[b] = i_data;
+            m_Host.tile_value[b]  = 0;
+            real* values = m_Host.values + i_data*BRICK3;
+            for (size_t i = 0; i < BRICK; ++i) {
+              for (size_t j = 0; j < BRICK; ++j) {
+                for (size_t k = 0; k < BRICK; ++k) {
+                  values[i*BRICK*BRICK + j*BRICK + k] = grid.get(bi*BRICK + i, bj*BRICK + j, bk*BRICK + k);
+                }
+              }
+            }
+            ++i_data;
+          } else {
+            m_Host.brick_index[b] = -1;
+            m_Host.tile_value[b]  = grid.getTile(bi, bj, bk);
+          }
+          ++b;
+        }
+      }
+    }
+  }
+}
+
+void BrickLevelSet::toVariable(PatchGrid* patch_grid, size_t i_field, size_t i_var)
+{
+  for (size_t i_patch = 0; i_patch < patch_grid->getNumPatches(); ++i_patch) {
+    CartesianPatch* patch = dynamic_cast<CartesianPatch*>(patch_grid->getPatch(i_patch));
+    if (patch) {
+      for (size_t i = 0; i < patch->sizeI(); ++i) {
+        for (size_t j = 0; j < patch->sizeJ(); ++j) {
+          for (size_t k = 0; k < patch->sizeK(); ++k) {
+            patch->f(i_field, i_var, i, j, k) = G(*patch, i, j, k);
+          }
+        }
+      }
+    }
+  }
+}
+
+void BrickLevelSet::copyToDevice()
+{
+#ifdef CUDA
+  if (m_Device.num_bricks_j) {
+    cudaFree(m_Device.num_bricks_j);
+    cudaFree(m_Device.num_bricks_k);
+    cudaFree(m_Device.brick_start);
+    cudaFree(m_Device.brick_index);
+    cudaFree(m_Device.tile_value);
+    cudaFree(m_Device.values);
+  }
+  cudaMalloc(&m_Device.num_bricks_j, m_NumPatches*sizeof(size_t));
+  cudaMalloc(&m_Device.num_bricks_k, m_NumPatches*sizeof(size_t));
+  cudaMalloc(&m_Device.brick_start,  m_NumPatches*sizeof(size_t));
+  cudaMalloc(&m_Device.brick_index,  m_NumBricks*sizeof(int));
+  cudaMalloc(&m_Device.tile_value,   m_NumBricks*sizeof(real));
+  cudaMalloc(&m_Device.values,       m_NumStoredBricks*BRICK3*sizeof(real));
+  CUDA_CHECK_ERROR;
+  cudaMemcpy(m_Device.num_bricks_j, m_Host.num_bricks_j, m_NumPatches*sizeof(size_t), cudaMemcpyHostToDevice);
+  cudaMemcpy(m_Device.num_bricks_k, m_Host.num_bricks_k, m_NumPatches*sizeof(size_t), cudaMemcpyHostToDevice);
+  cudaMemcpy(m_Device.brick_start,  m_Host.brick_start,  m_NumPatches*sizeof(size_t), cudaMemcpyHostToDevice);
+  cudaMemcpy(m_Device.brick_index,  m_Host.brick_index,  m_NumBricks*sizeof(int),     cudaMemcpyHostToDevice);
+  cudaMemcpy(m_Device.tile_value,   m_Host.tile_value,   m_NumBricks*sizeof(real),    cudaMemcpyHostToDevice);
+  cudaMemcpy(m_Device.values,       m_Host.values,       m_NumStoredBricks*BRICK3*sizeof(real), cudaMemcpyHostToDevice);
+  CUDA_CHECK_ERROR;
+#endif
+}
+
+void BrickLevelSet::deleteData()
+{
+  delete [] m_Host.num_bricks_j;
+  delete [] m_Host.num_bricks_k;
+  delete [] m_Host.brick_start;
+  delete [] m_Host.brick_index;
+  delete [] m_Host.tile_value;
+  delete [] m_Host.values;
+  clearData(m_Host);
+#ifdef CUDA
+  if (m_Device.num_bricks_j) {
+    cudaFree(m_Device.num_bricks_j);
+    cudaFree(m_Device.num_bricks_k);
+    cudaFree(m_Device.brick_start);
+    cudaFree(m_Device.brick_index);
+    cudaFree(m_Device.tile_value);
+    cudaFree(m_Device.values);
+  }
+#endif
+  clearData(m_Device);
+}
@@ -0,0 +1,134 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef BRICKLEVELSET_H
+#define BRICKLEVELSET_H
+
+class BrickLevelSet;
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "sparsebrickgrid.h"
+
+/**
+ * Level set of a PatchGrid stored in sparse bricks instead of a solver variable.
+ *
+ * Every Cartesian patch is split into bricks of SparseBrickGrid::BRICK^3 cells. Only bricks
+ * containing a cell with |G| below the band width are stored; all other bricks are tiles with
+ * a single value (the value of their cell with the smallest |G|). The bricks of all patches are
+ * kept in flat arrays, which are addressed by the index of the patch (Patch::getIndex).
+ *
+ * G is computed once into a scratch variable (e.g. with DiscreteLevelSet::setField) and
+ * then converted with build. Afterwards the scratch field can be used for other purposes
+ * and the solver does not have to carry G as an extra variable. The interface is the one of
+ * StoredLevelSet, so the Cartesian level set boundary conditions and LevelSetForces can be used
+ * with either of them.
+ *
+ * Copies of a BrickLevelSet are shallow (like GPU_Patch); they share the data of the original object.
+ */
+class BrickLevelSet
+{
+
+public: // data types
+
+  static const size_t BRICK  = SparseBrickGrid::BRICK;
+  static const size_t BRICK3 = SparseBrickGrid::BRICK3;
+
+  struct data_t
+  {
+    size_t* num_bricks_j; ///< number of bricks in j direction (per patch)
+    size_t* num_bricks_k; ///< number of bricks in k direction (per patch)
+    size_t* brick_start;  ///< first brick of a patch
+    int*    brick_index;  ///< storage slot of a brick in values (-1 for tiles)
+    real*   tile_value;   ///< constant value of a tile
+    real*   values;       ///< values of all stored bricks (k fastest)
+  };
+
+
+protected: // attributes
+
+  data_t m_Host;
+  data_t m_Device;
+  size_t m_NumPatches;
+  size_t m_NumBricks;
+  size_t m_NumStoredBricks;
+
+
+protected: // methods
+
+  static void clearData(data_t& data);
+
+
+public: // methods
+
+  BrickLevelSet();
+
+  /**
+   * Convert a level set from a patch variable into bricks.
+   * Patches which are not Cartesian do not get any bricks. Data of a previous build is released.
+   * @param patch_grid the PatchGrid (the patch indices will be set)
+   * @param i_field the field holding G
+   * @param i_var the variable holding G
+   * @param num_band_cells half width of the band with stored values (in cells of the respective patch)
+   */
+  void build(PatchGrid* patch_grid, size_t i_field, size_t i_var, real num_band_cells);
+
+  /**
+   * Write the stored level set into a patch variable (e.g. for plotting).
+   * @param patch_grid the PatchGrid which has been used to build the level set
+   * @param i_field the field to write to
+   * @param i_var the variable to write to
+   */
+  void toVariable(PatchGrid* patch_grid, size_t i_field, size_t i_var);
+
+  /**
+   * Copy all bricks to the GPU. The device data will be used by G in kernels.
+   */
+  void copyToDevice();
+
+  /**
+   * Release the host and device data. Copies of this object must not be used afterwards.
+   */
+  void deleteData();
+
+  size_t numBricks()       { return m_NumBricks; }
+  size_t numStoredBricks() { return m_NumStoredBricks; }
+  size_t storedBytes()     { return m_NumStoredBricks*BRICK3*sizeof(real); }
+
+  template <typename T_Patch>
+  CUDA_DH real G(T_Patch& patch, size_t i, size_t j, size_t k, size_t = 0)
+  {
+#ifdef __CUDA_ARCH__
+    const data_t& data = m_Device;
+#else
+    const data_t& data = m_Host;
+#endif
+    size_t i_patch = patch.getIndex();
+    size_t b = data.brick_start[i_patch] + ((i/BRICK)*data.num_bricks_j[i_patch] + j/BRICK)*data.num_bricks_k[i_patch] + k/BRICK;
+    int i_data = data.brick_index[b];
+    if (i_data < 0) {
+      return data.tile_value[b];
+    }
+    return data.values[i_data*BRICK3 + (i%BRICK)*BRICK*BRICK + (j%BRICK)*BRICK + k%BRICK];
+  }
+
+};
+
+#endif // BRICKLEVELSET_H
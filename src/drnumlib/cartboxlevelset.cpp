@@ -32,3 +32,23 @@ real CartboxLevelSet::calcDistance (const real &xo, const real &yo, const real &
 
   return distance;
 }
+
+void CartboxLevelSet::calcDistances(const real* xo, const real* yo, const real* zo, real* g, size_t n)
+{
+  // plain loop without virtual calls, so that it can be vectorised
+  real x1 = m_Xo_min;
+  real x2 = m_Xo_max;
+  real y1 = m_Yo_min;
+  real y2 = m_Yo_max;
+  real z1 = m_Zo_min;
+  real z2 = m_Zo_max;
+  for (size_t i = 0; i < n; ++i) {
+    real distance = x1 - xo[i];
+    distance = max(distance, xo[i] - x2);
+    distance = max(distance, y1 - yo[i]);
+    distance = max(distance, yo[i] - y2);
+    distance = max(distance, z1 - zo[i]);
+    distance = max(distance, zo[i] - z2);
+    g[i] = distance;
+  }
+}
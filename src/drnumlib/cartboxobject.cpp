@@ -52,3 +52,26 @@ bool CartboxObject::isInside (const real &xo, const real &yo, const real &zo)
 
   return inside;
 }
+
+
+bool CartboxObject::getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max)
+{
+  xyzo_min = vec3_t(m_Xo_min, m_Yo_min, m_Zo_min);
+  xyzo_max = vec3_t(m_Xo_max, m_Yo_max, m_Zo_max);
+  return true;
+}
+
+
+void CartboxObject::checkInside(const real* xo, const real* yo, const real* zo, char* inside, size_t n)
+{
+  // plain loop without virtual calls, so that it can be vectorised
+  real x1 = m_Xo_min;
+  real x2 = m_Xo_max;
+  real y1 = m_Yo_min;
+  real y2 = m_Yo_max;
+  real z1 = m_Zo_min;
+  real z2 = m_Zo_max;
+  for (size_t i = 0; i < n; ++i) {
+    inside[i] = (xo[i] > x1) & (xo[i] < x2) & (yo[i] > y1) & (yo[i] < y2) & (zo[i] > z1) & (zo[i] < z2);
+  }
+}
@@ -0,0 +1,470 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef CARTESIANLEVELSETBC_H
+#define CARTESIANLEVELSETBC_H
+
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+class CartesianLevelSetBC;
+
+#include "drnum.h"
+#include "cartesianpatch.h"
+#include "patchgrid.h"
+#include "weightedset.h"
+#include "movinglevelset.h"
+
+#include <QList>
+#include <QVector>
+
+/**
+ * Host side precomputation and cell operations of the level set boundary condition
+ * for Cartesian patches. This class is shared by GPU_CartesianLevelSetBC and
+ * CPU_CartesianLevelSetBC, which only differ in where the cell lists are processed.
+ *
+ * Cells with G < 0 are split into two groups:
+ *  - bccell_t: cells with a fluid cell (G >= 0) within two layers. They get the state
+ *    of their mirror point x - 2*G*grad(G) passed through the boundary operator BC.
+ *  - cell_t: cells deeper inside the body. They are extrapolated from neighbours
+ *    with a larger level set value.
+ */
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+class CartesianLevelSetBC
+{
+
+public: // data types
+
+  struct cell_t
+  {
+    size_t i, j, k;
+    int    di_1, di_2, dj_1, dj_2, dk_1, dk_2;
+    bool   extrapolate;
+  };
+
+  struct bccell_t
+  {
+    size_t index;
+    // neighbouring contribution weight
+    real   octet_wt[8];
+    // neighbouring cell index
+    int    octet_id[8];
+  };
+
+
+protected: // attributes
+
+  QVector<QList<cell_t> >   m_Cells;
+  QVector<QList<bccell_t> > m_BcCells;
+  bool                      m_UpdateRequired;
+  bool                      m_CellsModified; ///< cell lists changed since the last call of computeCells
+  LS                        m_Ls;
+  BC                        m_Bc;
+
+
+protected: // methods
+
+  /**
+   * Deactivate all cells with a negative level set value.
+   * @param patches the Cartesian patches this boundary condition acts on
+   */
+  void deactivateCells(const vector<CartesianPatch*>& patches);
+
+  /**
+   * Build the lists of boundary cells and inner cells for all patches.
+   * Nothing will be done if no update is required.
+   * @param patches the Cartesian patches this boundary condition acts on
+   * @return true if the lists have been rebuilt or modified (updateCellLists) since the last call
+   */
+  bool computeCells(const vector<CartesianPatch*>& patches);
+
+  /**
+   * Classify a single cell with G < 0 and append it to the boundary or inner cells.
+   * @param patch the patch of the cell
+   * @param i_patch the index of the patch
+   * @param i first index of the cell
+   * @param j second index of the cell
+   * @param k third index of the cell
+   */
+  void addCell(CartesianPatch* patch, int i_patch, int i, int j, int k);
+
+  /**
+   * Update the cell lists after a motion of a MovingLevelSet.
+   * Only the cells with a new value of G are reclassified.
+   * A full rebuild is triggered, if the moving level set has resampled all cells.
+   * @param patches the Cartesian patches this boundary condition acts on
+   * @param body the moving level set
+   */
+  void updateCellLists(const vector<CartesianPatch*>& patches, MovingLevelSet& body);
+
+
+public: // methods
+
+  CartesianLevelSetBC(LS ls, BC bc);
+
+  template <typename T_Patch>
+  CUDA_DH static void grad(T_Patch& patch, LS& ls,
+                           size_t i, size_t j, size_t k,
+                           real& gx, real& gy, real& gz)
+  {
+    if      (i == 0)                 gx = patch.idx()*(ls.G(patch, i+1, j, k) - ls.G(patch, i,   j, k));
+    else if (i == patch.sizeI() - 1) gx = patch.idx()*(ls.G(patch, i  , j, k) - ls.G(patch, i-1, j, k));
+    else                             gx = 0.5*patch.idx()*(ls.G(patch, i+1, j, k) - ls.G(patch, i-1, j, k));
+
+    if      (j == 0)                 gy = patch.idy()*(ls.G(patch, i, j+1, k) - ls.G(patch, i, j  , k));
+    else if (j == patch.sizeJ() - 1) gy = patch.idy()*(ls.G(patch, i, j  , k) - ls.G(patch, i, j-1, k));
+    else                             gy = 0.5*patch.idy()*(ls.G(patch, i, j+1, k) - ls.G(patch, i, j-1, k));
+
+    if      (k == 0)                 gz = patch.idz()*(ls.G(patch, i, j, k+1) - ls.G(patch, i, j, k  ));
+    else if (k == patch.sizeK() - 1) gz = patch.idz()*(ls.G(patch, i, j, k  ) - ls.G(patch, i, j, k-1));
+    else                             gz = 0.5*patch.idz()*(ls.G(patch, i, j, k+1) - ls.G(patch, i, j, k-1));
+  }
+
+  template <typename T_Patch>
+  CUDA_DH static void getOutsideState(T_Patch& patch, LS& ls,
+                                      size_t i, size_t j, size_t k,
+                                      int di, int dj, int dk,
+                                      real &h0, real &h1, real &h2, real &w, real* var1, real* var2)
+  {
+    // careful with parallel level sets (e.g. flat plate)
+    // there might be a 0/0 occurring
+
+    dim_t<DIM> dim;
+
+    h0 = ls.G(patch, i, j, k);
+    h1 = ls.G(patch, i + di, j + dj, k + dk);
+    h2 = ls.G(patch, i + 2*di, j + 2*dj, k + 2*dk);
+
+    patch.getVar(dim, 0, i + di, j + dj, k + dk, var1);
+    patch.getVar(dim, 0, i + 2*di, j + 2*dj, k + 2*dk, var2);
+    if (h2 < 0) {
+      w = 1;
+    } else {
+      w = h1/(h1 - h0);
+    }
+  }
+
+  /**
+   * Compute the new state of a boundary cell from field 0.
+   * The state at the mirror point is interpolated from the eight donors and passed
+   * through the boundary operator with mirrored distances (h1 = h2 = -h0).
+   * For a slip wall this reflects the normal velocity and keeps pressure and temperature.
+   * Level set variables (the last NUM_LS variables) are left unchanged.
+   * @param patch the patch (host or device representation)
+   * @param ls the level set
+   * @param bc the boundary operator
+   * @param cell the precomputed boundary cell
+   * @param var on return, the new state of the cell
+   */
+  template <typename T_Patch>
+  CUDA_DH static void bcCellState(T_Patch& patch, LS& ls, BC& bc, const bccell_t& cell, real* var)
+  {
+    dim_t<DIM> dim;
+    real var_m[DIM], var_bc[DIM];
+    for (size_t i_var = 0; i_var < DIM; ++i_var) {
+      var_m[i_var] = 0;
+    }
+    real weight = 0;
+    for (size_t i_donor = 0; i_donor < 8; ++i_donor) {
+      for (size_t i_var = 0; i_var < DIM - NUM_LS; ++i_var) {
+        var_m[i_var] += cell.octet_wt[i_donor]*patch.getVariable(0, i_var)[cell.octet_id[i_donor]];
+      }
+      weight += cell.octet_wt[i_donor];
+    }
+    for (size_t i_var = 0; i_var < DIM - NUM_LS; ++i_var) {
+      var_m[i_var] /= weight;
+    }
+    size_t i, j, k;
+    patch.ijk(cell.index, i, j, k);
+    real gx, gy, gz;
+    grad(patch, ls, i, j, k, gx, gy, gz);
+    real h0 = ls.G(patch, i, j, k);
+    bc.operate(var_m, var_m, var_bc, h0, -h0, -h0, 1, gx, gy, gz);
+    patch.getVar(dim, 0, i, j, k, var);
+    for (size_t i_var = 0; i_var < DIM - NUM_LS; ++i_var) {
+      var[i_var] = var_bc[i_var];
+    }
+  }
+
+  /**
+   * Compute the new state of an inner cell from field 0.
+   * Level set variables (the last NUM_LS variables) are left unchanged.
+   * @param patch the patch (host or device representation)
+   * @param ls the level set
+   * @param bc the boundary operator
+   * @param cell the precomputed inner cell
+   * @param var on return, the new state of the cell
+   * @param total_weight on return, the sum of all neighbour weights
+   * @return false if no suitable neighbour has been found or all weights vanish, e.g. where G is
+   *         constant (tiles of BrickLevelSet); var is undefined in this case
+   */
+  template <typename T_Patch>
+  CUDA_DH static bool innerCellState(T_Patch& patch, LS& ls, BC& bc, const cell_t& cell, real* var, real& total_weight)
+  {
+    size_t i = cell.i;
+    size_t j = cell.j;
+    size_t k = cell.k;
+
+    dim_t<DIM> dim;
+
+    real var_1[DIM], var_2[DIM];
+    real var_bc[DIM];
+    for (size_t i_var = 0; i_var < DIM; ++i_var) {
+      var[i_var] = 0.0;
+    }
+
+    real gx, gy, gz;
+    int count = 0;
+    real h0, h1, h2, w;
+    total_weight = 0;
+    grad(patch, ls, i, j, k, gx, gy, gz);
+    for (int di = cell.di_1; di <= cell.di_2; ++di) {
+      for (int dj = cell.dj_1; dj <= cell.dj_2; ++dj) {
+        for (int dk = cell.dk_1; dk <= cell.dk_2; ++dk) {
+          if (di != 0 || dj != 0 || dk != 0) {
+            if (ls.G(patch, i + di, j + dj, k + dk) >= 0 || (cell.extrapolate && ls.G(patch, i + di, j + dj, k + dk) > ls.G(patch, i, j, k))) {
+              real dx = di*patch.dx();
+              real dy = dj*patch.dy();
+              real dz = dk*patch.dz();
+              real weight = fabs(dx*gx + dy*gy + dz*gz)/sqrt(dx*dx + dy*dy + dz*dz);
+              if (cell.extrapolate) {
+                patch.getVar(dim, 0, i + di, j + dj, k + dk, var_bc);
+              } else {
+                getOutsideState(patch, ls, i, j, k, di, dj, dk, h0, h1, h2, w, var_1, var_2);
+                bc.operate(var_1, var_2, var_bc, h0, h1, h2, w, gx, gy, gz);
+              }
+              ++count;
+              total_weight += weight;
+              for (size_t i_var = 0; i_var < DIM - NUM_LS; ++i_var) {
+                var[i_var] += weight*var_bc[i_var];
+              }
+            }
+          }
+        }
+      }
+    }
+    if (count == 0 || total_weight <= 0) {
+      return false;
+    }
+    patch.getVar(dim, 0, i, j, k, var_bc);
+    for (size_t i_var = 0; i_var < DIM - NUM_LS; ++i_var) {
+      var_bc[i_var] = var[i_var]/total_weight;
+    }
+    for (size_t i_var = 0; i_var < DIM; ++i_var) {
+      var[i_var] = var_bc[i_var];
+    }
+    return true;
+  }
+
+};
+
+
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+CartesianLevelSetBC<DIM,NUM_LS,LS,BC>::CartesianLevelSetBC(LS ls, BC bc)
+{
+  m_Bc = bc;
+  m_Ls = ls;
+  m_UpdateRequired = true;
+  m_CellsModified = false;
+}
+
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+void CartesianLevelSetBC<DIM,NUM_LS,LS,BC>::deactivateCells(const vector<CartesianPatch*>& patches)
+{
+  for (size_t i_patch = 0; i_patch < patches.size(); ++i_patch) {
+    CartesianPatch& patch = *(patches[i_patch]);
+    if (patch.accessPatchType() == 1002) {
+      ERROR("level set boundary conditions are not supported on stretched patches");
+    }
+    for (size_t i = 0; i < patch.sizeI(); ++i) {
+      for (size_t j = 0; j < patch.sizeJ(); ++j) {
+        for (size_t k = 0; k < patch.sizeK(); ++k) {
+          if (m_Ls.G(patch, i, j, k) < 0) {
+            patch.deactivate(i,j,k);
+          }
+        }
+      }
+    }
+  }
+}
+
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+bool CartesianLevelSetBC<DIM,NUM_LS,LS,BC>::computeCells(const vector<CartesianPatch*>& patches)
+{
+  if (!m_UpdateRequired) {
+    bool modified = m_CellsModified;
+    m_CellsModified = false;
+    return modified;
+  }
+  m_Cells.resize(patches.size());
+  m_BcCells.resize(patches.size());
+  for (int i_patch = 0; i_patch < int(patches.size()); ++i_patch) {
+    m_Cells[i_patch].clear();
+    m_BcCells[i_patch].clear();
+    CartesianPatch* patch = patches[i_patch];
+    for (int i = 0; i < int(patch->sizeI()); ++i) {
+      for (int j = 0; j < int(patch->sizeJ()); ++j) {
+        for (int k = 0; k < int(patch->sizeK()); ++k) {
+          if (m_Ls.G(*patch, i, j, k) < 0) {
+            addCell(patch, i_patch, i, j, k);
+          }
+        }
+      }
+    }
+  }
+  m_UpdateRequired = false;
+  m_CellsModified = false;
+  return true;
+}
+
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+void CartesianLevelSetBC<DIM,NUM_LS,LS,BC>::addCell(CartesianPatch* patch, int i_patch, int i, int j, int k)
+{
+  int imax = patch->sizeI();
+  int jmax = patch->sizeJ();
+  int kmax = patch->sizeK();
+  bool extrapolate = true;
+  // -start and -end iteration range
+  // For two boundary layers
+  int i_stt = -2;
+  int i_end =  2;
+  int j_stt = -2;
+  int j_end =  2;
+  int k_stt = -2;
+  int k_end =  2;
+  // Limit iteration bounds close to the boundaries
+  if (i < 2)          i_stt += 2-i;
+  if (i == imax - 1)  i_end  = 0;
+  if (i == imax - 2)  i_end  = 1;
+  if (j < 2)          j_stt += 2-j;
+  if (j == jmax - 1)  j_end  = 0;
+  if (j == jmax - 2)  j_end  = 1;
+  if (k < 2)          k_stt += 2-k;
+  if (k == kmax - 1)  k_end  = 0;
+  if (k == kmax - 2)  k_end  = 1;
+  for (int di = i_stt; di <= i_end && extrapolate; ++di) {
+    for (int dj = j_stt; dj <= j_end && extrapolate; ++dj) {
+      for (int dk = k_stt; dk <= k_end && extrapolate; ++dk) {
+        if (di != 0 || dj != 0 || dk != 0) {
+          if (m_Ls.G(*patch, i + di, j + dj, k + dk) >= 0) {
+            int index_i = patch->index(i, j, k);
+            // mirror point in patch coordinates, as required by computeCCDataInterpolCoeffs_V1
+            real x_io, y_io, z_io;
+            patch->xyzCell(index_i, x_io, y_io, z_io);
+            real gx, gy, gz;
+            grad(*patch, m_Ls, i, j, k, gx, gy, gz);
+            real x_n, y_n, z_n;
+            x_n = x_io - 2*m_Ls.G(*patch, i, j, k)*gx;
+            y_n = y_io - 2*m_Ls.G(*patch, i, j, k)*gy;
+            z_n = z_io - 2*m_Ls.G(*patch, i, j, k)*gz;
+
+            WeightedSet<real> weight_set;
+            bool exists = patch->computeCCDataInterpolCoeffs_V1(x_n, y_n, z_n, weight_set);
+            if (!exists) BUG;
+            if (weight_set.getSize() == 0 || weight_set.getSize() > 8) BUG;
+            bccell_t cell;
+            // contributions with tiny weights have been eliminated -- pad as WeightedSet::tranferToFixedArrays does
+            for(int c_i = 0; c_i != 8; ++c_i) {
+              int c_src = min(c_i, int(weight_set.getSize()) - 1);
+              cell.octet_id[c_i] = weight_set.v[c_src].first;
+              cell.octet_wt[c_i] = c_i < int(weight_set.getSize()) ? weight_set.v[c_i].second : 0;
+            }
+            cell.index = index_i;
+            m_BcCells[i_patch] << cell;
+            extrapolate = false;
+          }
+        }
+      }
+    }
+  }
+  if (extrapolate) {
+    // Correct bounds once again for for extrapolation method..
+    if (i < 2)          i_stt = 0;
+    if (i >= imax - 2)  i_end = 0;
+    if (j < 2)          j_stt = 0;
+    if (j >= jmax - 2)  j_end = 0;
+    if (k < 2)          k_stt = 0;
+    if (k >= kmax - 2)  k_end = 0;
+    cell_t cell;
+    cell.i = i;
+    cell.j = j;
+    cell.k = k;
+    cell.di_1 = i_stt;
+    cell.di_2 = i_end;
+    cell.dj_1 = j_stt;
+    cell.dj_2 = j_end;
+    cell.dk_1 = k_stt;
+    cell.dk_2 = k_end;
+    cell.extrapolate = extrapolate;
+    m_Cells[i_patch] << cell;
+  }
+}
+
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+void CartesianLevelSetBC<DIM,NUM_LS,LS,BC>::updateCellLists(const vector<CartesianPatch*>& patches, MovingLevelSet& body)
+{
+  if (body.fullUpdate()) {
+    m_UpdateRequired = true;
+    return;
+  }
+  if (m_UpdateRequired) {
+    // a full rebuild is pending anyway
+    return;
+  }
+  for (int i_patch = 0; i_patch < int(patches.size()); ++i_patch) {
+    CartesianPatch* patch = patches[i_patch];
+    int i_body_patch = body.patchIndex(patch);
+    if (i_body_patch < 0) {
+      continue;
+    }
+    const vector<size_t>& updated = body.updatedCells(i_body_patch);
+    if (updated.size() == 0) {
+      continue;
+    }
+
+    // remove all entries of updated cells
+    QList<cell_t> cells;
+    for (int i_cell = 0; i_cell < m_Cells[i_patch].size(); ++i_cell) {
+      const cell_t& cell = m_Cells[i_patch][i_cell];
+      if (!binary_search(updated.begin(), updated.end(), patch->index(cell.i, cell.j, cell.k))) {
+        cells << cell;
+      }
+    }
+    m_Cells[i_patch] = cells;
+    QList<bccell_t> bc_cells;
+    for (int i_cell = 0; i_cell < m_BcCells[i_patch].size(); ++i_cell) {
+      const bccell_t& cell = m_BcCells[i_patch][i_cell];
+      if (!binary_search(updated.begin(), updated.end(), cell.index)) {
+        bc_cells << cell;
+      }
+    }
+    m_BcCells[i_patch] = bc_cells;
+
+    // and classify them again
+    for (size_t i_cell = 0; i_cell < updated.size(); ++i_cell) {
+      size_t i, j, k;
+      patch->ijk(updated[i_cell], i, j, k);
+      if (m_Ls.G(*patch, i, j, k) < 0) {
+        addCell(patch, i_patch, i, j, k);
+      }
+    }
+  }
+  m_CellsModified = true;
+}
+
+#endif // CARTESIANLEVELSETBC_H
@@ -38,6 +38,7 @@ CartesianPatch::CartesianPatch(PatchGrid* patch_grid, size_t num_protectlayers,
   //do allways with computeDeltas() m_Interpol_Initialized = false;
   /// @todo need a better eps-handling.
   m_Eps = 1.e-5;
+  m_NumActiveCells = 0;
   // NEW NEW_SEEK_EXCEPTION  setNumProtectLayers(m_NumProtectLayers);
 }
 
@@ -271,6 +272,14 @@ void CartesianPatch::buildBoundingBox()
 }
 
 
+void CartesianPatch::xyzNode(size_t i, size_t j, size_t k, real& x, real& y, real& z) const
+{
+  x = i*m_Dx;
+  y = j*m_Dy;
+  z = k*m_Dz;
+}
+
+
 void CartesianPatch::xxyyzzSubCellRaster(const size_t& l_cell, const size_t& lin_mult_res,
                                          vector<vec3_t>& xxyyzz_subcells,
                                          vec3_t& ref_dxxyyzz)
@@ -508,7 +517,8 @@ bool CartesianPatch::computeDependencies(const size_t& i_neighbour)
   //  - interpolate there if receiving cell hits neighbours core region
   for(size_t ll_rc=0; ll_rc < m_ReceiveCells.size(); ll_rc++) {
     size_t l_rc = m_ReceiveCells[ll_rc];
-    vec3_t xyz_rc = xyzCell(l_rc);
+    vec3_t xyz_rc;
+    xyzCell(l_rc, xyz_rc[0], xyz_rc[1], xyz_rc[2]);
     vec3_t xxyyzz_rc = trans.transform(xyz_rc);
     WeightedSet<real> w_set;
     if(m_InterpolateData) {
@@ -551,8 +561,7 @@ bool CartesianPatch::checkBoxOverlap(const vec3_t& box_xyzo_min, const vec3_t& b
   for (size_t i_cell = i_min; i_cell < i_after_max; i_cell++) {
     for (size_t j_cell = j_min; j_cell < j_after_max; j_cell++) {
       for (size_t k_cell = k_min; k_cell < k_after_max; k_cell++) {
-        vec3_t xyz_cell = xyzCell(i_cell, j_cell, k_cell);
-        vec3_t xyzo_cell = m_TransformInertial2This.transformReverse(xyz_cell);
+        vec3_t xyzo_cell = xyzoCell(index(i_cell, j_cell, k_cell));
         if (box_xyzo_min[0] <= xyzo_cell[0] &&
             box_xyzo_min[1] <= xyzo_cell[1] &&
             box_xyzo_min[2] <= xyzo_cell[2] &&
@@ -1682,9 +1691,7 @@ vtkSmartPointer<vtkDataSet> CartesianPatch::createVtkDataSet(size_t i_field, con
       for (size_t i = i_start; i <= i_stop; ++i) {
         vec3_t xyz_p;
         vec3_t xyzo_p;
-        xyz_p[0] = i * m_Dx;
-        xyz_p[1] = j * m_Dy;
-        xyz_p[2] = k * m_Dz;
+        xyzNode(i, j, k, xyz_p[0], xyz_p[1], xyz_p[2]);
         xyzo_p = m_TransformInertial2This.transformReverse(xyz_p);
         points->InsertNextPoint(xyzo_p.data());
       }
@@ -1704,8 +1711,7 @@ vtkSmartPointer<vtkDataSet> CartesianPatch::createVtkDataSet(size_t i_field, con
       for (size_t j = j_start; j < j_stop; ++j) {
         for (size_t i = i_start; i < i_stop; ++i) {
           getVarDim(numVariables(), i_field, i, j, k, raw_var);
-          vec3_t x;
-          xyzoIJK(i, j, k, x[0], x[1], x[2]);
+          vec3_t x = xyzoCell(index(i, j, k));
           var->SetValue(id, proc_vars.getScalar(i_var, raw_var, x));
           ++id;
         }
@@ -1723,8 +1729,7 @@ vtkSmartPointer<vtkDataSet> CartesianPatch::createVtkDataSet(size_t i_field, con
       for (size_t j = j_start; j < j_stop; ++j) {
         for (size_t i = i_start; i < i_stop; ++i) {
           getVarDim(numVariables(), i_field, i, j, k, raw_var);
-          vec3_t x;
-          xyzoIJK(i, j, k, x[0], x[1], x[2]);
+          vec3_t x = xyzoCell(index(i, j, k));
           vec3_t v = proc_vars.getVector(i_var, raw_var, x);
           v = m_TransformInertial2This.transfreeReverse(v);
           float vf[3];
@@ -1763,9 +1768,7 @@ vtkSmartPointer<vtkUnstructuredGrid> CartesianPatch::createVtkGridForCells(const
       size_t id_node = nodeIndex(N[i_node]);
       if (n2n[id_node] == -1) {
         n2n[id_node] = num_nodes;
-        x_node[id_node][0] = N[i_node].i * m_Dx;
-        x_node[id_node][1] = N[i_node].j * m_Dy;
-        x_node[id_node][2] = N[i_node].k * m_Dz;
+        xyzNode(N[i_node].i, N[i_node].j, N[i_node].k, x_node[id_node][0], x_node[id_node][1], x_node[id_node][2]);
         x_node[id_node] = m_TransformInertial2This.transformReverse(x_node[id_node]);
         ++num_nodes;
       }
@@ -1838,6 +1841,14 @@ int CartesianPatch::findCell(vec3_t xo)
   return index(i, j, k);
 }
 
+bool CartesianPatch::isInsideCore(vec3_t xo)
+{
+  vec3_t x = m_TransformInertial2This.transform(xo);
+  vec3_t x0(m_ICoreFirst*dx(), m_JCoreFirst*dy(), m_KCoreFirst*dz());
+  vec3_t x1(m_ICoreAfterlast*dx(), m_JCoreAfterlast*dy(), m_KCoreAfterlast*dz());
+  return GeometryTools::isInsideCartesianBox(x, x0, x1);
+}
+
 list<size_t> CartesianPatch::getNeighbours(size_t idx)
 {
   list<size_t> neigh;
@@ -1863,3 +1874,44 @@ list<size_t> CartesianPatch::getNeighbours(size_t idx)
   }
   return neigh;
 }
+
+void CartesianPatch::updateActiveRanges()
+{
+  if (!activeMaskChanged() && m_ActiveRangeStart.size() == m_NumI*m_NumJ + 1) {
+    return;
+  }
+  bool* active = getActive();
+  m_ActiveRangeStart.resize(m_NumI*m_NumJ + 1);
+  m_ActiveRangeK1.clear();
+  m_ActiveRangeK2.clear();
+  m_NumActiveCells = 0;
+  for (size_t i = 0; i < m_NumI; ++i) {
+    for (size_t j = 0; j < m_NumJ; ++j) {
+      m_ActiveRangeStart[i*m_NumJ + j] = m_ActiveRangeK1.size();
+      bool in_range = false;
+      for (size_t k = 0; k < m_NumK; ++k) {
+        size_t idx = index(i, j, k);
+        if (active[idx]) {
+          ++m_NumActiveCells;
+        }
+        bool sweep = active[idx];
+        sweep = sweep || (i > 0 && active[idx - m_NumJK]);
+        sweep = sweep || (j > 0 && active[idx - m_NumK]);
+        sweep = sweep || (k > 0 && active[idx - 1]);
+        if (sweep && !in_range) {
+          m_ActiveRangeK1.push_back(k);
+          in_range = true;
+        }
+        if (!sweep && in_range) {
+          m_ActiveRangeK2.push_back(k);
+          in_range = false;
+        }
+      }
+      if (in_range) {
+        m_ActiveRangeK2.push_back(m_NumK);
+      }
+    }
+  }
+  m_ActiveRangeStart[m_NumI*m_NumJ] = m_ActiveRangeK1.size();
+  setActiveMaskChanged(false);
+}
@@ -89,12 +89,29 @@ protected: // attributes
   real m_xCCInterMax, m_yCCInterMax, m_zCCInterMax;
   real m_Eps, m_EpsDX, m_EpsDY, m_EpsDZ;
 
+  // run-length encoded sweep ranges (see updateActiveRanges)
+  vector<size_t> m_ActiveRangeStart; ///< first range of each (i,j) line, NI*NJ + 1 entries
+  vector<size_t> m_ActiveRangeK1;    ///< first k of each range
+  vector<size_t> m_ActiveRangeK2;    ///< k after the last cell of each range
+  size_t         m_NumActiveCells;
+
 protected: // methods
 
   void computeDeltas();
 
   virtual void buildBoundingBox();
 
+  /**
+    * Get the coordinates of a node in the local xyz-system.
+    * @param i i-index of node
+    * @param j j-index of node
+    * @param k k-index of node
+    * @param x x-coord. of node (return reference)
+    * @param y y-coord. of node (return reference)
+    * @param z z-coord. of node (return reference)
+    */
+  virtual void xyzNode(size_t i, size_t j, size_t k, real& x, real& y, real& z) const;
+
 public: // methods
 
   /**
@@ -544,8 +561,29 @@ public: // methods
 
   virtual int findCell(vec3_t xo);
 
+  /**
+    * Check, if a point lies in the core region (no seek layers) of the patch.
+    * @param xo the point in inertial coordinates
+    * @return true, if the point is inside the core region
+    */
+  virtual bool isInsideCore(vec3_t xo);
+
   virtual list<size_t> getNeighbours(size_t idx);
 
+  /**
+    * Rebuild the active index ranges, if the active cells have changed.
+    * For each (i,j) line the cells owning a face (towards i-1, j-1 or k-1) next to an active cell
+    * are stored as ranges [k1, k2). Sweeping over these ranges covers all faces of active cells,
+    * while faces between inactive cells (e.g. inside immersed bodies) are skipped.
+    */
+  void updateActiveRanges();
+
+  size_t activeRangeBegin(size_t i, size_t j) { return m_ActiveRangeStart[i*m_NumJ + j]; }
+  size_t activeRangeEnd(size_t i, size_t j)   { return m_ActiveRangeStart[i*m_NumJ + j + 1]; }
+  size_t activeRangeK1(size_t i_range)         { return m_ActiveRangeK1[i_range]; }
+  size_t activeRangeK2(size_t i_range)         { return m_ActiveRangeK2[i_range]; }
+  size_t numActiveCells()                      { return m_NumActiveCells; }
+
 #ifdef WITH_VTK
   virtual vtkSmartPointer<vtkDataSet> createVtkDataSet(size_t i_field, const PostProcessingVariables& proc_vars);
   virtual vtkSmartPointer<vtkUnstructuredGrid> createVtkGridForCells(const list<size_t> &cells);
@@ -329,8 +329,8 @@ CUDA_DH void xyzoIJK(size_t i, size_t j, size_t k, real& x, real& y, real& z)
   z = m_Zo + k*m_Dz + 0.5*m_Dz;
 }
 
-CUDA_DH void deactivate(size_t i, size_t j, size_t k) { getActive()[index(i, j, k)] = false; }
-CUDA_DH void activate  (size_t i, size_t j, size_t k) { getActive()[index(i, j, k)] = true; }
+CUDA_DH void deactivate(size_t i, size_t j, size_t k) { getActive()[index(i, j, k)] = false; setActiveMaskChanged(); }
+CUDA_DH void activate  (size_t i, size_t j, size_t k) { getActive()[index(i, j, k)] = true;  setActiveMaskChanged(); }
 CUDA_DH bool isActive  (size_t i, size_t j, size_t k) { return getActive()[index(i, j, k)]; }
 
 /**
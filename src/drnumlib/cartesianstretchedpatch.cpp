@@ -0,0 +1,479 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+#include "cartesianstretchedpatch.h"
+#include "geometrytools.h"
+
+#include <algorithm>
+
+
+CartesianStretchedPatch::CartesianStretchedPatch(PatchGrid* patch_grid, size_t num_seeklayers, size_t num_addprotectlayers)
+  : CartesianPatch(patch_grid, num_seeklayers, num_addprotectlayers)
+{
+  m_mypatchtype = 1002;
+  m_MinDelta = 0;
+}
+
+
+void CartesianStretchedPatch::geometricDistribution(real length, size_t num, real ratio, bool symmetric, vector<real>& nodes)
+{
+  if (num == 0 || ratio <= 0) {
+    ERROR("invalid geometric node distribution");
+  }
+  // relative cell sizes, normalised to "length" below
+  vector<real> delta(num);
+  real sum = 0;
+  for (size_t i = 0; i < num; ++i) {
+    size_t n = i;
+    if (symmetric) {
+      n = min(i, num - 1 - i);
+    }
+    delta[i] = pow(ratio, real(n));
+    sum += delta[i];
+  }
+  nodes.resize(num + 1);
+  nodes[0] = 0;
+  for (size_t i = 0; i < num; ++i) {
+    nodes[i+1] = nodes[i] + delta[i]*length/sum;
+  }
+  nodes[num] = length; // avoid round off
+}
+
+
+bool CartesianStretchedPatch::readDistribution(istringstream& iss_input, size_t num, vector<real>& nodes)
+{
+  int mode;
+  iss_input >> mode;
+  if (mode == 0) {
+    nodes.resize(num + 1);
+    for (size_t i = 0; i <= num; ++i) {
+      iss_input >> nodes[i];
+    }
+  } else if (mode == 1 || mode == 2) {
+    real length, ratio;
+    iss_input >> length;
+    iss_input >> ratio;
+    geometricDistribution(length, num, ratio, mode == 2, nodes);
+  } else {
+    ERROR("unknown node distribution mode for CartesianStretchedPatch");
+  }
+  return !iss_input.fail();
+}
+
+
+bool CartesianStretchedPatch::readFromFile(istringstream& iss_input, real scale)
+{
+  bool no_error = Patch::readFromFile(iss_input, scale);
+  // number of cells in block axis directions
+  size_t num_i, num_j, num_k;
+  iss_input >> num_i;
+  iss_input >> num_j;
+  iss_input >> num_k;
+  // protection exceptions
+  size_t numProtXmin, numProtXmax, numProtYmin, numProtYmax, numProtZmin, numProtZmax;
+  iss_input >> numProtXmin;
+  iss_input >> numProtXmax;
+  iss_input >> numProtYmin;
+  iss_input >> numProtYmax;
+  iss_input >> numProtZmin;
+  iss_input >> numProtZmax;
+  // node distributions
+  vector<real> x_nodes, y_nodes, z_nodes;
+  no_error = readDistribution(iss_input, num_i, x_nodes) && no_error;
+  no_error = readDistribution(iss_input, num_j, y_nodes) && no_error;
+  no_error = readDistribution(iss_input, num_k, z_nodes) && no_error;
+  if (!no_error) {
+    ERROR("failed to read CartesianStretchedPatch");
+  }
+  // scale according to IO-scaling factor
+  for (size_t i = 0; i < x_nodes.size(); ++i) {
+    x_nodes[i] *= m_IOScale;
+  }
+  for (size_t j = 0; j < y_nodes.size(); ++j) {
+    y_nodes[j] *= m_IOScale;
+  }
+  for (size_t k = 0; k < z_nodes.size(); ++k) {
+    z_nodes[k] *= m_IOScale;
+  }
+  // apply patch modifiers
+  setSeekExceptions(numProtXmin, numProtXmax, numProtYmin, numProtYmax, numProtZmin, numProtZmax);
+  resize(num_i, num_j, num_k);
+  buildRegions();
+  setupStretchedMetrics(x_nodes, y_nodes, z_nodes);
+  // continue reading solver codes from file
+  Patch::readSolverCodes(iss_input);
+
+  return no_error;
+}
+
+
+void CartesianStretchedPatch::setupStretchedMetrics(const vector<real>& x_nodes, const vector<real>& y_nodes, const vector<real>& z_nodes)
+{
+  if (x_nodes.size() != sizeI() + 1 || y_nodes.size() != sizeJ() + 1 || z_nodes.size() != sizeK() + 1) {
+    ERROR("node distribution does not match patch size");
+  }
+  m_XNode = x_nodes;
+  m_YNode = y_nodes;
+  m_ZNode = z_nodes;
+  // shift to patch origin
+  for (size_t i = sizeI() + 1; i > 0; --i) {
+    m_XNode[i-1] -= m_XNode[0];
+  }
+  for (size_t j = sizeJ() + 1; j > 0; --j) {
+    m_YNode[j-1] -= m_YNode[0];
+  }
+  for (size_t k = sizeK() + 1; k > 0; --k) {
+    m_ZNode[k-1] -= m_ZNode[0];
+  }
+  // mean spacing for the uniform metrics of CartesianPatch (bounding box, dx(), ...)
+  setupMetrics(m_XNode[sizeI()], m_YNode[sizeJ()], m_ZNode[sizeK()]);
+  computeStretchedDeltas();
+}
+
+
+void CartesianStretchedPatch::computeStretchedDeltas()
+{
+  size_t num[3] = {sizeI(), sizeJ(), sizeK()};
+  vector<real>* nodes[3] = {&m_XNode, &m_YNode, &m_ZNode};
+  vector<real>* cells[3] = {&m_XCell, &m_YCell, &m_ZCell};
+  vector<real>* delta[3] = {&m_DxCell, &m_DyCell, &m_DzCell};
+  m_MinDelta = MAX_REAL;
+  for (int dim = 0; dim < 3; ++dim) {
+    cells[dim]->resize(num[dim]);
+    delta[dim]->resize(num[dim]);
+    for (size_t i = 0; i < num[dim]; ++i) {
+      real x1 = (*nodes[dim])[i];
+      real x2 = (*nodes[dim])[i+1];
+      if (x2 <= x1) {
+        ERROR("node coordinates of a CartesianStretchedPatch must be strictly increasing");
+      }
+      (*cells[dim])[i] = 0.5*(x1 + x2);
+      (*delta[dim])[i] = x2 - x1;
+      m_MinDelta = min(m_MinDelta, x2 - x1);
+    }
+  }
+  countFlops(3*(sizeI() + sizeJ() + sizeK()));
+
+  // cell centre limits and interpolation responsibility box, see CartesianPatch::computeDeltas
+  m_xCCMin = m_XCell[0];
+  m_yCCMin = m_YCell[0];
+  m_zCCMin = m_ZCell[0];
+  m_xCCMax = m_XCell[sizeI() - 1];
+  m_yCCMax = m_YCell[sizeJ() - 1];
+  m_zCCMax = m_ZCell[sizeK() - 1];
+  m_xCCInterMin = m_XCell[min(m_NumProtImin, sizeI() - 1)];
+  m_yCCInterMin = m_YCell[min(m_NumProtJmin, sizeJ() - 1)];
+  m_zCCInterMin = m_ZCell[min(m_NumProtKmin, sizeK() - 1)];
+  m_xCCInterMax = m_XCell[sizeI() - 1 - min(m_NumProtImax, sizeI() - 1)];
+  m_yCCInterMax = m_YCell[sizeJ() - 1 - min(m_NumProtJmax, sizeJ() - 1)];
+  m_zCCInterMax = m_ZCell[sizeK() - 1 - min(m_NumProtKmax, sizeK() - 1)];
+  m_EpsDX = m_MinDelta * m_Eps;
+  m_EpsDY = m_MinDelta * m_Eps;
+  m_EpsDZ = m_MinDelta * m_Eps;
+}
+
+
+void CartesianStretchedPatch::scaleRefParental(real scfactor)
+{
+  CartesianPatch::scaleRefParental(scfactor);
+  for (size_t i = 0; i < m_XNode.size(); ++i) {
+    m_XNode[i] *= scfactor;
+  }
+  for (size_t j = 0; j < m_YNode.size(); ++j) {
+    m_YNode[j] *= scfactor;
+  }
+  for (size_t k = 0; k < m_ZNode.size(); ++k) {
+    m_ZNode[k] *= scfactor;
+  }
+  computeStretchedDeltas();
+}
+
+
+void CartesianStretchedPatch::xyzNode(size_t i, size_t j, size_t k, real& x, real& y, real& z) const
+{
+  x = m_XNode[i];
+  y = m_YNode[j];
+  z = m_ZNode[k];
+}
+
+
+void CartesianStretchedPatch::xxyyzzSubCellRaster(const size_t& l_cell, const size_t& lin_mult_res,
+                                                  vector<vec3_t>& xxyyzz_subcells,
+                                                  vec3_t& ref_dxxyyzz)
+{
+  xxyyzz_subcells.clear();
+
+  size_t i, j, k;
+  ijk(l_cell,
+      i, j, k);
+
+  // increment in subcell resolution
+  real resolve_factor = 1./float(lin_mult_res);
+  real dxx_sub = m_DxCell[i] * resolve_factor;
+  real dyy_sub = m_DyCell[j] * resolve_factor;
+  real dzz_sub = m_DzCell[k] * resolve_factor;
+
+  // lower corner point in all coords
+  real xx_low = m_XNode[i] + 0.5 * dxx_sub;
+  real yy_low = m_YNode[j] + 0.5 * dyy_sub;
+  real zz_low = m_ZNode[k] + 0.5 * dzz_sub;
+
+  vec3_t xxyyzz_h;
+  for (size_t i_sub = 0; i_sub < lin_mult_res; i_sub ++) {
+    xxyyzz_h[0] = xx_low + i_sub * dxx_sub;
+    for (size_t j_sub = 0; j_sub < lin_mult_res; j_sub ++) {
+      xxyyzz_h[1] = yy_low + j_sub * dyy_sub;
+      for (size_t k_sub = 0; k_sub < lin_mult_res; k_sub ++) {
+        xxyyzz_h[2] = zz_low + k_sub * dzz_sub;
+        xxyyzz_subcells.push_back(xxyyzz_h);
+      }
+    }
+  }
+  ref_dxxyyzz[0] = m_DxCell[i];
+  ref_dxxyyzz[1] = m_DyCell[j];
+  ref_dxxyyzz[2] = m_DzCell[k];
+}
+
+
+bool CartesianStretchedPatch::stretchedCCInterpolCoeffs(const real& s_test,
+                                                        const size_t& ijk_donor_first, const size_t& ijk_donor_afterlast,
+                                                        const vector<real>& nodes, const vector<real>& cells,
+                                                        size_t& index_cell_ref, real& rs_coeff)
+{
+  // Sectors as in CartesianPatch::linearCCInterpolCoeffs:
+  //  [nodes[first], cells[first])             : lower DonorZonePlus, all weight to first cell
+  //  [cells[first], cells[afterlast-1])       : DonorZone, linear between neighbouring cell centres
+  //  [cells[afterlast-1], nodes[afterlast])   : upper DonorZonePlus, all weight to last cell
+  if (ijk_donor_afterlast <= ijk_donor_first) {
+    return false;
+  }
+  if (s_test < nodes[ijk_donor_first] || s_test >= nodes[ijk_donor_afterlast]) {
+    return false;
+  }
+  if (ijk_donor_afterlast - ijk_donor_first == 1) {
+    // single donor layer (flat direction)
+    index_cell_ref = ijk_donor_first;
+    rs_coeff = 0.;
+  }
+  else if (s_test < cells[ijk_donor_first]) {
+    index_cell_ref = ijk_donor_first;
+    rs_coeff = 0.;
+  }
+  else if (s_test >= cells[ijk_donor_afterlast - 1]) {
+    index_cell_ref = ijk_donor_afterlast - 2;
+    rs_coeff = 1.;
+  }
+  else {
+    vector<real>::const_iterator i_upper = upper_bound(cells.begin() + ijk_donor_first,
+                                                       cells.begin() + ijk_donor_afterlast, s_test);
+    index_cell_ref = size_t(i_upper - cells.begin()) - 1;
+    index_cell_ref = max(ijk_donor_first, min(ijk_donor_afterlast - 2, index_cell_ref));
+    real s1 = cells[index_cell_ref];
+    real s2 = cells[index_cell_ref + 1];
+    rs_coeff = (s_test - s1)/(s2 - s1);
+    countFlops(3);
+  }
+  return true;
+}
+
+
+bool CartesianStretchedPatch::stretchedInterpolOctet(real x, real y, real z,
+                                                     size_t& ic_ref, size_t& jc_ref, size_t& kc_ref,
+                                                     real* w_octet)
+{
+  real x_coeff, y_coeff, z_coeff;
+  if (!stretchedCCInterpolCoeffs(x, m_IDonorZoneFirst, m_IDonorZoneAfterlast, m_XNode, m_XCell, ic_ref, x_coeff)) {
+    return false;
+  }
+  if (!stretchedCCInterpolCoeffs(y, m_JDonorZoneFirst, m_JDonorZoneAfterlast, m_YNode, m_YCell, jc_ref, y_coeff)) {
+    return false;
+  }
+  if (!stretchedCCInterpolCoeffs(z, m_KDonorZoneFirst, m_KDonorZoneAfterlast, m_ZNode, m_ZCell, kc_ref, z_coeff)) {
+    return false;
+  }
+  w_octet[0] = (1. - x_coeff)  *  (1. - y_coeff)  *  (1. - z_coeff);
+  w_octet[1] = (1. - x_coeff)  *  (1. - y_coeff)  *     z_coeff;
+  w_octet[2] = (1. - x_coeff)  *     y_coeff      *  (1. - z_coeff);
+  w_octet[3] = (1. - x_coeff)  *     y_coeff      *     z_coeff;
+  w_octet[4] =    x_coeff      *  (1. - y_coeff)  *  (1. - z_coeff);
+  w_octet[5] =    x_coeff      *  (1. - y_coeff)  *     z_coeff;
+  w_octet[6] =    x_coeff      *     y_coeff      *  (1. - z_coeff);
+  w_octet[7] =    x_coeff      *     y_coeff      *     z_coeff;
+  return true;
+}
+
+
+bool CartesianStretchedPatch::computeCCDataInterpolCoeffs(real x, real y, real z,
+                                                          WeightedSet<real>& w_set)
+{
+  return computeCCDataInterpolCoeffs_V1(x, y, z, w_set);
+}
+
+
+bool CartesianStretchedPatch::computeCCDataInterpolCoeffs_V1(real x, real y, real z,
+                                                             WeightedSet<real>& w_set)
+{
+  size_t ic_ref, jc_ref, kc_ref;
+  real w_octet[8];
+  if (!stretchedInterpolOctet(x, y, z, ic_ref, jc_ref, kc_ref, w_octet)) {
+    return false;
+  }
+
+  // upper cell addresses, flat meshes (1D, 2D) need to be shifted back
+  size_t ic_ref_1 = min(ic_ref + 1, sizeI() - 1);
+  size_t jc_ref_1 = min(jc_ref + 1, sizeJ() - 1);
+  size_t kc_ref_1 = min(kc_ref + 1, sizeK() - 1);
+
+  w_set.clearWS();
+  w_set.pushBack(index(ic_ref,   jc_ref,   kc_ref  ), w_octet[0]);
+  w_set.pushBack(index(ic_ref,   jc_ref,   kc_ref_1), w_octet[1]);
+  w_set.pushBack(index(ic_ref,   jc_ref_1, kc_ref  ), w_octet[2]);
+  w_set.pushBack(index(ic_ref,   jc_ref_1, kc_ref_1), w_octet[3]);
+  w_set.pushBack(index(ic_ref_1, jc_ref,   kc_ref  ), w_octet[4]);
+  w_set.pushBack(index(ic_ref_1, jc_ref,   kc_ref_1), w_octet[5]);
+  w_set.pushBack(index(ic_ref_1, jc_ref_1, kc_ref  ), w_octet[6]);
+  w_set.pushBack(index(ic_ref_1, jc_ref_1, kc_ref_1), w_octet[7]);
+
+  //.. Eliminate round of contributors with below eps-weight
+  w_set.EliminateBelowEps(10*m_Eps, false, false);
+  //.. Ensure sum of weights to be 1. to correct eps-errors
+  w_set.adjustWeightSumShift(1.);
+
+  return true;
+}
+
+
+bool CartesianStretchedPatch::computeCCGrad1NInterpolCoeffs(real x, real y, real z,
+                                                            real nx, real ny, real nz,
+                                                            WeightedSet<real>& d_dn)
+{
+  size_t ic_ref, jc_ref, kc_ref;
+  real w_octet[8];
+  if (!stretchedInterpolOctet(x, y, z, ic_ref, jc_ref, kc_ref, w_octet)) {
+    return false;
+  }
+
+  //.. Normalize n-vector
+  real inv_n_abs = 1./sqrt(nx*nx + ny*ny + nz*nz);
+  real nn[3] = {nx*inv_n_abs, ny*inv_n_abs, nz*inv_n_abs};
+
+  size_t num[3] = {sizeI(), sizeJ(), sizeK()};
+  const vector<real>* cells[3] = {&m_XCell, &m_YCell, &m_ZCell};
+
+  // central differences on the non-uniform cell centres for all corners of the octet
+  d_dn.clearWS();
+  for (size_t i_corner = 0; i_corner < 8; ++i_corner) {
+    size_t ijk_c[3];
+    ijk_c[0] = min(ic_ref + i_corner/4,     num[0] - 1);
+    ijk_c[1] = min(jc_ref + (i_corner/2)%2, num[1] - 1);
+    ijk_c[2] = min(kc_ref + i_corner%2,     num[2] - 1);
+    for (int dim = 0; dim < 3; ++dim) {
+      size_t ijk_m[3] = {ijk_c[0], ijk_c[1], ijk_c[2]};
+      size_t ijk_p[3] = {ijk_c[0], ijk_c[1], ijk_c[2]};
+      if (ijk_c[dim] > 0) {
+        --ijk_m[dim];
+      }
+      if (ijk_c[dim] + 1 < num[dim]) {
+        ++ijk_p[dim];
+      }
+      if (ijk_p[dim] == ijk_m[dim]) {
+        continue; // flat in this direction
+      }
+      real coeff = w_octet[i_corner]*nn[dim]/((*cells[dim])[ijk_p[dim]] - (*cells[dim])[ijk_m[dim]]);
+      d_dn.pushBack(index(ijk_p[0], ijk_p[1], ijk_p[2]),  coeff);
+      d_dn.pushBack(index(ijk_m[0], ijk_m[1], ijk_m[2]), -coeff);
+    }
+  }
+  //.. compact to unique addresses
+  d_dn.Unify();
+  //.. Eliminate round off contributors with below eps-weight
+  d_dn.EliminateBelowEps(10*m_Eps, true, false);
+  //.. Ensure sum of weights to be 0. to correct eps-errors
+  d_dn.adjustWeightSumShift(0.);
+  return true;
+}
+
+
+real CartesianStretchedPatch::computeMinChLength()
+{
+  return m_MinDelta;
+}
+
+
+void CartesianStretchedPatch::computeNablaVar(const size_t& field_index, const size_t& var_index, const size_t& l_cell,
+                                              real& dvar_dx, real& dvar_dy, real& dvar_dz)
+{
+  real* var = getVariable(field_index, var_index);
+
+  size_t ijk_c[3];
+  ijk(l_cell,
+      ijk_c[0], ijk_c[1], ijk_c[2]);
+
+  size_t num[3] = {sizeI(), sizeJ(), sizeK()};
+  const vector<real>* cells[3] = {&m_XCell, &m_YCell, &m_ZCell};
+  real grad[3];
+
+  // central where possible, one sided at the patch boundaries
+  for (int dim = 0; dim < 3; ++dim) {
+    size_t ijk_m[3] = {ijk_c[0], ijk_c[1], ijk_c[2]};
+    size_t ijk_p[3] = {ijk_c[0], ijk_c[1], ijk_c[2]};
+    if (ijk_c[dim] > 0) {
+      --ijk_m[dim];
+    }
+    if (ijk_c[dim] + 1 < num[dim]) {
+      ++ijk_p[dim];
+    }
+    if (ijk_p[dim] == ijk_m[dim]) {
+      grad[dim] = 0;
+    } else {
+      size_t l_plus  = index(ijk_p[0], ijk_p[1], ijk_p[2]);
+      size_t l_minus = index(ijk_m[0], ijk_m[1], ijk_m[2]);
+      grad[dim] = (var[l_plus] - var[l_minus])/((*cells[dim])[ijk_p[dim]] - (*cells[dim])[ijk_m[dim]]);
+    }
+  }
+  dvar_dx = grad[0];
+  dvar_dy = grad[1];
+  dvar_dz = grad[2];
+}
+
+
+int CartesianStretchedPatch::findCell(vec3_t xo)
+{
+  vec3_t x = m_TransformInertial2This.transform(xo);
+  vec3_t x0(0, 0, 0);
+  vec3_t x1(m_XNode[sizeI()], m_YNode[sizeJ()], m_ZNode[sizeK()]);
+  if (!GeometryTools::isInsideCartesianBox(x, x0, x1)) {
+    return -1;
+  }
+  int i = min(int(upper_bound(m_XNode.begin(), m_XNode.end(), x[0]) - m_XNode.begin()) - 1, int(sizeI()) - 1);
+  int j = min(int(upper_bound(m_YNode.begin(), m_YNode.end(), x[1]) - m_YNode.begin()) - 1, int(sizeJ()) - 1);
+  int k = min(int(upper_bound(m_ZNode.begin(), m_ZNode.end(), x[2]) - m_ZNode.begin()) - 1, int(sizeK()) - 1);
+  return index(i, j, k);
+}
+
+
+bool CartesianStretchedPatch::isInsideCore(vec3_t xo)
+{
+  vec3_t x = m_TransformInertial2This.transform(xo);
+  vec3_t x0(m_XNode[m_ICoreFirst], m_YNode[m_JCoreFirst], m_ZNode[m_KCoreFirst]);
+  vec3_t x1(m_XNode[m_ICoreAfterlast], m_YNode[m_JCoreAfterlast], m_ZNode[m_KCoreAfterlast]);
+  return GeometryTools::isInsideCartesianBox(x, x0, x1);
+}
@@ -0,0 +1,223 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef CARTESIANSTRETCHEDPATCH_H
+#define CARTESIANSTRETCHEDPATCH_H
+
+class CartesianStretchedPatch;
+
+#include "cartesianpatch.h"
+
+/**
+ * A Cartesian patch with non-uniform spacing. The node positions are given independently
+ * for each of the three index directions by 1D coordinate arrays, so that cells can be
+ * clustered towards walls or shear layers without additional refinement patches.
+ *
+ * Addressing (i, j, k), the seek/protection/donor regions and the data layout are the ones of
+ * CartesianPatch. The uniform metrics of the base class (dx(), dy(), dz(), dV(), ...) hold the
+ * mean spacing of the patch; everything that needs the actual geometry uses the per-line
+ * accessors dxCell(i), dyCell(j), dzCell(k), ... instead. Use CartesianStretchedIterator to
+ * compute fluxes on patches of this type; see there for the operations which can be used.
+ *
+ * Patch type code in grid files is 1002. The data block is:
+ * @verbatim
+   <general patch data, see Patch::readFromFile>
+   num_i num_j num_k
+   num_seek_imin num_seek_imax num_seek_jmin num_seek_jmax num_seek_kmin num_seek_kmax
+   <i-distribution> <j-distribution> <k-distribution>
+   <solver codes>
+   @endverbatim
+ * Every distribution starts with a mode:
+ *  0 : followed by num+1 increasing node coordinates relative to the patch origin
+ *  1 : followed by "length ratio", geometric growth of the cell size by "ratio" from the min side
+ *  2 : followed by "length ratio", geometric growth by "ratio" from both sides towards the centre
+ *
+ * @note Immersed boundaries (split faces, level set BCs) and viscous fluxes are not supported on
+ *       stretched patches yet; they use the uniform metrics and stop with an error.
+ */
+class CartesianStretchedPatch : public CartesianPatch
+{
+
+protected: // attributes
+
+  vector<real> m_XNode;    ///< node coordinates in i direction (m_XNode[0] == 0)
+  vector<real> m_YNode;    ///< node coordinates in j direction (m_YNode[0] == 0)
+  vector<real> m_ZNode;    ///< node coordinates in k direction (m_ZNode[0] == 0)
+  vector<real> m_XCell;    ///< cell centre coordinates in i direction
+  vector<real> m_YCell;    ///< cell centre coordinates in j direction
+  vector<real> m_ZCell;    ///< cell centre coordinates in k direction
+  vector<real> m_DxCell;   ///< cell sizes in i direction
+  vector<real> m_DyCell;   ///< cell sizes in j direction
+  vector<real> m_DzCell;   ///< cell sizes in k direction
+  real         m_MinDelta; ///< smallest cell size in any direction
+
+
+protected: // methods
+
+  /**
+   * Read a 1D node distribution (see class description for the format).
+   * @param iss_input the stream to read from
+   * @param num number of cells in this direction
+   * @param nodes the node coordinates (return reference)
+   * @return true, if successful
+   */
+  bool readDistribution(istringstream& iss_input, size_t num, vector<real>& nodes);
+
+  /**
+   * Derive cell centres, cell sizes and the interpolation limits from the node arrays.
+   */
+  void computeStretchedDeltas();
+
+  /**
+   * Locate a coordinate in one direction for linear interpolation between cell centres.
+   * This is the stretched version of CartesianPatch::linearCCInterpolCoeffs and uses the same sectors.
+   * @param s_test the coordinate
+   * @param ijk_donor_first first index of the donor zone
+   * @param ijk_donor_afterlast index after the last one of the donor zone
+   * @param nodes node coordinates in this direction
+   * @param cells cell centre coordinates in this direction
+   * @param index_cell_ref lower cell index of the interpolation interval (return reference)
+   * @param rs_coeff weight of the upper cell (return reference)
+   * @return true, if s_test is inside the donor zone
+   */
+  bool stretchedCCInterpolCoeffs(const real& s_test,
+                                 const size_t& ijk_donor_first, const size_t& ijk_donor_afterlast,
+                                 const vector<real>& nodes, const vector<real>& cells,
+                                 size_t& index_cell_ref, real& rs_coeff);
+
+  /**
+   * Compute the eight tri-linear interpolation weights for a point in the donor zone.
+   * Weight order as in CartesianPatch::computeCCDataInterpolCoeffs_V1.
+   * @param x the x-value in the coords of the present patch
+   * @param y the y-value in the coords of the present patch
+   * @param z the z-value in the coords of the present patch
+   * @param ic_ref i-index of reference cell (return reference)
+   * @param jc_ref j-index of reference cell (return reference)
+   * @param kc_ref k-index of reference cell (return reference)
+   * @param w_octet eight interpolation weights (return reference)
+   * @return true, if the point is inside the donor zone
+   */
+  bool stretchedInterpolOctet(real x, real y, real z,
+                              size_t& ic_ref, size_t& jc_ref, size_t& kc_ref,
+                              real* w_octet);
+
+  virtual void xyzNode(size_t i, size_t j, size_t k, real& x, real& y, real& z) const;
+
+
+public: // methods
+
+  CartesianStretchedPatch(PatchGrid *patch_grid, size_t num_seeklayers = 2, size_t num_addprotectlayers = 0);
+
+  /**
+   * Create a geometric node distribution.
+   * @param length total length
+   * @param num number of cells
+   * @param ratio size ratio of neighbouring cells (> 1 clusters cells at the min side)
+   * @param symmetric grow from both sides towards the centre, if true
+   * @param nodes the num+1 node coordinates (return reference)
+   */
+  static void geometricDistribution(real length, size_t num, real ratio, bool symmetric, vector<real>& nodes);
+
+  /**
+   * Set up the metrics of the block from 1D node coordinates.
+   * The patch must have been resized before.
+   * @param x_nodes sizeI()+1 increasing node coordinates in i direction
+   * @param y_nodes sizeJ()+1 increasing node coordinates in j direction
+   * @param z_nodes sizeK()+1 increasing node coordinates in k direction
+   */
+  void setupStretchedMetrics(const vector<real>& x_nodes, const vector<real>& y_nodes, const vector<real>& z_nodes);
+
+  virtual bool readFromFile(istringstream& iss_input, real scale);
+  virtual void scaleRefParental(real scfactor);
+
+  real dxCell(size_t i) const { return m_DxCell[i]; }
+  real dyCell(size_t j) const { return m_DyCell[j]; }
+  real dzCell(size_t k) const { return m_DzCell[k]; }
+  real dVCell(size_t i, size_t j, size_t k) const { return m_DxCell[i]*m_DyCell[j]*m_DzCell[k]; }
+  real xCell(size_t i) const { return m_XCell[i]; }
+  real yCell(size_t j) const { return m_YCell[j]; }
+  real zCell(size_t k) const { return m_ZCell[k]; }
+  real xNode(size_t i) const { return m_XNode[i]; }
+  real yNode(size_t j) const { return m_YNode[j]; }
+  real zNode(size_t k) const { return m_ZNode[k]; }
+
+  /// all cell sizes in i direction (sizeI() entries)
+  const real* dxCells() const { return &m_DxCell[0]; }
+  /// all cell sizes in j direction (sizeJ() entries)
+  const real* dyCells() const { return &m_DyCell[0]; }
+  /// all cell sizes in k direction (sizeK() entries)
+  const real* dzCells() const { return &m_DzCell[0]; }
+
+  inline vec3_t xyzCell(const size_t& l) const
+  {
+    size_t i, j, k;
+    ijk(l,
+        i, j, k);
+    return xyzCell(i, j, k);
+  }
+
+  inline vec3_t xyzCell(const size_t& i, const size_t& j, const size_t& k) const
+  {
+    return vec3_t(m_XCell[i], m_YCell[j], m_ZCell[k]);
+  }
+
+  virtual void xyzCell(const size_t& l_cell,
+                       real& x_cell, real& y_cell, real& z_cell)
+  {
+    size_t i, j, k;
+    ijk(l_cell,
+        i, j, k);
+    xyzCell(i, j, k,
+            x_cell, y_cell, z_cell);
+  }
+
+  inline void xyzCell(const size_t& i, const size_t& j, const size_t& k,
+                      real& x, real& y, real& z) const
+  {
+    x = m_XCell[i];
+    y = m_YCell[j];
+    z = m_ZCell[k];
+  }
+
+  virtual void xxyyzzSubCellRaster(const size_t& l_cell, const size_t& lin_mult_res,
+                                   vector<vec3_t>& xxyyzz_subcells,
+                                   vec3_t& ref_dxxyyzz);
+
+  virtual bool computeCCDataInterpolCoeffs(real x, real y, real z,
+                                           WeightedSet<real>& w_set);
+
+  virtual bool computeCCDataInterpolCoeffs_V1(real x, real y, real z,
+                                              WeightedSet<real>& w_set);
+
+  virtual bool computeCCGrad1NInterpolCoeffs(real x, real y, real z,
+                                             real nx, real ny, real nz,
+                                             WeightedSet<real>& w_set);
+
+  virtual real computeMinChLength();
+
+  virtual void computeNablaVar(const size_t& field_index, const size_t& var_index, const size_t& l_cell,
+                               real& dvar_dx, real& dvar_dy, real& dvar_dz);
+
+  virtual int  findCell(vec3_t xo);
+  virtual bool isInsideCore(vec3_t xo);
+
+};
+
+#endif // CARTESIANSTRETCHEDPATCH_H
@@ -1,4 +1,5 @@
 #include "combilevelset.h"
+#include "levelsetprogram.h"
 
 
 CombiLevelSet::CombiLevelSet(LevelSetDefinition* levelset_a, LevelSetDefinition* levelset_b)
@@ -88,3 +89,22 @@ real CombiLevelSet::calcDistance(const real& xo, const real& yo, const real& zo)
 
   return distance;
 }
+
+
+void CombiLevelSet::compileOperands(LevelSetProgram& program)
+{
+  for (size_t i_o = 0; i_o < m_LevelSets.size(); i_o++) {
+    m_LevelSets[i_o]->compile(program);
+  }
+}
+
+
+real CombiLevelSet::getLipschitz()
+{
+  // min, max and negation do not increase the Lipschitz constant
+  real lipschitz = 0;
+  for (size_t i_o = 0; i_o < m_LevelSets.size(); i_o++) {
+    lipschitz = max(lipschitz, m_LevelSets[i_o]->getLipschitz());
+  }
+  return lipschitz;
+}
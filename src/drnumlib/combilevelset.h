@@ -19,6 +19,7 @@ protected: // methods
   void considerLowestLevelSetsOf(LevelSetDefinition* levelset);
   void concatLowestLevelSets(vector<LevelSetDefinition*>& other_lowest_levelsets);
   void findLowestLevelSets();
+  void compileOperands(LevelSetProgram& program);
 
 public:
   CombiLevelSet(LevelSetDefinition* levelset_a, LevelSetDefinition* levelset_b);
@@ -26,6 +27,7 @@ public:
   void includeLevelSet(LevelSetDefinition* levelset);
   virtual real calcDistance(const real& xo, const real& yo, const real& zo);
   virtual real evalReal() = 0;
+  virtual real getLipschitz();
 
 };
 
@@ -1,4 +1,5 @@
 #include "combilevelsetand.h"
+#include "levelsetprogram.h"
 
 CombiLevelSetAnd::CombiLevelSetAnd(LevelSetDefinition* levelset_a, LevelSetDefinition* levelset_b)
   : CombiLevelSet(levelset_a, levelset_b)
@@ -25,3 +26,8 @@ real CombiLevelSetAnd::evalReal()
   return distance;
 }
 
+void CombiLevelSetAnd::compile(LevelSetProgram& program)
+{
+  compileOperands(program);
+  program.addOperation(LevelSetProgram::AND, m_LevelSets.size());
+}
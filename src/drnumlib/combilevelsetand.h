@@ -22,6 +22,7 @@ public:
   CombiLevelSetAnd(LevelSetDefinition* levelset_a, LevelSetDefinition* levelset_b);
   CombiLevelSetAnd(LevelSetDefinition* levelset_a);
   virtual real evalReal();
+  virtual void compile(LevelSetProgram& program);
 };
 
 #endif // COMBILEVELSETAND_H
@@ -1,4 +1,5 @@
 #include "combilevelsetandnot.h"
+#include "levelsetprogram.h"
 
 CombiLevelSetAndNot::CombiLevelSetAndNot(LevelSetDefinition* levelset_a, LevelSetDefinition* levelset_b)
   : CombiLevelSet(levelset_a, levelset_b)
@@ -25,3 +26,9 @@ real CombiLevelSetAndNot::evalReal()
   }
   return distance;
 }
+
+void CombiLevelSetAndNot::compile(LevelSetProgram& program)
+{
+  compileOperands(program);
+  program.addOperation(LevelSetProgram::ANDNOT, m_LevelSets.size());
+}
@@ -21,6 +21,7 @@ public:
   CombiLevelSetAndNot(LevelSetDefinition* levelset_a, LevelSetDefinition* levelset_b);
   CombiLevelSetAndNot(LevelSetDefinition* levelset_a);
   virtual real evalReal();
+  virtual void compile(LevelSetProgram& program);
 };
 
 #endif // COMBILEVELSETANDNOT_H
@@ -1,4 +1,5 @@
 #include "combilevelsetor.h"
+#include "levelsetprogram.h"
 
 CombiLevelSetOr::CombiLevelSetOr(LevelSetDefinition* levelset_a, LevelSetDefinition* levelset_b)
   : CombiLevelSet(levelset_a, levelset_b)
@@ -24,3 +25,9 @@ real CombiLevelSetOr::evalReal()
   }
   return distance;
 }
+
+void CombiLevelSetOr::compile(LevelSetProgram& program)
+{
+  compileOperands(program);
+  program.addOperation(LevelSetProgram::OR, m_LevelSets.size());
+}
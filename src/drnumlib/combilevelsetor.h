@@ -22,6 +22,7 @@ public:
     CombiLevelSetOr(LevelSetDefinition* levelset_a, LevelSetDefinition* levelset_b);
     CombiLevelSetOr(LevelSetDefinition* levelset_a);
     virtual real evalReal();
+  virtual void compile(LevelSetProgram& program);
 };
 
 #endif // COMBILEVELSETOR_H
@@ -19,6 +19,7 @@
 // +                                                                      +
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 #include "combiobject.h"
+#include "objectprogram.h"
 
 
 CombiObject::CombiObject(ObjectDefinition* object_a, ObjectDefinition* object_b)
@@ -110,3 +111,10 @@ bool CombiObject::isInside(const real& xo, const real& yo, const real& zo)
   return inside;
 }
 
+
+void CombiObject::compileOperands(ObjectProgram& program)
+{
+  for (size_t i_o = 0; i_o < m_Objects.size(); i_o++) {
+    m_Objects[i_o]->compile(program);
+  }
+}
@@ -39,6 +39,7 @@ protected: // methods
   void considerLowestObjectsOf(ObjectDefinition* object);
   void concatLowestObjects(vector<ObjectDefinition*>& other_lowest_objects);
   void findLowestObjects();
+  void compileOperands(ObjectProgram& program);
 
 public:
   CombiObject(ObjectDefinition* object_a, ObjectDefinition* object_b);
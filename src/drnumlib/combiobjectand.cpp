@@ -19,6 +19,7 @@
 // +                                                                      +
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 #include "combiobjectand.h"
+#include "objectprogram.h"
 
 CombiObjectAnd::CombiObjectAnd(ObjectDefinition* object_a, ObjectDefinition* object_b)
   : CombiObject(object_a, object_b)
@@ -52,3 +53,31 @@ bool CombiObjectAnd::evalBool()
 
 //  return a_inside && b_inside;
 }
+
+
+void CombiObjectAnd::compile(ObjectProgram& program)
+{
+  compileOperands(program);
+  program.addOperation(ObjectProgram::AND, m_Objects.size());
+}
+
+
+bool CombiObjectAnd::getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max)
+{
+  // intersection of all bounded objects
+  bool bounded = false;
+  for (size_t i_o = 0; i_o < m_Objects.size(); i_o++) {
+    vec3_t o_min, o_max;
+    if (m_Objects[i_o]->getBoundingBox(o_min, o_max)) {
+      if (bounded) {
+        xyzo_min.maximisePerCoord(o_min);
+        xyzo_max.minimisePerCoord(o_max);
+      } else {
+        xyzo_min = o_min;
+        xyzo_max = o_max;
+        bounded = true;
+      }
+    }
+  }
+  return bounded;
+}
@@ -19,6 +19,7 @@
 // +                                                                      +
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 #include "combiobjectandnot.h"
+#include "objectprogram.h"
 
 CombiObjectAndNot::CombiObjectAndNot(ObjectDefinition* object_a, ObjectDefinition* object_b)
   : CombiObject(object_a, object_b)
@@ -55,3 +56,17 @@ bool CombiObjectAndNot::evalBool()
 
 //  return a_inside && !b_inside;
 }
+
+
+void CombiObjectAndNot::compile(ObjectProgram& program)
+{
+  compileOperands(program);
+  program.addOperation(ObjectProgram::ANDNOT, m_Objects.size());
+}
+
+
+bool CombiObjectAndNot::getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max)
+{
+  // the subtracted objects can only shrink the first one
+  return m_Objects[0]->getBoundingBox(xyzo_min, xyzo_max);
+}
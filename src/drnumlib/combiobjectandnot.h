@@ -31,6 +31,8 @@ public:
   CombiObjectAndNot(ObjectDefinition* object_a, ObjectDefinition* object_b);
   CombiObjectAndNot(ObjectDefinition* object_a);
   virtual bool evalBool();
+  virtual void compile(ObjectProgram& program);
+  virtual bool getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max);
 };
 
 #endif // COMBIOBJECTANDNOT_H
@@ -19,6 +19,7 @@
 // +                                                                      +
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 #include "combiobjector.h"
+#include "objectprogram.h"
 
 CombiObjectOr::CombiObjectOr(ObjectDefinition* object_a, ObjectDefinition* object_b)
   : CombiObject(object_a, object_b)
@@ -51,3 +52,30 @@ bool CombiObjectOr::evalBool()
 
 //  return a_inside || b_inside;
 }
+
+
+void CombiObjectOr::compile(ObjectProgram& program)
+{
+  compileOperands(program);
+  program.addOperation(ObjectProgram::OR, m_Objects.size());
+}
+
+
+bool CombiObjectOr::getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max)
+{
+  // union of all objects, unbounded if any of them is unbounded
+  for (size_t i_o = 0; i_o < m_Objects.size(); i_o++) {
+    vec3_t o_min, o_max;
+    if (!m_Objects[i_o]->getBoundingBox(o_min, o_max)) {
+      return false;
+    }
+    if (i_o == 0) {
+      xyzo_min = o_min;
+      xyzo_max = o_max;
+    } else {
+      xyzo_min.minimisePerCoord(o_min);
+      xyzo_max.maximisePerCoord(o_max);
+    }
+  }
+  return true;
+}
@@ -41,6 +41,8 @@ public:
                     real radius_bottom, real radius_top);
 
     virtual real calcDistance(const real& xo, const real& yo, const real& zo);
+    virtual void calcDistances(const real* xo, const real* yo, const real* zo, real* g, size_t n);
+    virtual real getLipschitz() { return 1.0; } // (signed) distance function
 
 };
 
@@ -84,3 +84,43 @@ bool ConeObject::isInside (const real &xo, const real &yo, const real &zo)
   // survived until here? => inside
   return true;
 }
+
+
+bool ConeObject::getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max)
+{
+  // box around spheres at both ends of the axis
+  real radius = max(m_RadiusBottom, m_RadiusTop);
+  vec3_t top_o = m_BottomO + m_AxisO;
+  for (size_t i = 0; i < 3; ++i) {
+    xyzo_min[i] = min(m_BottomO[i], top_o[i]) - radius;
+    xyzo_max[i] = max(m_BottomO[i], top_o[i]) + radius;
+  }
+  return true;
+}
+
+
+void ConeObject::checkInside(const real* xo, const real* yo, const real* zo, char* inside, size_t n)
+{
+  // plain loop without virtual calls, vector temporaries and early returns, so that it can be vectorised
+  real bx = m_BottomO[0];
+  real by = m_BottomO[1];
+  real bz = m_BottomO[2];
+  real ax = m_AxisO[0];
+  real ay = m_AxisO[1];
+  real az = m_AxisO[2];
+  real inv_q_length  = m_InvQLength;
+  real radius_bottom = m_RadiusBottom;
+  real radius_top    = m_RadiusTop;
+  for (size_t i = 0; i < n; ++i) {
+    real dx = xo[i] - bx;
+    real dy = yo[i] - by;
+    real dz = zo[i] - bz;
+    real scal_n = (ax*dx + ay*dy + az*dz)*inv_q_length;
+    real cx = ay*dz - az*dy;
+    real cy = az*dx - ax*dz;
+    real cz = ax*dy - ay*dx;
+    real qdist  = (cx*cx + cy*cy + cz*cz)*inv_q_length;
+    real r_lim  = (1 - scal_n)*radius_bottom + scal_n*radius_top;
+    inside[i] = (scal_n >= 0) & (scal_n <= 1) & (qdist <= r_lim*r_lim);
+  }
+}
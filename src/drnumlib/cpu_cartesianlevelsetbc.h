@@ -0,0 +1,141 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef CPU_CARTESIANLEVELSETBC_H
+#define CPU_CARTESIANLEVELSETBC_H
+
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+class CPU_CartesianLevelSetBC;
+
+#include "cartesianlevelsetbc.h"
+
+#include "drnum.h"
+#include "genericoperation.h"
+
+/**
+ * CPU implementation of the level set boundary condition for Cartesian patches.
+ * Uses the same cell lists and cell operations as GPU_CartesianLevelSetBC.
+ * New states are computed into a buffer first and written to field 0 afterwards,
+ * which gives the same result as the field 2 round trip of the GPU version.
+ */
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+class CPU_CartesianLevelSetBC : public GenericOperation, public CartesianLevelSetBC<DIM, NUM_LS, LS, BC>
+{
+
+public: // data types
+
+  typedef typename CartesianLevelSetBC<DIM, NUM_LS, LS, BC>::cell_t   cell_t;
+  typedef typename CartesianLevelSetBC<DIM, NUM_LS, LS, BC>::bccell_t bccell_t;
+
+
+protected: // attributes
+
+  PatchGrid*              m_PatchGrid;
+  vector<CartesianPatch*> m_Patches;
+  vector<real>            m_Buffer; ///< new states of the cells of one pass
+  vector<char>            m_Set;    ///< flags for cells which have got a new state
+
+
+public: // methods
+
+  CPU_CartesianLevelSetBC(PatchGrid* patch_grid, LS ls, BC bc);
+
+  /**
+   * Update the cell lists after a motion of a MovingLevelSet (see MovingLevelSet::move).
+   * @param body the moving level set
+   */
+  void updateCells(MovingLevelSet& body) { this->updateCellLists(m_Patches, body); }
+
+  virtual void operator()();
+
+};
+
+
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+CPU_CartesianLevelSetBC<DIM,NUM_LS,LS,BC>::CPU_CartesianLevelSetBC(PatchGrid* patch_grid, LS ls, BC bc)
+  : CartesianLevelSetBC<DIM, NUM_LS, LS, BC>(ls, bc)
+{
+  m_PatchGrid = patch_grid;
+  for (size_t i = 0; i < m_PatchGrid->getNumPatches(); ++i) {
+    CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i));
+    if (patch) {
+      m_Patches.push_back(patch);
+    }
+  }
+  this->deactivateCells(m_Patches);
+}
+
+template <unsigned int DIM, unsigned int NUM_LS, typename LS, typename BC>
+void CPU_CartesianLevelSetBC<DIM,NUM_LS,LS,BC>::operator()()
+{
+  this->computeCells(m_Patches);
+  dim_t<DIM> dim;
+
+  for (size_t i_patch = 0; i_patch < m_Patches.size(); ++i_patch) {
+    CartesianPatch& patch = *(m_Patches[i_patch]);
+
+    // cells next to the boundary (mirror states)
+    {
+      const QList<bccell_t>& cells = this->m_BcCells[i_patch];
+      int num_cells = cells.size();
+      m_Buffer.resize(DIM*num_cells);
+#ifndef DEBUG
+      #pragma omp parallel for
+#endif
+      for (int i_cell = 0; i_cell < num_cells; ++i_cell) {
+        this->bcCellState(patch, this->m_Ls, this->m_Bc, cells[i_cell], &m_Buffer[DIM*i_cell]);
+      }
+#ifndef DEBUG
+      #pragma omp parallel for
+#endif
+      for (int i_cell = 0; i_cell < num_cells; ++i_cell) {
+        size_t i, j, k;
+        patch.ijk(cells[i_cell].index, i, j, k);
+        patch.setVar(dim, 0, i, j, k, &m_Buffer[DIM*i_cell]);
+      }
+    }
+
+    // cells deeper inside the body (extrapolation)
+    {
+      const QList<cell_t>& cells = this->m_Cells[i_patch];
+      int num_cells = cells.size();
+      m_Buffer.resize(DIM*num_cells);
+      m_Set.resize(num_cells);
+#ifndef DEBUG
+      #pragma omp parallel for
+#endif
+      for (int i_cell = 0; i_cell < num_cells; ++i_cell) {
+        real total_weight;
+        m_Set[i_cell] = this->innerCellState(patch, this->m_Ls, this->m_Bc, cells[i_cell], &m_Buffer[DIM*i_cell], total_weight);
+      }
+#ifndef DEBUG
+      #pragma omp parallel for
+#endif
+      for (int i_cell = 0; i_cell < num_cells; ++i_cell) {
+        if (m_Set[i_cell]) {
+          patch.setVar(dim, 0, cells[i_cell].i, cells[i_cell].j, cells[i_cell].k, &m_Buffer[DIM*i_cell]);
+        }
+      }
+    }
+
+  }
+}
+
+#endif // CPU_CARTESIANLEVELSETBC_H
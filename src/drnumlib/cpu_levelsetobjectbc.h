@@ -24,12 +24,25 @@
 #include "levelsetobjectbc.h"
 #include "lslayerdataextrapol.h"
 
+/**
+  * CPU implementation of levelset based boundary conditions.
+  * Works on the packed layer cells (LSLayerCells) in parallel. The abuse_field is
+  * not used on the CPU; mirror values are stored in a packed buffer instead.
+  */
 template <typename OP>
 class CPU_LevelSetObjectBC : public LevelSetObjectBC
 {
 
 protected:
   OP m_Op;
+  vector<real> m_Acc; ///< mirror values of the layer cells (replaces the abuse field)
+
+  /** Apply the operator on packed layer cells in two phases (mirror access, then set values).
+    * @param cells the packed layer cells
+    * @param inner true for inner cells, false for outer cells
+    * @param relax relaxation factor
+    */
+  void operatePacked(LSLayerCells& cells, bool inner, real relax);
 
 public:
 
@@ -60,7 +73,9 @@ void CPU_LevelSetObjectBC<OP>::operator()()
 {
 
   // Potential recursion: Interpolate sets may contain cells in m_InnerCellsLayers.
-  // To prevent recursion, the abuse_field is used as intermediate data storage.
+  // To prevent recursion, all mirror values are acquired first (into m_Acc) and
+  // set afterwards. Cells are written only once per phase, hence both phases
+  // run in parallel.
 
   real relax = 0.5;
 
@@ -68,24 +83,35 @@ void CPU_LevelSetObjectBC<OP>::operator()()
     *       relax < 1. , if corrections are small, but keep it to react on inpulsive
     *       starts or similar. Found approx. 0.8 to be a limit for impulsive starts. */
 
-  // Inner Cells
-  //.. 1st loop: acquire data, avoid recursion
-  for (size_t ll_c = 0; ll_c < m_NumInnerLayerCells; ll_c++) {
-    m_Op.access(m_InnerCellsLayers[ll_c], m_Field, m_AbuseField);
-  }
-  //.. 2nd loop: set values
-  for (size_t ll_c = 0; ll_c < m_NumInnerLayerCells; ll_c++) {
-    m_Op.operateInner(m_InnerCellsLayers[ll_c], m_Field, m_AbuseField, relax);
-  }
+  operatePacked(m_InnerCells, true, relax);
+  operatePacked(m_OuterCells, false, relax);
+}
+
+template <typename OP>
+void CPU_LevelSetObjectBC<OP>::operatePacked(LSLayerCells& cells, bool inner, real relax)
+{
+  size_t num_vars = m_Op.numVars();
+  int num_cells = cells.numCells();
+  m_Acc.resize(num_vars*num_cells);
 
-  // Outer Cells
   //.. 1st loop: acquire data, avoid recursion
-  for (size_t ll_c = 0; ll_c < m_NumOuterLayerCells; ll_c++) {
-    m_Op.access(m_OuterCellsLayers[ll_c], m_Field, m_AbuseField);
+#ifndef DEBUG
+  #pragma omp parallel for
+#endif
+  for (int ll_c = 0; ll_c < num_cells; ll_c++) {
+    cells.interpolate(ll_c, m_Field, num_vars, &m_Acc[num_vars*ll_c]);
   }
+
   //.. 2nd loop: set values
-  for (size_t ll_c = 0; ll_c < m_NumOuterLayerCells; ll_c++) {
-    m_Op.operateOuter(m_OuterCellsLayers[ll_c], m_Field, m_AbuseField, relax);
+#ifndef DEBUG
+  #pragma omp parallel for
+#endif
+  for (int ll_c = 0; ll_c < num_cells; ll_c++) {
+    if (inner) {
+      m_Op.operateInner(cells, ll_c, m_Field, &m_Acc[num_vars*ll_c], relax);
+    } else {
+      m_Op.operateOuter(cells, ll_c, m_Field, &m_Acc[num_vars*ll_c], relax);
+    }
   }
 }
 
@@ -52,3 +52,29 @@ real CylinderLevelSet::calcDistance (const real &xo, const real &yo, const real
 
   return distance;
 }
+
+void CylinderLevelSet::calcDistances(const real* xo, const real* yo, const real* zo, real* g, size_t n)
+{
+  // plain loop without virtual calls and vector temporaries, so that it can be vectorised
+  real bx = m_BottomO[0];
+  real by = m_BottomO[1];
+  real bz = m_BottomO[2];
+  real ax = m_AxisO_norm[0];
+  real ay = m_AxisO_norm[1];
+  real az = m_AxisO_norm[2];
+  real length = m_Length;
+  real radius = m_Radius;
+  for (size_t i = 0; i < n; ++i) {
+    real dx = xo[i] - bx;
+    real dy = yo[i] - by;
+    real dz = zo[i] - bz;
+    real scal = ax*dx + ay*dy + az*dz;
+    real cx = ay*dz - az*dy;
+    real cy = az*dx - ax*dz;
+    real cz = ax*dy - ay*dx;
+    real distance = -scal;
+    distance = max(distance, scal - length);
+    distance = max(distance, real(sqrt(cx*cx + cy*cy + cz*cz)) - radius);
+    g[i] = distance;
+  }
+}
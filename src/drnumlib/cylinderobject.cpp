@@ -77,3 +77,39 @@ bool CylinderObject::isInside (const real &xo, const real &yo, const real &zo)
   // survived until here? => inside
   return true;
 }
+
+
+bool CylinderObject::getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max)
+{
+  // box around spheres at both ends of the axis
+  vec3_t top_o = m_BottomO + m_AxisO;
+  for (size_t i = 0; i < 3; ++i) {
+    xyzo_min[i] = min(m_BottomO[i], top_o[i]) - m_Radius;
+    xyzo_max[i] = max(m_BottomO[i], top_o[i]) + m_Radius;
+  }
+  return true;
+}
+
+
+void CylinderObject::checkInside(const real* xo, const real* yo, const real* zo, char* inside, size_t n)
+{
+  // plain loop without virtual calls, vector temporaries and early returns, so that it can be vectorised
+  real bx = m_BottomO[0];
+  real by = m_BottomO[1];
+  real bz = m_BottomO[2];
+  real ax = m_AxisO[0];
+  real ay = m_AxisO[1];
+  real az = m_AxisO[2];
+  real q_length = m_QLength;
+  real qlr      = m_QLR;
+  for (size_t i = 0; i < n; ++i) {
+    real dx = xo[i] - bx;
+    real dy = yo[i] - by;
+    real dz = zo[i] - bz;
+    real scal = ax*dx + ay*dy + az*dz;
+    real cx = ay*dz - az*dy;
+    real cy = az*dx - ax*dz;
+    real cz = ax*dy - ay*dx;
+    inside[i] = (scal >= 0) & (scal <= q_length) & (cx*cx + cy*cy + cz*cz <= qlr);
+  }
+}
@@ -48,6 +48,8 @@ public:
                     real radius);
 
     virtual bool isInside (const real& xo, const real& yo, const real& zo);
+    virtual void checkInside(const real* xo, const real* yo, const real* zo, char* inside, size_t n);
+    virtual bool getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max);
 
 };
 
@@ -37,11 +37,32 @@
 #include "patchgrid.h"
 #include "postprocessingvariables.h"
 #include "cartesianpatch.h"
+#include "telemetry.h"
+#include "windingnumber.h"
+
+#ifdef OPEN_MP
+#include <omp.h>
+#endif
 
 #ifdef GPU
 #include "gpu_cartesianpatch.h"
 #endif
 
+/**
+ * Signed distance to a triangulated surface (STL or PLY), stored in variable IVAR of field 0
+ * (or of the field selected by setField).
+ *
+ * Cartesian patches are split into sub-blocks which are processed in parallel. For every block
+ * the exact distance of its centre cell decides whether the block can intersect the narrow band
+ * around the surface. Such blocks are refined down to 2x2x2 cells, which finally get exact (AABB tree)
+ * distances; all other blocks only get the sign and an upper bound of the distance from their centre cell. Afterwards the distance
+ * field is extended from the exact cells by a fast sweeping Eikonal solver (one patch per thread).
+ *
+ * The sign is taken from the generalized winding number of the surface (see WindingNumber), which
+ * is robust for surfaces with gaps or overlaps. It is only evaluated for the cells of the narrow band
+ * and for the centre cells of the remaining blocks; the sign of a block centre applies to the whole block.
+ * Alternatively, the sign can be taken from the normal of the closest triangle (setWindingNumberSign).
+ */
 template <unsigned int DIM, unsigned int IVAR>
 class DiscreteLevelSet
 {
@@ -68,25 +89,75 @@ private: // types
   typedef CGAL::AABB_traits<K, SegmentPrimitive>           SegmentTraits;
   typedef CGAL::AABB_tree<SegmentTraits>                   SegmentTree;
 
+  struct block_t
+  {
+    size_t i_patch;
+    size_t i1, j1, k1, i2, j2, k2;  ///< index range of the block (i2, j2, k2: after last)
+  };
+
 
 
 
 private: // attributes
 
   PatchGrid*        m_PatchGrid;
+  size_t            m_Field;       ///< field to store the level set in
   QVector<Triangle> m_Triangles;
   QVector<vec3_t>   m_Normals;
   TriangleTree      m_TriangleTree;
-  real              m_Tol;
+  WindingNumber     m_WindingNumber;
+  bool              m_UseWindingNumber;
+  real              m_BandWidth;   ///< half width of the narrow band (number of cells)
+  size_t            m_BlockSize;   ///< edge length of the sub-blocks (number of cells)
+  size_t            m_MaxCycles;   ///< maximal number of fast sweeping cycles (8 sweeps each)
+  size_t            m_NumExact;    ///< number of exact distance queries of the last computation
 
 
 protected: //
 
   void computeLevelSet(vtkPolyData* poly);
   real computePointLevelSet(vec3_t x);
-  void levelSetPerCell(size_t i_patch, int& count, int& total_count);
-  void recursiveLevelSet(CartesianPatch* patch, size_t i_o, size_t j_o, size_t k_o, size_t i_m, size_t j_m, size_t k_m);
-  void interpolate(CartesianPatch* patch, size_t i_o, size_t j_o, size_t k_o, size_t i_m, size_t j_m, size_t k_m);
+
+  /**
+   * Unsigned distance to the surface.
+   * @param x the point
+   * @param normal_sign will hold the sign from the normal of the closest triangle
+   * @return the distance
+   */
+  real computePointDistance(vec3_t x, real& normal_sign);
+
+  /**
+   * Sign of the level set (negative inside).
+   * @param x the point
+   * @param normal_sign the sign from the normal of the closest triangle (see computePointDistance)
+   * @return -1 or 1
+   */
+  real computeSign(vec3_t x, real normal_sign);
+  void levelSetPerCell(size_t i_patch);
+
+  /**
+   * Compute a sub-block of a Cartesian patch (recursive).
+   * Cells inside the narrow band get exact distances and are marked as known.
+   * @param patch the Cartesian patch
+   * @param i1 first i index
+   * @param j1 first j index
+   * @param k1 first k index
+   * @param i2 i index after last
+   * @param j2 j index after last
+   * @param k2 k index after last
+   * @param known flags of cells with exact distances
+   * @return the number of exact distance queries
+   */
+  size_t computeBlock(CartesianPatch* patch, size_t i1, size_t j1, size_t k1, size_t i2, size_t j2, size_t k2, vector<char>& known);
+
+  /**
+   * Extend the distance field from the known cells (fast sweeping method).
+   * @param patch the Cartesian patch
+   * @param known flags of cells with exact distances
+   */
+  void fastSweeping(CartesianPatch* patch, const vector<char>& known);
+
+  real sweep(CartesianPatch* patch, const vector<char>& known, vector<real>& u, bool i_up, bool j_up, bool k_up);
 
 
 public:
@@ -95,6 +166,33 @@ public:
 
   void readGeometry(QString geometry_file_name);
 
+  /**
+   * Set the half width of the narrow band with exact distances.
+   * @param num_cells half width in cells (of the respective patch)
+   */
+  void setBandWidth(real num_cells) { m_BandWidth = num_cells; }
+
+  /**
+   * Set the edge length of the sub-blocks (work units of the parallel traversal).
+   * @param num_cells the block size in cells
+   */
+  void setBlockSize(size_t num_cells) { m_BlockSize = max(size_t(2), num_cells); }
+
+  size_t numExactQueries() { return m_NumExact; }
+
+  /**
+   * Select the sign criterion.
+   * @param use_winding_number generalized winding number (default) if true, closest triangle normal if false
+   */
+  void setWindingNumberSign(bool use_winding_number) { m_UseWindingNumber = use_winding_number; }
+
+  /**
+   * Select the field to store the level set in (default 0).
+   * A scratch field allows to compute the level set without an extra solver variable (see BrickLevelSet).
+   * @param i_field the index of the field
+   */
+  void setField(size_t i_field) { m_Field = i_field; }
+
 };
 
 
@@ -117,7 +215,12 @@ template <unsigned int DIM, unsigned int IVAR>
 DiscreteLevelSet<DIM,IVAR>::DiscreteLevelSet(PatchGrid *patch_grid)
 {
   m_PatchGrid = patch_grid;
-  m_Tol = 0.55;
+  m_Field     = 0;
+  m_BandWidth = 3;
+  m_BlockSize = 8;
+  m_MaxCycles = 4;
+  m_NumExact  = 0;
+  m_UseWindingNumber = true;
 }
 
 template <unsigned int DIM, unsigned int IVAR>
@@ -147,7 +250,8 @@ void DiscreteLevelSet<DIM,IVAR>::readGeometry(QString geometry_file_name)
 template <unsigned int DIM, unsigned int IVAR>
 void DiscreteLevelSet<DIM,IVAR>::computeLevelSet(vtkPolyData *poly)
 {
-  //QVector<Segment>     m_Segments;
+  ScopedTimer timer("levelSet");
+  double start_time = Telemetry::wallTime();
 
   // build triangle tree
   {
@@ -174,146 +278,264 @@ void DiscreteLevelSet<DIM,IVAR>::computeLevelSet(vtkPolyData *poly)
     }
     m_TriangleTree.rebuild(m_Triangles.begin(), m_Triangles.end());
     m_TriangleTree.accelerate_distance_queries();
+
+    m_WindingNumber.clear();
+    if (m_UseWindingNumber) {
+      for (int id_cell = 0; id_cell < num_faces; ++id_cell) {
+        const Triangle& T = m_Triangles[id_cell];
+        dvec3_t a(T.vertex(0)[0], T.vertex(0)[1], T.vertex(0)[2]);
+        dvec3_t b(T.vertex(1)[0], T.vertex(1)[1], T.vertex(1)[2]);
+        dvec3_t c(T.vertex(2)[0], T.vertex(2)[1], T.vertex(2)[2]);
+        m_WindingNumber.addTriangle(a, b, c);
+      }
+      m_WindingNumber.setup();
+    }
+
+    // The search structure is built on the first query; this must not happen in a parallel region.
+    computePointLevelSet(vec3_t(0,0,0));
   }
+  double tree_time = Telemetry::wallTime();
 
-  int count = 0;
-  int total_count = 0;
-  //real var[DIM];
-  //dim_t<DIM> dim;
+  // collect the sub-blocks of all Cartesian patches
+  vector<block_t> blocks;
+  vector<vector<char> > known(m_PatchGrid->getNumPatches());
+  vector<size_t> cartesian_patches;
+  size_t num_cells = 0;
   for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
-
     CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i_patch));
-    //CartesianPatch* patch = NULL;
     if (patch) {
-      size_t i_m = patch->sizeI() - 1;
-      size_t j_m = patch->sizeJ() - 1;
-      size_t k_m = patch->sizeK() - 1;
-
-      if ( i_m == 0 || j_m == 0 || k_m == 0) {
-         cout << endl << endl << "Error! i-> " << i_m << " j-> " << j_m << " k-> " << k_m << endl;
-         BUG;
+      cartesian_patches.push_back(i_patch);
+      known[i_patch].resize(patch->variableSize(), 0);
+      num_cells += patch->variableSize();
+      for (size_t i = 0; i < patch->sizeI(); i += m_BlockSize) {
+        for (size_t j = 0; j < patch->sizeJ(); j += m_BlockSize) {
+          for (size_t k = 0; k < patch->sizeK(); k += m_BlockSize) {
+            block_t block;
+            block.i_patch = i_patch;
+            block.i1 = i;
+            block.j1 = j;
+            block.k1 = k;
+            block.i2 = min(i + m_BlockSize, patch->sizeI());
+            block.j2 = min(j + m_BlockSize, patch->sizeJ());
+            block.k2 = min(k + m_BlockSize, patch->sizeK());
+            blocks.push_back(block);
+          }
+        }
       }
-      recursiveLevelSet(patch, 0, 0, 0, i_m, j_m, k_m);
     }
-    else {
+  }
+
+  // narrow band with exact distances
+  size_t num_exact = 0;
+#ifndef DEBUG
+#pragma omp parallel for schedule(dynamic) reduction(+:num_exact)
+#endif
+  for (size_t i_block = 0; i_block < blocks.size(); ++i_block) {
+    const block_t& B = blocks[i_block];
+    CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(B.i_patch));
+    num_exact += computeBlock(patch, B.i1, B.j1, B.k1, B.i2, B.j2, B.k2, known[B.i_patch]);
+  }
+  double band_time = Telemetry::wallTime();
+
+  // extension outside of the narrow band
+#ifndef DEBUG
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (size_t i = 0; i < cartesian_patches.size(); ++i) {
+    size_t i_patch = cartesian_patches[i];
+    fastSweeping(dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i_patch)), known[i_patch]);
+  }
+  double sweep_time = Telemetry::wallTime();
+
+  // other patch types are computed cell by cell
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    if (!dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i_patch))) {
       cout << "Computing levelset cell per cell for patch-> " << i_patch << "." << endl;
-      levelSetPerCell(i_patch, count, total_count);
+      levelSetPerCell(i_patch);
+      num_exact += m_PatchGrid->getPatch(i_patch)->variableSize();
     }
   }
+  m_NumExact = num_exact;
+
+  double end_time = Telemetry::wallTime();
+  cout << "level set: " << m_Triangles.size() << " triangles, " << num_cells << " Cartesian cells, ";
+  cout << num_exact << " exact distance queries" << endl;
+  cout << "  tree: " << tree_time - start_time << " s, narrow band: " << band_time - tree_time;
+  cout << " s, fast sweeping: " << sweep_time - band_time << " s, total: " << end_time - start_time << " s" << endl;
 }
 
 template <unsigned int DIM, unsigned int IVAR>
-void DiscreteLevelSet<DIM,IVAR>::recursiveLevelSet(CartesianPatch* patch, size_t i_o, size_t j_o, size_t k_o, size_t i_m, size_t j_m, size_t k_m)
+size_t DiscreteLevelSet<DIM,IVAR>::computeBlock(CartesianPatch* patch, size_t i1, size_t j1, size_t k1, size_t i2, size_t j2, size_t k2, vector<char>& known)
 {
-  real var[DIM];
-  dim_t<DIM> dim;
-
-  size_t index[8];
-  index[0] = patch->index(i_o, j_o, k_o);
-  index[1] = patch->index(i_m, j_o, k_o);
-  index[2] = patch->index(i_o, j_m, k_o);
-  index[3] = patch->index(i_o, j_o, k_m);
-  index[4] = patch->index(i_m, j_m, k_o);
-  index[5] = patch->index(i_m, j_o, k_m);
-  index[6] = patch->index(i_o, j_m, k_m);
-  index[7] = patch->index(i_m, j_m, k_m);
-
-  real g[8];
-  for (int i = 0; i < 8; ++i) {
-    vec3_t x = patch->xyzoCell(index[i]);
-    g[i] = computePointLevelSet(x);
+  size_t i_c = (i1 + i2 - 1)/2;
+  size_t j_c = (j1 + j2 - 1)/2;
+  size_t k_c = (k1 + k2 - 1)/2;
+  vec3_t x_c = patch->xyzoCell(patch->index(i_c, j_c, k_c));
+  real   normal_sign;
+  real   d_c = computePointDistance(x_c, normal_sign);
+
+  // largest distance of a cell centre of the block to the centre cell
+  real Di = max(i_c - i1, i2 - 1 - i_c)*patch->dx();
+  real Dj = max(j_c - j1, j2 - 1 - j_c)*patch->dy();
+  real Dk = max(k_c - k1, k2 - 1 - k_c)*patch->dz();
+  real radius = sqrt(Di*Di + Dj*Dj + Dk*Dk);
+  real band   = m_BandWidth*max(patch->dx(), max(patch->dy(), patch->dz()));
+
+  if (d_c > radius + band) {
+
+    // The block is completely outside of the narrow band and cannot be crossed by the surface.
+    // |G| <= |G_c| + |x - x_c| is used as initial value for the fast sweeping method.
+    real sign = computeSign(x_c, normal_sign);
+    for (size_t i = i1; i < i2; ++i) {
+      for (size_t j = j1; j < j2; ++j) {
+        for (size_t k = k1; k < k2; ++k) {
+          vec3_t dx = patch->xyzoCell(patch->index(i, j, k)) - x_c;
+          patch->f(m_Field, IVAR, i, j, k) = sign*(d_c + dx.abs());
+        }
+      }
+    }
+    patch->f(m_Field, IVAR, i_c, j_c, k_c) = sign*d_c;
+    known[patch->index(i_c, j_c, k_c)] = 1;
+    return 1;
   }
-  vec3_t x_ooo = patch->xyzoCell(index[0]);
-  vec3_t x_ijk = patch->xyzoCell(index[7]);
-  real d = m_Tol*(x_ooo - x_ijk).abs();
 
-  if ( fabs(g[0]) < d || fabs(g[1]) < d || fabs(g[2]) < d || fabs(g[3]) < d ||
-       fabs(g[4]) < d || fabs(g[5]) < d || fabs(g[6]) < d || fabs(g[7]) < d)
-  {
-    //cout  << "    recursion" << endl;
-    int trunc = 5;
-    if ( (i_m-i_o) <= trunc && (j_m-j_o) <= trunc && (k_m-k_o) <= trunc) {
-      for (size_t i = i_o; i <= i_m; ++i) {
-        for (size_t j = j_o; j <= j_m; ++j) {
-          for (size_t k = k_o; k <= k_m; ++k) {
-            size_t i_cell = patch->index(i,j,k);
-            vec3_t x = patch->xyzoCell(i_cell);
-            real g = computePointLevelSet(x);
-            static_cast<Patch*>(patch)->getVar(dim, 0, i_cell, var);
-            var[IVAR] = g;
-            static_cast<Patch*>(patch)->setVar(dim, 0, i_cell, var);
+  // refine large blocks (disjoint children, no cell is evaluated twice)
+  if (i2 - i1 > 2 || j2 - j1 > 2 || k2 - k1 > 2) {
+    size_t i_split[3] = {i1, (i1 + i2)/2, i2};
+    size_t j_split[3] = {j1, (j1 + j2)/2, j2};
+    size_t k_split[3] = {k1, (k1 + k2)/2, k2};
+    size_t num_queries = 1;
+    for (int ci = 0; ci < 2; ++ci) {
+      for (int cj = 0; cj < 2; ++cj) {
+        for (int ck = 0; ck < 2; ++ck) {
+          if (i_split[ci] < i_split[ci+1] && j_split[cj] < j_split[cj+1] && k_split[ck] < k_split[ck+1]) {
+            num_queries += computeBlock(patch, i_split[ci], j_split[cj], k_split[ck], i_split[ci+1], j_split[cj+1], k_split[ck+1], known);
           }
         }
       }
-      return;
-    } else {
-      if ( (i_m-i_o) == 0 || (j_m-j_o) == 0 || (k_m-k_o) == 0) {
-        cout << "WARNING at least one x_m-x_o == 0" << endl;
-      }
-      if ( (i_m - i_o) >= max(j_m-j_o, k_m-k_o)) {
-        //cout << "half i" << endl;
-        int i_new = (i_m - i_o)/2 + i_o;
-        recursiveLevelSet(patch, i_o  , j_o, k_o, i_new, j_m, k_m );
-        recursiveLevelSet(patch, i_new, j_o, k_o, i_m  , j_m, k_m );
-        return;
-      }
-      if ( (j_m - j_o) >= max(i_m-i_o, k_m-k_o)) {
-        //cout << "half j" << endl;
-        int j_new = (j_m - j_o)/2 + j_o;
-        recursiveLevelSet(patch, i_o, j_o  , k_o, i_m, j_new, k_m );
-        recursiveLevelSet(patch, i_o, j_new, k_o, i_m, j_m, k_m );
-        return;
+    }
+    return num_queries;
+  }
+
+  for (size_t i = i1; i < i2; ++i) {
+    for (size_t j = j1; j < j2; ++j) {
+      for (size_t k = k1; k < k2; ++k) {
+        size_t idx = patch->index(i, j, k);
+        patch->f(m_Field, IVAR, i, j, k) = computePointLevelSet(patch->xyzoCell(idx));
+        known[idx] = 1;
       }
-      if ( (k_m - k_o) >= max(i_m-i_o, j_m-j_o)) {
-        //cout << "half k" << endl;
-        int k_new = (k_m - k_o)/2 + k_o;
-        recursiveLevelSet(patch, i_o, j_o, k_o  , i_m, j_m, k_new );
-        recursiveLevelSet(patch, i_o, j_o, k_new, i_m, j_m, k_m   );
-        return;
+    }
+  }
+  return (i2 - i1)*(j2 - j1)*(k2 - k1);
+}
+
+template <unsigned int DIM, unsigned int IVAR>
+real DiscreteLevelSet<DIM,IVAR>::sweep(CartesianPatch* patch, const vector<char>& known, vector<real>& u, bool i_up, bool j_up, bool k_up)
+{
+  int NI = patch->sizeI();
+  int NJ = patch->sizeJ();
+  int NK = patch->sizeK();
+  real h[3] = {patch->dx(), patch->dy(), patch->dz()};
+  real max_change = 0;
+  for (int ii = 0; ii < NI; ++ii) {
+    int i = i_up ? ii : NI - 1 - ii;
+    for (int jj = 0; jj < NJ; ++jj) {
+      int j = j_up ? jj : NJ - 1 - jj;
+      for (int kk = 0; kk < NK; ++kk) {
+        int k = k_up ? kk : NK - 1 - kk;
+        size_t idx = patch->index(i, j, k);
+        if (known[idx]) {
+          continue;
+        }
+
+        // smallest neighbour values in all three directions
+        real a[3];
+        a[0] = min(i > 0 ? u[patch->index(i-1, j, k)] : MAX_REAL, i < NI-1 ? u[patch->index(i+1, j, k)] : MAX_REAL);
+        a[1] = min(j > 0 ? u[patch->index(i, j-1, k)] : MAX_REAL, j < NJ-1 ? u[patch->index(i, j+1, k)] : MAX_REAL);
+        a[2] = min(k > 0 ? u[patch->index(i, j, k-1)] : MAX_REAL, k < NK-1 ? u[patch->index(i, j, k+1)] : MAX_REAL);
+        real b[3] = {h[0], h[1], h[2]};
+
+        // sort ascending
+        for (int l1 = 0; l1 < 2; ++l1) {
+          for (int l2 = 0; l2 < 2 - l1; ++l2) {
+            if (a[l2] > a[l2 + 1]) {
+              swap(a[l2], a[l2 + 1]);
+              swap(b[l2], b[l2 + 1]);
+            }
+          }
+        }
+        if (a[0] >= MAX_REAL) {
+          continue;
+        }
+
+        // Godunov upwind solution of |grad(u)| = 1
+        real u_new = a[0] + b[0];
+        real A = 0;
+        real B = 0;
+        real C = -1;
+        for (int l = 0; l < 3; ++l) {
+          if (l > 0 && u_new <= a[l]) {
+            break;
+          }
+          real w = 1.0/(b[l]*b[l]);
+          A += w;
+          B += w*a[l];
+          C += w*a[l]*a[l];
+          if (l > 0) {
+            real D = B*B - A*C;
+            u_new = (B + sqrt(max(real(0), D)))/A;
+          }
+        }
+        if (u_new < u[idx]) {
+          max_change = max(max_change, u[idx] - u_new);
+          u[idx] = u_new;
+        }
       }
     }
   }
-  interpolate(patch, i_o, j_o, k_o, i_m, j_m, k_m);
+  return max_change;
 }
 
 template <unsigned int DIM, unsigned int IVAR>
-void DiscreteLevelSet<DIM,IVAR>::interpolate(CartesianPatch* patch, size_t i1, size_t j1, size_t k1, size_t i2, size_t j2, size_t k2)
+void DiscreteLevelSet<DIM,IVAR>::fastSweeping(CartesianPatch* patch, const vector<char>& known)
 {
-  real var[DIM];
-  dim_t<DIM> dim;
-
-  real G_111 = computePointLevelSet(patch->xyzoCell(patch->index(i1, j1, k1)));
-  real G_112 = computePointLevelSet(patch->xyzoCell(patch->index(i1, j1, k2)));
-  real G_121 = computePointLevelSet(patch->xyzoCell(patch->index(i1, j2, k1)));
-  real G_122 = computePointLevelSet(patch->xyzoCell(patch->index(i1, j2, k2)));
-  real G_211 = computePointLevelSet(patch->xyzoCell(patch->index(i2, j1, k1)));
-  real G_212 = computePointLevelSet(patch->xyzoCell(patch->index(i2, j1, k2)));
-  real G_221 = computePointLevelSet(patch->xyzoCell(patch->index(i2, j2, k1)));
-  real G_222 = computePointLevelSet(patch->xyzoCell(patch->index(i2, j2, k2)));
-
-  for (size_t i = i1; i <= i2; ++i) {
-    real di = real(i - i1)/real(i2 - i1);
-    real G_i11 = (1-di)*G_111 + di*G_211;
-    real G_i12 = (1-di)*G_112 + di*G_212;
-    real G_i21 = (1-di)*G_121 + di*G_221;
-    real G_i22 = (1-di)*G_122 + di*G_222;
-    for (size_t j = j1; j <= j2; ++j) {
-      real dj = real(j - j1)/real(j2 - j1);
-      real G_ij1 = (1-dj)*G_i11 + dj*G_i21;
-      real G_ij2 = (1-dj)*G_i12 + dj*G_i22;
-      for (size_t k = k1; k <= k2; ++k) {
-        real dk = real(k - k1)/real(k2 - k1);
-        real G_ijk = (1-dk)*G_ij1 + dk*G_ij2;
-        patch->getVar(dim, 0, i, j, k, var);
-        var[IVAR] = G_ijk;
-        patch->setVar(dim, 0, i, j, k, var);
+  // work on |G|, the sign is already known for all cells
+  vector<real> u(patch->variableSize());
+  for (size_t i = 0; i < patch->sizeI(); ++i) {
+    for (size_t j = 0; j < patch->sizeJ(); ++j) {
+      for (size_t k = 0; k < patch->sizeK(); ++k) {
+        u[patch->index(i, j, k)] = fabs(patch->f(m_Field, IVAR, i, j, k));
+      }
+    }
+  }
+  real tol = 1e-3*min(patch->dx(), min(patch->dy(), patch->dz()));
+  for (size_t i_cycle = 0; i_cycle < m_MaxCycles; ++i_cycle) {
+    real max_change = 0;
+    for (int i_sweep = 0; i_sweep < 8; ++i_sweep) {
+      max_change = max(max_change, sweep(patch, known, u, i_sweep & 1, i_sweep & 2, i_sweep & 4));
+    }
+    if (max_change < tol) {
+      break;
+    }
+  }
+  for (size_t i = 0; i < patch->sizeI(); ++i) {
+    for (size_t j = 0; j < patch->sizeJ(); ++j) {
+      for (size_t k = 0; k < patch->sizeK(); ++k) {
+        size_t idx = patch->index(i, j, k);
+        if (!known[idx]) {
+          if (patch->f(m_Field, IVAR, i, j, k) < 0) {
+            patch->f(m_Field, IVAR, i, j, k) = -u[idx];
+          } else {
+            patch->f(m_Field, IVAR, i, j, k) = u[idx];
+          }
+        }
       }
     }
   }
 }
 
 template <unsigned int DIM, unsigned int IVAR>
-real DiscreteLevelSet<DIM,IVAR>::computePointLevelSet(vec3_t x)
+real DiscreteLevelSet<DIM,IVAR>::computePointDistance(vec3_t x, real& normal_sign)
 {
   real g;
   try {
@@ -325,8 +547,9 @@ real DiscreteLevelSet<DIM,IVAR>::computePointLevelSet(vec3_t x)
     vec3_t x_snap = vec3_t(cp[0], cp[1], cp[2]);
     vec3_t v = x - x_snap;
     g = v.abs();
+    normal_sign = 1;
     if (v*m_Normals[id] < 0) {
-      g *= -1;
+      normal_sign = -1;
     }
   } catch (...) {
     ERROR("cannot compute distance");
@@ -335,18 +558,42 @@ real DiscreteLevelSet<DIM,IVAR>::computePointLevelSet(vec3_t x)
 }
 
 template <unsigned int DIM, unsigned int IVAR>
-void DiscreteLevelSet<DIM,IVAR>::levelSetPerCell(size_t i_patch, int& count, int& total_count)
+real DiscreteLevelSet<DIM,IVAR>::computeSign(vec3_t x, real normal_sign)
 {
-  real var[DIM];
-  dim_t<DIM> dim;
-  for (size_t i_cell = 0; i_cell < m_PatchGrid->getPatch(i_patch)->variableSize(); ++i_cell) {
-    vec3_t x = m_PatchGrid->getPatch(i_patch)->xyzoCell(i_cell);
-    m_PatchGrid->getPatch(i_patch)->getVar(dim, 0, i_cell, var);
-    var[IVAR] = DiscreteLevelSet::computePointLevelSet(x);
-    m_PatchGrid->getPatch(i_patch)->setVar(dim, 0, i_cell, var);
+  if (m_UseWindingNumber) {
+    if (m_WindingNumber.isInside(x)) {
+      return -1;
+    }
+    return 1;
+  }
+  return normal_sign;
+}
+
+template <unsigned int DIM, unsigned int IVAR>
+real DiscreteLevelSet<DIM,IVAR>::computePointLevelSet(vec3_t x)
+{
+  real normal_sign;
+  real d = computePointDistance(x, normal_sign);
+  return computeSign(x, normal_sign)*d;
+}
+
+template <unsigned int DIM, unsigned int IVAR>
+void DiscreteLevelSet<DIM,IVAR>::levelSetPerCell(size_t i_patch)
+{
+  Patch* patch = m_PatchGrid->getPatch(i_patch);
+  real* G = patch->getVariable(m_Field, IVAR);
+#ifndef DEBUG
+#pragma omp parallel for
+#endif
+  for (size_t i_cell = 0; i_cell < patch->variableSize(); ++i_cell) {
+    G[i_cell] = computePointLevelSet(patch->xyzoCell(i_cell));
   }
 }
 
+/**
+ * Level set stored in a variable of the patches.
+ * The values are computed by DiscreteLevelSet or loaded from a LevelSetFile.
+ */
 class StoredLevelSet
 {
 
@@ -41,6 +41,7 @@ using namespace std;
 //
 //#define DEBUG
 #define DRNUM_SINGLE_PRECISION
+//#define DRNUM_MIXED_PRECISION   // double accumulation with single precision storage
 
 
 #ifdef __CUDACC__
@@ -59,6 +60,17 @@ using namespace std;
 
 typedef float real;
 
+/**
+ * Type for accumulations (residuals, norms, simulation time, force integrals).
+ * With DRNUM_MIXED_PRECISION the fields are stored and the fluxes are computed in
+ * single precision, while sums over many contributions are carried out in double precision.
+ */
+#ifdef DRNUM_MIXED_PRECISION
+typedef double acc_real;
+#else
+typedef float acc_real;
+#endif
+
 #define MAX_REAL numeric_limits<real>::max()
 #define MIN_REAL numeric_limits<real>::min()
 
@@ -72,6 +84,7 @@ typedef float real;
 #else
 
 typedef double real;
+typedef double acc_real;
 
 inline int posReal2Int(real v)
 {
@@ -48,14 +48,24 @@ SOURCES += \
     patch.cpp \
     blockcfd.cpp \
     cartesianpatch.cpp \
+    cartesianstretchedpatch.cpp \
     codestring.cpp \
     timeintegration.cpp \
     rungekutta.cpp \
+    fieldstatistics.cpp \
+    gastable.cpp \
+    gridpartitioner.cpp \
+    sampler.cpp \
+    telemetry.cpp \
+    hardwarecounters.cpp \
+    patchprofiler.cpp \
+    patchactivitycontroller.cpp \
     patchgrid.cpp \
     patchgroups.cpp \
     math/coordtransform.cpp \
     math/coordtransformvv.cpp \
     transformation.cpp \
+    windingnumber.cpp \
     cartesianraster.cpp \
     structuredhexraster.cpp \
     raster.cpp \
@@ -65,6 +75,7 @@ SOURCES += \
     cubeincartisianpatch.cpp \
     configmap.cpp \
     objectdefinition.cpp \
+    objectprogram.cpp \
     cartboxobject.cpp \
     sphereobject.cpp \
     cylinderobject.cpp \
@@ -78,6 +89,7 @@ SOURCES += \
     coneobject.cpp \
     compressiblesolidwallbobc.cpp \
     levelsetdefinition.cpp \
+    levelsetfile.cpp \
     combilevelset.cpp \
     combilevelsetor.cpp \
     combilevelsetand.cpp \
@@ -87,25 +99,37 @@ SOURCES += \
     conelevelset.cpp \
     spherelevelset.cpp \
     levelsetobject.cpp \
-    levelsetobjectbc.cpp
+    levelsetobjectbc.cpp \
+    levelsetprogram.cpp \
+    lslayercells.cpp \
+    movinglevelset.cpp \
+    sparsebrickgrid.cpp \
+    bricklevelset.cpp \
+    splitfacefile.cpp
 
 HEADERS += \
     blockcfd.h \
+    cartesianlevelsetbc.h \
     cartesianpatch_common.h \
     cartesianpatch.h \
+    cartesianstretchedpatch.h \
     cartesianraster.h \
     codestring.h \
     compressiblevariables.h \
+    cpu_cartesianlevelsetbc.h \
     debug.h \
+    fieldstatistics.h \
     fluxes/ausmdv.h \
     fluxes/ausm.h \
     fluxes/ausmplus.h \
+    fluxes/compressiblecachedviscflux.h \
     fluxes/compressiblefarfieldflux.h \
     fluxes/compressibleflux.h \
     fluxes/compressibleslipflux.h \
     fluxes/compressibleviscflux.h \
     fluxes/compressiblewallflux.h \
     fluxes/knp.h \
+    fluxes/prismaticlayerausmplus.h \
     fluxes/kt.h \
     fluxes/ktmod.h \
     fluxes/roe.h \
@@ -116,9 +140,13 @@ HEADERS += \
     gpu_rungekutta.h \
     intercoeffpad.h \
     intercoeffws.h \
+    levelsetfile.h \
+    levelsetforces.h \
+    iterators/cartesianstretchediterator.h \
     iterators/gpu_cartesianiterator.h \
     iterators/gpu_patchiterator.h \
     iterators/patchiterator.h \
+    iterators/prismaticlayeriterator.h \
     iterators/tpatchiterator.h \
     math/coordtransform.h \
     math/coordtransformvv.h \
@@ -129,11 +157,18 @@ HEADERS += \
     math/mathvector_structs.h \
     math/smallsquarematrix.h \
     patch_common.h \
+    patchactivitycontroller.h \
     patchgrid.h \
     patchgroups.h \
     patch.h \
     perfectgas.h \
+    gastable.h \
+    gridpartitioner.h \
+    tabulatedgas.h \
+    thermallyperfectgas.h \
+    frozenmixturegas.h \
     raster.h \
+    sampler.h \
     reconstruction/minmod.h \
     reconstruction/roelim.h \
     reconstruction/secondorder.h \
@@ -145,13 +180,18 @@ HEADERS += \
     rungekutta.h \
     rungekuttapg1.h \
     structuredhexraster.h \
+    telemetry.h \
+    hardwarecounters.h \
+    patchprofiler.h \
     timeintegration.h \
     tinsecthashraster.h \
     transformation.h \
+    windingnumber.h \
     sparseweightedset.h \
     usparseweightedset.h \
     weightedset.h \
     vectorhashraster.h \
+    viscousgradients.h \
     iterators/cartesianiterator.h \
     prismaticlayerpatch.h \
     iteratorfeeder.h \
@@ -163,6 +203,7 @@ HEADERS += \
     configmap.h \
     cubeincartisianpatch.h \
     objectdefinition.h \
+    objectprogram.h \
     cartboxobject.h \
     cubeincartisianpatch.h \
     cartesiancycliccopy.h \
@@ -189,5 +230,12 @@ HEADERS += \
     spherelevelset.h \
     levelsetobject.h \
     levelsetobjectbc.h \
+    levelsetprogram.h \
     LSLayerData.h \
-    lslayerdataextrapol.h
+    lslayercells.h \
+    lslayerdataextrapol.h \
+    movinglevelset.h \
+    sparsebrickgrid.h \
+    bricklevelset.h \
+    splitfacebuilder.h \
+    splitfacefile.h
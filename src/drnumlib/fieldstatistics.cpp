@@ -0,0 +1,230 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "fieldstatistics.h"
+
+#include <QFile>
+#include <QDataStream>
+
+#ifdef OPEN_MP
+#include <omp.h>
+#endif
+
+FieldStatistics::FieldStatistics(PatchGrid* patch_grid, size_t first_field, size_t interval, size_t num_sub_steps, size_t i_field)
+{
+  m_PatchGrid   = patch_grid;
+  m_IField      = i_field;
+  m_FirstField  = first_field;
+  m_Interval    = max(size_t(1), interval);
+  m_NumSubSteps = max(size_t(1), num_sub_steps);
+  m_DensityVar  = -1;
+  m_NumCalls    = 0;
+  m_NumSamples  = 0;
+  m_NumVars     = 0;
+  if (m_PatchGrid->getNumPatches() > 0) {
+    Patch* patch = m_PatchGrid->getPatch(0);
+    m_NumVars    = patch->numVariables();
+    m_VectorVars = patch->getVectorVarIndices();
+    if (patch->numFields() < m_FirstField + numFields(m_NumVars, m_VectorVars.size())) {
+      ERROR("not enough fields to store statistics");
+    }
+  }
+  reset();
+}
+
+size_t FieldStatistics::numFields(size_t num_vars, size_t num_vector_vars)
+{
+  size_t num_slots = 9*num_vector_vars;
+  return 2 + (num_slots + num_vars - 1)/num_vars;
+}
+
+real* FieldStatistics::slot(Patch* patch, size_t i_slot)
+{
+  return patch->getVariable(m_FirstField + 2 + i_slot/m_NumVars, i_slot%m_NumVars);
+}
+
+void FieldStatistics::reset()
+{
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    Patch* patch = m_PatchGrid->getPatch(i_patch);
+    for (size_t i_field = m_FirstField; i_field < m_FirstField + numFields(m_NumVars, m_VectorVars.size()); ++i_field) {
+      real* data = patch->getField(i_field);
+      for (size_t i = 0; i < patch->fieldSize(); ++i) {
+        data[i] = 0;
+      }
+    }
+  }
+  m_NumSamples = 0;
+}
+
+void FieldStatistics::addSample(Patch* patch)
+{
+  vector<real*> var(m_NumVars);
+  vector<real*> mean(m_NumVars);
+  vector<real*> m2(m_NumVars);
+  for (size_t i_var = 0; i_var < m_NumVars; ++i_var) {
+    var[i_var]  = patch->getVariable(m_IField, i_var);
+    mean[i_var] = patch->getVariable(m_FirstField, i_var);
+    m2[i_var]   = patch->getVariable(m_FirstField + 1, i_var);
+  }
+  vector<real*> vec_slot(9*m_VectorVars.size());
+  for (size_t i_slot = 0; i_slot < vec_slot.size(); ++i_slot) {
+    vec_slot[i_slot] = slot(patch, i_slot);
+  }
+  real ir = 1.0/real(m_NumSamples);
+  int N = patch->variableSize();
+
+#ifndef DEBUG
+  #pragma omp parallel for
+#endif
+  for (int idx = 0; idx < N; ++idx) {
+
+    // mean and M2 of all variables
+    for (size_t i_var = 0; i_var < m_NumVars; ++i_var) {
+      real x     = var[i_var][idx];
+      real delta = x - mean[i_var][idx];
+      mean[i_var][idx] += delta*ir;
+      m2[i_var][idx]   += delta*(x - mean[i_var][idx]);
+    }
+
+    // velocity triples, including co-moments
+    for (size_t i_vec = 0; i_vec < m_VectorVars.size(); ++i_vec) {
+      real** S = &vec_slot[9*i_vec];
+      real u[3], d_old[3], d_new[3];
+      for (int i_dim = 0; i_dim < 3; ++i_dim) {
+        u[i_dim] = var[m_VectorVars[i_vec] + i_dim][idx];
+        if (m_DensityVar >= 0) {
+          u[i_dim] /= var[m_DensityVar][idx];
+        }
+        d_old[i_dim] = u[i_dim] - S[i_dim][idx];
+        S[i_dim][idx] += d_old[i_dim]*ir;
+        d_new[i_dim] = u[i_dim] - S[i_dim][idx];
+        S[3 + i_dim][idx] += d_old[i_dim]*d_new[i_dim];
+      }
+      S[6][idx] += d_old[0]*d_new[1];
+      S[7][idx] += d_old[0]*d_new[2];
+      S[8][idx] += d_old[1]*d_new[2];
+    }
+  }
+  countFlops(N*(5*m_NumVars + 27*m_VectorVars.size()));
+}
+
+void FieldStatistics::sample()
+{
+  ++m_NumSamples;
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    addSample(m_PatchGrid->getPatch(i_patch));
+  }
+}
+
+void FieldStatistics::operator()()
+{
+  ++m_NumCalls;
+  if (m_NumCalls % (m_Interval*m_NumSubSteps) == 0) {
+    sample();
+  }
+}
+
+void FieldStatistics::computeRms(size_t i_dst)
+{
+  real ir = 1.0/real(max(size_t(1), m_NumSamples));
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    Patch* patch = m_PatchGrid->getPatch(i_patch);
+    for (size_t i_var = 0; i_var < m_NumVars; ++i_var) {
+      real* m2  = patch->getVariable(m_FirstField + 1, i_var);
+      real* dst = patch->getVariable(i_dst, i_var);
+      for (size_t idx = 0; idx < patch->variableSize(); ++idx) {
+        dst[idx] = sqrt(max(real(0), m2[idx]*ir));
+      }
+    }
+  }
+}
+
+void FieldStatistics::computeReynoldsStresses(size_t i_vec, size_t i_dst)
+{
+  if (i_vec >= m_VectorVars.size() || m_NumVars < 6) {
+    BUG;
+  }
+  real ir = 1.0/real(max(size_t(1), m_NumSamples));
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    Patch* patch = m_PatchGrid->getPatch(i_patch);
+    for (size_t i = 0; i < 6; ++i) {
+      real* src = slot(patch, 9*i_vec + 3 + i);
+      real* dst = patch->getVariable(i_dst, i);
+      for (size_t idx = 0; idx < patch->variableSize(); ++idx) {
+        dst[idx] = src[idx]*ir;
+      }
+    }
+  }
+}
+
+QString FieldStatistics::counterFileName(QString base_file_name, int count)
+{
+  QString count_txt;
+  count_txt.setNum(count);
+  count_txt = count_txt.rightJustified(6, '0');
+  return base_file_name + "_stat_" + count_txt + ".dnc";
+}
+
+void FieldStatistics::write(QString base_file_name, int count)
+{
+  size_t num_fields = numFields(m_NumVars, m_VectorVars.size());
+  for (size_t i = 0; i < num_fields; ++i) {
+    QString i_txt;
+    i_txt.setNum(int(i));
+    m_PatchGrid->writeData(m_FirstField + i, base_file_name + "_stat" + i_txt, real(m_NumSamples), count);
+  }
+
+  // the counters do not fit into a 'real' for long runs -- store them separately
+  QFile file(counterFileName(base_file_name, count));
+  if (!file.open(QIODevice::WriteOnly)) {
+    ERROR("unable to write statistics counters");
+  }
+  QDataStream stream(&file);
+  stream << quint64(m_NumCalls) << quint64(m_NumSamples);
+}
+
+void FieldStatistics::read(QString base_file_name, int count)
+{
+  QString count_txt;
+  count_txt.setNum(count);
+  count_txt = count_txt.rightJustified(6, '0');
+  size_t num_fields = numFields(m_NumVars, m_VectorVars.size());
+  for (size_t i = 0; i < num_fields; ++i) {
+    QString i_txt;
+    i_txt.setNum(int(i));
+    real num_samples = m_PatchGrid->readData(m_FirstField + i, base_file_name + "_stat" + i_txt + "_" + count_txt);
+    m_NumSamples = size_t(num_samples + 0.5);
+  }
+  QFile file(counterFileName(base_file_name, count));
+  if (file.open(QIODevice::ReadOnly)) {
+    QDataStream stream(&file);
+    quint64 num_calls, num_samples;
+    stream >> num_calls >> num_samples;
+    if (stream.status() != QDataStream::Ok) {
+      ERROR("corrupt statistics counter file");
+    }
+    m_NumCalls   = size_t(num_calls);
+    m_NumSamples = size_t(num_samples);
+  } else {
+    // restart data without a counter file: assume the last call added a sample
+    m_NumCalls = m_NumSamples*m_Interval*m_NumSubSteps;
+  }
+}
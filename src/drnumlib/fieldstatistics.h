@@ -0,0 +1,142 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef FIELDSTATISTICS_H
+#define FIELDSTATISTICS_H
+
+#include "drnum.h"
+#include "genericoperation.h"
+#include "patchgrid.h"
+
+#include <QString>
+
+/**
+ * Running statistics of all variables of a field (mean and second moments).
+ *
+ * The statistics are accumulated with Welford's algorithm, so no samples have
+ * to be kept and the second moments do not suffer from cancellation. The data
+ * live in additional fields of the patches, starting at first_field:
+ *
+ *  first_field     : mean of all variables
+ *  first_field + 1 : sum of squared deviations (M2) of all variables
+ *  first_field + 2 : velocity block, 9 slots per vector variable, packed over
+ *                    as many fields as needed:
+ *                    mean(u,v,w), M2(uu,vv,ww), co-moments(uv,uw,vw)
+ *
+ * Velocities are the vector variables declared with PatchGrid::defineVectorVar,
+ * divided by the density variable if one has been set (setDensityVar). Hence
+ * the Reynolds stresses are <u'v'> = co-moment/n.
+ *
+ * As a post-operation of an s-stage Runge-Kutta scheme the operation is called
+ * s times per time step; only the last call of every interval*s calls adds a sample.
+ */
+class FieldStatistics : public GenericOperation
+{
+
+protected: // attributes
+
+  PatchGrid*     m_PatchGrid;
+  size_t         m_IField;        ///< field to take samples from
+  size_t         m_FirstField;    ///< first field holding statistics
+  size_t         m_NumVars;
+  vector<size_t> m_VectorVars;    ///< start indices of vector variables
+  int            m_DensityVar;    ///< index of the density variable (-1: none)
+  size_t         m_Interval;      ///< sample every m_Interval time steps
+  size_t         m_NumSubSteps;   ///< number of calls per time step
+  size_t         m_NumCalls;      ///< number of calls, persisted for restarts
+  size_t         m_NumSamples;    ///< number of samples, persisted for restarts
+
+
+protected: // methods
+
+  real*   slot(Patch* patch, size_t i_slot);
+  void    addSample(Patch* patch);
+  QString counterFileName(QString base_file_name, int count);
+
+
+public: // methods
+
+  /**
+   * @param patch_grid the grid
+   * @param first_field first field to store statistics in
+   * @param interval sample every interval-th time step
+   * @param num_sub_steps number of calls per time step (e.g. Runge-Kutta stages)
+   * @param i_field the field to take samples from
+   */
+  FieldStatistics(PatchGrid* patch_grid, size_t first_field, size_t interval = 1, size_t num_sub_steps = 1, size_t i_field = 0);
+
+  /**
+   * Number of additional fields required for the statistics.
+   * @param num_vars number of variables per field
+   * @param num_vector_vars number of vector variables
+   * @return number of fields
+   */
+  static size_t numFields(size_t num_vars, size_t num_vector_vars);
+
+  void setDensityVar(int i_var) { m_DensityVar = i_var; }
+
+  /**
+   * Reset all statistics to zero.
+   */
+  void reset();
+
+  /**
+   * Add a sample of the current solution, regardless of the interval.
+   */
+  void sample();
+
+  virtual void operator()();
+
+  size_t numSamples() { return m_NumSamples; }
+
+  /**
+   * Compute the root mean square of the fluctuations of all variables.
+   * @param i_dst the destination field
+   */
+  void computeRms(size_t i_dst);
+
+  /**
+   * Compute the velocity covariances (Reynolds stresses) of a vector variable.
+   * Variables 0..5 of the destination are set to uu, vv, ww, uv, uw, vw.
+   * @param i_vec the index of the vector variable (in order of definition)
+   * @param i_dst the destination field
+   */
+  void computeReynoldsStresses(size_t i_vec, size_t i_dst);
+
+  /**
+   * Write the statistics for a later restart. The fields are written with
+   * PatchGrid::writeData (bitwise, in the precision of 'real'); the call and
+   * sample counters go to an additional file (base_file_name_stat_count.dnc)
+   * as 64 bit integers, so they survive the round trip exactly.
+   * @param base_file_name base name of the files (one file per field)
+   * @param count the output counter
+   */
+  void write(QString base_file_name, int count);
+
+  /**
+   * Read the statistics written by write().
+   * @param base_file_name base name of the files
+   * @param count the output counter
+   */
+  void read(QString base_file_name, int count);
+
+};
+
+#endif // FIELDSTATISTICS_H
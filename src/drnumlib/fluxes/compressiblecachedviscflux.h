@@ -0,0 +1,278 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef COMPRESSIBLECACHEDVISCFLUX_H
+#define COMPRESSIBLECACHEDVISCFLUX_H
+
+#include "fluxes/compressibleflux.h"
+#include "cartesianpatch.h"
+#include "viscousgradients.h"
+
+/**
+ * Viscous flux for Cartesian patches which reads cell gradients from ViscousGradients.
+ * computeGradients has to be called for each patch before the face loops (CartesianIterator
+ * does this automatically); it stores u, v, w, T, their central gradients and mu, mu_t and k
+ * for every cell. A face then only needs two cell indices: the normal derivatives are
+ * differences of the neighbouring cells and the tangential derivatives are the averages of
+ * the cached cell gradients. Compared to CompressibleViscFlux/CompressibleSmagorinskyFlux
+ * this avoids evaluating each tangential gradient and mu four times per stage.
+ * Directions with two cells or less are treated as degenerate (zero gradient).
+ * CS > 0 adds the Smagorinsky eddy viscosity with c_s = 1e-4*CS and Pr_t = 0.85.
+ * Host only; GPU iterators have to use the uncached fluxes.
+ */
+template <unsigned int DIM, typename TGas, unsigned int CS = 0>
+class CompressibleCachedViscFlux : public CompressibleFlux<DIM, TGas>
+{
+
+protected: // attributes
+
+  ViscousGradients* m_Gradients;
+
+
+protected: // methods
+
+  static real cellGrad(real* phi, size_t idx, size_t stride, size_t i, size_t n, real h);
+
+  void faceFlux(size_t idx_l, size_t idx_r, size_t dir, real D, real A, real* flux);
+
+
+public: // data types
+
+  typedef ViscousGradients gradient_cache_t;
+
+
+public: // methods
+
+  CompressibleCachedViscFlux() : m_Gradients(NULL) {}
+
+  template <typename PATCH> void computeGradients(PATCH *patch, ViscousGradients* gradients);
+
+  template <typename PATCH> void xField(PATCH *patch, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+  {
+    faceFlux(patch->index(i-1, j, k), patch->index(i, j, k), 0, (real)1.0/patch->dx(), A, flux);
+  }
+
+  template <typename PATCH> void yField(PATCH *patch, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+  {
+    faceFlux(patch->index(i, j-1, k), patch->index(i, j, k), 1, (real)1.0/patch->dy(), A, flux);
+  }
+
+  template <typename PATCH> void zField(PATCH *patch, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
+  {
+    faceFlux(patch->index(i, j, k-1), patch->index(i, j, k), 2, (real)1.0/patch->dz(), A, flux);
+  }
+
+  template <typename PATCH> void splitFlux(PATCH *patch, splitface_t sf, real* flux);
+
+};
+
+/**
+ * Convenience name matching the template arguments of CompressibleSmagorinskyFlux.
+ */
+template <unsigned int DIM, unsigned int CS, typename TGas>
+class CompressibleCachedSmagorinskyFlux : public CompressibleCachedViscFlux<DIM, TGas, CS>
+{
+};
+
+
+template <unsigned int DIM, typename TGas, unsigned int CS>
+inline real CompressibleCachedViscFlux<DIM, TGas, CS>::cellGrad(real* phi, size_t idx, size_t stride, size_t i, size_t n, real h)
+{
+  if (n <= 2) {
+    return 0;
+  }
+  size_t idx1 = idx;
+  size_t idx2 = idx;
+  real   dist = 0;
+  if (i > 0) {
+    idx1 -= stride;
+    dist += h;
+  }
+  if (i + 1 < n) {
+    idx2 += stride;
+    dist += h;
+  }
+  countFlops(2);
+  return (phi[idx2] - phi[idx1])/dist;
+}
+
+template <unsigned int DIM, typename TGas, unsigned int CS>
+template <typename PATCH>
+void CompressibleCachedViscFlux<DIM, TGas, CS>::computeGradients(PATCH *patch, ViscousGradients* gradients)
+{
+  m_Gradients = gradients;
+
+  int    NI = patch->sizeI();
+  size_t NJ = patch->sizeJ();
+  size_t NK = patch->sizeK();
+  gradients->resize(NI*NJ*NK);
+
+  // primitive variables and laminar transport coefficients
+  #ifndef DEBUG
+  #pragma omp parallel for
+  #endif
+  for (int i = 0; i < NI; ++i) {
+    dim_t<DIM> dim;
+    real var[DIM];
+    for (size_t j = 0; j < NJ; ++j) {
+      for (size_t k = 0; k < NK; ++k) {
+        size_t idx = patch->index(i, j, k);
+        real p, T, u, v, w;
+        patch->getVar(dim, 0, i, j, k, var);
+        TGas::conservativeToPrimitive(var, p, T, u, v, w);
+        real mu = TGas::mu(var);
+        gradients->f(ViscousGradients::U, idx)    = u;
+        gradients->f(ViscousGradients::V, idx)    = v;
+        gradients->f(ViscousGradients::W, idx)    = w;
+        gradients->f(ViscousGradients::T, idx)    = T;
+        gradients->f(ViscousGradients::MU, idx)   = mu;
+        gradients->f(ViscousGradients::MU_T, idx) = 0;
+        gradients->f(ViscousGradients::K, idx)    = mu*TGas::cp(var)/TGas::Pr(var);
+        countFlops(3);
+      }
+    }
+  }
+
+  // gradients and eddy viscosity
+  size_t stride[3] = { NJ*NK, NK, 1 };
+  real   h[3]      = { patch->dx(), patch->dy(), patch->dz() };
+  #ifndef DEBUG
+  #pragma omp parallel for
+  #endif
+  for (int i = 0; i < NI; ++i) {
+    for (size_t j = 0; j < NJ; ++j) {
+      for (size_t k = 0; k < NK; ++k) {
+        size_t idx = patch->index(i, j, k);
+        size_t ijk[3] = { size_t(i), j, k };
+        size_t n[3]   = { size_t(NI), NJ, NK };
+        for (size_t i_comp = 0; i_comp < 4; ++i_comp) {
+          real* phi = gradients->field(ViscousGradients::U + i_comp);
+          for (size_t dir = 0; dir < 3; ++dir) {
+            gradients->f(ViscousGradients::DU_DX + 3*i_comp + dir, idx) = cellGrad(phi, idx, stride[dir], ijk[dir], n[dir], h[dir]);
+          }
+        }
+        if (CS > 0) {
+          real du_dx = gradients->f(ViscousGradients::DU_DX, idx);
+          real du_dy = gradients->f(ViscousGradients::DU_DY, idx);
+          real du_dz = gradients->f(ViscousGradients::DU_DZ, idx);
+          real dv_dx = gradients->f(ViscousGradients::DV_DX, idx);
+          real dv_dy = gradients->f(ViscousGradients::DV_DY, idx);
+          real dv_dz = gradients->f(ViscousGradients::DV_DZ, idx);
+          real dw_dx = gradients->f(ViscousGradients::DW_DX, idx);
+          real dw_dy = gradients->f(ViscousGradients::DW_DY, idx);
+          real dw_dz = gradients->f(ViscousGradients::DW_DZ, idx);
+          dim_t<DIM> dim;
+          real var[DIM];
+          patch->getVar(dim, 0, i, j, k, var);
+          real cs  = 1e-4*real(CS);
+          real S   = sqr(du_dx) + sqr(du_dy + dv_dx) + sqr(du_dz + dw_dx) + sqr(dv_dy) + sqr(dv_dz + dw_dy) + sqr(dw_dz);
+          real mut = var[0]*sqr(cs*patch->dx())*sqrt(S);
+          gradients->f(ViscousGradients::MU_T, idx) = mut;
+          gradients->f(ViscousGradients::K, idx)   += mut*TGas::cp(var)/0.85;
+          countFlops(25);
+          countSqrts(1);
+        }
+      }
+    }
+  }
+}
+
+template <unsigned int DIM, typename TGas, unsigned int CS>
+inline void CompressibleCachedViscFlux<DIM, TGas, CS>::faceFlux(size_t idx_l, size_t idx_r, size_t dir, real D, real A, real* flux)
+{
+#ifdef DEBUG
+  if (!m_Gradients) {
+    BUG;
+  }
+#endif
+  ViscousGradients& G = *m_Gradients;
+
+  // face velocity and velocity gradient tensor grad[a][b] = d(u_a)/d(x_b)
+  real U[3], grad[3][3];
+  for (size_t a = 0; a < 3; ++a) {
+    real u_l = G.f(ViscousGradients::U + a, idx_l);
+    real u_r = G.f(ViscousGradients::U + a, idx_r);
+    U[a] = (real)0.5*(u_l + u_r);
+    for (size_t b = 0; b < 3; ++b) {
+      grad[a][b] = (real)0.5*(G.f(ViscousGradients::DU_DX + 3*a + b, idx_l) + G.f(ViscousGradients::DU_DX + 3*a + b, idx_r));
+    }
+    grad[a][dir] = (u_r - u_l)*D;
+  }
+  real dT = (G.f(ViscousGradients::T, idx_r) - G.f(ViscousGradients::T, idx_l))*D;
+  real mu = (real)0.5*(  G.f(ViscousGradients::MU, idx_l) + G.f(ViscousGradients::MU_T, idx_l)
+                       + G.f(ViscousGradients::MU, idx_r) + G.f(ViscousGradients::MU_T, idx_r));
+  real k_heat = (real)0.5*(G.f(ViscousGradients::K, idx_l) + G.f(ViscousGradients::K, idx_r));
+  countFlops(38);
+
+  // tensions on the face
+  real div_u = grad[0][0] + grad[1][1] + grad[2][2];
+  real tau[3];
+  for (size_t a = 0; a < 3; ++a) {
+    tau[a] = mu*(grad[a][dir] + grad[dir][a]);
+  }
+  tau[dir] -= FR23*mu*div_u;
+  countFlops(14);
+
+  // heat flux
+  real q_dot = k_heat*dT;
+  countFlops(2);
+
+  // The viscous fluxes for the cons. quantities
+  flux[1] -= tau[0]*A;
+  flux[2] -= tau[1]*A;
+  flux[3] -= tau[2]*A;
+  flux[4] -= (tau[0]*U[0] + tau[1]*U[1] + tau[2]*U[2] + q_dot)*A;
+  countFlops(14);
+}
+
+template <unsigned int DIM, typename TGas, unsigned int CS>
+template <typename PATCH>
+void CompressibleCachedViscFlux<DIM, TGas, CS>::splitFlux(PATCH *patch, splitface_t sf, real* flux)
+{
+  real u = m_Gradients->f(ViscousGradients::U, sf.idx);
+  real v = m_Gradients->f(ViscousGradients::V, sf.idx);
+  real w = m_Gradients->f(ViscousGradients::W, sf.idx);
+  real u_abs = sqrt(u*u + v*v + w*w);
+  real scal = u*sf.wnx + v*sf.wny + w*sf.wnz;
+  u -= scal*sf.wnx;
+  v -= scal*sf.wny;
+  w -= scal*sf.wnz;
+  real u_tgt = sqrt(u*u + v*v + w*w);
+
+  if (u_tgt/u_abs < 1e-3 || u_abs < 1e-6) {
+    return;
+  }
+
+  real rho    = patch->getVariable(0, 0)[sf.idx];
+  real y_plus = 20;
+  real u_tau  = 0;
+  real mu     = m_Gradients->f(ViscousGradients::MU, sf.idx);
+  real y_wall = sf.dist;
+  for (int iter = 0; iter < 10; ++iter) {
+    y_plus = max(real(20.0), u_tau*y_wall*rho/mu);
+    u_tau  = u_tgt/(log(y_plus)/0.41 + 5.0);
+  }
+  real tau_wall = rho*u_tau*u_tau*sqrt(sf.nx*sf.nx + sf.ny*sf.ny + sf.nz*sf.nz);
+  flux[1] -= u/u_tgt * tau_wall;
+  flux[2] -= v/u_tgt * tau_wall;
+  flux[3] -= w/u_tgt * tau_wall;
+}
+
+#endif // COMPRESSIBLECACHEDVISCFLUX_H
@@ -29,8 +29,8 @@
   real p1, T1, u1, v1, w1; \
   TGas::conservativeToPrimitive(m_Var, p0, T0, u0, v0, w0); \
   TGas::conservativeToPrimitive(var1, p1, T1, u1, v1, w1); \
-  real a0 = CHECKED_REAL(sqrt(TGas::gamma()*TGas::R()*T0)); \
-  real a1 = CHECKED_REAL(sqrt(TGas::gamma()*TGas::R()*T1));
+  real a0 = CHECKED_REAL(sqrt(TGas::gamma(m_Var)*TGas::R(m_Var)*T0)); \
+  real a1 = CHECKED_REAL(sqrt(TGas::gamma(var1)*TGas::R(var1)*T1));
 
 #define FARFIELD_SPLIT \
   real M = real(0.5)*(M0 + M1);  \
@@ -64,6 +64,13 @@
     } \
   }
 
+// face state; the total enthalpy is taken from the conservative variables, in order to
+// match the caloric model of the gas (e.g. TabulatedGas)
+#define FARFIELD_FACE \
+  real var_face[5]; \
+  TGas::primitiveToConservative(p, T, u, v, w, var_face); \
+  real H = (var_face[4] + p)/var_face[0];
+
 template <unsigned int DIM, typename TReconstruction, typename TGas>
 class CompressibleFarfieldFlux
 {
@@ -98,11 +105,12 @@ public:
     real M0 = -CHECKED_REAL(u0/a0);
     real M1 = -CHECKED_REAL(u1/a1);
     FARFIELD_SPLIT
-    flux[0] = A*p/(TGas::R()*T)*u;
+    FARFIELD_FACE
+    flux[0] = A*var_face[0]*u;
     flux[1] = flux[0]*u + A*p;
     flux[2] = flux[0]*v;
     flux[3] = flux[0]*w;
-    flux[4] = flux[0]*(TGas::cp()*T + 0.5*(u*u + v*v + w*w));
+    flux[4] = flux[0]*H;
   }
 
   template <typename PATCH> CUDA_DH void xWallM(PATCH *patch, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
@@ -113,11 +121,12 @@ public:
     real M0 = CHECKED_REAL(u0/a0);
     real M1 = CHECKED_REAL(u1/a1);
     FARFIELD_SPLIT
-    flux[0] = A*p/(TGas::R()*T)*u;
+    FARFIELD_FACE
+    flux[0] = A*var_face[0]*u;
     flux[1] = flux[0]*u + A*p;
     flux[2] = flux[0]*v;
     flux[3] = flux[0]*w;
-    flux[4] = flux[0]*(TGas::cp()*T + 0.5*(u*u + v*v + w*w));
+    flux[4] = flux[0]*H;
   }
 
   template <typename PATCH> CUDA_DH void yWallP(PATCH *patch, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
@@ -128,11 +137,12 @@ public:
     real M0 = -CHECKED_REAL(v0/a0);
     real M1 = -CHECKED_REAL(v1/a1);
     FARFIELD_SPLIT
-    flux[0] = A*p/(TGas::R()*T)*v;
+    FARFIELD_FACE
+    flux[0] = A*var_face[0]*v;
     flux[1] = flux[0]*u;
     flux[2] = flux[0]*v + A*p;
     flux[3] = flux[0]*w;
-    flux[4] = flux[0]*(TGas::cp()*T + 0.5*(u*u + v*v + w*w));
+    flux[4] = flux[0]*H;
   }
 
   template <typename PATCH> CUDA_DH void yWallM(PATCH *patch, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
@@ -143,11 +153,12 @@ public:
     real M0 = CHECKED_REAL(v0/a0);
     real M1 = CHECKED_REAL(v1/a1);
     FARFIELD_SPLIT
-    flux[0] = A*p/(TGas::R()*T)*v;
+    FARFIELD_FACE
+    flux[0] = A*var_face[0]*v;
     flux[1] = flux[0]*u;
     flux[2] = flux[0]*v + A*p;
     flux[3] = flux[0]*w;
-    flux[4] = flux[0]*(TGas::cp()*T + 0.5*(u*u + v*v + w*w));
+    flux[4] = flux[0]*H;
   }
 
   template <typename PATCH> CUDA_DH void zWallP(PATCH *patch, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
@@ -158,11 +169,12 @@ public:
     real M0 = -CHECKED_REAL(w0/a0);
     real M1 = -CHECKED_REAL(w1/a1);
     FARFIELD_SPLIT
-    flux[0] = A*p/(TGas::R()*T)*w;
+    FARFIELD_FACE
+    flux[0] = A*var_face[0]*w;
     flux[1] = flux[0]*u;
     flux[2] = flux[0]*v;
     flux[3] = flux[0]*w + A*p;
-    flux[4] = flux[0]*(TGas::cp()*T + 0.5*(u*u + v*v + w*w));
+    flux[4] = flux[0]*H;
   }
 
   template <typename PATCH> CUDA_DH void zWallM(PATCH *patch, size_t i, size_t j, size_t k, real x, real y, real z, real A, real* flux)
@@ -173,11 +185,12 @@ public:
     real M0 = CHECKED_REAL(w0/a0);
     real M1 = CHECKED_REAL(w1/a1);
     FARFIELD_SPLIT
-    flux[0] = A*p/(TGas::R()*T)*w;
+    FARFIELD_FACE
+    flux[0] = A*var_face[0]*w;
     flux[1] = flux[0]*u;
     flux[2] = flux[0]*v;
     flux[3] = flux[0]*w + A*p;
-    flux[4] = flux[0]*(TGas::cp()*T + 0.5*(u*u + v*v + w*w));
+    flux[4] = flux[0]*H;
   }
 
 };
@@ -151,84 +151,41 @@ protected: // methods
       idx0 = idx;
     }
 
-    patch->getVar(dim, i_field, idx0, var);
+    patch->getVar(dim, i_field, i0, j0, k0, var);
+    return true;
   }
 
 
 public: // methods
 
+  /**
+   * Inviscid flux across a split face (slip wall).
+   * The face is closed: there is no mass and energy flux and the face pressure is the pressure
+   * of the (linearised) Riemann problem between the cell and its mirrored state.
+   * @param patch the patch
+   * @param sf the split face
+   * @param flux the flux will be added to this array (mass, momentum, energy)
+   */
   template <typename PATCH> CUDA_DH void splitFlux(PATCH *patch, splitface_t sf, real* flux)
   {
-    /*
-    real var_field[DIM];
-    real var_cell[DIM];
-    real var_face[DIM];
-    dim_t<DIM> dim;
-    fieldVar(patch, 0, sf.idx, sf.idx_neigh, var_field);
-    patch->getVar(dim, 0, sf.idx, var_cell);
-
-    real p_field, u_field, v_field, w_field, T_field;
-    real p_cell, u_cell, v_cell, w_cell, T_cell;
-    TGas::conservativeToPrimitive(var_field, p_field, T_field, u_field, v_field, w_field);
-    TGas::conservativeToPrimitive(var_cell, p_cell, T_cell, u_cell, v_cell, w_cell);
-
-    //real u_abs_field  = sqrt(sqr(u_field) + sqr(v_field) + sqr(w_field));
-    //real u_abs_cell   = sqrt(sqr(u_cell) + sqr(v_cell) + sqr(w_cell));
-    //real u_norm_field = u_field*sf.wnx + v_field*sf.wny + w_field*sf.wnz;
-    //real u_norm_cell  = u_cell*sf.wnx + v_cell*sf.wny + w_cell*sf.wnz;
-    //real u_tang_field = sqrt(sqr(u_abs_field) - sqr(u_norm_field));
-    //real u_tang_cell  = sqrt(sqr(u_abs_cell) - sqr(u_norm_cell));
-
-    real A = sqrt(sqr(sf.nx) + sqr(sf.ny) + sqr(sf.nz));
-    real nx0 = sf.nx/A;
-    real ny0 = sf.ny/A;
-    real nz0 = sf.nz/A;
-    real wgt  = 0.0;
-
-    real Fwgt = 1.0;
-    real F_field = var_field[0]*sqr(u_field*nx0 + v_field*ny0 + w_field*nz0) + p_field;
-    real F_cell = var_cell[0]*sqr(u_cell*nx0 + v_cell*ny0 + w_cell*nz0) + p_cell;
-    real F = Fwgt*F_cell + (1.0 - Fwgt)*F_field;
-
-    //real u_norm_face = FR13*(1.0 - sf.h1)*u_norm_field;
-    real p_face = wgt*p_field + (1.0 - wgt)*p_cell;
-    real T_face = wgt*T_field + (1.0 - wgt)*T_cell;
-    real u_face = wgt*u_field + (1.0 - wgt)*u_cell;
-    real v_face = wgt*v_field + (1.0 - wgt)*v_cell;
-    real w_face = wgt*w_field + (1.0 - wgt)*w_cell;
-    real scal = u_face*sf.wnx + v_face*sf.wny + w_face*sf.wnz;
-    u_face -= scal*sf.wnx;
-    v_face -= scal*sf.wny;
-    w_face -= scal*sf.wnz;
-    real un_face = u_face*nx0 + v_face*ny0 + w_face*nz0;
-    real RT = TGas::R(var_cell)*T_face;
-    real pwgt = fabs(nx0*sf.wnx + ny0*sf.wny + nz0*sf.wnz);
-    p_face = pwgt*p_face + (1.0 - pwgt)*F*RT/(sqr(un_face) + RT);
-    //u_face += u_norm_face*sf.wnx;
-    //v_face += u_norm_face*sf.wny;
-    //w_face += u_norm_face*sf.wnz;
-
-    TGas::primitiveToConservative(p_face, T_face, u_face, v_face, w_face, var_face);
-
-    real r_face  = var_face[0];
-    real rE_face = var_face[4];
-
-    real h_face = (rE_face + p_face)/r_face;
-    real flux_0;
-
-    flux_0   = r_face*u_face*sf.nx + r_face*v_face*sf.ny + r_face*w_face*sf.nz;
-    flux[0] += flux_0;
-    flux[1] += (r_face*u_face*r_face*u_face + p_face)*sf.nx +                   r_face*u_face*v_face*sf.ny +                   r_face*u_face*w_face*sf.nz;
-    flux[2] +=                   r_face*u_face*v_face*sf.nx + (r_face*v_face*r_face*v_face + p_face)*sf.ny +                   r_face*v_face*w_face*sf.nz;
-    flux[3] +=                   r_face*u_face*w_face*sf.nx +                   r_face*v_face*w_face*sf.ny + (r_face*w_face*r_face*w_face + p_face)*sf.nz;
-    flux[4] += h_face*flux_0;
-    */
-    real var_field[DIM];
-    real var_cell[DIM];
-    real var_face[DIM];
+    real var[DIM];
     dim_t<DIM> dim;
-    fieldVar(patch, 0, sf.idx, sf.idx_neigh, var_field);
-    patch->getVar(dim, 0, sf.idx, var_cell);
+    size_t i, j, k;
+    patch->ijk(sf.idx, i, j, k);
+    patch->getVar(dim, 0, i, j, k, var);
+    COMPR_VARS;
+
+    // velocity component along the face normal (pointing into the cell)
+    real A  = sqrt(sqr(sf.nx) + sqr(sf.ny) + sqr(sf.nz));
+    real un = (u*sf.nx + v*sf.ny + w*sf.nz)/A;
+    real a  = CHECKED_REAL(sqrt(TGas::gamma(var)*TGas::R(var)*T));
+
+    real p_face = p - r*a*un;
+    flux[1] += p_face*sf.nx;
+    flux[2] += p_face*sf.ny;
+    flux[3] += p_face*sf.nz;
+    countFlops(21);
+    countSqrts(2);
   }
 
 };
@@ -292,7 +292,9 @@ public: // methods
   {
     real var[DIM];
     dim_t<DIM> dim;
-    patch->getVar(dim, 0, sf.idx, var);
+    size_t i, j, k;
+    patch->ijk(sf.idx, i, j, k);
+    patch->getVar(dim, 0, i, j, k, var);
     real u = var[1]/var[0];
     real v = var[2]/var[0];
     real w = var[3]/var[0];
@@ -312,7 +314,7 @@ public: // methods
     real mu = TGas::mu(var);
     real y_wall = sf.dist;//sf.wnx*patch->dx() + sf.wny*patch->dy() + sf.wnz*patch->dx();
     for (int iter = 0; iter < 10; ++iter) {
-      y_plus = max(20.0, u_tau*y_wall*var[0]/mu);
+      y_plus = max(real(20.0), u_tau*y_wall*var[0]/mu);
       u_tau  = u_tgt/(log(y_plus)/0.41 + 5.0);
     }
     real tau_wall = var[0]*u_tau*u_tau*sqrt(sf.nx*sf.nx + sf.ny*sf.ny + sf.nz*sf.nz);
@@ -0,0 +1,104 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef PRISMATICLAYERAUSMPLUS_H
+#define PRISMATICLAYERAUSMPLUS_H
+
+#include "fluxes/compressibleflux.h"
+#include "prismaticlayerpatch.h"
+
+/**
+ * First order AUSM+ operation for PrismaticLayerIterator.
+ * The reference surface is an inviscid (slip) wall, outer and lateral boundaries
+ * use the cell values on both sides (the seek layers get overwritten by donor data anyway).
+ */
+template <unsigned int DIM, typename TGas>
+class PrismaticLayerAusmPlus : public CompressibleFlux<DIM, TGas>
+{
+
+protected: // methods
+
+  using CompressibleFlux<DIM, TGas>::M4;
+  using CompressibleFlux<DIM, TGas>::P5;
+
+  void ausmFlux(real* var_l, real* var_r, const vec3_t& n, real* flux)
+  {
+    COMPRESSIBLE_LEFT_VARS;
+    COMPRESSIBLE_RIGHT_VARS;
+
+    real A  = n.abs();
+    real nx = n[0]/A;
+    real ny = n[1]/A;
+    real nz = n[2]/A;
+    real U_l = u_l*nx + v_l*ny + w_l*nz;
+    real U_r = u_r*nx + v_r*ny + w_r*nz;
+    countFlops(15);
+    countSqrts(1);
+
+    real a    = FR12*(a_l + a_r);
+    real M    = M4(U_l/a, 1) + M4(U_r/a, -1);
+    real Mp   = FR12*(M + fabs(M));
+    real Mm   = FR12*(M - fabs(M));
+    real p    = P5(U_l/a, 1)*p_l + P5(U_r/a, -1)*p_r;
+    countFlops(14);
+
+    flux[0] += a*A*(r_l*Mp + r_r*Mm);
+    flux[1] += FR12*flux[0]*(u_l + u_r) + nx*A*p - FR12*fabs(flux[0])*(u_r - u_l);
+    flux[2] += FR12*flux[0]*(v_l + v_r) + ny*A*p - FR12*fabs(flux[0])*(v_r - v_l);
+    flux[3] += FR12*flux[0]*(w_l + w_r) + nz*A*p - FR12*fabs(flux[0])*(w_r - w_l);
+    flux[4] += FR12*flux[0]*(H_l + H_r)          - FR12*fabs(flux[0])*(H_r - H_l);
+    countFlops(42);
+  }
+
+
+public: // methods
+
+  void innerFlux(PrismaticLayerPatch* patch, size_t l1, size_t l2, const vec3_t&, const vec3_t& n, real* flux)
+  {
+    real var_l[DIM], var_r[DIM];
+    dim_t<DIM> dim;
+    patch->getVar(dim, 0, l1, var_l);
+    patch->getVar(dim, 0, l2, var_r);
+    ausmFlux(var_l, var_r, n, flux);
+  }
+
+  void wallFlux(PrismaticLayerPatch* patch, size_t l, const vec3_t&, const vec3_t& n, real* flux)
+  {
+    real var[DIM];
+    dim_t<DIM> dim;
+    patch->getVar(dim, 0, l, var);
+    COMPR_VARS;
+    flux[1] += n[0]*p;
+    flux[2] += n[1]*p;
+    flux[3] += n[2]*p;
+    countFlops(3);
+  }
+
+  void outerFlux(PrismaticLayerPatch* patch, size_t l, const vec3_t&, const vec3_t& n, real* flux)
+  {
+    real var[DIM];
+    dim_t<DIM> dim;
+    patch->getVar(dim, 0, l, var);
+    ausmFlux(var, var, n, flux);
+  }
+
+};
+
+#endif // PRISMATICLAYERAUSMPLUS_H
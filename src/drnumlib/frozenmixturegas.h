@@ -0,0 +1,110 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef FROZENMIXTUREGAS_H
+#define FROZENMIXTUREGAS_H
+
+#include "tabulatedgas.h"
+
+#ifdef __CUDACC__
+static __constant__ GasTable frozen_mixture_gas_device_table;
+#endif
+
+/**
+ * Host copy of the table; initialised with dry air (N2, O2, Ar) in the range 200 K to 3000 K.
+ */
+inline GasTable& frozenMixtureGasHostTable()
+{
+  struct DefaultTable : public GasTable
+  {
+    DefaultTable()
+    {
+      vector<GasSpecies> species;
+      vector<real> mass_fractions;
+      species.push_back(GasSpecies::get("N2"));
+      species.push_back(GasSpecies::get("O2"));
+      species.push_back(GasSpecies::get("Ar"));
+      mass_fractions.push_back(0.7552);
+      mass_fractions.push_back(0.2314);
+      mass_fractions.push_back(0.0134);
+      build(species, mass_fractions, 200, 3000, 300, false);
+    }
+  };
+  static DefaultTable table;
+  return table;
+}
+
+/**
+ * Multi-species mixture of frozen (constant) composition, e.g. combustion products of a hot jet.
+ * The mixture properties (mass-averaged cp, Wilke's rule for mu and k) only depend on the
+ * temperature and are looked up in uniform tables.
+ * For GPU runs updateDevice() has to be called after setup() from the CUDA translation unit.
+ */
+class FrozenMixtureGas : public TabulatedGas<FrozenMixtureGas>
+{
+
+public: // static methods
+
+  static CUDA_DH const GasTable& table();
+
+  /**
+   * Build the lookup tables.
+   * @param species the names of the species (see GasSpecies::get)
+   * @param mass_fractions the mass fractions of the species
+   * @param T_min lower limit of the table range
+   * @param T_max upper limit of the table range
+   * @param cubic cubic instead of linear interpolation
+   * @param T_ref temperature for property requests without a state
+   */
+  static void setup(const vector<string>& species, const vector<real>& mass_fractions,
+                    real T_min = 200, real T_max = 3000, bool cubic = false, real T_ref = 300);
+
+  static void updateDevice();
+
+};
+
+
+inline CUDA_DH const GasTable& FrozenMixtureGas::table()
+{
+#ifdef __CUDA_ARCH__
+  return frozen_mixture_gas_device_table;
+#else
+  return frozenMixtureGasHostTable();
+#endif
+}
+
+inline void FrozenMixtureGas::setup(const vector<string>& species, const vector<real>& mass_fractions,
+                                    real T_min, real T_max, bool cubic, real T_ref)
+{
+  vector<GasSpecies> species_data;
+  for (size_t i = 0; i < species.size(); ++i) {
+    species_data.push_back(GasSpecies::get(species[i]));
+  }
+  frozenMixtureGasHostTable().build(species_data, mass_fractions, T_min, T_max, T_ref, cubic);
+}
+
+inline void FrozenMixtureGas::updateDevice()
+{
+#ifdef __CUDACC__
+  cudaMemcpyToSymbol(frozen_mixture_gas_device_table, &frozenMixtureGasHostTable(), sizeof(GasTable));
+#endif
+}
+
+#endif // FROZENMIXTUREGAS_H
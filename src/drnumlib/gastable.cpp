@@ -0,0 +1,247 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "gastable.h"
+
+#define GAS_UNIVERSAL_R 8.314462618
+
+double GasSpecies::R() const
+{
+  return GAS_UNIVERSAL_R/M;
+}
+
+double GasSpecies::cp(double T) const
+{
+  const double* a = a_low;
+  if (T >= T_mid) {
+    a = a_high;
+  }
+  return R()*(a[0] + T*(a[1] + T*(a[2] + T*(a[3] + T*a[4]))));
+}
+
+double GasSpecies::mu(double T) const
+{
+  return mu_ref*pow(T/T_ref, 1.5)*(T_ref + S)/(T + S);
+}
+
+double GasSpecies::k(double T) const
+{
+  return mu(T)*(cp(T) + 1.25*R());
+}
+
+/**
+ * Integral of the polynomial a1 + a2*T + ... + a5*T^4 from T1 to T2.
+ */
+static double polynomialIntegral(const double* a, double T1, double T2)
+{
+  double P1 = T1*(a[0] + T1*(a[1]/2 + T1*(a[2]/3 + T1*(a[3]/4 + T1*a[4]/5))));
+  double P2 = T2*(a[0] + T2*(a[1]/2 + T2*(a[2]/3 + T2*(a[3]/4 + T2*a[4]/5))));
+  return P2 - P1;
+}
+
+double GasSpecies::cpIntegral(double T1, double T2) const
+{
+  double integral = 0;
+  if (T1 < T_mid) {
+    integral += polynomialIntegral(a_low, T1, min(T2, T_mid));
+  }
+  if (T2 > T_mid) {
+    integral += polynomialIntegral(a_high, max(T1, T_mid), T2);
+  }
+  return R()*integral;
+}
+
+GasSpecies GasSpecies::get(string name)
+{
+  GasSpecies species;
+  species.name  = name;
+  species.T_mid = 1000.0;
+  species.T_ref = 273.0;
+
+  // NASA polynomials (GRI-Mech 3.0), Sutherland constants (F.M. White, Viscous Fluid Flow)
+  if (name == "N2") {
+    double a_low[5]  = {  3.298677e+00,  1.4082404e-03, -3.963222e-06,  5.641515e-09, -2.444854e-12 };
+    double a_high[5] = {  2.926640e+00,  1.4879768e-03, -5.684760e-07,  1.0097038e-10, -6.753351e-15 };
+    copy(a_low, a_low + 5, species.a_low);
+    copy(a_high, a_high + 5, species.a_high);
+    species.M      = 0.0280134;
+    species.mu_ref = 1.663e-5;
+    species.S      = 107.0;
+  } else if (name == "O2") {
+    double a_low[5]  = {  3.78245636e+00, -2.99673416e-03,  9.84730201e-06, -9.68129509e-09,  3.24372837e-12 };
+    double a_high[5] = {  3.28253784e+00,  1.48308754e-03, -7.57966669e-07,  2.09470555e-10, -2.16717794e-14 };
+    copy(a_low, a_low + 5, species.a_low);
+    copy(a_high, a_high + 5, species.a_high);
+    species.M      = 0.0319988;
+    species.mu_ref = 1.919e-5;
+    species.S      = 139.0;
+  } else if (name == "Ar") {
+    double a[5] = { 2.5, 0, 0, 0, 0 };
+    copy(a, a + 5, species.a_low);
+    copy(a, a + 5, species.a_high);
+    species.M      = 0.039948;
+    species.mu_ref = 2.125e-5;
+    species.S      = 144.0;
+  } else if (name == "CO2") {
+    double a_low[5]  = {  2.35677352e+00,  8.98459677e-03, -7.12356269e-06,  2.45919022e-09, -1.43699548e-13 };
+    double a_high[5] = {  3.85746029e+00,  4.41437026e-03, -2.21481404e-06,  5.23490188e-10, -4.72084164e-14 };
+    copy(a_low, a_low + 5, species.a_low);
+    copy(a_high, a_high + 5, species.a_high);
+    species.M      = 0.0440095;
+    species.mu_ref = 1.370e-5;
+    species.S      = 222.0;
+  } else if (name == "H2O") {
+    double a_low[5]  = {  4.19864056e+00, -2.03643410e-03,  6.52040211e-06, -5.48797062e-09,  1.77197817e-12 };
+    double a_high[5] = {  3.03399249e+00,  2.17691804e-03, -1.64072518e-07, -9.70419870e-11,  1.68200992e-14 };
+    copy(a_low, a_low + 5, species.a_low);
+    copy(a_high, a_high + 5, species.a_high);
+    species.M      = 0.0180153;
+    species.mu_ref = 1.12e-5;
+    species.T_ref  = 350.0;
+    species.S      = 1064.0;
+  } else if (name == "air") {
+    // mole fraction weighted polynomials of the constituents
+    string names[3] = { "N2", "O2", "Ar" };
+    double Y[3]     = { 0.7552, 0.2314, 0.0134 };
+    double n_total  = 0;
+    for (int i = 0; i < 3; ++i) {
+      n_total += Y[i]/get(names[i]).M;
+    }
+    for (int j = 0; j < 5; ++j) {
+      species.a_low[j]  = 0;
+      species.a_high[j] = 0;
+    }
+    for (int i = 0; i < 3; ++i) {
+      GasSpecies constituent = get(names[i]);
+      double X = Y[i]/constituent.M/n_total;
+      for (int j = 0; j < 5; ++j) {
+        species.a_low[j]  += X*constituent.a_low[j];
+        species.a_high[j] += X*constituent.a_high[j];
+      }
+    }
+    species.M      = 1.0/n_total;
+    species.mu_ref = 1.716e-5;
+    species.T_ref  = 273.15;
+    species.S      = 110.4;
+  } else {
+    ERROR(("unknown species: " + name).c_str());
+  }
+  return species;
+}
+
+void GasTable::build(const vector<GasSpecies>& species, const vector<real>& mass_fractions,
+                     real T_min, real T_max, real T_ref, bool cubic)
+{
+  if (species.size() == 0 || species.size() != mass_fractions.size() || T_max <= T_min) {
+    BUG;
+  }
+  size_t N = species.size();
+
+  // mass and mole fractions
+  vector<double> Y(N);
+  vector<double> X(N);
+  double Y_total = 0;
+  for (size_t i = 0; i < N; ++i) {
+    Y_total += mass_fractions[i];
+  }
+  double n_total = 0;
+  for (size_t i = 0; i < N; ++i) {
+    Y[i] = mass_fractions[i]/Y_total;
+    n_total += Y[i]/species[i].M;
+  }
+  for (size_t i = 0; i < N; ++i) {
+    X[i] = Y[i]/species[i].M/n_total;
+  }
+
+  double R = 0;
+  for (size_t i = 0; i < N; ++i) {
+    R += Y[i]*species[i].R();
+  }
+  double cv_min = -R;
+  for (size_t i = 0; i < N; ++i) {
+    cv_min += Y[i]*species[i].cp(T_min);
+  }
+
+  m_R     = R;
+  m_TRef  = T_ref;
+  m_TMin  = T_min;
+  m_DT    = (T_max - T_min)/(GAS_TABLE_SIZE - 1);
+  m_InvDT = 1.0/m_DT;
+  m_Cubic = cubic;
+
+  vector<double> mu_i(N);
+  vector<double> k_i(N);
+  for (int i_node = 0; i_node < GAS_TABLE_SIZE; ++i_node) {
+    double T = T_min + i_node*double(T_max - T_min)/(GAS_TABLE_SIZE - 1);
+    double cp = 0;
+    double e = cv_min*T_min - R*(T - T_min);
+    for (size_t i = 0; i < N; ++i) {
+      cp += Y[i]*species[i].cp(T);
+      e  += Y[i]*species[i].cpIntegral(T_min, T);
+      mu_i[i] = species[i].mu(T);
+      k_i[i]  = species[i].k(T);
+    }
+
+    // Wilke's mixing rule
+    double mu = 0;
+    double k  = 0;
+    for (size_t i = 0; i < N; ++i) {
+      double sum = 0;
+      for (size_t j = 0; j < N; ++j) {
+        double phi = 1 + sqrt(mu_i[i]/mu_i[j])*pow(species[j].M/species[i].M, 0.25);
+        phi *= phi/sqrt(8*(1 + species[i].M/species[j].M));
+        sum += X[j]*phi;
+      }
+      mu += X[i]*mu_i[i]/sum;
+      k  += X[i]*k_i[i]/sum;
+    }
+
+    m_Cp[i_node]    = cp;
+    m_Gamma[i_node] = cp/(cp - R);
+    m_Mu[i_node]    = mu;
+    m_K[i_node]     = k;
+    m_E[i_node]     = e;
+  }
+
+  // inverse table T(e) on a uniform grid of the internal energy
+  double e_min = m_E[0];
+  double e_max = m_E[GAS_TABLE_SIZE - 1];
+  m_EMin  = e_min;
+  m_DE    = (e_max - e_min)/(GAS_TABLE_SIZE - 1);
+  m_InvDE = 1.0/m_DE;
+  for (int i_node = 0; i_node < GAS_TABLE_SIZE; ++i_node) {
+    double e  = e_min + i_node*(e_max - e_min)/(GAS_TABLE_SIZE - 1);
+    double T1 = T_min;
+    double T2 = T_max;
+    for (int iter = 0; iter < 60; ++iter) {
+      double T  = 0.5*(T1 + T2);
+      double eT = cv_min*T_min - R*(T - T_min);
+      for (size_t i = 0; i < N; ++i) {
+        eT += Y[i]*species[i].cpIntegral(T_min, T);
+      }
+      if (eT < e) {
+        T1 = T;
+      } else {
+        T2 = T;
+      }
+    }
+    m_T[i_node] = 0.5*(T1 + T2);
+  }
+}
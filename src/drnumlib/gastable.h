@@ -0,0 +1,145 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef GASTABLE_H
+#define GASTABLE_H
+
+#include "drnum.h"
+
+#include <vector>
+#include <string>
+
+/// number of nodes of the uniform lookup tables
+#define GAS_TABLE_SIZE 512
+
+/**
+ * Properties of a single species (host only).
+ * The heat capacity is given by the 7-coefficient NASA polynomials
+ * cp/R = a1 + a2*T + a3*T^2 + a4*T^3 + a5*T^4 (two temperature ranges),
+ * the viscosity by Sutherland's law and the thermal conductivity by Eucken's relation
+ * k = mu*(cp + 5/4*R).
+ */
+struct GasSpecies
+{
+  string name;
+  double M;          ///< molar mass [kg/mol]
+  double T_mid;      ///< upper limit of the low temperature range of the polynomials
+  double a_low[5];   ///< polynomial coefficients for T < T_mid
+  double a_high[5];  ///< polynomial coefficients for T >= T_mid
+  double mu_ref;     ///< Sutherland reference viscosity
+  double T_ref;      ///< Sutherland reference temperature
+  double S;          ///< Sutherland constant
+
+  double R() const;
+  double cp(double T) const;
+  double mu(double T) const;
+  double k(double T) const;
+
+  /**
+   * Integral of cp from T1 to T2.
+   */
+  double cpIntegral(double T1, double T2) const;
+
+  /**
+   * Built-in species data: "N2", "O2", "Ar", "CO2", "H2O" and "air".
+   * "air" is dry air (mass fractions N2 0.7552, O2 0.2314, Ar 0.0134) combined into
+   * a single species with Sutherland's constants of air.
+   * @param name the name of the species
+   * @return the species data
+   */
+  static GasSpecies get(string name);
+};
+
+
+/**
+ * Uniform lookup tables of the properties of a gas with temperature-dependent heat capacity.
+ * The tables are plain data, so that a copy can reside in GPU constant memory.
+ * Values are interpolated linearly or with cubic (Catmull-Rom) polynomials; beyond the
+ * table range the end segments are extrapolated linearly.
+ * The internal energy is e(T) = cv(T_min)*T_min + int_{T_min}^{T} cv dT, so that e/T and h/T are the
+ * caloric (secant) heat capacities, which keep the formulations of the flux functions
+ * (T = e/cv, h = cp*T) exact.
+ */
+struct GasTable
+{
+  real m_R;
+  real m_TRef;    ///< temperature for property requests without a state (e.g. cp())
+  real m_TMin;
+  real m_DT;
+  real m_InvDT;
+  real m_EMin;
+  real m_DE;
+  real m_InvDE;
+  bool m_Cubic;
+
+  real m_Cp[GAS_TABLE_SIZE];     ///< cp(T)
+  real m_Gamma[GAS_TABLE_SIZE];  ///< gamma(T)
+  real m_Mu[GAS_TABLE_SIZE];     ///< mu(T)
+  real m_K[GAS_TABLE_SIZE];      ///< k(T)
+  real m_E[GAS_TABLE_SIZE];      ///< e(T)
+  real m_T[GAS_TABLE_SIZE];      ///< T(e)
+
+  /**
+   * Build the tables for a mixture of frozen composition.
+   * Heat capacities are mass-averaged; viscosity and conductivity of mixtures use Wilke's mixing rule.
+   * @param species the species of the mixture
+   * @param mass_fractions the mass fractions of the species (normalised internally)
+   * @param T_min lower limit of the table range
+   * @param T_max upper limit of the table range
+   * @param T_ref temperature for property requests without a state
+   * @param cubic cubic instead of linear interpolation
+   */
+  void build(const vector<GasSpecies>& species, const vector<real>& mass_fractions,
+             real T_min, real T_max, real T_ref, bool cubic);
+
+  CUDA_DH real interpolate(const real* table, real x, real x_min, real inv_dx) const;
+
+  CUDA_DH real cp(real T)    const { return interpolate(m_Cp, T, m_TMin, m_InvDT); }
+  CUDA_DH real gamma(real T) const { return interpolate(m_Gamma, T, m_TMin, m_InvDT); }
+  CUDA_DH real mu(real T)    const { return interpolate(m_Mu, T, m_TMin, m_InvDT); }
+  CUDA_DH real k(real T)     const { return interpolate(m_K, T, m_TMin, m_InvDT); }
+  CUDA_DH real e(real T)     const { return interpolate(m_E, T, m_TMin, m_InvDT); }
+  CUDA_DH real T(real e)     const { return interpolate(m_T, e, m_EMin, m_InvDE); }
+};
+
+
+inline CUDA_DH real GasTable::interpolate(const real* table, real x, real x_min, real inv_dx) const
+{
+  real s = (x - x_min)*inv_dx;
+  int  i = int(floor(s));
+  if (i < 0) {
+    i = 0;
+  } else if (i > GAS_TABLE_SIZE - 2) {
+    i = GAS_TABLE_SIZE - 2;
+  }
+  real w = s - i;
+  real f0 = table[i];
+  real f1 = table[i + 1];
+  countFlops(5);
+  if (!m_Cubic || w < 0 || w > 1) {
+    return f0 + w*(f1 - f0);
+  }
+  real fm = table[i > 0 ? i - 1 : i];
+  real f2 = table[i < GAS_TABLE_SIZE - 2 ? i + 2 : i + 1];
+  countFlops(15);
+  return f0 + real(0.5)*w*(f1 - fm + w*(2*fm - 5*f0 + 4*f1 - f2 + w*(3*(f0 - f1) + f2 - fm)));
+}
+
+#endif // GASTABLE_H
@@ -0,0 +1,411 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "gridpartitioner.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+
+GridPartitioner::GridPartitioner(size_t num_seek_layers, size_t num_add_protect_layers)
+{
+  m_NumSeekLayers       = num_seek_layers;
+  m_NumAddProtectLayers = num_add_protect_layers;
+  m_MaxCells            = numeric_limits<size_t>::max();
+  m_MinCells            = 0;
+  m_MinSliceCells       = 1;
+  m_FirstBCWord         = 3;
+  m_InterfaceCode       = "far";
+  m_NumSplits           = 0;
+  m_NumMerges           = 0;
+}
+
+void GridPartitioner::setPatchSize(size_t max_cells, size_t min_cells)
+{
+  if (max_cells == 0) {
+    ERROR("the maximal patch size has to be positive");
+  }
+  m_MaxCells = max_cells;
+  m_MinCells = min_cells;
+}
+
+void GridPartitioner::setCacheBudget(size_t cache_bytes, size_t num_threads, size_t bytes_per_cell, size_t min_cells_per_thread)
+{
+  num_threads    = max(size_t(1), num_threads);
+  bytes_per_cell = max(size_t(1), bytes_per_cell);
+  m_MaxCells      = max(size_t(1), num_threads*cache_bytes/bytes_per_cell);
+  m_MinCells      = min(num_threads*min_cells_per_thread, m_MaxCells/2);
+  m_MinSliceCells = 2*num_threads;
+}
+
+void GridPartitioner::setBoundaryCodeWords(size_t first_bc_word, string interface_code)
+{
+  m_FirstBCWord   = first_bc_word;
+  m_InterfaceCode = interface_code;
+}
+
+void GridPartitioner::readGrid(istream& s_grid)
+{
+  while (!s_grid.eof()) {
+    size_t patch_type = 0;
+    s_grid >> patch_type;
+    if (patch_type == 0) {
+      break;
+    }
+    patch_t patch;
+    patch.type = patch_type;
+    char c;
+    while (s_grid.get(c)) {
+      if (c == '{') {
+        break;
+      }
+      patch.comment.push_back(c);
+    }
+    while (!patch.comment.empty() && isspace(patch.comment[patch.comment.size() - 1])) {
+      patch.comment.erase(patch.comment.size() - 1);
+    }
+    while (!patch.comment.empty() && isspace(patch.comment[0])) {
+      patch.comment.erase(0, 1);
+    }
+    getline(s_grid, patch.text, '}');
+    if (patch_type == 1001) {
+      istringstream iss(patch.text);
+      iss >> patch.origin[0] >> patch.origin[1] >> patch.origin[2];
+      iss >> patch.base_i[0] >> patch.base_i[1] >> patch.base_i[2];
+      iss >> patch.base_j[0] >> patch.base_j[1] >> patch.base_j[2];
+      iss >> patch.io_scale;
+      iss >> patch.num[0] >> patch.num[1] >> patch.num[2];
+      for (size_t dir = 0; dir < 3; ++dir) {
+        iss >> patch.seek[dir][0] >> patch.seek[dir][1];
+      }
+      iss >> patch.length[0] >> patch.length[1] >> patch.length[2];
+      if (iss.fail()) {
+        ERROR("unable to read the description of a Cartesian patch");
+      }
+      string word;
+      while (iss >> word) {
+        // ',' and ';' are delimiters as well (see CodeString::buildFrom)
+        string part;
+        for (size_t i = 0; i <= word.size(); ++i) {
+          if (i == word.size() || word[i] == ',' || word[i] == ';') {
+            if (!part.empty()) {
+              patch.codes.push_back(part);
+            }
+            part = "";
+          } else {
+            part.push_back(word[i]);
+          }
+        }
+      }
+      patch.text = "";
+    }
+    m_Patches.push_back(patch);
+  }
+}
+
+void GridPartitioner::readGrid(string file_name)
+{
+  ifstream s_grid(file_name.c_str());
+  if (!s_grid) {
+    cout << "grid file: " << file_name << endl;
+    ERROR("unable to open grid file");
+  }
+  readGrid(s_grid);
+}
+
+void GridPartitioner::writeGrid(ostream& s_grid)
+{
+  s_grid << setprecision(12);
+  for (size_t i_patch = 0; i_patch < m_Patches.size(); ++i_patch) {
+    patch_t& patch = m_Patches[i_patch];
+    s_grid << patch.type << " " << patch.comment << "\n{";
+    if (patch.type == 1001) {
+      s_grid << "\n";
+      s_grid << "  " << patch.origin[0] << " " << patch.origin[1] << " " << patch.origin[2] << "\n";
+      s_grid << "  " << patch.base_i[0] << " " << patch.base_i[1] << " " << patch.base_i[2] << "\n";
+      s_grid << "  " << patch.base_j[0] << " " << patch.base_j[1] << " " << patch.base_j[2] << "\n";
+      s_grid << "  " << patch.io_scale << "\n";
+      s_grid << "  " << patch.num[0] << " " << patch.num[1] << " " << patch.num[2] << "\n";
+      s_grid << " ";
+      for (size_t dir = 0; dir < 3; ++dir) {
+        s_grid << " " << patch.seek[dir][0] << " " << patch.seek[dir][1];
+      }
+      s_grid << "\n";
+      s_grid << "  " << patch.length[0] << " " << patch.length[1] << " " << patch.length[2] << "\n";
+      s_grid << " ";
+      for (size_t i_word = 0; i_word < patch.codes.size(); ++i_word) {
+        s_grid << " " << patch.codes[i_word];
+      }
+      s_grid << "\n";
+    } else {
+      s_grid << patch.text;
+    }
+    s_grid << "}\n";
+  }
+  s_grid << "0\n";
+}
+
+void GridPartitioner::writeGrid(string file_name)
+{
+  ofstream s_grid(file_name.c_str());
+  if (!s_grid) {
+    cout << "grid file: " << file_name << endl;
+    ERROR("unable to write grid file");
+  }
+  writeGrid(s_grid);
+}
+
+void GridPartitioner::createPatches(PatchGrid* patch_grid, real scale)
+{
+  stringstream s_grid;
+  writeGrid(s_grid);
+  patch_grid->readGrid(s_grid, scale);
+}
+
+dvec3_t GridPartitioner::axis(const patch_t& patch, size_t dir) const
+{
+  // same orthonormalisation as CoordTransform::setMatrixFromBaseIJ
+  dvec3_t e_i = patch.base_i;
+  e_i.normalise();
+  dvec3_t e_j = e_i;
+  e_j *= -(patch.base_j*e_i);
+  e_j += patch.base_j;
+  e_j.normalise();
+  if (dir == 0) {
+    return e_i;
+  }
+  if (dir == 1) {
+    return e_j;
+  }
+  return e_i.cross(e_j);
+}
+
+size_t GridPartitioner::minCoreCells(size_t dir) const
+{
+  // the seek cells of a neighbour have to find donor cells outside of the protection zone
+  size_t min_cells = 2*(m_NumSeekLayers + m_NumAddProtectLayers) + 2;
+  if (dir == 0) {
+    min_cells = max(min_cells, m_MinSliceCells);
+  }
+  return min_cells;
+}
+
+string GridPartitioner::sideCode(const patch_t& patch, size_t dir, size_t side) const
+{
+  size_t i_word = m_FirstBCWord + 2*dir + side;
+  if (i_word < patch.codes.size()) {
+    return patch.codes[i_word];
+  }
+  return "";
+}
+
+void GridPartitioner::setSideCode(patch_t& patch, size_t dir, size_t side, const string& code) const
+{
+  size_t i_word = m_FirstBCWord + 2*dir + side;
+  if (i_word < patch.codes.size()) {
+    patch.codes[i_word] = code;
+  }
+}
+
+GridPartitioner::patch_t GridPartitioner::subPatch(const patch_t& patch, size_t dir, size_t first, size_t after_last, bool interface_min, bool interface_max) const
+{
+  patch_t sub_patch = patch;
+  double delta = patch.delta(dir);
+  sub_patch.num[dir]    = after_last - first;
+  sub_patch.length[dir] = delta*sub_patch.num[dir];
+  dvec3_t shift = axis(patch, dir);
+  shift *= delta*first;
+  sub_patch.origin += shift;
+  if (interface_min) {
+    sub_patch.seek[dir][0] = m_NumSeekLayers;
+    setSideCode(sub_patch, dir, 0, m_InterfaceCode);
+  }
+  if (interface_max) {
+    sub_patch.seek[dir][1] = m_NumSeekLayers;
+    setSideCode(sub_patch, dir, 1, m_InterfaceCode);
+  }
+  return sub_patch;
+}
+
+void GridPartitioner::split(const patch_t& patch, vector<patch_t>& sub_patches)
+{
+  if (patch.type != 1001 || patch.numCells() <= m_MaxCells) {
+    sub_patches.push_back(patch);
+    return;
+  }
+
+  // bisect the longest direction which can still be split
+  int    split_dir = -1;
+  size_t max_core  = 0;
+  for (size_t dir = 0; dir < 3; ++dir) {
+    size_t num_core = patch.num[dir] - min(patch.num[dir], patch.seek[dir][0] + patch.seek[dir][1]);
+    if (num_core >= 2*minCoreCells(dir) && num_core > max_core) {
+      split_dir = dir;
+      max_core  = num_core;
+    }
+  }
+  if (split_dir < 0) {
+    sub_patches.push_back(patch);
+    return;
+  }
+
+  // cells [c - s, c) are seek cells of the upper sub-patch and the last s cells of the
+  // lower sub-patch are seek cells; one additional cell of overlap keeps all seek cells
+  // strictly inside the donor zone of the other sub-patch
+  size_t c = patch.seek[split_dir][0] + max_core/2;
+  size_t s = m_NumSeekLayers;
+  size_t p = m_NumAddProtectLayers;
+  patch_t lower = subPatch(patch, split_dir, 0, c + s + p + 1, false, true);
+  patch_t upper = subPatch(patch, split_dir, c - s, patch.num[split_dir], true, false);
+  if (lower.comment.find("(partitioned)") == string::npos) {
+    lower.comment += " (partitioned)";
+    upper.comment += " (partitioned)";
+  }
+  ++m_NumSplits;
+  split(lower, sub_patches);
+  split(upper, sub_patches);
+}
+
+bool GridPartitioner::mergeable(const patch_t& patch1, const patch_t& patch2, size_t& dir, size_t& offset) const
+{
+  if (patch1.type != 1001 || patch2.type != 1001) {
+    return false;
+  }
+  if (patch1.codes.size() != patch2.codes.size()) {
+    return false;
+  }
+  const double tol = 1e-6;
+  if (fabs(patch1.io_scale - patch2.io_scale) > tol*fabs(patch1.io_scale)) {
+    return false;
+  }
+  for (size_t i_dir = 0; i_dir < 3; ++i_dir) {
+    if ((axis(patch1, i_dir) - axis(patch2, i_dir)).abs() > tol) {
+      return false;
+    }
+    if (fabs(patch1.delta(i_dir) - patch2.delta(i_dir)) > tol*patch1.delta(i_dir)) {
+      return false;
+    }
+  }
+  for (size_t i_word = 0; i_word < patch1.codes.size(); ++i_word) {
+    if (i_word >= m_FirstBCWord && i_word < m_FirstBCWord + 6) {
+      continue;
+    }
+    if (patch1.codes[i_word] != patch2.codes[i_word]) {
+      return false;
+    }
+  }
+
+  // patch2 has to be a continuation of patch1 in exactly one direction
+  dvec3_t dx = patch2.origin - patch1.origin;
+  int merge_dir = -1;
+  for (size_t i_dir = 0; i_dir < 3; ++i_dir) {
+    double shift = (dx*axis(patch1, i_dir))/patch1.delta(i_dir);
+    if (fabs(shift) > tol) {
+      if (merge_dir >= 0 || shift < 0.5) {
+        return false;
+      }
+      double num_cells = floor(shift + 0.5);
+      if (fabs(shift - num_cells) > tol || num_cells > patch1.num[i_dir]) {
+        return false;
+      }
+      merge_dir = i_dir;
+      offset    = size_t(num_cells);
+    }
+  }
+  if (merge_dir < 0) {
+    return false;
+  }
+  dir = merge_dir;
+
+  // patch2 has to extend patch1, otherwise the upper side of patch1 would be replaced
+  if (offset + patch2.num[dir] <= patch1.num[dir]) {
+    return false;
+  }
+
+  // the sides in between have to be interfaces, all other sides have to match
+  if (patch1.seek[dir][1] == 0 || patch2.seek[dir][0] == 0) {
+    return false;
+  }
+  for (size_t i_dir = 0; i_dir < 3; ++i_dir) {
+    if (i_dir == dir) {
+      continue;
+    }
+    if (patch1.num[i_dir] != patch2.num[i_dir]) {
+      return false;
+    }
+    for (size_t side = 0; side < 2; ++side) {
+      if (patch1.seek[i_dir][side] != patch2.seek[i_dir][side]) {
+        return false;
+      }
+      if (sideCode(patch1, i_dir, side) != sideCode(patch2, i_dir, side)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void GridPartitioner::partition()
+{
+  // merge small patches
+  if (m_MinCells > 0) {
+    bool merged = true;
+    while (merged) {
+      merged = false;
+      for (size_t i1 = 0; i1 < m_Patches.size() && !merged; ++i1) {
+        for (size_t i2 = 0; i2 < m_Patches.size() && !merged; ++i2) {
+          if (i1 == i2) {
+            continue;
+          }
+          patch_t& patch1 = m_Patches[i1];
+          patch_t& patch2 = m_Patches[i2];
+          if (patch1.numCells() >= m_MinCells && patch2.numCells() >= m_MinCells) {
+            continue;
+          }
+          size_t dir, offset;
+          if (mergeable(patch1, patch2, dir, offset)) {
+            size_t num = max(patch1.num[dir], offset + patch2.num[dir]);
+            if (patch1.numCells()/patch1.num[dir]*num <= m_MaxCells) {
+              double delta        = patch1.delta(dir);
+              patch1.num[dir]     = num;
+              patch1.length[dir]  = delta*num;
+              patch1.seek[dir][1] = patch2.seek[dir][1];
+              setSideCode(patch1, dir, 1, sideCode(patch2, dir, 1));
+              if (patch1.comment.find("(partitioned)") == string::npos) {
+                patch1.comment += " (partitioned)";
+              }
+              m_Patches.erase(m_Patches.begin() + i2);
+              ++m_NumMerges;
+              merged = true;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // split large patches
+  vector<patch_t> patches;
+  for (size_t i_patch = 0; i_patch < m_Patches.size(); ++i_patch) {
+    split(m_Patches[i_patch], patches);
+  }
+  m_Patches = patches;
+}
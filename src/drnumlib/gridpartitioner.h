@@ -0,0 +1,180 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef GRIDPARTITIONER_H
+#define GRIDPARTITIONER_H
+
+#include "drnum.h"
+#include "patchgrid.h"
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+/**
+ * Grid preprocessing: subdivision of large and merging of small Cartesian patches.
+ *
+ * Works on the patch descriptions of a grid file (see PatchGrid::readGrid). Oversized
+ * Cartesian patches (type 1001) are split along their longest axes; the sub-patches
+ * overlap by twice the number of seek layers plus the additional protection layers and
+ * one extra cell, so that the seek cells of every sub-patch coincide with cells inside
+ * the donor zone of its neighbour. Small
+ * adjacent patches with the same orientation, cell size, cross section and solver codes
+ * are merged, as long as the result does not exceed the maximal size. All other patch
+ * types are passed through unchanged.
+ *
+ * The sides of a sub-patch facing another sub-patch get seek layers and the interface
+ * code word in place of the boundary code. The boundary code words are expected at the
+ * positions [first_bc_word, first_bc_word + 6) of the solver codes, in the order
+ * xm xp ym yp zm zp (see setBoundaryCodeWords).
+ *
+ * The result is written to a new grid file or fed straight into a PatchGrid, which
+ * has to be done before PatchGrid::computeDependencies.
+ */
+class GridPartitioner
+{
+
+protected: // data types
+
+  struct patch_t
+  {
+    size_t         type;
+    string         comment;
+    string         text;          ///< verbatim contents of patches other than 1001
+    dvec3_t        origin;
+    dvec3_t        base_i;
+    dvec3_t        base_j;
+    double         io_scale;
+    size_t         num[3];
+    size_t         seek[3][2];
+    double         length[3];
+    vector<string> codes;
+
+    size_t numCells() const { return num[0]*num[1]*num[2]; }
+    double delta(size_t dir) const { return length[dir]/num[dir]; }
+  };
+
+
+protected: // attributes
+
+  vector<patch_t> m_Patches;
+  size_t          m_NumSeekLayers;
+  size_t          m_NumAddProtectLayers;
+  size_t          m_MaxCells;         ///< maximal number of cells of a patch
+  size_t          m_MinCells;         ///< patches below this size are merged if possible
+  size_t          m_MinSliceCells;    ///< minimal number of core cells of a sub-patch in the i direction
+  size_t          m_FirstBCWord;
+  string          m_InterfaceCode;
+  size_t          m_NumSplits;
+  size_t          m_NumMerges;
+
+
+protected: // methods
+
+  dvec3_t axis(const patch_t& patch, size_t dir) const;
+  size_t  minCoreCells(size_t dir) const;
+  void    setSideCode(patch_t& patch, size_t dir, size_t side, const string& code) const;
+  string  sideCode(const patch_t& patch, size_t dir, size_t side) const;
+  patch_t subPatch(const patch_t& patch, size_t dir, size_t first, size_t after_last, bool interface_min, bool interface_max) const;
+  void    split(const patch_t& patch, vector<patch_t>& sub_patches);
+  bool    mergeable(const patch_t& patch1, const patch_t& patch2, size_t& dir, size_t& offset) const;
+
+
+public: // methods
+
+  /**
+   * @param num_seek_layers number of seek layers (see PatchGrid::setNumSeekLayers)
+   * @param num_add_protect_layers number of additional protection layers (see PatchGrid::setNumAddProtectLayers)
+   */
+  GridPartitioner(size_t num_seek_layers = 2, size_t num_add_protect_layers = 0);
+
+  /**
+   * Set the size limits of the patches directly.
+   * @param max_cells maximal number of cells of a patch
+   * @param min_cells patches with fewer cells are merged with neighbours (0: no merging)
+   */
+  void setPatchSize(size_t max_cells, size_t min_cells);
+
+  /**
+   * Derive the size limits of the patches from a cache budget and the number of threads.
+   * A patch is computed by all threads at once, so its data (all fields) should fit into the
+   * combined cache of the threads, while every thread should get a reasonable amount of work.
+   * The i direction of a patch is distributed over the threads, hence sub-patches keep
+   * at least two i-slices per thread.
+   * @param cache_bytes cache size per thread in bytes (e.g. L2 cache per core)
+   * @param num_threads the number of threads
+   * @param bytes_per_cell memory footprint of one cell (fields, variables and residuals)
+   * @param min_cells_per_thread minimal number of cells per thread
+   */
+  void setCacheBudget(size_t cache_bytes, size_t num_threads, size_t bytes_per_cell, size_t min_cells_per_thread = 4096);
+
+  /**
+   * Define the position of the boundary code words within the solver codes and the code
+   * word for sides facing a neighbouring sub-patch.
+   * @param first_bc_word index of the first boundary code word (xm)
+   * @param interface_code the code word for sides between sub-patches
+   */
+  void setBoundaryCodeWords(size_t first_bc_word, string interface_code);
+
+  /**
+   * Read patch descriptions in grid file format.
+   * @param s_grid the stream to read from
+   */
+  void readGrid(istream& s_grid);
+
+  /**
+   * Read patch descriptions from a grid file.
+   * @param file_name the name of the grid file
+   */
+  void readGrid(string file_name);
+
+  /**
+   * Split and merge the patches according to the size limits.
+   */
+  void partition();
+
+  /**
+   * Write the patch descriptions in grid file format.
+   * @param s_grid the stream to write to
+   */
+  void writeGrid(ostream& s_grid);
+
+  /**
+   * Write the patch descriptions to a grid file.
+   * @param file_name the name of the grid file
+   */
+  void writeGrid(string file_name);
+
+  /**
+   * Create the patches in a PatchGrid. Has to be called before PatchGrid::computeDependencies.
+   * @param patch_grid the PatchGrid
+   * @param scale scaling factor for all coordinates (see PatchGrid::readGrid)
+   */
+  void createPatches(PatchGrid* patch_grid, real scale = 1.0);
+
+  size_t numPatches() { return m_Patches.size(); }
+  size_t numSplits() { return m_NumSplits; }
+  size_t numMerges() { return m_NumMerges; }
+  size_t maxCells() { return m_MaxCells; }
+  size_t minCells() { return m_MinCells; }
+
+};
+
+#endif // GRIDPARTITIONER_H
@@ -0,0 +1,130 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "hardwarecounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <string.h>
+#endif
+
+#ifdef OPEN_MP
+#include <omp.h>
+#endif
+
+HardwareCounters::HardwareCounters()
+{
+  m_Available = false;
+}
+
+HardwareCounters::~HardwareCounters()
+{
+  closeAll();
+}
+
+void HardwareCounters::closeAll()
+{
+#ifdef __linux__
+  for (size_t i = 0; i < m_Fds.size(); ++i) {
+    if (m_Fds[i] >= 0) {
+      close(m_Fds[i]);
+    }
+  }
+#endif
+  m_Fds.clear();
+  m_Available = false;
+}
+
+#ifdef __linux__
+static int openCounter(unsigned long long config)
+{
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type           = PERF_TYPE_HARDWARE;
+  attr.size           = sizeof(attr);
+  attr.config         = config;
+  attr.disabled       = 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv     = 1;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+bool HardwareCounters::open()
+{
+  closeAll();
+#ifdef __linux__
+  int num_threads = 1;
+#ifdef OPEN_MP
+  num_threads = omp_get_max_threads();
+#endif
+  m_Fds.resize(3*num_threads, -1);
+  // every thread has to open its own counters, since they count the calling thread only
+#ifdef OPEN_MP
+#pragma omp parallel num_threads(num_threads)
+#endif
+  {
+    int i_thread = 0;
+#ifdef OPEN_MP
+    i_thread = omp_get_thread_num();
+#endif
+    m_Fds[3*i_thread + 0] = openCounter(PERF_COUNT_HW_CPU_CYCLES);
+    m_Fds[3*i_thread + 1] = openCounter(PERF_COUNT_HW_INSTRUCTIONS);
+    m_Fds[3*i_thread + 2] = openCounter(PERF_COUNT_HW_CACHE_MISSES);
+  }
+  m_Available = true;
+  for (size_t i = 0; i < m_Fds.size(); ++i) {
+    if (m_Fds[i] < 0) {
+      m_Available = false;
+    }
+  }
+  if (!m_Available) {
+    closeAll();
+  }
+#endif
+  return m_Available;
+}
+
+void HardwareCounters::read(counters_t &counters)
+{
+  counters.cycles       = 0;
+  counters.instructions = 0;
+  counters.cache_misses = 0;
+#ifdef __linux__
+  if (!m_Available) {
+    return;
+  }
+  for (size_t i = 0; i < m_Fds.size(); i += 3) {
+    unsigned long long value;
+    if (::read(m_Fds[i + 0], &value, sizeof(value)) == sizeof(value)) {
+      counters.cycles += value;
+    }
+    if (::read(m_Fds[i + 1], &value, sizeof(value)) == sizeof(value)) {
+      counters.instructions += value;
+    }
+    if (::read(m_Fds[i + 2], &value, sizeof(value)) == sizeof(value)) {
+      counters.cache_misses += value;
+    }
+  }
+#endif
+}
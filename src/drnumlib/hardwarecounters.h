@@ -0,0 +1,83 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef HARDWARECOUNTERS_H
+#define HARDWARECOUNTERS_H
+
+#include "drnum.h"
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Hardware performance counters (CPU cycles, instructions and cache misses).
+ *
+ * On Linux the counters are read through perf_event_open. Every OpenMP thread opens
+ * its own set of counters in open(), read() returns the sum over all threads.
+ * Counting requires a sufficiently low setting of /proc/sys/kernel/perf_event_paranoid;
+ * if the counters cannot be opened, available() returns false and all values are zero.
+ */
+class HardwareCounters
+{
+
+public: // data types
+
+  struct counters_t
+  {
+    unsigned long long cycles;
+    unsigned long long instructions;
+    unsigned long long cache_misses;
+  };
+
+
+protected: // attributes
+
+  vector<int> m_Fds;  ///< file descriptors [3*thread + counter]
+  bool        m_Available;
+
+
+protected: // methods
+
+  void closeAll();
+
+
+public: // methods
+
+  HardwareCounters();
+  ~HardwareCounters();
+
+  /**
+   * Open the counters for all OpenMP threads.
+   * @return true if the counters could be opened
+   */
+  bool open();
+
+  bool available() { return m_Available; }
+
+  /**
+   * Read the counters (sum over all threads).
+   * @param counters will hold the current counter values
+   */
+  void read(counters_t& counters);
+
+};
+
+#endif // HARDWARECOUNTERS_H
@@ -47,6 +47,10 @@ void IteratorFeeder::feed(PatchGrid &patch_grid)
         * Case could as well be considered an error, as an iterator has been
         * build with a flux that is never used.
         */
+      size_t patch_type = m_Iterators[i_it]->getPatchType();
+      if (patch_type != 0 && patch_type != spg->m_PatchType) {
+        continue;
+      }
       if (m_Iterators[i_it]->getCodeString() == cs) {
         found = true;
         for (size_t i_patch = 0; i_patch < spg->m_Patches.size(); ++i_patch) {
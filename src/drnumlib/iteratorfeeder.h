@@ -37,6 +37,36 @@ using namespace std;
 
 //class IteratorFeeder;
 
+/**
+ * Maps a run-time case index onto a compile-time template argument.
+ * The call of creator.create<CASE>(solver_codes) is instantiated for all cases in [CASE, NUM_CASES),
+ * which allows to build fully specialised iterators (e.g. inviscid and viscous) without any
+ * branching inside the flux kernels. Every case is a separate instantiation of the iterator,
+ * hence the number of cases should be kept small.
+ */
+template <typename TCreator, unsigned int CASE, unsigned int NUM_CASES>
+struct StaticCaseDispatch
+{
+  static PatchIterator* create(TCreator& creator, unsigned int case_index, const CodeString& solver_codes)
+  {
+    if (case_index == CASE) {
+      return creator.template create<CASE>(solver_codes);
+    }
+    return StaticCaseDispatch<TCreator, CASE + 1, NUM_CASES>::create(creator, case_index, solver_codes);
+  }
+};
+
+template <typename TCreator, unsigned int NUM_CASES>
+struct StaticCaseDispatch<TCreator, NUM_CASES, NUM_CASES>
+{
+  static PatchIterator* create(TCreator&, unsigned int, const CodeString&)
+  {
+    BUG;
+    return NULL;
+  }
+};
+
+
 class IteratorFeeder
 {
 
@@ -54,6 +84,55 @@ public: // methods
 
   void feed(PatchGrid& patch_grid);
 
+  /**
+   * Create one specialised iterator for every distinct combination of solver code string
+   * and patch type of the patch groups.
+   * The creator has to provide:
+   *  - a constant TCreator::num_cases,
+   *  - unsigned int caseIndex(const CodeString&) mapping solver codes to a case in [0, num_cases),
+   *  - template <unsigned int CASE> PatchIterator* create(const CodeString&) building the iterator
+   *    for a case and the solver codes of a patch group.
+   * The new iterators get the code string and patch type of their patch group and still have to be fed
+   * with feed(patch_grid).
+   * @param patch_grid the PatchGrid to build iterators for
+   * @param creator the creator of the specialised iterators
+   */
+  template <typename TCreator>
+  void createIterators(PatchGrid& patch_grid, TCreator& creator);
+
+  size_t numIterators() { return m_Iterators.size(); }
+  PatchIterator* getIterator(size_t i) { return m_Iterators[i]; }
+
 };
 
+
+template <typename TCreator>
+void IteratorFeeder::createIterators(PatchGrid& patch_grid, TCreator& creator)
+{
+  PatchGroups* patch_groups = patch_grid.getPatchGroups();
+  for (size_t i_pg = 0 ; i_pg < patch_groups->accessNumPatchGroups(); ++i_pg) {
+    SinglePatchGroup* spg = patch_groups->accessSinglePatchGroup(i_pg);
+    CodeString cs = spg->m_SolverCodes;
+
+    // patch groups of different patch types may share the same solver codes
+    bool exists = false;
+    for (size_t i_it = 0; i_it < m_Iterators.size(); ++i_it) {
+      if (m_Iterators[i_it]->getCodeString() == cs && m_Iterators[i_it]->getPatchType() == spg->m_PatchType) {
+        exists = true;
+      }
+    }
+    if (!exists) {
+      unsigned int case_index = creator.caseIndex(cs);
+      if (case_index >= TCreator::num_cases) {
+        cout << cs.c_str() << endl;
+        BUG;
+      }
+      PatchIterator* iterator = StaticCaseDispatch<TCreator, 0, TCreator::num_cases>::create(creator, case_index, cs);
+      iterator->setCodeString(cs);
+      iterator->setPatchType(spg->m_PatchType);
+      addIterator(iterator);
+    }
+  }
+}
+
 #endif // ITERATORFEEDER_H
@@ -23,6 +23,8 @@
 
 #include "cartesianpatch.h"
 #include "iterators/tpatchiterator.h"
+#include "telemetry.h"
+#include "viscousgradients.h"
 
 template <unsigned int DIM, typename OP>
 class CartesianIterator : public TPatchIterator<CartesianPatch, OP>
@@ -30,14 +32,15 @@ class CartesianIterator : public TPatchIterator<CartesianPatch, OP>
 
 protected: // attributes
 
-  real*  m_Res;
-  size_t m_ResLength;
-  size_t m_I1;
-  size_t m_J1;
-  size_t m_K1;
-  size_t m_SizeI;
-  size_t m_SizeJ;
-  size_t m_SizeK;
+  acc_real* m_Res;
+  size_t    m_ResLength;
+  size_t    m_I1;
+  size_t    m_J1;
+  size_t    m_K1;
+  size_t    m_SizeI;
+  size_t    m_SizeJ;
+  size_t    m_SizeK;
+  ViscousGradients m_Gradients; ///< cell gradients for operators with a gradient pre-pass
 
 
 protected: // methods
@@ -63,6 +66,7 @@ CartesianIterator<DIM, OP>::CartesianIterator(OP op) : TPatchIterator<CartesianP
 {
   m_Res = NULL;
   m_ResLength = 0;
+  this->setPatchType(1001);
 }
 
 template <unsigned int DIM, typename OP>
@@ -77,7 +81,7 @@ void CartesianIterator<DIM, OP>::checkResFieldSize(size_t i1, size_t j1, size_t
   size_t new_length = m_SizeI*m_SizeJ*m_SizeK;
   if (new_length > m_ResLength) {
     delete [] m_Res;
-    m_Res = new real [new_length*num_vars];
+    m_Res = new acc_real [new_length*num_vars];
     m_ResLength = new_length;
   }
 }
@@ -88,10 +92,20 @@ void CartesianIterator<DIM, OP>::compute(real factor, const vector<size_t> &patc
 {
   for (size_t i_patch = 0; i_patch < patches.size(); ++i_patch) {
 
-    if (patchActive(i_patch)) {
+    if (patchActive(patches[i_patch])) {
       CartesianPatch* patch = this->m_Patches[patches[i_patch]];
 
+      // skip patches without active cells (e.g. completely inside an immersed body)
+      patch->updateActiveRanges();
+      if (patch->numActiveCells() == 0) {
+        continue;
+      }
+
+      static size_t i_region = global_telemetry.region("computePatch");
+      ScopedTimer timer(i_region, patch->getIndex());
+
       checkResFieldSize(0, 0, 0, patch->sizeI(), patch->sizeJ(), patch->sizeK(), patch->numVariables());
+      ViscousGradientPass<OP>::apply(this->m_Op, patch, &m_Gradients);
 
       real Ax = patch->dy()*patch->dz();
       real Ay = patch->dx()*patch->dz();
@@ -106,12 +120,15 @@ void CartesianIterator<DIM, OP>::compute(real factor, const vector<size_t> &patc
 
       real flux[5];
 
+      // faces crossed by an immersed boundary get the wall flux of the split face pass instead
+      bool has_split_faces = patch->getNumSplitGroups() > 0;
+
       for (size_t i_res = 0; i_res < DIM*m_ResLength; ++i_res) {
         m_Res[i_res] = 0;
       }
       countFlops(3);
 
-      // compute main block
+      // compute main block; only the ranges next to active cells (see CartesianPatch::updateActiveRanges)
       for (int offset = 0; offset <= 1; ++offset) {
         #ifndef DEBUG
         #pragma omp parallel
@@ -140,45 +157,49 @@ void CartesianIterator<DIM, OP>::compute(real factor, const vector<size_t> &patc
           for (size_t i = i_start; i < i_stop; ++i) {
             real y = 0.5*patch->dy();
             for (size_t j = j1; j < j2; ++j) {
-              real z = 0.5*patch->dz();
-              for (size_t k = k1; k < k2; ++k) {
-
-                GlobalDebug::xyz(x,y,z);
-
-                // x direction
-                if (i > 0 && patch->sizeI() > 2) {
-                  fill(flux, 5, 0);
-                  this->m_Op.xField(patch, i, j, k, x, y, z, Ax, flux);
-                  for (size_t i_var = 0; i_var < DIM; ++i_var) {
-                    m_Res[resIndex(i_var, i-1, j, k)] -= flux[i_var];
-                    m_Res[resIndex(i_var, i, j, k)]   += flux[i_var];
+              for (size_t i_range = patch->activeRangeBegin(i, j); i_range < patch->activeRangeEnd(i, j); ++i_range) {
+                size_t k_start = patch->activeRangeK1(i_range);
+                size_t k_stop  = patch->activeRangeK2(i_range);
+                real z = 0.5*patch->dz() + k_start*patch->dz();
+                for (size_t k = k_start; k < k_stop; ++k) {
+
+                  GlobalDebug::xyz(x,y,z);
+
+                  // x direction
+                  if (i > 0 && patch->sizeI() > 2 && !(has_split_faces && patch->isSplitFace(patch->index(i-1, j, k), patch->index(i, j, k)))) {
+                    fill(flux, 5, 0);
+                    this->m_Op.xField(patch, i, j, k, x, y, z, Ax, flux);
+                    for (size_t i_var = 0; i_var < DIM; ++i_var) {
+                      m_Res[resIndex(i_var, i-1, j, k)] -= flux[i_var];
+                      m_Res[resIndex(i_var, i, j, k)]   += flux[i_var];
+                    }
+                    countFlops(2*DIM);
                   }
-                  countFlops(2*DIM);
-                }
 
-                // y direction
-                if (j > 0 && patch->sizeJ() > 2) {
-                  fill(flux, 5, 0);
-                  this->m_Op.yField(patch, i, j, k, x, y, z, Ay, flux);
-                  for (size_t i_var = 0; i_var < DIM; ++i_var) {
-                    m_Res[resIndex(i_var, i, j-1, k)] -= flux[i_var];
-                    m_Res[resIndex(i_var, i, j, k)]   += flux[i_var];
+                  // y direction
+                  if (j > 0 && patch->sizeJ() > 2 && !(has_split_faces && patch->isSplitFace(patch->index(i, j-1, k), patch->index(i, j, k)))) {
+                    fill(flux, 5, 0);
+                    this->m_Op.yField(patch, i, j, k, x, y, z, Ay, flux);
+                    for (size_t i_var = 0; i_var < DIM; ++i_var) {
+                      m_Res[resIndex(i_var, i, j-1, k)] -= flux[i_var];
+                      m_Res[resIndex(i_var, i, j, k)]   += flux[i_var];
+                    }
+                    countFlops(2*DIM);
                   }
-                  countFlops(2*DIM);
-                }
 
-                // z direction
-                if (k > 0 && patch->sizeK() > 2) {
-                  fill(flux, 5, 0);
-                  this->m_Op.zField(patch, i, j, k, x, y, z, Az, flux);
-                  for (size_t i_var = 0; i_var < DIM; ++i_var) {
-                    m_Res[resIndex(i_var, i, j, k-1)] -= flux[i_var];
-                    m_Res[resIndex(i_var, i, j, k)]   += flux[i_var];
+                  // z direction
+                  if (k > 0 && patch->sizeK() > 2 && !(has_split_faces && patch->isSplitFace(patch->index(i, j, k-1), patch->index(i, j, k)))) {
+                    fill(flux, 5, 0);
+                    this->m_Op.zField(patch, i, j, k, x, y, z, Az, flux);
+                    for (size_t i_var = 0; i_var < DIM; ++i_var) {
+                      m_Res[resIndex(i_var, i, j, k-1)] -= flux[i_var];
+                      m_Res[resIndex(i_var, i, j, k)]   += flux[i_var];
+                    }
+                    countFlops(2*DIM);
                   }
-                  countFlops(2*DIM);
-                }
 
-                z += patch->dz();
+                  z += patch->dz();
+                }
               }
               y += patch->dy();
             }
@@ -307,8 +328,32 @@ void CartesianIterator<DIM, OP>::compute(real factor, const vector<size_t> &patc
         }
       }
 
+      // split faces (immersed boundaries, see SplitFaceBuilder)
+      // the faces of a group belong to different cells, so they can be processed in parallel
+      for (size_t i_group = 0; i_group < patch->getNumSplitGroups(); ++i_group) {
+        splitface_t* split_faces = patch->getSplitFaces();
+        int face1 = patch->getSplitGroupLimit(i_group);
+        int face2 = patch->getSplitGroupLimit(i_group + 1);
+        #ifndef DEBUG
+        #pragma omp parallel for
+        #endif
+        for (int i_face = face1; i_face < face2; ++i_face) {
+          if (!split_faces[i_face].inside) {
+            real flux[DIM];
+            fill(flux, DIM, 0);
+            this->m_Op.splitFlux(patch, split_faces[i_face], flux);
+            size_t i, j, k;
+            patch->ijk(split_faces[i_face].idx, i, j, k);
+            for (size_t i_var = 0; i_var < DIM; ++i_var) {
+              m_Res[resIndex(i_var, i, j, k)] += flux[i_var];
+            }
+            countFlops(DIM);
+          }
+        }
+      }
+
       // advance to next iteration level (time)
-      real patch_factor = factor/patch->dV();
+      acc_real patch_factor = factor/patch->dV();
       for (size_t i = i1; i < i2; ++i) {
         for (size_t j = j1; j < j2; ++j) {
           for (size_t k = k1; k < k2; ++k) {
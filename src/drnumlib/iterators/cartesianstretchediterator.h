@@ -0,0 +1,285 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef CARTESIANSTRETCHEDITERATOR_H
+#define CARTESIANSTRETCHEDITERATOR_H
+
+#include "cartesianstretchedpatch.h"
+#include "iterators/tpatchiterator.h"
+#include "viscousgradients.h"
+#include "telemetry.h"
+
+/**
+ * Flux iterator for CartesianStretchedPatch.
+ * The operation interface is the one of CartesianIterator (xField, xWallM, xWallP, ...), only the
+ * face areas and the cell centres passed to the operation vary along the grid lines and the update
+ * uses the individual cell volumes.
+ *
+ * Inside the operation the patch is still seen through the CartesianPatch accessors (dx(),
+ * xyzCell(), ...), which are not virtual and return the mean spacing. Hence only operations which
+ * do not use the cell spacing give the correct geometry: inviscid fluxes with Upwind1 (Upwind2
+ * assumes equal spacing of the neighbours and loses accuracy where the grid stretches), far-field
+ * and slip walls. Viscous fluxes are not supported; operations with cached viscous gradients
+ * (see ViscousGradientPass) are rejected. Level set boundary conditions and split faces refuse
+ * stretched patches as well.
+ */
+template <unsigned int DIM, typename OP>
+class CartesianStretchedIterator : public TPatchIterator<CartesianStretchedPatch, OP>
+{
+
+protected: // attributes
+
+  acc_real* m_Res;
+  size_t    m_ResLength;
+  size_t    m_SizeJ;
+  size_t    m_SizeK;
+
+
+protected: // methods
+
+  void checkResFieldSize(size_t size_i, size_t size_j, size_t size_k, size_t num_vars);
+
+
+public:
+
+  using TPatchIterator<CartesianStretchedPatch, OP>::addPatch;
+  using PatchIterator::patchActive;
+
+  CartesianStretchedIterator(OP op);
+
+  size_t resIndex(size_t i_var, size_t i, size_t j, size_t k) { return m_ResLength*i_var + i*m_SizeJ*m_SizeK + j*m_SizeK + k; }
+
+  virtual void compute(real factor, const vector<size_t> &patches);
+
+};
+
+template <unsigned int DIM, typename OP>
+CartesianStretchedIterator<DIM, OP>::CartesianStretchedIterator(OP op) : TPatchIterator<CartesianStretchedPatch, OP>(op)
+{
+  m_Res = NULL;
+  m_ResLength = 0;
+  this->setPatchType(1002);
+  if (ViscousGradientPass<OP>::active) {
+    ERROR("viscous gradients are not supported on stretched patches (CartesianStretchedIterator)");
+  }
+}
+
+template <unsigned int DIM, typename OP>
+void CartesianStretchedIterator<DIM, OP>::checkResFieldSize(size_t size_i, size_t size_j, size_t size_k, size_t num_vars)
+{
+  m_SizeJ = size_j;
+  m_SizeK = size_k;
+  size_t new_length = size_i*size_j*size_k;
+  if (new_length > m_ResLength) {
+    delete [] m_Res;
+    m_Res = new acc_real [new_length*num_vars];
+  }
+  m_ResLength = max(m_ResLength, new_length);
+}
+
+
+template <unsigned int DIM, typename OP>
+void CartesianStretchedIterator<DIM, OP>::compute(real factor, const vector<size_t> &patches)
+{
+  for (size_t i_patch = 0; i_patch < patches.size(); ++i_patch) {
+
+    if (patchActive(patches[i_patch])) {
+      CartesianStretchedPatch* patch = this->m_Patches[patches[i_patch]];
+      static size_t i_region = global_telemetry.region("computePatch");
+      ScopedTimer timer(i_region, patch->getIndex());
+
+      size_t i2 = patch->sizeI();
+      size_t j2 = patch->sizeJ();
+      size_t k2 = patch->sizeK();
+      checkResFieldSize(i2, j2, k2, patch->numVariables());
+
+      const real* dx = patch->dxCells();
+      const real* dy = patch->dyCells();
+      const real* dz = patch->dzCells();
+
+      real flux[5];
+
+      for (size_t i_res = 0; i_res < DIM*m_ResLength; ++i_res) {
+        m_Res[i_res] = 0;
+      }
+
+      // compute main block
+      // face areas: Ax = dy[j]*dz[k], Ay = dx[i]*dz[k], Az = dx[i]*dy[j]
+      for (int offset = 0; offset <= 1; ++offset) {
+        #ifndef DEBUG
+        #pragma omp parallel
+        #endif
+        {
+          #ifdef OPEN_MP
+          size_t num_threads = omp_get_num_threads();
+          size_t tid         = omp_get_thread_num();
+          #else
+          size_t num_threads = 1;
+          size_t tid         = 0;
+          #endif
+          size_t n           = i2/(2*num_threads) + 1;
+          size_t i_start     = (offset + 2*tid)*n;
+          size_t i_stop      = min(i2, i_start + n);
+
+          real flux[5];
+
+          for (size_t i = i_start; i < i_stop; ++i) {
+            real x = patch->xCell(i);
+            for (size_t j = 0; j < j2; ++j) {
+              real y    = patch->yCell(j);
+              real Az   = dx[i]*dy[j];
+              for (size_t k = 0; k < k2; ++k) {
+                real z  = patch->zCell(k);
+                real Ax = dy[j]*dz[k];
+                real Ay = dx[i]*dz[k];
+                countFlops(3);
+
+                GlobalDebug::xyz(x,y,z);
+
+                // x direction
+                if (i > 0 && i2 > 2) {
+                  fill(flux, 5, 0);
+                  this->m_Op.xField(patch, i, j, k, x, y, z, Ax, flux);
+                  for (size_t i_var = 0; i_var < DIM; ++i_var) {
+                    m_Res[resIndex(i_var, i-1, j, k)] -= flux[i_var];
+                    m_Res[resIndex(i_var, i, j, k)]   += flux[i_var];
+                  }
+                  countFlops(2*DIM);
+                }
+
+                // y direction
+                if (j > 0 && j2 > 2) {
+                  fill(flux, 5, 0);
+                  this->m_Op.yField(patch, i, j, k, x, y, z, Ay, flux);
+                  for (size_t i_var = 0; i_var < DIM; ++i_var) {
+                    m_Res[resIndex(i_var, i, j-1, k)] -= flux[i_var];
+                    m_Res[resIndex(i_var, i, j, k)]   += flux[i_var];
+                  }
+                  countFlops(2*DIM);
+                }
+
+                // z direction
+                if (k > 0 && k2 > 2) {
+                  fill(flux, 5, 0);
+                  this->m_Op.zField(patch, i, j, k, x, y, z, Az, flux);
+                  for (size_t i_var = 0; i_var < DIM; ++i_var) {
+                    m_Res[resIndex(i_var, i, j, k-1)] -= flux[i_var];
+                    m_Res[resIndex(i_var, i, j, k)]   += flux[i_var];
+                  }
+                  countFlops(2*DIM);
+                }
+              }
+            }
+          }
+        }
+      }
+
+      // compute walls, coordinates are the ones of the cell centres as in CartesianIterator
+      //
+      // .. x walls
+      if (i2 > 2) {
+        for (size_t j = 0; j < j2; ++j) {
+          real y = patch->yCell(j);
+          for (size_t k = 0; k < k2; ++k) {
+            real z  = patch->zCell(k);
+            real Ax = dy[j]*dz[k];
+            fill(flux, 5, 0);
+            this->m_Op.xWallM(patch, 0, j, k, patch->xCell(0), y, z, Ax, flux);
+            for (size_t i_var = 0; i_var < DIM; ++i_var) {
+              m_Res[resIndex(i_var, 0, j, k)] += flux[i_var];
+            }
+            fill(flux, 5, 0);
+            this->m_Op.xWallP(patch, i2, j, k, patch->xNode(i2) + 0.5*dx[i2-1], y, z, Ax, flux);
+            for (size_t i_var = 0; i_var < DIM; ++i_var) {
+              m_Res[resIndex(i_var, i2-1, j, k)] -= flux[i_var];
+            }
+            countFlops(2*DIM + 1);
+          }
+        }
+      }
+
+      // .. y walls
+      if (j2 > 2) {
+        for (size_t i = 0; i < i2; ++i) {
+          real x = patch->xCell(i);
+          for (size_t k = 0; k < k2; ++k) {
+            real z  = patch->zCell(k);
+            real Ay = dx[i]*dz[k];
+            fill(flux, 5, 0);
+            this->m_Op.yWallM(patch, i, 0, k, x, patch->yCell(0), z, Ay, flux);
+            for (size_t i_var = 0; i_var < DIM; ++i_var) {
+              m_Res[resIndex(i_var, i, 0, k)] += flux[i_var];
+            }
+            fill(flux, 5, 0);
+            this->m_Op.yWallP(patch, i, j2, k, x, patch->yNode(j2) + 0.5*dy[j2-1], z, Ay, flux);
+            for (size_t i_var = 0; i_var < DIM; ++i_var) {
+              m_Res[resIndex(i_var, i, j2-1, k)] -= flux[i_var];
+            }
+            countFlops(2*DIM + 1);
+          }
+        }
+      }
+
+      // .. z walls
+      if (k2 > 2) {
+        for (size_t i = 0; i < i2; ++i) {
+          real x = patch->xCell(i);
+          for (size_t j = 0; j < j2; ++j) {
+            real y  = patch->yCell(j);
+            real Az = dx[i]*dy[j];
+            fill(flux, 5, 0);
+            this->m_Op.zWallM(patch, i, j, 0, x, y, patch->zCell(0), Az, flux);
+            for (size_t i_var = 0; i_var < DIM; ++i_var) {
+              m_Res[resIndex(i_var, i, j, 0)] += flux[i_var];
+            }
+            fill(flux, 5, 0);
+            this->m_Op.zWallP(patch, i, j, k2, x, y, patch->zNode(k2) + 0.5*dz[k2-1], Az, flux);
+            for (size_t i_var = 0; i_var < DIM; ++i_var) {
+              m_Res[resIndex(i_var, i, j, k2-1)] -= flux[i_var];
+            }
+            countFlops(2*DIM + 1);
+          }
+        }
+      }
+
+      // advance to next iteration level (time), individual cell volumes
+      #ifndef DEBUG
+      #pragma omp parallel for
+      #endif
+      for (int i = 0; i < int(i2); ++i) {
+        for (size_t j = 0; j < j2; ++j) {
+          acc_real line_factor = factor/(dx[i]*dy[j]);
+          for (size_t k = 0; k < k2; ++k) {
+            if (patch->isActive(i,j,k)) {
+              acc_real cell_factor = line_factor/dz[k];
+              for (size_t i_var = 0; i_var < DIM; ++i_var) {
+                patch->f(0, i_var, i, j, k) = patch->f(1, i_var, i, j, k) + cell_factor*m_Res[resIndex(i_var, i, j, k)];
+              }
+              countFlops(1 + 2*DIM);
+            }
+          }
+          countFlops(2);
+        }
+      }
+    }
+  }
+}
+
+#endif // CARTESIANSTRETCHEDITERATOR_H
@@ -44,6 +44,7 @@ template <unsigned int DIM, typename OP>
 GPU_CartesianIterator<DIM,OP>::GPU_CartesianIterator(OP op, int cuda_device, size_t thread_limit)
   : GPU_PatchIterator<DIM, CartesianPatch, GPU_CartesianPatch, OP>(op, cuda_device, thread_limit)
 {
+  this->setPatchType(1001);
 }
 
 #ifndef NDEBUG
@@ -24,6 +24,7 @@
 #include "patch.h"
 #include "patchgrid.h"
 #include "codestring.h"
+#include "telemetry.h"
 
 class PatchIterator
 {
@@ -34,11 +35,13 @@ private: // attributes
   vector<bool>   m_PatchActive;
 
   CodeString m_SolverCodes;
+  size_t     m_PatchType;  ///< patch type code this iterator works on (0: any)
 
 
 public:
 
   PatchIterator();
+  virtual ~PatchIterator() {}
 
   virtual void updateHost() { BUG; }
   virtual void updateDevice() { BUG; }
@@ -69,12 +72,25 @@ public:
     */
   CodeString getCodeString();
 
+  /**
+    * Set the patch type code (see Patch::accessPatchType) this iterator works on.
+    * @param patch_type the type code, 0 for any patch type
+    */
+  void setPatchType(size_t patch_type) { m_PatchType = patch_type; }
+
+  /**
+    * Get the patch type code this iterator works on.
+    * @return the type code, 0 for any patch type
+    */
+  size_t getPatchType() { return m_PatchType; }
+
 };
 
 inline PatchIterator::PatchIterator()
 {
   //m_Patches.reserve(max(size_t(100), patch_grid.getNumPatches()));
   m_SolverCodes = string("void");
+  m_PatchType = 0;
 }
 
 inline void PatchIterator::computeAll(real factor)
@@ -105,7 +121,9 @@ inline CodeString PatchIterator::getCodeString()
 
 inline void PatchIterator::copyDonorData(size_t i_field)
 {
+  static size_t i_region = global_telemetry.region("copyDonorDataPatch");
   for (size_t i_patch = 0; i_patch < m_Patches.size(); ++i_patch) {
+    ScopedTimer timer(i_region, m_Patches[i_patch]->getIndex());
     m_Patches[i_patch]->accessDonorDataDirect(i_field);
   }
 }
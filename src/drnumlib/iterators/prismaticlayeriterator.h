@@ -0,0 +1,194 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef PRISMATICLAYERITERATOR_H
+#define PRISMATICLAYERITERATOR_H
+
+#include "prismaticlayerpatch.h"
+#include "iterators/tpatchiterator.h"
+#include "telemetry.h"
+
+/**
+ * Flux iterator for PrismaticLayerPatch.
+ *
+ * The sweeps follow the storage order of the patch (wall normal k-lines):
+ *  - layer faces: one k-line per reference face, all residual updates stay inside the k-line,
+ *    so the k-lines are processed in parallel,
+ *  - lateral faces: edge groups of the patch, the edges of a group do not share a k-line,
+ *    the inner loop runs along both k-lines of the edge.
+ *
+ * The operation OP has to provide (A is the area vector, x the face centre):
+ *  - innerFlux(patch, l1, l2, x, A, flux): flux from cell l1 to cell l2, A points from l1 to l2,
+ *  - wallFlux(patch, l, x, A, flux): flux on the reference surface, A points into cell l,
+ *  - outerFlux(patch, l, x, A, flux): flux on the outer and lateral boundaries, A points out of cell l.
+ */
+template <unsigned int DIM, typename OP>
+class PrismaticLayerIterator : public TPatchIterator<PrismaticLayerPatch, OP>
+{
+
+protected: // attributes
+
+  acc_real* m_Res;
+  size_t    m_ResLength;
+
+
+protected: // methods
+
+  void checkResFieldSize(size_t new_length, size_t num_vars);
+
+
+public:
+
+  using TPatchIterator<PrismaticLayerPatch, OP>::addPatch;
+  using PatchIterator::patchActive;
+
+  PrismaticLayerIterator(OP op);
+
+  size_t resIndex(size_t i_var, size_t l_cell) { return m_ResLength*i_var + l_cell; }
+
+  virtual void compute(real factor, const vector<size_t> &patches);
+
+};
+
+template <unsigned int DIM, typename OP>
+PrismaticLayerIterator<DIM, OP>::PrismaticLayerIterator(OP op) : TPatchIterator<PrismaticLayerPatch, OP>(op)
+{
+  m_Res = NULL;
+  m_ResLength = 0;
+  this->setPatchType(1010);
+}
+
+template <unsigned int DIM, typename OP>
+void PrismaticLayerIterator<DIM, OP>::checkResFieldSize(size_t new_length, size_t num_vars)
+{
+  if (new_length > m_ResLength) {
+    delete [] m_Res;
+    m_Res = new acc_real [new_length*num_vars];
+    m_ResLength = new_length;
+  }
+}
+
+template <unsigned int DIM, typename OP>
+void PrismaticLayerIterator<DIM, OP>::compute(real factor, const vector<size_t> &patches)
+{
+  for (size_t i_patch = 0; i_patch < patches.size(); ++i_patch) {
+
+    if (patchActive(patches[i_patch])) {
+      PrismaticLayerPatch* patch = this->m_Patches[patches[i_patch]];
+      static size_t i_region = global_telemetry.region("computePatch");
+      ScopedTimer timer(i_region, patch->getIndex());
+
+      checkResFieldSize(patch->variableSize(), patch->numVariables());
+      for (size_t i_res = 0; i_res < DIM*m_ResLength; ++i_res) {
+        m_Res[i_res] = 0;
+      }
+
+      size_t num_layers = patch->numLayers();
+
+      // layer faces along the k-lines
+      #ifndef DEBUG
+      #pragma omp parallel for
+      #endif
+      for (int i_2d = 0; i_2d < int(patch->num2DFaces()); ++i_2d) {
+        real flux[5];
+        size_t l_first = patch->index(i_2d, 0);
+
+        // .. reference surface (wall)
+        fill(flux, 5, 0);
+        this->m_Op.wallFlux(patch, l_first, patch->layerFaceCentre(i_2d, 0), patch->layerFaceNormal(i_2d, 0), flux);
+        for (size_t i_var = 0; i_var < DIM; ++i_var) {
+          m_Res[resIndex(i_var, l_first)] += flux[i_var];
+        }
+        countFlops(DIM);
+
+        // .. between layers
+        for (size_t i_level = 1; i_level < num_layers; ++i_level) {
+          size_t l1 = l_first + i_level - 1;
+          fill(flux, 5, 0);
+          this->m_Op.innerFlux(patch, l1, l1 + 1, patch->layerFaceCentre(i_2d, i_level), patch->layerFaceNormal(i_2d, i_level), flux);
+          for (size_t i_var = 0; i_var < DIM; ++i_var) {
+            m_Res[resIndex(i_var, l1)]     -= flux[i_var];
+            m_Res[resIndex(i_var, l1 + 1)] += flux[i_var];
+          }
+          countFlops(2*DIM);
+        }
+
+        // .. outer boundary
+        size_t l_last = l_first + num_layers - 1;
+        fill(flux, 5, 0);
+        this->m_Op.outerFlux(patch, l_last, patch->layerFaceCentre(i_2d, num_layers), patch->layerFaceNormal(i_2d, num_layers), flux);
+        for (size_t i_var = 0; i_var < DIM; ++i_var) {
+          m_Res[resIndex(i_var, l_last)] -= flux[i_var];
+        }
+        countFlops(DIM);
+      }
+
+      // lateral faces, the edges of a group belong to different k-lines
+      for (size_t i_group = 0; i_group < patch->numEdgeGroups(); ++i_group) {
+        int edge1 = patch->getEdgeGroupLimit(i_group);
+        int edge2 = patch->getEdgeGroupLimit(i_group + 1);
+        #ifndef DEBUG
+        #pragma omp parallel for
+        #endif
+        for (int i_edge = edge1; i_edge < edge2; ++i_edge) {
+          real flux[5];
+          const PrismEdge& edge = patch->getEdge(i_edge);
+          size_t l1_first = patch->index(edge.m_Face1, 0);
+          if (edge.m_Boundary) {
+            for (size_t i_layer = 0; i_layer < num_layers; ++i_layer) {
+              fill(flux, 5, 0);
+              this->m_Op.outerFlux(patch, l1_first + i_layer, patch->edgeFaceCentre(i_edge, i_layer), patch->edgeFaceNormal(i_edge, i_layer), flux);
+              for (size_t i_var = 0; i_var < DIM; ++i_var) {
+                m_Res[resIndex(i_var, l1_first + i_layer)] -= flux[i_var];
+              }
+              countFlops(DIM);
+            }
+          } else {
+            size_t l2_first = patch->index(edge.m_Face2, 0);
+            for (size_t i_layer = 0; i_layer < num_layers; ++i_layer) {
+              fill(flux, 5, 0);
+              this->m_Op.innerFlux(patch, l1_first + i_layer, l2_first + i_layer, patch->edgeFaceCentre(i_edge, i_layer), patch->edgeFaceNormal(i_edge, i_layer), flux);
+              for (size_t i_var = 0; i_var < DIM; ++i_var) {
+                m_Res[resIndex(i_var, l1_first + i_layer)] -= flux[i_var];
+                m_Res[resIndex(i_var, l2_first + i_layer)] += flux[i_var];
+              }
+              countFlops(2*DIM);
+            }
+          }
+        }
+      }
+
+      // advance to next iteration level (time)
+      #ifndef DEBUG
+      #pragma omp parallel for
+      #endif
+      for (int l_cell = 0; l_cell < int(patch->variableSize()); ++l_cell) {
+        if (patch->isActive(l_cell)) {
+          acc_real cell_factor = factor/patch->cellVolume(l_cell);
+          for (size_t i_var = 0; i_var < DIM; ++i_var) {
+            patch->getVariable(0, i_var)[l_cell] = patch->getVariable(1, i_var)[l_cell] + cell_factor*m_Res[resIndex(i_var, l_cell)];
+          }
+        }
+      }
+    }
+  }
+}
+
+#endif // PRISMATICLAYERITERATOR_H
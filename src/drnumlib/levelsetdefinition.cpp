@@ -1,4 +1,5 @@
 #include "levelsetdefinition.h"
+#include "levelsetprogram.h"
 
 LevelSetDefinition::LevelSetDefinition()
 {
@@ -9,3 +10,15 @@ void LevelSetDefinition::getLowestLevelSets(vector<LevelSetDefinition*>& my_lowe
   my_lowest_levelsets.clear();
   my_lowest_levelsets.push_back(this);
 }
+
+void LevelSetDefinition::calcDistances(const real* xo, const real* yo, const real* zo, real* g, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    g[i] = calcDistance(xo[i], yo[i], zo[i]);
+  }
+}
+
+void LevelSetDefinition::compile(LevelSetProgram& program)
+{
+  program.addLeaf(this);
+}
@@ -2,6 +2,7 @@
 #define LEVELSETDEFINITION_H
 
 class LevelSetDefinition;
+class LevelSetProgram;
 
 #include "drnum.h"
 
@@ -33,6 +34,26 @@ public:
 
   real calcDistance(vec3_t xyzo) { return calcDistance (xyzo[0], xyzo[1],xyzo[2]); }
 
+  /**
+    * Compute the levelset values for a batch of points.
+    * Derived classes may overload this, if a batch can be computed more efficiently.
+    * Must be thread safe for all classes used as leaves of a LevelSetProgram.
+    */
+  virtual void calcDistances(const real* xo, const real* yo, const real* zo, real* g, size_t n);
+
+  /**
+    * Append the evaluation of this levelset to a postfix program.
+    * Leaves are loaded directly, combined levelsets compile their children first.
+    */
+  virtual void compile(LevelSetProgram& program);
+
+  /**
+    * Lipschitz constant of the levelset function, i.e. |G(a) - G(b)| <= L*|a - b|.
+    * Used to skip patches and blocks of cells far away from the surface.
+    * The default MAX_REAL means "unknown" and disables any culling.
+    */
+  virtual real getLipschitz() { return MAX_REAL; }
+
   virtual void getLowestLevelSets(vector<LevelSetDefinition*>& my_lowest_levelsets);
 
   virtual real evalReal() {return getKnownDistance();}
@@ -0,0 +1,174 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "levelsetfile.h"
+
+#include <fstream>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const int    LEVELSETFILE_VERSION = 1;
+static const size_t LEVELSETFILE_ALIGN   = 64;
+
+LevelSetFile::LevelSetFile(PatchGrid *patch_grid, string geometry_file_name)
+{
+  m_PatchGrid    = patch_grid;
+  m_GridHash     = gridHash(patch_grid);
+  m_GeometryHash = fileHash(geometry_file_name);
+}
+
+unsigned long long LevelSetFile::hashBytes(const void *data, size_t num_bytes, unsigned long long hash)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < num_bytes; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+unsigned long long LevelSetFile::gridHash(PatchGrid *patch_grid)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  size_t num_patches = patch_grid->getNumPatches();
+  hash = hashBytes(&num_patches, sizeof(num_patches), hash);
+  for (size_t i_patch = 0; i_patch < num_patches; ++i_patch) {
+    Patch* patch = patch_grid->getPatch(i_patch);
+    size_t num_cells = patch->variableSize();
+    hash = hashBytes(&num_cells, sizeof(num_cells), hash);
+    for (size_t i_cell = 0; i_cell < num_cells; ++i_cell) {
+      vec3_t x = patch->xyzoCell(i_cell);
+      float xf[3] = {float(x[0]), float(x[1]), float(x[2])};
+      hash = hashBytes(xf, sizeof(xf), hash);
+    }
+  }
+  return hash;
+}
+
+unsigned long long LevelSetFile::fileHash(string file_name)
+{
+  ifstream file(file_name.c_str(), ios::binary);
+  if (!file) {
+    return 0;
+  }
+  unsigned long long hash = 14695981039346656037ULL;
+  vector<char> buffer(1 << 20);
+  while (file) {
+    file.read(&buffer[0], buffer.size());
+    hash = hashBytes(&buffer[0], file.gcount(), hash);
+  }
+  return hash;
+}
+
+void LevelSetFile::write(string file_name, size_t i_var, size_t i_field)
+{
+  size_t num_patches = m_PatchGrid->getNumPatches();
+  header_t header;
+  memset(&header, 0, sizeof(header));
+  strncpy(header.magic, "DRNUMLS", 8);
+  header.version       = LEVELSETFILE_VERSION;
+  header.real_size     = sizeof(real);
+  header.grid_hash     = m_GridHash;
+  header.geometry_hash = m_GeometryHash;
+  header.num_patches   = num_patches;
+
+  // offsets of the (aligned) data blocks
+  vector<unsigned long long> table(2*num_patches);
+  size_t offset = sizeof(header_t) + table.size()*sizeof(unsigned long long);
+  for (size_t i_patch = 0; i_patch < num_patches; ++i_patch) {
+    offset = LEVELSETFILE_ALIGN*((offset + LEVELSETFILE_ALIGN - 1)/LEVELSETFILE_ALIGN);
+    table[2*i_patch]     = offset;
+    table[2*i_patch + 1] = m_PatchGrid->getPatch(i_patch)->variableSize();
+    offset += table[2*i_patch + 1]*sizeof(real);
+  }
+
+  ofstream file(file_name.c_str(), ios::binary);
+  if (!file) {
+    ERROR("cannot write level set file");
+  }
+  file.write(reinterpret_cast<char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<char*>(&table[0]), table.size()*sizeof(unsigned long long));
+  size_t position = sizeof(header_t) + table.size()*sizeof(unsigned long long);
+  char zero[LEVELSETFILE_ALIGN];
+  memset(zero, 0, LEVELSETFILE_ALIGN);
+  for (size_t i_patch = 0; i_patch < num_patches; ++i_patch) {
+    file.write(zero, table[2*i_patch] - position);
+    Patch* patch = m_PatchGrid->getPatch(i_patch);
+    patch->copyFieldToHost(i_field);
+    file.write(reinterpret_cast<char*>(patch->getVariable(i_field, i_var)), patch->variableSize()*sizeof(real));
+    position = table[2*i_patch] + patch->variableSize()*sizeof(real);
+  }
+}
+
+bool LevelSetFile::read(string file_name, size_t i_var, size_t i_field)
+{
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || size_t(file_stat.st_size) < sizeof(header_t)) {
+    close(fd);
+    return false;
+  }
+  size_t file_size = file_stat.st_size;
+  void* map = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  const char* data = static_cast<const char*>(map);
+  const header_t* header = reinterpret_cast<const header_t*>(data);
+
+  bool ok = true;
+  size_t num_patches = m_PatchGrid->getNumPatches();
+  if (strncmp(header->magic, "DRNUMLS", 8) != 0) {
+    ok = false;
+  } else if (header->version != LEVELSETFILE_VERSION || header->real_size != int(sizeof(real))) {
+    ok = false;
+  } else if (header->grid_hash != m_GridHash || header->geometry_hash != m_GeometryHash) {
+    ok = false;
+  } else if (header->num_patches != num_patches) {
+    ok = false;
+  } else if (sizeof(header_t) + 2*num_patches*sizeof(unsigned long long) > file_size) {
+    ok = false;
+  }
+  if (ok) {
+    const unsigned long long* table = reinterpret_cast<const unsigned long long*>(data + sizeof(header_t));
+    for (size_t i_patch = 0; i_patch < num_patches; ++i_patch) {
+      Patch* patch = m_PatchGrid->getPatch(i_patch);
+      if (table[2*i_patch + 1] != patch->variableSize() || table[2*i_patch] + patch->variableSize()*sizeof(real) > file_size) {
+        ok = false;
+        break;
+      }
+    }
+    if (ok) {
+      for (size_t i_patch = 0; i_patch < num_patches; ++i_patch) {
+        Patch* patch = m_PatchGrid->getPatch(i_patch);
+        memcpy(patch->getVariable(i_field, i_var), data + table[2*i_patch], patch->variableSize()*sizeof(real));
+      }
+    }
+  }
+  munmap(map, file_size);
+  return ok;
+}
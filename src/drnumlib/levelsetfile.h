@@ -0,0 +1,116 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef LEVELSETFILE_H
+#define LEVELSETFILE_H
+
+#include "drnum.h"
+#include "patchgrid.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Binary level set cache for a grid and geometry pair.
+ *
+ * The file holds one variable (normally G of a DiscreteLevelSet) for all patches of a PatchGrid.
+ * It is keyed by a hash of all cell centres of the grid and a hash of the geometry file contents,
+ * so a stored level set is only used if neither the grid nor the geometry have changed.
+ *
+ * File layout (native byte order, data blocks aligned to 64 bytes):
+ *  header:  char[8] "DRNUMLS", int version, int sizeof(real),
+ *           uint64 grid hash, uint64 geometry hash, uint64 number of patches
+ *  table:   number of patches x (uint64 offset, uint64 number of cells)
+ *  data:    number of cells x real for every patch
+ *
+ * The file is memory mapped for reading, the data are copied directly into the patches.
+ */
+class LevelSetFile
+{
+
+protected: // data types
+
+  struct header_t
+  {
+    char               magic[8];
+    int                version;
+    int                real_size;
+    unsigned long long grid_hash;
+    unsigned long long geometry_hash;
+    unsigned long long num_patches;
+  };
+
+
+protected: // attributes
+
+  PatchGrid*         m_PatchGrid;
+  unsigned long long m_GridHash;
+  unsigned long long m_GeometryHash;
+
+
+protected: // methods
+
+  static unsigned long long hashBytes(const void* data, size_t num_bytes, unsigned long long hash);
+
+
+public: // methods
+
+  /**
+   * @param patch_grid the grid (patches must have been created already)
+   * @param geometry_file_name the geometry file (only used for the hash)
+   */
+  LevelSetFile(PatchGrid* patch_grid, string geometry_file_name);
+
+  /**
+   * Compute a hash of the grid (cell centres of all patches).
+   * @param patch_grid the grid
+   * @return the hash (FNV-1a, 64 bit)
+   */
+  static unsigned long long gridHash(PatchGrid* patch_grid);
+
+  /**
+   * Compute a hash of the contents of a file.
+   * @param file_name the name of the file
+   * @return the hash (FNV-1a, 64 bit), 0 if the file cannot be read
+   */
+  static unsigned long long fileHash(string file_name);
+
+  /**
+   * Store a variable of all patches.
+   * @param file_name the name of the level set file
+   * @param i_var the index of the level set variable
+   * @param i_field the index of the field
+   */
+  void write(string file_name, size_t i_var, size_t i_field = 0);
+
+  /**
+   * Load a variable of all patches, if the file matches grid and geometry.
+   * @param file_name the name of the level set file
+   * @param i_var the index of the level set variable
+   * @param i_field the index of the field
+   * @return true if the level set has been loaded
+   */
+  bool read(string file_name, size_t i_var, size_t i_field = 0);
+
+};
+
+#endif // LEVELSETFILE_H
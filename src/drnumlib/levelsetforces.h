@@ -0,0 +1,349 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef LEVELSETFORCES_H
+#define LEVELSETFORCES_H
+
+template <unsigned int DIM, typename LS, typename TGas>
+class LevelSetForces;
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "cartesianpatch.h"
+#include "geometrytools.h"
+
+#include <fstream>
+
+#ifdef OPEN_MP
+#include <omp.h>
+#endif
+
+/**
+ * Integration of forces and moments on a body described by a level set (G < 0 inside).
+ *
+ * All cell faces with a sign change of G are collected once in setup(). Every face
+ * carries the fluid cell, the wall distance of this cell, the normal of the body
+ * (gradient of G) and an area weight A_face*|n_d|, so that the weights of all faces
+ * representing a piece of surface add up to its true area. If patches overlap, a face
+ * is only counted by the finest patch whose core region contains the surface point.
+ *
+ * compute() then only gathers pressure (and the wall shear stress, if viscous) from
+ * the fluid cells. Forces and moments are given in inertial coordinates.
+ */
+template <unsigned int DIM, typename LS, typename TGas>
+class LevelSetForces
+{
+
+public: // data types
+
+  struct face_t
+  {
+    size_t i_patch;
+    size_t idx;     ///< index of the fluid cell
+    real   wgt;     ///< area weight
+    real   h;       ///< wall distance of the fluid cell
+    vec3_t n;       ///< normal of the body, pointing into the fluid (inertial coords)
+    vec3_t x;       ///< surface point (inertial coords)
+  };
+
+
+protected: // attributes
+
+  PatchGrid*     m_PatchGrid;
+  LS             m_Ls;
+  vector<face_t> m_Faces;
+  vector<size_t> m_FacePatches;   ///< patches holding at least one face
+  bool           m_Viscous;
+  real           m_PRef;
+  real           m_QRef;
+  real           m_ARef;
+  real           m_LRef;
+  vec3_t         m_XRef;
+  vec3_t         m_PressureForce;
+  vec3_t         m_ViscousForce;
+  vec3_t         m_Moment;
+
+
+protected: // methods
+
+  vec3_t gradG(CartesianPatch* patch, size_t i, size_t j, size_t k);
+  bool   ownsPoint(size_t i_patch, vec3_t xo);
+  void   addFace(size_t i_patch, size_t i1, size_t j1, size_t k1, size_t i2, size_t j2, size_t k2, real A, int dir);
+
+
+public: // methods
+
+  /**
+   * @param patch_grid the grid
+   * @param ls the level set (e.g. StoredLevelSet)
+   * @param viscous flag to add the wall shear stress
+   */
+  LevelSetForces(PatchGrid* patch_grid, LS ls, bool viscous = false);
+
+  /**
+   * Set reference values for the coefficients.
+   * @param p_ref reference pressure (subtracted from the wall pressure)
+   * @param q_ref reference dynamic pressure
+   * @param A_ref reference area
+   * @param L_ref reference length (moments)
+   * @param x_ref moment reference point
+   */
+  void setReference(real p_ref, real q_ref, real A_ref, real L_ref, vec3_t x_ref);
+
+  /**
+   * Find all surface faces. Has to be called after the level set has been computed.
+   */
+  void setup();
+
+  /**
+   * Integrate forces and moments of the current solution (field 0).
+   */
+  void compute();
+
+  /**
+   * Append a line with time, force and moment coefficients to a text file.
+   * @param file_name the log file
+   * @param t the current time
+   */
+  void write(string file_name, real t);
+
+  vec3_t force()              { return m_PressureForce + m_ViscousForce; }
+  vec3_t pressureForce()      { return m_PressureForce; }
+  vec3_t viscousForce()       { return m_ViscousForce; }
+  vec3_t moment()             { return m_Moment; }
+  vec3_t forceCoefficients()  { return (1.0/(m_QRef*m_ARef))*force(); }
+  vec3_t momentCoefficients() { return (1.0/(m_QRef*m_ARef*m_LRef))*m_Moment; }
+  size_t numFaces()           { return m_Faces.size(); }
+
+};
+
+
+template <unsigned int DIM, typename LS, typename TGas>
+LevelSetForces<DIM,LS,TGas>::LevelSetForces(PatchGrid* patch_grid, LS ls, bool viscous)
+{
+  m_PatchGrid = patch_grid;
+  m_Ls        = ls;
+  m_Viscous   = viscous;
+  m_PRef      = 0;
+  m_QRef      = 1;
+  m_ARef      = 1;
+  m_LRef      = 1;
+  m_XRef      = vec3_t(0, 0, 0);
+  m_PressureForce = vec3_t(0, 0, 0);
+  m_ViscousForce  = vec3_t(0, 0, 0);
+  m_Moment        = vec3_t(0, 0, 0);
+}
+
+template <unsigned int DIM, typename LS, typename TGas>
+void LevelSetForces<DIM,LS,TGas>::setReference(real p_ref, real q_ref, real A_ref, real L_ref, vec3_t x_ref)
+{
+  m_PRef = p_ref;
+  m_QRef = q_ref;
+  m_ARef = A_ref;
+  m_LRef = L_ref;
+  m_XRef = x_ref;
+}
+
+template <unsigned int DIM, typename LS, typename TGas>
+vec3_t LevelSetForces<DIM,LS,TGas>::gradG(CartesianPatch* patch, size_t i, size_t j, size_t k)
+{
+  size_t i1 = max(size_t(1), i) - 1, i2 = min(patch->sizeI() - 1, i + 1);
+  size_t j1 = max(size_t(1), j) - 1, j2 = min(patch->sizeJ() - 1, j + 1);
+  size_t k1 = max(size_t(1), k) - 1, k2 = min(patch->sizeK() - 1, k + 1);
+  vec3_t grad(0, 0, 0);
+  if (i2 > i1) {
+    grad[0] = (m_Ls.G(*patch, i2, j, k) - m_Ls.G(*patch, i1, j, k))/((i2 - i1)*patch->dx());
+  }
+  if (j2 > j1) {
+    grad[1] = (m_Ls.G(*patch, i, j2, k) - m_Ls.G(*patch, i, j1, k))/((j2 - j1)*patch->dy());
+  }
+  if (k2 > k1) {
+    grad[2] = (m_Ls.G(*patch, i, j, k2) - m_Ls.G(*patch, i, j, k1))/((k2 - k1)*patch->dz());
+  }
+  return grad;
+}
+
+template <unsigned int DIM, typename LS, typename TGas>
+bool LevelSetForces<DIM,LS,TGas>::ownsPoint(size_t i_patch, vec3_t xo)
+{
+  CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i_patch));
+  if (!patch->isInsideCore(xo)) {
+    return false;
+  }
+  real length = patch->computeMinChLength();
+  for (size_t i_other = 0; i_other < m_PatchGrid->getNumPatches(); ++i_other) {
+    if (i_other == i_patch) {
+      continue;
+    }
+    CartesianPatch* other = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i_other));
+    if (!other) {
+      continue;
+    }
+    if (!GeometryTools::isInsideCartesianBox(xo, other->accessBBoxXYZoMin(), other->accessBBoxXYZoMax())) {
+      continue;
+    }
+    real other_length = other->computeMinChLength();
+    if (other_length < length || (other_length == length && i_other < i_patch)) {
+      if (other->isInsideCore(xo)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+template <unsigned int DIM, typename LS, typename TGas>
+void LevelSetForces<DIM,LS,TGas>::addFace(size_t i_patch, size_t i1, size_t j1, size_t k1, size_t i2, size_t j2, size_t k2, real A, int dir)
+{
+  CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i_patch));
+  real G1 = m_Ls.G(*patch, i1, j1, k1);
+  real G2 = m_Ls.G(*patch, i2, j2, k2);
+  if (G1*G2 >= 0) {
+    return;
+  }
+  if (G1 < 0) {
+    swap(i1, i2);
+    swap(j1, j2);
+    swap(k1, k2);
+    swap(G1, G2);
+  }
+
+  // (i1,j1,k1) is the fluid cell now
+  real w = G1/(G1 - G2);
+  vec3_t x1 = patch->xyzCell(i1, j1, k1);
+  vec3_t x2 = patch->xyzCell(i2, j2, k2);
+  vec3_t x  = x1 + w*(x2 - x1);
+  vec3_t n  = gradG(patch, i1, j1, k1);
+  if (n.abs() < 1e-20) {
+    return;
+  }
+  n.normalise();
+
+  face_t face;
+  face.i_patch = i_patch;
+  face.idx     = patch->index(i1, j1, k1);
+  face.wgt     = A*fabs(n[dir]);
+  face.h       = max(G1, real(0.1)*patch->computeMinChLength());
+  face.x       = patch->getTransformInertial2This().transformReverse(x);
+  face.n       = patch->getTransformInertial2This().transfreeReverse(n);
+  face.n.normalise();
+  if (ownsPoint(i_patch, face.x)) {
+    m_Faces.push_back(face);
+  }
+}
+
+template <unsigned int DIM, typename LS, typename TGas>
+void LevelSetForces<DIM,LS,TGas>::setup()
+{
+  m_Faces.clear();
+  m_FacePatches.clear();
+  m_PatchGrid->buildBoundingBox(false);
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i_patch));
+    if (!patch) {
+      continue;
+    }
+    size_t num_faces = m_Faces.size();
+    real Ax = patch->dy()*patch->dz();
+    real Ay = patch->dx()*patch->dz();
+    real Az = patch->dx()*patch->dy();
+    for (size_t i = 0; i < patch->sizeI(); ++i) {
+      for (size_t j = 0; j < patch->sizeJ(); ++j) {
+        for (size_t k = 0; k < patch->sizeK(); ++k) {
+          if (i + 1 < patch->sizeI()) {
+            addFace(i_patch, i, j, k, i + 1, j, k, Ax, 0);
+          }
+          if (j + 1 < patch->sizeJ()) {
+            addFace(i_patch, i, j, k, i, j + 1, k, Ay, 1);
+          }
+          if (k + 1 < patch->sizeK()) {
+            addFace(i_patch, i, j, k, i, j, k + 1, Az, 2);
+          }
+        }
+      }
+    }
+    if (m_Faces.size() > num_faces) {
+      m_FacePatches.push_back(i_patch);
+    }
+  }
+}
+
+template <unsigned int DIM, typename LS, typename TGas>
+void LevelSetForces<DIM,LS,TGas>::compute()
+{
+  for (size_t i = 0; i < m_FacePatches.size(); ++i) {
+    m_PatchGrid->getPatch(m_FacePatches[i])->copyFieldToHost(0);
+  }
+  acc_real fpx = 0, fpy = 0, fpz = 0;
+  acc_real fvx = 0, fvy = 0, fvz = 0;
+  acc_real mx = 0, my = 0, mz = 0;
+  int N = m_Faces.size();
+
+#ifndef DEBUG
+  #pragma omp parallel for reduction(+:fpx,fpy,fpz,fvx,fvy,fvz,mx,my,mz)
+#endif
+  for (int i_face = 0; i_face < N; ++i_face) {
+    const face_t& face = m_Faces[i_face];
+    Patch* patch = m_PatchGrid->getPatch(face.i_patch);
+    dim_t<DIM> dim;
+    real var[DIM];
+    patch->getVar(dim, 0, face.idx, var);
+    real p, T, u, v, w;
+    TGas::conservativeToPrimitive(var, p, T, u, v, w);
+
+    // pressure acts against the normal of the body
+    vec3_t dF = (-(p - m_PRef)*face.wgt)*face.n;
+    fpx += dF[0];
+    fpy += dF[1];
+    fpz += dF[2];
+
+    // wall shear stress from the tangential velocity of the fluid cell
+    if (m_Viscous) {
+      vec3_t U = patch->getTransformInertial2This().transfreeReverse(vec3_t(u, v, w));
+      U -= (U*face.n)*face.n;
+      vec3_t dFv = (TGas::mu(var)*face.wgt/face.h)*U;
+      fvx += dFv[0];
+      fvy += dFv[1];
+      fvz += dFv[2];
+      dF += dFv;
+    }
+
+    vec3_t r = face.x - m_XRef;
+    vec3_t M = r.cross(dF);
+    mx += M[0];
+    my += M[1];
+    mz += M[2];
+  }
+  m_PressureForce = vec3_t(fpx, fpy, fpz);
+  m_ViscousForce  = vec3_t(fvx, fvy, fvz);
+  m_Moment        = vec3_t(mx, my, mz);
+}
+
+template <unsigned int DIM, typename LS, typename TGas>
+void LevelSetForces<DIM,LS,TGas>::write(string file_name, real t)
+{
+  ofstream file(file_name.c_str(), ios::app);
+  vec3_t cf = forceCoefficients();
+  vec3_t cm = momentCoefficients();
+  file << t << " " << cf[0] << " " << cf[1] << " " << cf[2];
+  file << " " << cm[0] << " " << cm[1] << " " << cm[2] << endl;
+}
+
+#endif // LEVELSETFORCES_H
@@ -38,6 +38,9 @@ LevelSetObject::LevelSetObject(LevelSetDefinition* levelset,
   m_NumOuterLayers     = num_outer_layers;
   m_MinInnerRelDist    = min_innerreldist;
   m_MinOuterRelDist    = min_outerreldist;
+  m_Lipschitz          = MAX_REAL;
+  m_BlockSize          = 8;
+  m_NumExactCells      = 0;
 }
 
 
@@ -47,59 +50,201 @@ void LevelSetObject::update()
   m_AffectedPatchIDs.clear();    // just to be sure
   m_FullyBlackPatchIDs.clear();  // just to be sure
 
-  // Loop for patches
-  for (size_t i_p = 0; i_p < m_PatchGrid->getNumPatches(); i_p++) {
+  // Flatten the levelset definition. Note: the definition itself must not be
+  // evaluated from several threads, since combined levelsets store intermediate
+  // values in their lowest levelsets (setKnownDistance).
+  m_Program.compile(m_LevelSetDefinition);
+  m_Lipschitz = m_LevelSetDefinition->getLipschitz();
+  size_t max_block_cells = m_BlockSize*m_BlockSize*m_BlockSize;
 
-    Patch* patch = m_PatchGrid->getPatch(i_p);
-    bool patch_affected = false;
-    bool fully_black = true;
-    real* var = patch->getVariable(m_FieldIndex, m_VarIndex);
+  // Classify patches. Cartesian patches far from the surface are culled as a whole,
+  // all others are split into blocks of cells to be checked later on.
+  vector<block_t> culled;
+  vector<block_t> blocks;
+  {
+    vector<real> work(m_Program.workspaceSize(1));
+    for (size_t i_p = 0; i_p < m_PatchGrid->getNumPatches(); i_p++) {
+      block_t block;
+      block.i_patch = i_p;
+      block.has_negative = false;
+      block.has_positive = false;
+      CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i_p));
+      if (patch) {
+        block.i1 = 0;
+        block.j1 = 0;
+        block.k1 = 0;
+        block.i2 = patch->sizeI();
+        block.j2 = patch->sizeJ();
+        block.k2 = patch->sizeK();
+        if (cullBlock(block, &work[0])) {
+          culled.push_back(block);
+          continue;
+        }
+        for (size_t i = 0; i < patch->sizeI(); i += m_BlockSize) {
+          for (size_t j = 0; j < patch->sizeJ(); j += m_BlockSize) {
+            for (size_t k = 0; k < patch->sizeK(); k += m_BlockSize) {
+              block.i1 = i;
+              block.j1 = j;
+              block.k1 = k;
+              block.i2 = min(i + m_BlockSize, patch->sizeI());
+              block.j2 = min(j + m_BlockSize, patch->sizeJ());
+              block.k2 = min(k + m_BlockSize, patch->sizeK());
+              blocks.push_back(block);
+            }
+          }
+        }
+      } else {
+        // no culling for other patch types, just batches of cells
+        size_t num_cells = m_PatchGrid->getPatch(i_p)->variableSize();
+        for (size_t l = 0; l < num_cells; l += max_block_cells) {
+          block.i1 = l;
+          block.i2 = min(l + max_block_cells, num_cells);
+          blocks.push_back(block);
+        }
+      }
+    }
+  }
 
-    // Loop for cells of patch
-    /// @todo parallel omp made corresponding loop in BlockObject extremely slow ???
-    //#pragma omp parallel for
-    for (size_t l_c = 0; l_c < patch->variableSize(); l_c++) {
-      real xc, yc, zc;
-      patch->xyzoCell(l_c,
-                      xc, yc, zc);
-      var[l_c] = m_LevelSetDefinition->calcDistance(xc, yc, zc);
-      if (var[l_c] < 0.) patch_affected = true;
-      if (var[l_c] > 0.) fully_black = false;
+  // Check blocks and evaluate the ones close to the surface
+  size_t num_exact = 0;
+#ifndef DEBUG
+  #pragma omp parallel
+#endif
+  {
+    vector<real> xc(max_block_cells), yc(max_block_cells), zc(max_block_cells), g(max_block_cells);
+    vector<real> work(m_Program.workspaceSize(max_block_cells));
+
+#ifndef DEBUG
+    #pragma omp for schedule(dynamic) reduction(+:num_exact)
+#endif
+    for (int i_block = 0; i_block < int(blocks.size()); ++i_block) {
+      block_t& block = blocks[i_block];
+      bool cartesian = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(block.i_patch)) != NULL;
+      if (!cartesian || !cullBlock(block, &work[0])) {
+        evaluateBlock(block, &xc[0], &yc[0], &zc[0], &g[0], &work[0]);
+        num_exact += cartesian ? (block.i2 - block.i1)*(block.j2 - block.j1)*(block.k2 - block.k1) : block.i2 - block.i1;
+      }
     }
+  }
+  m_NumExactCells = num_exact;
 
-    if (patch_affected) {
+  // Reduce flags of blocks per patch
+  vector<bool> patch_affected(m_PatchGrid->getNumPatches(), false);
+  vector<bool> fully_black(m_PatchGrid->getNumPatches(), true);
+  blocks.insert(blocks.end(), culled.begin(), culled.end());
+  for (size_t i_block = 0; i_block < blocks.size(); ++i_block) {
+    if (blocks[i_block].has_negative) patch_affected[blocks[i_block].i_patch] = true;
+    if (blocks[i_block].has_positive) fully_black[blocks[i_block].i_patch] = false;
+  }
+  for (size_t i_p = 0; i_p < m_PatchGrid->getNumPatches(); i_p++) {
+    if (patch_affected[i_p]) {
       m_AffectedPatchIDs.push_back(i_p);
     }
-
-    if (fully_black) {
+    if (fully_black[i_p]) {
       m_FullyBlackPatchIDs.push_back(i_p);
     }
   }
+
   // Create levelset layer data sets
   extractBCellLayers();
 }
 
 
-void LevelSetObject::extractBCellLayers()
+bool LevelSetObject::cullBlock(block_t& block, real* work)
 {
-  // Build 1st and 2nd dimension of cell layer data sets
-  m_InnerCellsLayers.resize(m_PatchGrid->getNumPatches());
-  m_OuterCellsLayers.resize(m_PatchGrid->getNumPatches());
-  for (size_t i_p = 0; i_p < m_PatchGrid->getNumPatches(); i_p++) {
-    m_InnerCellsLayers[i_p].resize(m_NumInnerLayers);
-    m_OuterCellsLayers[i_p].resize(m_NumOuterLayers);
+  CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(block.i_patch));
+
+  // Sphere around the cell centres of the block.
+  // Note: the cell centres span a (rotated) box, its diagonal is the diameter.
+  real x1, y1, z1, x2, y2, z2;
+  patch->xyzoCell(patch->index(block.i1, block.j1, block.k1),
+                  x1, y1, z1);
+  patch->xyzoCell(patch->index(block.i2 - 1, block.j2 - 1, block.k2 - 1),
+                  x2, y2, z2);
+  real xm = 0.5*(x1 + x2);
+  real ym = 0.5*(y1 + y2);
+  real zm = 0.5*(z1 + z2);
+  real radius = 0.5*sqrt((x2 - x1)*(x2 - x1) + (y2 - y1)*(y2 - y1) + (z2 - z1)*(z2 - z1));
+
+  // Band of exact values, needed for layers and gradients
+  real h = sqrt(patch->dx()*patch->dx() + patch->dy()*patch->dy() + patch->dz()*patch->dz());
+  real band = (max(m_NumInnerLayers, m_NumOuterLayers) + 2)*h;
+
+  real g_m;
+  m_Program.evaluate(&xm, &ym, &zm, &g_m, 1, work);
+  if (fabs(g_m)/m_Lipschitz <= radius + band) {
+    return false;
   }
 
-  /** @todo switch to m_AffectedPatchIDs later. Use direct patch indexing at
-    * present for simplicity. This means for non affected patches, empty
-    * lists m_InnerCellsLayers[i_p][i_layer][...cells...] and
-    * m_OuterCellsLayers[i_p][i_layer][...cells...] */
-  //  // Loop for patches affected
-  //  for (size_t ii_p = 0; ii_p < m_AffectedPatchIDs.size(); ii_p++) {
-  //    size_t i_p = m_AffectedPatchIDs[ii_p];
+  // |G - g_m| <= L*radius in the whole block
+  real g_bound = g_m > 0 ? g_m - m_Lipschitz*radius : g_m + m_Lipschitz*radius;
+  real* var = patch->getVariable(m_FieldIndex, m_VarIndex);
+  for (size_t i = block.i1; i < block.i2; ++i) {
+    for (size_t j = block.j1; j < block.j2; ++j) {
+      for (size_t k = block.k1; k < block.k2; ++k) {
+        var[patch->index(i, j, k)] = g_bound;
+      }
+    }
+  }
+  block.has_negative = g_bound < 0;
+  block.has_positive = g_bound > 0;
+  return true;
+}
 
-  // Loop for all patches. Note: direct indexing on patches!
-  for (size_t i_p = 0; i_p < m_PatchGrid->getNumPatches(); i_p++) {
+
+void LevelSetObject::evaluateBlock(block_t& block, real* x, real* y, real* z, real* g, real* work)
+{
+  Patch* patch = m_PatchGrid->getPatch(block.i_patch);
+  CartesianPatch* cart_patch = dynamic_cast<CartesianPatch*>(patch);
+  real* var = patch->getVariable(m_FieldIndex, m_VarIndex);
+
+  // gather cell indices
+  vector<size_t> cells;
+  cells.reserve(m_BlockSize*m_BlockSize*m_BlockSize);
+  if (cart_patch) {
+    for (size_t i = block.i1; i < block.i2; ++i) {
+      for (size_t j = block.j1; j < block.j2; ++j) {
+        for (size_t k = block.k1; k < block.k2; ++k) {
+          cells.push_back(cart_patch->index(i, j, k));
+        }
+      }
+    }
+  } else {
+    for (size_t l_c = block.i1; l_c < block.i2; ++l_c) {
+      cells.push_back(l_c);
+    }
+  }
+
+  for (size_t i = 0; i < cells.size(); ++i) {
+    patch->xyzoCell(cells[i],
+                    x[i], y[i], z[i]);
+  }
+  m_Program.evaluate(x, y, z, g, cells.size(), work);
+  for (size_t i = 0; i < cells.size(); ++i) {
+    var[cells[i]] = g[i];
+    if (g[i] < 0.) block.has_negative = true;
+    if (g[i] > 0.) block.has_positive = true;
+  }
+}
+
+
+void LevelSetObject::extractBCellLayers()
+{
+  // Build 1st and 2nd dimension of cell layer data sets.
+  // Note: indirect indexing on patches via m_AffectedPatchIDs. Patches not affected
+  //       cannot hold layer cells.
+  m_InnerCellsLayers.clear();
+  m_OuterCellsLayers.clear();
+  m_InnerCellsLayers.resize(m_AffectedPatchIDs.size());
+  m_OuterCellsLayers.resize(m_AffectedPatchIDs.size());
+  for (size_t ii_p = 0; ii_p < m_AffectedPatchIDs.size(); ii_p++) {
+    m_InnerCellsLayers[ii_p].resize(m_NumInnerLayers);
+    m_OuterCellsLayers[ii_p].resize(m_NumOuterLayers);
+  }
+
+  // Loop for patches affected
+  for (size_t ii_p = 0; ii_p < m_AffectedPatchIDs.size(); ii_p++) {
+    size_t i_p = m_AffectedPatchIDs[ii_p];
     Patch* patch = m_PatchGrid->getPatch(i_p);
     real* var = patch->getVariable(m_FieldIndex, m_VarIndex);
     vector<size_t> ind_cell_neighbours;
@@ -144,12 +289,12 @@ void LevelSetObject::extractBCellLayers()
         lslde_h.m_G = g;
         if (g < 0.) {
           if(m_NumInnerLayers > 0) { // only if al least a 0th layer is requested
-            // m_InnerCellsLayers[i_p][0].push_back(LSLayerDataExtrapol(l_c, g));
-            m_InnerCellsLayers[i_p][0].push_back(lslde_h);
+            // m_InnerCellsLayers[ii_p][0].push_back(LSLayerDataExtrapol(l_c, g));
+            m_InnerCellsLayers[ii_p][0].push_back(lslde_h);
           }
         } else {
           if(m_NumOuterLayers > 0) { // only if al least a 0th layer is requested
-            m_OuterCellsLayers[i_p][0].push_back(lslde_h);
+            m_OuterCellsLayers[ii_p][0].push_back(lslde_h);
           }
         }
       }
@@ -169,9 +314,9 @@ void LevelSetObject::extractBCellLayers()
       //      while (go_on) {  /// @todo recursion while really needed?
       //        go_on = false;
       size_t ll_c = 0;
-      while(ll_c < m_InnerCellsLayers[i_p][0].size()) {
-        //        for(size_t ll_c = 0; ll_c < m_InnerCellsLayers[i_p][0].size(); ll_c++) {
-        size_t l_c = m_InnerCellsLayers[i_p][0][ll_c].m_Cell;
+      while(ll_c < m_InnerCellsLayers[ii_p][0].size()) {
+        //        for(size_t ll_c = 0; ll_c < m_InnerCellsLayers[ii_p][0].size(); ll_c++) {
+        size_t l_c = m_InnerCellsLayers[ii_p][0][ll_c].m_Cell;
         //.. find min and max g-values in neighbourship as reference and
         //   compute minimal distance from g=0 (the surface) allowed
         patch->cellOverFaceNeighbours(l_c,
@@ -189,7 +334,7 @@ void LevelSetObject::extractBCellLayers()
         //.. check distance of cell
         if(var[l_c] > -min_distance) { // must replace
           //.... eliminate cell from list and unmark it
-          m_InnerCellsLayers[i_p][0].erase(m_InnerCellsLayers[i_p][0].begin()+ll_c);
+          m_InnerCellsLayers[ii_p][0].erase(m_InnerCellsLayers[ii_p][0].begin()+ll_c);
           cell_marker[l_c] = false;
 
           count++;
@@ -206,8 +351,8 @@ void LevelSetObject::extractBCellLayers()
                 lslde_h.m_VariableSize = patch->variableSize();
                 lslde_h.m_Cell = l_cn;
                 lslde_h.m_G = var[l_cn];
-                // m_InnerCellsLayers[i_p][0].push_back(LSLayerDataExtrapol(l_cn, var[l_cn]));
-                m_InnerCellsLayers[i_p][0].push_back(lslde_h);
+                // m_InnerCellsLayers[ii_p][0].push_back(LSLayerDataExtrapol(l_cn, var[l_cn]));
+                m_InnerCellsLayers[ii_p][0].push_back(lslde_h);
                 cell_marker[l_cn] = true;
                 go_on = true;  // must recheck, in case it is recursively to close to g=0
               }
@@ -222,7 +367,7 @@ void LevelSetObject::extractBCellLayers()
     }
     // Improve memory access sequence
     /** @todo Why sort will not work on LSLayerDataExtrapol::operator< ? */
-    //sort(m_InnerCellsLayers[i_p][0].begin(), m_InnerCellsLayers[i_p][0].end());
+    //sort(m_InnerCellsLayers[ii_p][0].begin(), m_InnerCellsLayers[ii_p][0].end());
 
     // Correct 0th outer layer, if distance from boundary is not sufficient
     // In case of insufficient distance:
@@ -238,8 +383,8 @@ void LevelSetObject::extractBCellLayers()
     for (size_t i_layer = 1; i_layer < m_NumInnerLayers; i_layer++) {
       //.... loop for cells in layer below
       size_t below_layer = i_layer - 1;
-      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[i_p][below_layer].size(); ll_c++) {
-        size_t l_c = m_InnerCellsLayers[i_p][below_layer][ll_c].m_Cell;
+      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[ii_p][below_layer].size(); ll_c++) {
+        size_t l_c = m_InnerCellsLayers[ii_p][below_layer][ll_c].m_Cell;
         //...... check face neighbours and insert if these belong to i_layer
         patch->cellOverFaceNeighbours(l_c,
                                       ind_cell_neighbours);
@@ -248,14 +393,14 @@ void LevelSetObject::extractBCellLayers()
           if (!cell_marker[l_cn]) {
             if (var[l_cn] < 0.) { // eventually false due to the eps
               // real g_n = var[l_cn];
-              // m_InnerCellsLayers[i_p][i_layer].push_back(LSLayerDataExtrapol(l_cn, g_n));
+              // m_InnerCellsLayers[ii_p][i_layer].push_back(LSLayerDataExtrapol(l_cn, g_n));
               LSLayerDataExtrapol lslde_h;
               lslde_h.m_Data = patch->getData();
               lslde_h.m_FieldSize = patch->fieldSize();
               lslde_h.m_VariableSize = patch->variableSize();
               lslde_h.m_Cell = l_cn;
               lslde_h.m_G = var[l_cn];
-              m_InnerCellsLayers[i_p][i_layer].push_back(lslde_h);
+              m_InnerCellsLayers[ii_p][i_layer].push_back(lslde_h);
               cell_marker[l_cn] = true;
             }
           }
@@ -266,8 +411,8 @@ void LevelSetObject::extractBCellLayers()
     for (size_t i_layer = 1; i_layer < m_NumOuterLayers; i_layer++) {
       //.... loop for cells in layer below
       size_t below_layer = i_layer - 1;
-      for (size_t ll_c = 0; ll_c < m_OuterCellsLayers[i_p][below_layer].size(); ll_c++) {
-        size_t l_c = m_OuterCellsLayers[i_p][below_layer][ll_c].m_Cell;
+      for (size_t ll_c = 0; ll_c < m_OuterCellsLayers[ii_p][below_layer].size(); ll_c++) {
+        size_t l_c = m_OuterCellsLayers[ii_p][below_layer][ll_c].m_Cell;
         //...... check face neighbours and insert if these belong to i_layer
         patch->cellOverFaceNeighbours(l_c,
                                       ind_cell_neighbours);
@@ -276,14 +421,14 @@ void LevelSetObject::extractBCellLayers()
           if (!cell_marker[l_cn]) {
             if (var[l_cn] > 0.) { // eventually false due to the eps
 //              real g_n = var[l_cn];
-//              m_OuterCellsLayers[i_p][i_layer].push_back(LSLayerDataExtrapol(l_cn, g_n));
+//              m_OuterCellsLayers[ii_p][i_layer].push_back(LSLayerDataExtrapol(l_cn, g_n));
               LSLayerDataExtrapol lslde_h;
               lslde_h.m_Data = patch->getData();
               lslde_h.m_FieldSize = patch->fieldSize();
               lslde_h.m_VariableSize = patch->variableSize();
               lslde_h.m_Cell = l_cn;
               lslde_h.m_G = var[l_cn];
-              m_OuterCellsLayers[i_p][i_layer].push_back(lslde_h);
+              m_OuterCellsLayers[ii_p][i_layer].push_back(lslde_h);
               cell_marker[l_cn] = true;
             }
           }
@@ -293,9 +438,9 @@ void LevelSetObject::extractBCellLayers()
 
     // Compute levelset gradients and mirror points
     //.. Inside
-    for (size_t i_layer = 0; i_layer < m_InnerCellsLayers[i_p].size(); i_layer++) {
-      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[i_p][i_layer].size(); ll_c++) {
-        size_t l_c = m_InnerCellsLayers[i_p][i_layer][ll_c].m_Cell;
+    for (size_t i_layer = 0; i_layer < m_InnerCellsLayers[ii_p].size(); i_layer++) {
+      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[ii_p][i_layer].size(); ll_c++) {
+        size_t l_c = m_InnerCellsLayers[ii_p][i_layer][ll_c].m_Cell;
         vec3_t g_xyz;
         patch->computeNablaVar(m_FieldIndex, m_VarIndex, l_c,
                                g_xyz);
@@ -303,9 +448,9 @@ void LevelSetObject::extractBCellLayers()
         //        real gx, gy, gz;
         //        patch->computeNablaVar(m_FieldIndex, m_VarIndex, l_c,
         //                               gx, gy, gz);
-        m_InnerCellsLayers[i_p][i_layer][ll_c].m_Gx = g_xyz[0];
-        m_InnerCellsLayers[i_p][i_layer][ll_c].m_Gy = g_xyz[1];
-        m_InnerCellsLayers[i_p][i_layer][ll_c].m_Gz = g_xyz[2];
+        m_InnerCellsLayers[ii_p][i_layer][ll_c].m_Gx = g_xyz[0];
+        m_InnerCellsLayers[ii_p][i_layer][ll_c].m_Gy = g_xyz[1];
+        m_InnerCellsLayers[ii_p][i_layer][ll_c].m_Gz = g_xyz[2];
 
         //.. Compute mirror points for opposite side data access
         //   Note: local coordinate system of the patch i_p
@@ -313,7 +458,7 @@ void LevelSetObject::extractBCellLayers()
         /** @todo Switch to a one-click-debug vector3_type and consequently
           *       use it throughout the program. */
 
-        real shift_len = -2. * m_InnerCellsLayers[i_p][i_layer][ll_c].m_G;
+        real shift_len = -2. * m_InnerCellsLayers[ii_p][i_layer][ll_c].m_G;
         vec3_t mirror_shift = shift_len * g_xyz;
         real xc, yc, zc;
         patch->xyzCell(l_c,
@@ -324,15 +469,15 @@ void LevelSetObject::extractBCellLayers()
         patch->computeCCDataInterpolCoeffs_V1(mirror_xyz[0], mirror_xyz[1], mirror_xyz[2],
                                               ws);
         if(ws.tranferToFixedArrays(8,
-                                   m_InnerCellsLayers[i_p][i_layer][ll_c].m_MirrorDonor,
-                                   m_InnerCellsLayers[i_p][i_layer][ll_c].m_MirrorWeight)) {
-          m_InnerCellsLayers[i_p][i_layer][ll_c].m_ExOK = true;
+                                   m_InnerCellsLayers[ii_p][i_layer][ll_c].m_MirrorDonor,
+                                   m_InnerCellsLayers[ii_p][i_layer][ll_c].m_MirrorWeight)) {
+          m_InnerCellsLayers[ii_p][i_layer][ll_c].m_ExOK = true;
         } else {
-          m_InnerCellsLayers[i_p][i_layer][ll_c].m_ExOK = false;
+          m_InnerCellsLayers[ii_p][i_layer][ll_c].m_ExOK = false;
         }
       }
       //.. Clean up m_InnerCellsLayers: Eliminate all entries with
-      //   m_InnerCellsLayers[i_p][i_layer][ll_c].m_ExOK == false
+      //   m_InnerCellsLayers[ii_p][i_layer][ll_c].m_ExOK == false
       //   These are nodes that extrapolate to "outside" of the core patch bounds. The
       //   variables in these cells will later be overwritten by overlap transfer.
       //   On oblique surfaces crossing patch borders, the extrapolation access may
@@ -342,25 +487,25 @@ void LevelSetObject::extractBCellLayers()
         * Postpone this operation until having the common data pointer. Then access
         * neighbour patch info directly.*/
       vector<size_t> shift_down;
-      shift_down.resize(m_InnerCellsLayers[i_p][i_layer].size());
+      shift_down.resize(m_InnerCellsLayers[ii_p][i_layer].size());
       size_t all_shift_down = 0;
-      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[i_p][i_layer].size(); ll_c++) {
+      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[ii_p][i_layer].size(); ll_c++) {
         shift_down[ll_c] = all_shift_down;
-        if (!m_InnerCellsLayers[i_p][i_layer][ll_c].m_ExOK) {
+        if (!m_InnerCellsLayers[ii_p][i_layer][ll_c].m_ExOK) {
           all_shift_down++;
         }
       }
-      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[i_p][i_layer].size(); ll_c++) {
+      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[ii_p][i_layer].size(); ll_c++) {
         size_t ll_c_down = ll_c - shift_down[ll_c];
-        m_InnerCellsLayers[i_p][i_layer][ll_c_down] = m_InnerCellsLayers[i_p][i_layer][ll_c];
+        m_InnerCellsLayers[ii_p][i_layer][ll_c_down] = m_InnerCellsLayers[ii_p][i_layer][ll_c];
       }
-      size_t old_size = m_InnerCellsLayers[i_p][i_layer].size();
+      size_t old_size = m_InnerCellsLayers[ii_p][i_layer].size();
       size_t new_size = old_size - all_shift_down;
-      m_InnerCellsLayers[i_p][i_layer].resize(new_size);
+      m_InnerCellsLayers[ii_p][i_layer].resize(new_size);
 #ifdef DEBUG
       bool error = false;
-      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[i_p][i_layer].size(); ll_c++) {
-        if (!m_InnerCellsLayers[i_p][i_layer][ll_c].m_ExOK) {
+      for (size_t ll_c = 0; ll_c < m_InnerCellsLayers[ii_p][i_layer].size(); ll_c++) {
+        if (!m_InnerCellsLayers[ii_p][i_layer][ll_c].m_ExOK) {
           error = true;
         }
       }
@@ -369,9 +514,9 @@ void LevelSetObject::extractBCellLayers()
     }
 
     //.. Outside
-    for (size_t i_layer = 0; i_layer < m_OuterCellsLayers[i_p].size(); i_layer++) {
-      for (size_t ll_c = 0; ll_c < m_OuterCellsLayers[i_p][i_layer].size(); ll_c++) {
-        size_t l_c = m_OuterCellsLayers[i_p][i_layer][ll_c].m_Cell;
+    for (size_t i_layer = 0; i_layer < m_OuterCellsLayers[ii_p].size(); i_layer++) {
+      for (size_t ll_c = 0; ll_c < m_OuterCellsLayers[ii_p][i_layer].size(); ll_c++) {
+        size_t l_c = m_OuterCellsLayers[ii_p][i_layer][ll_c].m_Cell;
         vec3_t g_xyz;
         patch->computeNablaVar(m_FieldIndex, m_VarIndex, l_c,
                                g_xyz);
@@ -379,9 +524,17 @@ void LevelSetObject::extractBCellLayers()
         //        real gx, gy, gz;
         //        patch->computeNablaVar(m_FieldIndex, m_VarIndex, l_c,
         //                               gx, gy, gz);
-        m_OuterCellsLayers[i_p][i_layer][ll_c].m_Gx = g_xyz[0];
-        m_OuterCellsLayers[i_p][i_layer][ll_c].m_Gy = g_xyz[1];
-        m_OuterCellsLayers[i_p][i_layer][ll_c].m_Gz = g_xyz[2];
+        m_OuterCellsLayers[ii_p][i_layer][ll_c].m_Gx = g_xyz[0];
+        m_OuterCellsLayers[ii_p][i_layer][ll_c].m_Gy = g_xyz[1];
+        m_OuterCellsLayers[ii_p][i_layer][ll_c].m_Gz = g_xyz[2];
+
+        //.. No mirror points for outer cells. Set neutral donors (the cell itself with
+        //   zero weights) to allow packed mirror access on all layer cells.
+        m_OuterCellsLayers[ii_p][i_layer][ll_c].m_ExOK = false;
+        for (size_t i = 0; i < 8; i++) {
+          m_OuterCellsLayers[ii_p][i_layer][ll_c].m_MirrorDonor[i]  = l_c;
+          m_OuterCellsLayers[ii_p][i_layer][ll_c].m_MirrorWeight[i] = 0.;
+        }
       }
     }
   }
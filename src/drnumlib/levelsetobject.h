@@ -24,7 +24,9 @@
 class LevelSetObject;
 
 #include "levelsetdefinition.h"
+#include "levelsetprogram.h"
 #include "patchgrid.h"
+#include "cartesianpatch.h"
 #include "lslayerdataextrapol.h"
 
 /**
@@ -40,6 +42,12 @@ class LevelSetObject;
   *
   * Inner domain: G < 0. where the value of G corresponds to a distance
   * from the surface as defined by the corresponding LevelSetDefinition
+  *
+  * If the LevelSetDefinition provides a Lipschitz constant, patches and blocks
+  * of cells (CartesianPatch only) far away from the surface are not evaluated
+  * cell by cell. They are filled with a conservative bound instead, which has
+  * the correct sign, but underestimates |G|. Exact values are guaranteed in a
+  * band of (max(num_inner_layers, num_outer_layers) + 2) cells around G = 0.
   */
 class LevelSetObject
 {
@@ -47,15 +55,31 @@ class LevelSetObject
   //  friend class LevelSetObjectBC;
   //  friend class CompressibleEulerLSOBC;
 
+protected: // data types
+
+  struct block_t
+  {
+    size_t i_patch;
+    size_t i1, j1, k1;  ///< first cell (Cartesian), i1 is the first cell index otherwise
+    size_t i2, j2, k2;  ///< last cell + 1 (Cartesian), i2 is the last cell index + 1 otherwise
+    bool   has_negative;
+    bool   has_positive;
+  };
+
+
 protected: // attributes
 
   LevelSetDefinition* m_LevelSetDefinition; /// Geometric levelset definition of object(s)
+  LevelSetProgram m_Program;                /// Flattened, thread safe form of m_LevelSetDefinition
+  real   m_Lipschitz;                       /// Lipschitz constant of m_LevelSetDefinition
+  size_t m_BlockSize;                       /// Edge length of cell blocks used for culling
+  size_t m_NumExactCells;                   /// Number of cells evaluated exactly in the last update
   PatchGrid* m_PatchGrid;                   /// PatchGrid to work on
   size_t     m_FieldIndex;                  /// Index of the variable field to write data to
   size_t     m_VarIndex;                    /// Index of the variable to write data to
   /** @todo Swith to a leaner data concept, rather than using a numerical variable. */
 
-  vector<size_t> m_AffectedPatchIDs;        /// Indices of patches affected by this LevelSetObject
+  vector<size_t> m_AffectedPatchIDs;        /// Indices of patches affected by this LevelSetObject (some G < 0)
   vector<size_t> m_FullyBlackPatchIDs;      /// Indices of patches that are totally inside the object
   /** @todo Might be better to exclude the fully black patches from m_AffectedPatchIDs (?). */
 
@@ -70,7 +94,8 @@ protected: // attributes
     *   1st dim: layer:
     *       0 :  has at least one face neighbour with positive G-value (outside)
     *       1 .. m_NumInnerLayers : furter layers towards inside
-    *   2nd dim: cell indices in layer */
+    *   2nd dim: cell indices in layer
+    * Note: indirect indexing on patches, 0th dim is the index in m_AffectedPatchIDs. */
   vector<vector<vector<LSLayerDataExtrapol> > > m_InnerCellsLayers;
 
   /** Cell layers around boundaries outside of the object.
@@ -79,10 +104,28 @@ protected: // attributes
     *   1st dim: layer:
     *       0 :  has at least one face neighbour with negative G-value (inside)
     *       1 .. m_NumOuterLayers : furter layers farther outside
-    *   2nd dim: cell indices in layer */
+    *   2nd dim: cell indices in layer
+    * Note: indirect indexing on patches, 0th dim is the index in m_AffectedPatchIDs. */
   vector<vector<vector<LSLayerDataExtrapol> > > m_OuterCellsLayers;
 
 
+protected: // methods
+
+  /** Try to fill a block of cells with a bound of G, if it is far from the surface.
+    * @param block the block (flags will be set, if culled)
+    * @param work workspace of m_Program for a single point
+    * @return true, if the block has been culled
+    */
+  bool cullBlock(block_t& block, real* work);
+
+  /** Evaluate all cells of a block exactly.
+    * @param block the block (flags will be set)
+    * @param x, y, z, g buffers for at least m_BlockSize^3 cells
+    * @param work workspace of m_Program for m_BlockSize^3 points
+    */
+  void evaluateBlock(block_t& block, real* x, real* y, real* z, real* g, real* work);
+
+
 public: // methods
 
   /** Constructor.
@@ -110,6 +153,10 @@ public: // methods
     */
   void update();
 
+  /** Number of cells evaluated exactly in the last call of update().
+    */
+  size_t getNumExactCells() {return m_NumExactCells;}
+
   /** Extract cell layers around the boundaries.
     */
   void extractBCellLayers();
@@ -41,15 +41,24 @@ void LevelSetObjectBC::transferCellLayerData ()
   size_t count_index;
   size_t num_patches = m_PatchGrid->getNumPatches();
 
+  // Layer data of the LevelSetObject exist for affected patches only (indirect indexing).
+  // Find the corresponding index for all patches, num_patches if not affected.
+  vector<size_t>& affected_ids = *(m_LevelSetObject->getAffectedPatchIDsPtr());
+  vector<size_t> affected_index(num_patches, num_patches);
+  for (size_t ii_p = 0; ii_p < affected_ids.size(); ii_p++) {
+    affected_index[affected_ids[ii_p]] = ii_p;
+  }
+  vector<LSLayerDataExtrapol> no_cells;
+
   // Inner
   vector<vector<vector<LSLayerDataExtrapol> > >& inner_cls
       = m_LevelSetObject->getInnerCellsLayers();
 
   //.. Count total number of data entries in LevelSetObject::m_InnerCellsLayers
   count = 0;
-  for (size_t i_p = 0; i_p < num_patches; i_p++) {
+  for (size_t ii_p = 0; ii_p < inner_cls.size(); ii_p++) {
     for (size_t i_layer = 0; i_layer < m_NumInnerLayers; i_layer++) {
-      count += inner_cls[i_p][i_layer].size();
+      count += inner_cls[ii_p][i_layer].size();
     }
   }
 
@@ -64,9 +73,9 @@ void LevelSetObjectBC::transferCellLayerData ()
   count_index = 0;
   m_InnerCLStart[0][0] = count_index;
   for (size_t i_p = 0; i_p < num_patches; i_p++) {
-    vector<vector<LSLayerDataExtrapol> >& inner_cls_p = inner_cls[i_p];
+    size_t ii_p = affected_index[i_p];
     for (size_t i_layer = 0; i_layer < m_NumInnerLayers; i_layer++) {
-      vector<LSLayerDataExtrapol>& inner_cls_p_l = inner_cls_p[i_layer];
+      vector<LSLayerDataExtrapol>& inner_cls_p_l = ii_p < num_patches ? inner_cls[ii_p][i_layer] : no_cells;
       //      m_InnerCLStart[i_p][i_layer] = count_index;
       for (size_t ll_c = 0; ll_c < inner_cls_p_l.size(); ll_c++) {
         m_InnerCellsLayers[count_index] = inner_cls_p_l[ll_c];
@@ -86,9 +95,9 @@ void LevelSetObjectBC::transferCellLayerData ()
 
   //.. Count total number of data entries in LevelSetObject::m_OuterCellsLayers
   count = 0;
-  for (size_t i_p = 0; i_p < num_patches; i_p++) {
+  for (size_t ii_p = 0; ii_p < outer_cls.size(); ii_p++) {
     for (size_t i_layer = 0; i_layer < m_NumOuterLayers; i_layer++) {
-      count += outer_cls[i_p][i_layer].size();
+      count += outer_cls[ii_p][i_layer].size();
     }
   }
 
@@ -103,9 +112,9 @@ void LevelSetObjectBC::transferCellLayerData ()
   count_index = 0;
   m_OuterCLStart[0][0] = count_index;
   for (size_t i_p = 0; i_p < num_patches; i_p++) {
-    vector<vector<LSLayerDataExtrapol> >& outer_cls_p = outer_cls[i_p];
+    size_t ii_p = affected_index[i_p];
     for (size_t i_layer = 0; i_layer < m_NumOuterLayers; i_layer++) {
-      vector<LSLayerDataExtrapol>& outer_cls_p_l = outer_cls_p[i_layer];
+      vector<LSLayerDataExtrapol>& outer_cls_p_l = ii_p < num_patches ? outer_cls[ii_p][i_layer] : no_cells;
       //      m_OuterCLStart[i_p][i_layer] = count_index;
       for (size_t ll_c = 0; ll_c < outer_cls_p_l.size(); ll_c++) {
         m_OuterCellsLayers[count_index] = outer_cls_p_l[ll_c];
@@ -120,8 +129,8 @@ void LevelSetObjectBC::transferCellLayerData ()
   }
 
   //.. Set 1D pointers (m_InnerCLStartAll and m_OuterCLStartAll)
-  m_InnerCLStartAll = new size_t[m_NumInnerLayers + 1]; // Note: end index for last layers needed
-  m_OuterCLStartAll = new size_t[m_NumOuterLayers + 1]; // Note: end index for last layers needed
+  m_InnerCLStartAll = new size_t[num_patches + 1]; // Note: end index for last patch needed
+  m_OuterCLStartAll = new size_t[num_patches + 1]; // Note: end index for last patch needed
   //.... Transfer start pointers per patch (inner)
   for (size_t i_p = 0; i_p <= num_patches; i_p++) {  // Note: <=
     m_InnerCLStartAll[i_p] =  m_InnerCLStart[i_p][0];
@@ -131,4 +140,8 @@ void LevelSetObjectBC::transferCellLayerData ()
   //.. Total number of cells in inner and outer lists
   m_NumInnerLayerCells = m_InnerCLStartAll[num_patches];
   m_NumOuterLayerCells = m_OuterCLStartAll[num_patches];
+
+  //.. Packed layouts
+  m_InnerCells.build(m_InnerCellsLayers, m_InnerCLStartAll, num_patches);
+  m_OuterCells.build(m_OuterCellsLayers, m_OuterCLStartAll, num_patches);
 }
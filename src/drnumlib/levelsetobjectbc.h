@@ -27,6 +27,7 @@ class LevelSetObjectBC;
 #include "levelsetobject.h"
 //#include "LSLayerData.h" /// @todo capital letters?
 #include "lslayerdataextrapol.h"
+#include "lslayercells.h"
 
 /**
   * Base class for levelset based inner boundary conditions.
@@ -92,6 +93,12 @@ protected: // attributes
     * 1st dim: patch id (direct: 0, 1, 2, ...) */
   size_t* m_OuterCLStartAll;
 
+  /** Packed layout of the inner layer cells, sorted by patch and cell index */
+  LSLayerCells m_InnerCells;
+
+  /** Packed layout of the outer layer cells, sorted by patch and cell index */
+  LSLayerCells m_OuterCells;
+
 
 public:
 
@@ -107,7 +114,8 @@ public:
   // void setLevelSetObject (LevelSetObject* levelset_object) {m_LevelSetObject = levelset_object;}
 
   /** Transfer levelset data (cells, values and grads) as given in m_LevelSetObject to
-    * array based data sets m_InnerCellsLayers and m_OuterCellsLayers
+    * array based data sets m_InnerCellsLayers and m_OuterCellsLayers and to the
+    * packed layouts m_InnerCells and m_OuterCells.
     */
   void transferCellLayerData ();
 
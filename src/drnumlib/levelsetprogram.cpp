@@ -0,0 +1,123 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "levelsetprogram.h"
+
+LevelSetProgram::LevelSetProgram()
+{
+  m_MaxStack = 0;
+  m_StackSize = 0;
+}
+
+void LevelSetProgram::compile(LevelSetDefinition* levelset)
+{
+  m_Leaves.clear();
+  m_Code.clear();
+  m_MaxStack = 0;
+  m_StackSize = 0;
+  levelset->compile(*this);
+  if (m_StackSize != 1) {
+    BUG;
+  }
+}
+
+void LevelSetProgram::addLeaf(LevelSetDefinition* levelset)
+{
+  size_t i_leaf = 0;
+  while (i_leaf < m_Leaves.size() && m_Leaves[i_leaf] != levelset) {
+    ++i_leaf;
+  }
+  if (i_leaf == m_Leaves.size()) {
+    m_Leaves.push_back(levelset);
+  }
+  instruction_t instruction;
+  instruction.op  = LOAD;
+  instruction.arg = i_leaf;
+  m_Code.push_back(instruction);
+  ++m_StackSize;
+  m_MaxStack = max(m_MaxStack, m_StackSize);
+}
+
+void LevelSetProgram::addOperation(operation_t op, size_t num_operands)
+{
+  if (op == LOAD || num_operands == 0 || num_operands > m_StackSize) {
+    BUG;
+  }
+  instruction_t instruction;
+  instruction.op  = op;
+  instruction.arg = num_operands;
+  m_Code.push_back(instruction);
+  m_StackSize -= num_operands - 1;
+}
+
+void LevelSetProgram::evaluate(const real* x, const real* y, const real* z, real* g, size_t n, real* work)
+{
+  // leaf rows first, the stack rows follow
+  real* leaf  = work;
+  real* stack = work + m_Leaves.size()*n;
+
+  for (size_t i_leaf = 0; i_leaf < m_Leaves.size(); ++i_leaf) {
+    m_Leaves[i_leaf]->calcDistances(x, y, z, leaf + i_leaf*n, n);
+  }
+
+  // a single leaf does not need the stack at all
+  if (m_Code.size() == 1) {
+    for (size_t i = 0; i < n; ++i) {
+      g[i] = leaf[i];
+    }
+    return;
+  }
+
+  size_t sp = 0;
+  for (size_t i_code = 0; i_code < m_Code.size(); ++i_code) {
+    const instruction_t& instruction = m_Code[i_code];
+    if (instruction.op == LOAD) {
+      const real* src = leaf + instruction.arg*n;
+      real* dst = stack + sp*n;
+      for (size_t i = 0; i < n; ++i) {
+        dst[i] = src[i];
+      }
+      ++sp;
+    } else {
+      sp -= instruction.arg;
+      real* dst = stack + sp*n;
+      for (size_t i_op = 1; i_op < instruction.arg; ++i_op) {
+        const real* src = dst + i_op*n;
+        if (instruction.op == AND) {
+          for (size_t i = 0; i < n; ++i) {
+            dst[i] = max(dst[i], src[i]);
+          }
+        } else if (instruction.op == OR) {
+          for (size_t i = 0; i < n; ++i) {
+            dst[i] = min(dst[i], src[i]);
+          }
+        } else {
+          for (size_t i = 0; i < n; ++i) {
+            dst[i] = max(dst[i], -src[i]);
+          }
+        }
+      }
+      ++sp;
+    }
+  }
+  for (size_t i = 0; i < n; ++i) {
+    g[i] = stack[i];
+  }
+}
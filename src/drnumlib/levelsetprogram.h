@@ -0,0 +1,121 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef LEVELSETPROGRAM_H
+#define LEVELSETPROGRAM_H
+
+class LevelSetProgram;
+
+#include "drnum.h"
+#include "levelsetdefinition.h"
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Flattened evaluation of a (combined) level set definition.
+ *
+ * A tree of CombiLevelSetAnd/Or/AndNot nodes is compiled into a postfix
+ * program. The leaves of the tree (the "lowest" level sets) are stored once,
+ * even if they appear several times. Evaluation is done for batches of points:
+ * every leaf is evaluated for the whole batch first and the combination
+ * operations are then applied as plain element-wise max/min loops on a stack
+ * of rows. No state is written into the level set definitions, hence several
+ * threads can evaluate the same program, as long as each of them provides its
+ * own workspace.
+ *
+ * Example:
+ * @code
+ * LevelSetProgram program;
+ * program.compile(levelset);
+ * vector<real> work(program.workspaceSize(n));
+ * program.evaluate(x, y, z, g, n, &work[0]);
+ * @endcode
+ */
+class LevelSetProgram
+{
+
+public: // data types
+
+  enum operation_t { LOAD, AND, OR, ANDNOT };
+
+  struct instruction_t
+  {
+    operation_t op;
+    size_t      arg; ///< leaf index for LOAD, number of operands otherwise
+  };
+
+
+protected: // attributes
+
+  vector<LevelSetDefinition*> m_Leaves;
+  vector<instruction_t>       m_Code;
+  size_t                      m_MaxStack;
+  size_t                      m_StackSize; ///< only used while compiling
+
+
+public: // methods
+
+  LevelSetProgram();
+
+  /**
+   * Compile a level set definition into a postfix program.
+   * @param levelset the root of the level set tree
+   */
+  void compile(LevelSetDefinition* levelset);
+
+  /**
+   * Append a leaf to the program (used by LevelSetDefinition::compile).
+   * @param levelset the leaf level set
+   */
+  void addLeaf(LevelSetDefinition* levelset);
+
+  /**
+   * Append a combination operation to the program (used by CombiLevelSet::compile).
+   * @param op the operation (AND, OR or ANDNOT)
+   * @param num_operands the number of operands on top of the stack
+   */
+  void addOperation(operation_t op, size_t num_operands);
+
+  /**
+   * Size of the workspace required to evaluate a batch of points.
+   * @param n the number of points of the batch
+   * @return the number of reals the workspace has to provide
+   */
+  size_t workspaceSize(size_t n) { return (m_Leaves.size() + m_MaxStack)*n; }
+
+  /**
+   * Evaluate the program for a batch of points.
+   * @param x the x coordinates of the points
+   * @param y the y coordinates of the points
+   * @param z the z coordinates of the points
+   * @param g on return, the level set values of the points
+   * @param n the number of points
+   * @param work a workspace of at least workspaceSize(n) reals
+   */
+  void evaluate(const real* x, const real* y, const real* z, real* g, size_t n, real* work);
+
+  size_t numLeaves()       { return m_Leaves.size(); }
+  size_t numInstructions() { return m_Code.size(); }
+
+};
+
+#endif // LEVELSETPROGRAM_H
@@ -0,0 +1,72 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "lslayercells.h"
+
+#include <algorithm>
+
+void LSLayerCells::build(const LSLayerDataExtrapol* layer_data, const size_t* patch_start, size_t num_patches)
+{
+  size_t num_cells = patch_start[num_patches] - patch_start[0];
+
+  m_PatchStart.resize(num_patches + 1);
+  m_PatchData.assign(num_patches, (real*) NULL);
+  m_PatchFieldSize.assign(num_patches, 0);
+  m_PatchVariableSize.assign(num_patches, 0);
+  m_Patch.resize(num_cells);
+  m_Cell.resize(num_cells);
+  m_Donor.resize(8*num_cells);
+  m_Weight.resize(8*num_cells);
+  m_G.resize(num_cells);
+  m_Gx.resize(num_cells);
+  m_Gy.resize(num_cells);
+  m_Gz.resize(num_cells);
+
+  size_t ll_c = 0;
+  for (size_t i_p = 0; i_p < num_patches; ++i_p) {
+    m_PatchStart[i_p] = ll_c;
+
+    // sort the cells of the patch by their index (layers are merged)
+    vector<pair<size_t, size_t> > order;
+    for (size_t i = patch_start[i_p]; i < patch_start[i_p + 1]; ++i) {
+      order.push_back(make_pair(layer_data[i].m_Cell, i));
+    }
+    sort(order.begin(), order.end());
+
+    for (size_t i_o = 0; i_o < order.size(); ++i_o) {
+      const LSLayerDataExtrapol& lslde = layer_data[order[i_o].second];
+      m_PatchData[i_p]         = lslde.m_Data;
+      m_PatchFieldSize[i_p]    = lslde.m_FieldSize;
+      m_PatchVariableSize[i_p] = lslde.m_VariableSize;
+      m_Patch[ll_c] = i_p;
+      m_Cell[ll_c]  = lslde.m_Cell;
+      for (size_t i = 0; i < 8; ++i) {
+        m_Donor[8*ll_c + i]  = lslde.m_MirrorDonor[i];
+        m_Weight[8*ll_c + i] = lslde.m_MirrorWeight[i];
+      }
+      m_G[ll_c]  = lslde.m_G;
+      m_Gx[ll_c] = lslde.m_Gx;
+      m_Gy[ll_c] = lslde.m_Gy;
+      m_Gz[ll_c] = lslde.m_Gz;
+      ++ll_c;
+    }
+  }
+  m_PatchStart[num_patches] = ll_c;
+}
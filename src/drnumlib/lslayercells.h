@@ -0,0 +1,124 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef LSLAYERCELLS_H
+#define LSLAYERCELLS_H
+
+class LSLayerCells;
+
+#include "drnum.h"
+#include "lslayerdataextrapol.h"
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Packed storage of levelset layer cells (inner or outer) of all patches.
+ *
+ * All data are stored in flat arrays (structure of arrays), sorted by patch and
+ * by cell index within a patch, to get a monotonic memory access sequence on the
+ * variable fields. For every cell the 8 mirror donors and weights are stored
+ * contiguously (8*ll_c ... 8*ll_c+7).
+ *
+ * Example (two phase operation without recursion):
+ * @code
+ * for (ll_c ...) cells.interpolate(ll_c, i_field, num_vars, &acc[num_vars*ll_c]);
+ * for (ll_c ...) cells.variable(ll_c, i_field, i_var)[cells.cell(ll_c)] = f(acc[num_vars*ll_c + i_var]);
+ * @endcode
+ */
+class LSLayerCells
+{
+
+protected: // attributes
+
+  // per patch
+  vector<size_t> m_PatchStart;        ///< first cell of patches, num_patches + 1 entries
+  vector<real*>  m_PatchData;         ///< data pointer of patches
+  vector<size_t> m_PatchFieldSize;    ///< field size of patches
+  vector<size_t> m_PatchVariableSize; ///< variable size of patches
+
+  // per layer cell
+  vector<size_t> m_Patch;             ///< patch of a cell
+  vector<size_t> m_Cell;              ///< index of a cell in its patch
+  vector<size_t> m_Donor;             ///< mirror donors, 8 per cell
+  vector<real>   m_Weight;            ///< mirror weights, 8 per cell
+  vector<real>   m_G;                 ///< levelset value
+  vector<real>   m_Gx;                ///< x-comp of normalised levelset gradient
+  vector<real>   m_Gy;                ///< y-comp of normalised levelset gradient
+  vector<real>   m_Gz;                ///< z-comp of normalised levelset gradient
+
+
+public: // methods
+
+  /**
+   * Build the packed layout from the concatenated layer data of LevelSetObjectBC.
+   * @param layer_data the layer cells of all patches (all layers)
+   * @param patch_start start index of the patches in layer_data (num_patches + 1 entries)
+   * @param num_patches the number of patches
+   */
+  void build(const LSLayerDataExtrapol* layer_data, const size_t* patch_start, size_t num_patches);
+
+  size_t numCells()                { return m_Cell.size(); }
+  size_t numPatches()              { return m_PatchData.size(); }
+  size_t patchStart(size_t i_p)    { return m_PatchStart[i_p]; }
+  size_t cell(size_t ll_c)         { return m_Cell[ll_c]; }
+  real   g(size_t ll_c)            { return m_G[ll_c]; }
+  real   gx(size_t ll_c)           { return m_Gx[ll_c]; }
+  real   gy(size_t ll_c)           { return m_Gy[ll_c]; }
+  real   gz(size_t ll_c)           { return m_Gz[ll_c]; }
+
+  /**
+   * Get a variable array of the patch a layer cell belongs to.
+   * @param ll_c the index of the layer cell
+   * @param i_field the variable field
+   * @param i_var the variable
+   * @return pointer to the variable of the patch
+   */
+  real* variable(size_t ll_c, size_t i_field, size_t i_var)
+  {
+    size_t i_p = m_Patch[ll_c];
+    return m_PatchData[i_p] + i_field*m_PatchFieldSize[i_p] + i_var*m_PatchVariableSize[i_p];
+  }
+
+  /**
+   * Interpolate the variables on the mirror point of a layer cell.
+   * @param ll_c the index of the layer cell
+   * @param i_field the variable field
+   * @param num_vars the number of variables (0 ... num_vars-1)
+   * @param acc on return, the interpolated values
+   */
+  void interpolate(size_t ll_c, size_t i_field, size_t num_vars, real* acc)
+  {
+    const size_t* donor  = &m_Donor[8*ll_c];
+    const real*   weight = &m_Weight[8*ll_c];
+    for (size_t i_var = 0; i_var < num_vars; ++i_var) {
+      real* var = variable(ll_c, i_field, i_var);
+      real value = 0;
+      for (size_t i = 0; i < 8; ++i) {
+        value += weight[i]*var[donor[i]];
+      }
+      acc[i_var] = value;
+    }
+  }
+
+};
+
+#endif // LSLAYERCELLS_H
@@ -43,6 +43,21 @@ public:
                     const size_t& abuse_field,
                     const real& relax);
 
+  /** Number of variables needed on mirror points (packed layout). */
+  static size_t numVars() { return 5; }
+
+  void operateInner(LSLayerCells& cells,
+                    const size_t& ll_c,
+                    const size_t& i_field,
+                    const real* acc,
+                    const real& relax);
+
+  void operateOuter(LSLayerCells& cells,
+                    const size_t& ll_c,
+                    const size_t& i_field,
+                    const real* acc,
+                    const real& relax) {}
+
 };
 
 
@@ -144,6 +159,42 @@ void LSOBCCompressibleEulerOp::operateInner(const LSLayerDataExtrapol& lslde,
 }
 
 
+inline void LSOBCCompressibleEulerOp::operateInner(LSLayerCells& cells,
+                                                   const size_t& ll_c,
+                                                   const size_t& i_field,
+                                                   const real* acc,
+                                                   const real& relax)
+{
+  size_t l_c = cells.cell(ll_c);
+  real gxn = cells.gx(ll_c);
+  real gyn = cells.gy(ll_c);
+  real gzn = cells.gz(ll_c);
+  real* rho   = cells.variable(ll_c, i_field, 0);
+  real* rhou  = cells.variable(ll_c, i_field, 1);
+  real* rhov  = cells.variable(ll_c, i_field, 2);
+  real* rhow  = cells.variable(ll_c, i_field, 3);
+  real* rhoE  = cells.variable(ll_c, i_field, 4);
+
+  // see above (experimental version with damped relaxation)
+  real rho_uvw_n = acc[1] * gxn + acc[2] * gyn + acc[3] * gzn;
+  real eps = 1.e-6;
+  real rhou_hard = acc[1] - 2. * rho_uvw_n * gxn;
+  real rhov_hard = acc[2] - 2. * rho_uvw_n * gyn;
+  real rhow_hard = acc[3] - 2. * rho_uvw_n * gzn;
+  real damp_rhou = abs(rhou[l_c] - rhou_hard) / (abs(rhou[l_c]) + eps);
+  real damp_rhov = abs(rhov[l_c] - rhov_hard) / (abs(rhov[l_c]) + eps);
+  real damp_rhow = abs(rhow[l_c] - rhow_hard) / (abs(rhow[l_c]) + eps);
+  if(damp_rhou > (1.-relax)) damp_rhou = 1. - relax;
+  if(damp_rhov > (1.-relax)) damp_rhov = 1. - relax;
+  if(damp_rhow > (1.-relax)) damp_rhow = 1. - relax;
+  rhou[l_c] = (1. - damp_rhou) * rhou_hard + damp_rhou * rhou[l_c];
+  rhov[l_c] = (1. - damp_rhov) * rhov_hard + damp_rhov * rhov[l_c];
+  rhow[l_c] = (1. - damp_rhow) * rhow_hard + damp_rhow * rhow[l_c];
+  rho[l_c]  = acc[0];
+  rhoE[l_c] = acc[4];
+}
+
+
 void LSOBCCompressibleEulerOp::operateOuter(const LSLayerDataExtrapol& lslde,
                                             const size_t& i_field,
                                             const size_t& abuse_field,
@@ -42,6 +42,21 @@ public:
                     const size_t& field,
                     const size_t& abuse_field,
                     const real& relax);
+
+  /** Number of variables needed on mirror points (packed layout). */
+  static size_t numVars() { return 5; }
+
+  void operateInner(LSLayerCells& cells,
+                    const size_t& ll_c,
+                    const size_t& i_field,
+                    const real* acc,
+                    const real& relax);
+
+  void operateOuter(LSLayerCells& cells,
+                    const size_t& ll_c,
+                    const size_t& i_field,
+                    const real* acc,
+                    const real& relax) {}
 };
 
 
@@ -116,6 +131,28 @@ void LSOBCCompressibleSWallOp::operateInner(const LSLayerDataExtrapol& lslde,
 }
 
 
+inline void LSOBCCompressibleSWallOp::operateInner(LSLayerCells& cells,
+                                                   const size_t& ll_c,
+                                                   const size_t& i_field,
+                                                   const real* acc,
+                                                   const real& relax)
+{
+  size_t l_c = cells.cell(ll_c);
+  real* rho   = cells.variable(ll_c, i_field, 0);
+  real* rhou  = cells.variable(ll_c, i_field, 1);
+  real* rhov  = cells.variable(ll_c, i_field, 2);
+  real* rhow  = cells.variable(ll_c, i_field, 3);
+  real* rhoE  = cells.variable(ll_c, i_field, 4);
+
+  // see above
+  rho[l_c]  = acc[0];
+  rhou[l_c] = relax*(-acc[1]) + (1.-relax)*rhou[l_c];
+  rhov[l_c] = relax*(-acc[2]) + (1.-relax)*rhov[l_c];
+  rhow[l_c] = relax*(-acc[3]) + (1.-relax)*rhow[l_c];
+  rhoE[l_c] = acc[4];
+}
+
+
 void LSOBCCompressibleSWallOp::operateOuter(const LSLayerDataExtrapol& lslde,
                                             const size_t& i_field,
                                             const size_t& abuse_field,
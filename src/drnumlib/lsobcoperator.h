@@ -24,6 +24,7 @@
 class LSOBCOperator;
 
 #include "lslayerdataextrapol.h"
+#include "lslayercells.h"
 
 /** @todo Maybe this class is suitable to hold access(const LSLayerdataExtrapol&)
   *       later. Then introduce template DIM .  */
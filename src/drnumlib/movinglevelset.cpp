@@ -0,0 +1,426 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "movinglevelset.h"
+#include "levelsetprogram.h"
+
+#include <algorithm>
+
+MovingLevelSet::MovingLevelSet(PatchGrid* patch_grid, size_t i_var)
+{
+  m_PatchGrid = patch_grid;
+  m_IVar = i_var;
+  m_H = 1;
+  m_Band = 0;
+  m_Outside = MAX_REAL;
+  m_Initialised = false;
+  m_FullUpdate = true;
+  m_NumSampledCells = 0;
+  m_NumCoveredCells = 0;
+  m_NumUncoveredCells = 0;
+  for (size_t i = 0; i < m_PatchGrid->getNumPatches(); ++i) {
+    CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i));
+    if (patch) {
+      m_Patches.push_back(patch);
+    }
+  }
+  m_BandCells.resize(m_Patches.size());
+  m_UpdatedCells.resize(m_Patches.size());
+  m_Mark.resize(m_Patches.size());
+}
+
+int MovingLevelSet::patchIndex(CartesianPatch* patch)
+{
+  for (size_t i_patch = 0; i_patch < m_Patches.size(); ++i_patch) {
+    if (m_Patches[i_patch] == patch) {
+      return i_patch;
+    }
+  }
+  return -1;
+}
+
+void MovingLevelSet::sample(LevelSetDefinition* levelset, vec3_t x1, vec3_t x2, real h, real band)
+{
+  LevelSetProgram program;
+  program.compile(levelset);
+
+  real L = levelset->getLipschitz();
+  real margin = sqrt(3.0)*h;
+  if (L < MAX_REAL) {
+    margin *= L;
+  }
+  m_H = h;
+  m_Band = band;
+  m_Outside = band + margin;
+  for (size_t i = 0; i < 3; ++i) {
+    m_X0[i] = x1[i] - band - margin;
+  }
+  size_t num_i = size_t((x2[0] - x1[0] + 2*(band + margin))/h) + 2;
+  size_t num_j = size_t((x2[1] - x1[1] + 2*(band + margin))/h) + 2;
+  size_t num_k = size_t((x2[2] - x1[2] + 2*(band + margin))/h) + 2;
+  m_Field.resize(num_i, num_j, num_k, m_Outside);
+
+  size_t B = SparseBrickGrid::BRICK;
+  size_t nbj = m_Field.numBricksJ();
+  size_t nbk = m_Field.numBricksK();
+  int num_bricks = m_Field.numBricks();
+
+  // classify the bricks by their centre value
+  // a brick will be a tile, if all interpolation stencils of band points avoid it
+  vector<real> g_centre(num_bricks);
+  vector<char> exact(num_bricks, true);
+  if (L < MAX_REAL) {
+    real r = 0.5*sqrt(3.0)*(B - 1)*h;
+#ifndef DEBUG
+    #pragma omp parallel for
+#endif
+    for (int b = 0; b < num_bricks; ++b) {
+      size_t bi = b/(nbj*nbk);
+      size_t bj = (b/nbk)%nbj;
+      size_t bk = b%nbk;
+      real x = m_X0[0] + (bi*B + 0.5*(B - 1))*h;
+      real y = m_X0[1] + (bj*B + 0.5*(B - 1))*h;
+      real z = m_X0[2] + (bk*B + 0.5*(B - 1))*h;
+      vector<real> work(program.workspaceSize(1));
+      program.evaluate(&x, &y, &z, &g_centre[b], 1, &work[0]);
+      exact[b] = fabs(g_centre[b]) - L*r <= band + margin;
+      if (!exact[b]) {
+        real g_bound = fabs(g_centre[b]) - L*r;
+        g_centre[b] = g_centre[b] < 0 ? -g_bound : g_bound;
+      }
+    }
+  }
+
+  // allocate (not thread safe) ...
+  for (int b = 0; b < num_bricks; ++b) {
+    size_t bi = b/(nbj*nbk);
+    size_t bj = (b/nbk)%nbj;
+    size_t bk = b%nbk;
+    if (exact[b]) {
+      m_Field.allocateBrick(bi, bj, bk);
+    } else {
+      m_Field.setTile(bi, bj, bk, g_centre[b]);
+    }
+  }
+
+  // ... and fill the exact bricks
+#ifndef DEBUG
+  #pragma omp parallel for
+#endif
+  for (int b = 0; b < num_bricks; ++b) {
+    if (exact[b]) {
+      size_t bi = b/(nbj*nbk);
+      size_t bj = (b/nbk)%nbj;
+      size_t bk = b%nbk;
+      vector<real> x, y, z;
+      vector<size_t> node;
+      for (size_t i = bi*B; i < min((bi + 1)*B, num_i); ++i) {
+        for (size_t j = bj*B; j < min((bj + 1)*B, num_j); ++j) {
+          for (size_t k = bk*B; k < min((bk + 1)*B, num_k); ++k) {
+            x.push_back(m_X0[0] + i*h);
+            y.push_back(m_X0[1] + j*h);
+            z.push_back(m_X0[2] + k*h);
+            node.push_back(i*num_j*num_k + j*num_k + k);
+          }
+        }
+      }
+      vector<real> g(node.size());
+      vector<real> work(program.workspaceSize(node.size()));
+      program.evaluate(&x[0], &y[0], &z[0], &g[0], node.size(), &work[0]);
+      for (size_t i_node = 0; i_node < node.size(); ++i_node) {
+        size_t i = node[i_node]/(num_j*num_k);
+        size_t j = (node[i_node]/num_k)%num_j;
+        size_t k = node[i_node]%num_k;
+        m_Field.set(i, j, k, g[i_node]);
+      }
+    }
+  }
+
+  // bricks without any band values are not required either
+  m_Field.prune(band + margin);
+  m_Initialised = false;
+}
+
+real MovingLevelSet::bodyG(const vec3_t& x_body) const
+{
+  real fi = (x_body[0] - m_X0[0])/m_H;
+  real fj = (x_body[1] - m_X0[1])/m_H;
+  real fk = (x_body[2] - m_X0[2])/m_H;
+  if (fi < 0 || fj < 0 || fk < 0) {
+    return m_Outside;
+  }
+  size_t i = size_t(fi);
+  size_t j = size_t(fj);
+  size_t k = size_t(fk);
+  if (i + 1 >= m_Field.sizeI() || j + 1 >= m_Field.sizeJ() || k + 1 >= m_Field.sizeK()) {
+    return m_Outside;
+  }
+  real wi = fi - i;
+  real wj = fj - j;
+  real wk = fk - k;
+  real g = 0;
+  g += (1 - wi)*(1 - wj)*(1 - wk)*m_Field.get(i,     j,     k);
+  g += (1 - wi)*(1 - wj)*     wk *m_Field.get(i,     j,     k + 1);
+  g += (1 - wi)*     wj *(1 - wk)*m_Field.get(i,     j + 1, k);
+  g += (1 - wi)*     wj *     wk *m_Field.get(i,     j + 1, k + 1);
+  g +=      wi *(1 - wj)*(1 - wk)*m_Field.get(i + 1, j,     k);
+  g +=      wi *(1 - wj)*     wk *m_Field.get(i + 1, j,     k + 1);
+  g +=      wi *     wj *(1 - wk)*m_Field.get(i + 1, j + 1, k);
+  g +=      wi *     wj *     wk *m_Field.get(i + 1, j + 1, k + 1);
+  return g;
+}
+
+real MovingLevelSet::maxDisplacement(const CoordTransformVV& inertial2body_1, const CoordTransformVV& inertial2body_2)
+{
+  // the displacement of a rigid motion is a convex function of the position,
+  // hence the maximum is found at one of the corners of the body grid
+  real d_max = 0;
+  for (size_t corner = 0; corner < 8; ++corner) {
+    vec3_t x;
+    x[0] = m_X0[0] + ((corner & 1) ? (m_Field.sizeI() - 1)*m_H : 0);
+    x[1] = m_X0[1] + ((corner & 2) ? (m_Field.sizeJ() - 1)*m_H : 0);
+    x[2] = m_X0[2] + ((corner & 4) ? (m_Field.sizeK() - 1)*m_H : 0);
+    vec3_t x1 = inertial2body_1.transformReverse(x);
+    vec3_t x2 = inertial2body_2.transformReverse(x);
+    vec3_t dx = x2 - x1;
+    d_max = max(d_max, dx.abs());
+  }
+  return d_max;
+}
+
+void MovingLevelSet::initialise(const CoordTransformVV& inertial2body)
+{
+  m_TransformInertial2Body = inertial2body;
+  m_NumSampledCells = 0;
+  m_NumCoveredCells = 0;
+  m_NumUncoveredCells = 0;
+  for (size_t i_patch = 0; i_patch < m_Patches.size(); ++i_patch) {
+    vector<size_t> cells(m_Patches[i_patch]->variableSize());
+    for (size_t l = 0; l < cells.size(); ++l) {
+      cells[l] = l;
+    }
+    resample(i_patch, cells, 0, true);
+    m_UpdatedCells[i_patch].clear();
+  }
+  m_Initialised = true;
+  m_FullUpdate = true;
+}
+
+void MovingLevelSet::move(const CoordTransformVV& inertial2body)
+{
+  if (!m_Initialised) {
+    initialise(inertial2body);
+    return;
+  }
+
+  // incremental updates are only valid, if all sign changes and their neighbourhood
+  // (two cells for the boundary condition stencils) are within the old and the new band
+  real dx_max = 0;
+  for (size_t i_patch = 0; i_patch < m_Patches.size(); ++i_patch) {
+    CartesianPatch* patch = m_Patches[i_patch];
+    dx_max = max(dx_max, max(patch->dx(), max(patch->dy(), patch->dz())));
+  }
+  if (maxDisplacement(m_TransformInertial2Body, inertial2body) + 4*sqrt(3.0)*dx_max >= m_Band) {
+    initialise(inertial2body);
+    return;
+  }
+
+  m_TransformInertial2Body = inertial2body;
+  m_FullUpdate = false;
+  m_NumSampledCells = 0;
+  m_NumCoveredCells = 0;
+  m_NumUncoveredCells = 0;
+  size_t B = SparseBrickGrid::BRICK;
+  for (size_t i_patch = 0; i_patch < m_Patches.size(); ++i_patch) {
+    CartesianPatch* patch = m_Patches[i_patch];
+    vector<char>& mark = m_Mark[i_patch];
+    mark.resize(patch->variableSize(), false);
+
+    // cells of the old band ...
+    vector<size_t> cells = m_BandCells[i_patch];
+    for (size_t i_cell = 0; i_cell < cells.size(); ++i_cell) {
+      mark[cells[i_cell]] = true;
+    }
+    size_t num_old_band = cells.size();
+
+    // ... and all cells covered by exact bricks in the new position
+    CoordTransformVV inertial2patch = patch->getTransformInertial2This();
+    vec3_t x_ccmin = patch->xyzCell(0, 0, 0);
+    for (size_t bi = 0; bi < m_Field.numBricksI(); ++bi) {
+      for (size_t bj = 0; bj < m_Field.numBricksJ(); ++bj) {
+        for (size_t bk = 0; bk < m_Field.numBricksK(); ++bk) {
+          if (m_Field.isAllocated(bi, bj, bk)) {
+
+            // index range of the brick (including the interpolation cells to the next brick)
+            real x1 = MAX_REAL, y1 = MAX_REAL, z1 = MAX_REAL;
+            real x2 = -MAX_REAL, y2 = -MAX_REAL, z2 = -MAX_REAL;
+            for (size_t corner = 0; corner < 8; ++corner) {
+              vec3_t x_body;
+              x_body[0] = m_X0[0] + ((corner & 1) ? (bi + 1)*B : bi*B)*m_H;
+              x_body[1] = m_X0[1] + ((corner & 2) ? (bj + 1)*B : bj*B)*m_H;
+              x_body[2] = m_X0[2] + ((corner & 4) ? (bk + 1)*B : bk*B)*m_H;
+              vec3_t x_inertial = inertial2body.transformReverse(x_body);
+              vec3_t x = inertial2patch.transform(x_inertial);
+              x1 = min(x1, x[0]); x2 = max(x2, x[0]);
+              y1 = min(y1, x[1]); y2 = max(y2, x[1]);
+              z1 = min(z1, x[2]); z2 = max(z2, x[2]);
+            }
+            int i1 = max(0, int(floor((x1 - x_ccmin[0])/patch->dx())));
+            int j1 = max(0, int(floor((y1 - x_ccmin[1])/patch->dy())));
+            int k1 = max(0, int(floor((z1 - x_ccmin[2])/patch->dz())));
+            int i2 = min(int(patch->sizeI()) - 1, int(ceil((x2 - x_ccmin[0])/patch->dx())));
+            int j2 = min(int(patch->sizeJ()) - 1, int(ceil((y2 - x_ccmin[1])/patch->dy())));
+            int k2 = min(int(patch->sizeK()) - 1, int(ceil((z2 - x_ccmin[2])/patch->dz())));
+            for (int i = i1; i <= i2; ++i) {
+              for (int j = j1; j <= j2; ++j) {
+                for (int k = k1; k <= k2; ++k) {
+                  size_t l = patch->index(i, j, k);
+                  if (!mark[l]) {
+                    mark[l] = true;
+                    cells.push_back(l);
+                  }
+                }
+              }
+            }
+
+          }
+        }
+      }
+    }
+    for (size_t i_cell = 0; i_cell < cells.size(); ++i_cell) {
+      mark[cells[i_cell]] = false;
+    }
+    resample(i_patch, cells, num_old_band, false);
+  }
+}
+
+void MovingLevelSet::resample(size_t i_patch, const vector<size_t>& cells, size_t num_old_band, bool full)
+{
+  CartesianPatch* patch = m_Patches[i_patch];
+  int num_cells = cells.size();
+
+  // sample the body field
+  vector<real> g_new(num_cells);
+#ifndef DEBUG
+  #pragma omp parallel for
+#endif
+  for (int i_cell = 0; i_cell < num_cells; ++i_cell) {
+    vec3_t x_inertial = patch->xyzoCell(cells[i_cell]);
+    g_new[i_cell] = bodyG(m_TransformInertial2Body.transform(x_inertial));
+  }
+  m_NumSampledCells += num_cells;
+
+  // apply the new values
+  real* G = patch->getVariable(0, m_IVar);
+  vector<size_t> band;
+  vector<size_t> updated;
+  vector<size_t> covered;
+  vector<size_t> uncovered;
+  for (int i_cell = 0; i_cell < num_cells; ++i_cell) {
+    size_t l = cells[i_cell];
+    real g_old = G[l];
+    bool in_new_band = fabs(g_new[i_cell]) < m_Band;
+    bool in_old_band = i_cell < int(num_old_band);
+    if (!full && !in_new_band && !in_old_band) {
+      // far from the surface before and after the motion: the old bound stays valid
+      continue;
+    }
+    if (in_new_band) {
+      band.push_back(l);
+    }
+    if (g_new[i_cell] != g_old) {
+      G[l] = g_new[i_cell];
+      updated.push_back(l);
+    }
+    if (g_new[i_cell] < 0) {
+      if (!m_Initialised || g_old >= 0) {
+        covered.push_back(l);
+      }
+    } else if (m_Initialised && g_old < 0) {
+      uncovered.push_back(l);
+    }
+  }
+
+  // mean state of the fluid neighbours for uncovered cells
+  // (active before this update and G >= 0)
+  size_t num_vars = patch->numVariables();
+  int num_uncovered = uncovered.size();
+  vector<real> var(num_vars*num_uncovered, 0.0);
+  vector<char> found(num_uncovered, false);
+#ifndef DEBUG
+  #pragma omp parallel for
+#endif
+  for (int i_cell = 0; i_cell < num_uncovered; ++i_cell) {
+    size_t i, j, k;
+    patch->ijk(uncovered[i_cell], i, j, k);
+    int count = 0;
+    for (int di = -1; di <= 1; ++di) {
+      for (int dj = -1; dj <= 1; ++dj) {
+        for (int dk = -1; dk <= 1; ++dk) {
+          int i_n = i + di;
+          int j_n = j + dj;
+          int k_n = k + dk;
+          if (i_n >= 0 && j_n >= 0 && k_n >= 0 && i_n < int(patch->sizeI()) && j_n < int(patch->sizeJ()) && k_n < int(patch->sizeK())) {
+            size_t l_n = patch->index(i_n, j_n, k_n);
+            if (patch->getActive()[l_n] && G[l_n] >= 0) {
+              for (size_t i_var = 0; i_var < num_vars; ++i_var) {
+                var[num_vars*i_cell + i_var] += patch->getVariable(0, i_var)[l_n];
+              }
+              ++count;
+            }
+          }
+        }
+      }
+    }
+    if (count > 0) {
+      for (size_t i_var = 0; i_var < num_vars; ++i_var) {
+        var[num_vars*i_cell + i_var] /= count;
+      }
+      found[i_cell] = true;
+    }
+  }
+
+  // change the active flags
+  if (covered.size() > 0 || num_uncovered > 0) {
+    patch->setActiveMaskChanged();
+  }
+  for (size_t i_cell = 0; i_cell < covered.size(); ++i_cell) {
+    patch->getActive()[covered[i_cell]] = false;
+  }
+  for (int i_cell = 0; i_cell < num_uncovered; ++i_cell) {
+    size_t l = uncovered[i_cell];
+    patch->getActive()[l] = true;
+    if (found[i_cell]) {
+      for (size_t i_var = 0; i_var < num_vars; ++i_var) {
+        if (i_var != m_IVar) {
+          patch->getVariable(0, i_var)[l] = var[num_vars*i_cell + i_var];
+        }
+      }
+    }
+  }
+  if (m_Initialised) {
+    m_NumCoveredCells += covered.size();
+  }
+  m_NumUncoveredCells += uncovered.size();
+
+  sort(updated.begin(), updated.end());
+  m_BandCells[i_patch].swap(band);
+  m_UpdatedCells[i_patch].swap(updated);
+}
@@ -0,0 +1,170 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef MOVINGLEVELSET_H
+#define MOVINGLEVELSET_H
+
+class MovingLevelSet;
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "cartesianpatch.h"
+#include "levelsetdefinition.h"
+#include "sparsebrickgrid.h"
+#include "math/coordtransformvv.h"
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Level set of a rigid body moving through the Cartesian patches of a PatchGrid.
+ *
+ * The distance field is sampled once in the body frame and stored on a sparse brick
+ * grid (SparseBrickGrid). Values are exact in a band of half width m_Band around the
+ * surface. The rest of the body grid consists of tiles of constant value with the
+ * correct sign.
+ *
+ * On the patches G is stored in the variable m_IVar of field 0. StoredLevelSet and
+ * the Cartesian level set boundary conditions can therefore be used unchanged. When
+ * the body moves (move), only cells of the old and the new band are resampled. The
+ * active flags are changed only where G changes its sign. Cells which become fluid
+ * cells ("uncovered" cells) get the mean state of their fluid neighbours. If the
+ * displacement is too large for an incremental update, all cells are resampled.
+ *
+ * Example:
+ * @code
+ * MovingLevelSet body(&patch_grid, 5);
+ * body.sample(levelset, x1, x2, h, band);
+ * body.initialise(inertial2body);
+ * CPU_CartesianLevelSetBC<6, 1, StoredLevelSet, bc_t> bc(&patch_grid, StoredLevelSet(5), bc_t());
+ * ...
+ * body.move(new_inertial2body);
+ * bc.updateCells(body);
+ * @endcode
+ */
+class MovingLevelSet
+{
+
+protected: // attributes
+
+  PatchGrid*              m_PatchGrid;
+  size_t                  m_IVar;                  ///< variable of field 0 to store G in
+  vector<CartesianPatch*> m_Patches;
+  SparseBrickGrid         m_Field;                 ///< G at the nodes of the body grid
+  vec3_t                  m_X0;                    ///< first node of the body grid (body frame)
+  real                    m_H;                     ///< node spacing of the body grid
+  real                    m_Band;                  ///< half width of the band with exact values
+  real                    m_Outside;               ///< value of G outside of the body grid
+  CoordTransformVV        m_TransformInertial2Body;
+  bool                    m_Initialised;
+  bool                    m_FullUpdate;            ///< true if all cells have been resampled in the last update
+  vector<vector<size_t> > m_BandCells;             ///< cells with |G| < m_Band (per patch)
+  vector<vector<size_t> > m_UpdatedCells;          ///< sorted cells with a new value of G after the last update (per patch)
+  vector<vector<char> >   m_Mark;                  ///< scratch flags to avoid duplicate cells (per patch)
+  size_t                  m_NumSampledCells;       ///< number of cells sampled in the last update
+  size_t                  m_NumCoveredCells;       ///< number of fluid cells covered by the body in the last update
+  size_t                  m_NumUncoveredCells;     ///< number of cells uncovered by the body in the last update
+
+
+protected: // methods
+
+  /**
+   * Sample G for a list of cells of one patch and apply the results.
+   * @param i_patch the index of the patch in m_Patches
+   * @param cells the cells to sample
+   * @param num_old_band the first num_old_band entries of cells are the band cells of the last update
+   * @param full true if all cells of the patch are sampled
+   */
+  void resample(size_t i_patch, const vector<size_t>& cells, size_t num_old_band, bool full);
+
+  /**
+   * Maximal displacement of the body grid between two positions.
+   * @param inertial2body_1 the first position
+   * @param inertial2body_2 the second position
+   * @return the maximal distance any point of the body grid moves
+   */
+  real maxDisplacement(const CoordTransformVV& inertial2body_1, const CoordTransformVV& inertial2body_2);
+
+
+public: // methods
+
+  /**
+   * @param patch_grid the patch grid (only Cartesian patches are used)
+   * @param i_var the variable of field 0 to store G in
+   */
+  MovingLevelSet(PatchGrid* patch_grid, size_t i_var);
+
+  /**
+   * Sample the body frame distance field.
+   * Bricks which are certainly farther than band from the surface (Lipschitz bound)
+   * are not evaluated cell by cell.
+   * @param levelset the level set definition in body coordinates
+   * @param x1 lower corner of the bounding box of the body (body frame)
+   * @param x2 upper corner of the bounding box of the body (body frame)
+   * @param h node spacing of the body grid
+   * @param band half width of the band with exact values. This must be larger than
+   *        the motion during a single update plus four cells of the patches.
+   */
+  void sample(LevelSetDefinition* levelset, vec3_t x1, vec3_t x2, real h, real band);
+
+  /**
+   * Set the position of the body and resample all cells of all patches.
+   * Cells with G < 0 will be deactivated.
+   * @param inertial2body transformation from the inertial system into the body frame
+   */
+  void initialise(const CoordTransformVV& inertial2body);
+
+  /**
+   * Move the body to a new position and update G and the active flags incrementally.
+   * @param inertial2body transformation from the inertial system into the body frame
+   */
+  void move(const CoordTransformVV& inertial2body);
+
+  /**
+   * Get G in the body frame (trilinear interpolation on the body grid).
+   * @param x_body the position in body coordinates
+   * @return the level set value
+   */
+  real bodyG(const vec3_t& x_body) const;
+
+  real G(const vec3_t& x_inertial) const { return bodyG(m_TransformInertial2Body.transform(x_inertial)); }
+
+  size_t          numPatches()                         { return m_Patches.size(); }
+  CartesianPatch* getPatch(size_t i_patch)             { return m_Patches[i_patch]; }
+  bool            fullUpdate()                         { return m_FullUpdate; }
+  size_t          numSampledCells()                    { return m_NumSampledCells; }
+  size_t          numCoveredCells()                    { return m_NumCoveredCells; }
+  size_t          numUncoveredCells()                  { return m_NumUncoveredCells; }
+  size_t          numBricks()                          { return m_Field.numAllocatedBricks(); }
+  const vector<size_t>& updatedCells(size_t i_patch)   { return m_UpdatedCells[i_patch]; }
+
+  /**
+   * Find a patch.
+   * @param patch the patch to look for
+   * @return the index of the patch or -1 if the patch is not handled by this level set
+   */
+  int patchIndex(CartesianPatch* patch);
+
+  CoordTransformVV getTransformInertial2Body() { return m_TransformInertial2Body; }
+
+};
+
+#endif // MOVINGLEVELSET_H
@@ -19,6 +19,7 @@
 // +                                                                      +
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 #include "objectdefinition.h"
+#include "objectprogram.h"
 
 ObjectDefinition::ObjectDefinition()
 {
@@ -30,3 +31,17 @@ void ObjectDefinition::getLowestObjects(vector<ObjectDefinition*>& my_lowest_obj
   my_lowest_objects.clear();
   my_lowest_objects.push_back(this);
 }
+
+
+void ObjectDefinition::checkInside(const real* xo, const real* yo, const real* zo, char* inside, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    inside[i] = isInside(xo[i], yo[i], zo[i]) ? 1 : 0;
+  }
+}
+
+
+void ObjectDefinition::compile(ObjectProgram& program)
+{
+  program.addLeaf(this);
+}
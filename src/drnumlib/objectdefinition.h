@@ -22,6 +22,7 @@
 #define OBJECTDEFINITION_H
 
 class ObjectDefinition;
+class ObjectProgram;
 
 #include "drnum.h"
 
@@ -56,6 +57,28 @@ public:
 
   bool isInside(vec3_t xyzo) { return isInside (xyzo[0], xyzo[1],xyzo[2]); }
 
+  /**
+    * Check a batch of points (1: inside, 0: outside).
+    * Derived classes may overload this, if a batch can be checked more efficiently.
+    * Must be thread safe for all classes used as leaves of an ObjectProgram.
+    */
+  virtual void checkInside(const real* xo, const real* yo, const real* zo, char* inside, size_t n);
+
+  /**
+    * Append the evaluation of this object to a postfix program.
+    * Leaves are loaded directly, combined objects compile their children first.
+    */
+  virtual void compile(ObjectProgram& program);
+
+  /**
+    * Conservative bounding box of the object in xyzo-coords.
+    * Used to skip patches and blocks of cells, that cannot be touched by the object.
+    * @param xyzo_min on return, lower coords of the box
+    * @param xyzo_max on return, upper coords of the box
+    * @return false, if no bounds are known for this object
+    */
+  virtual bool getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max) { return false; }
+
   virtual void getLowestObjects(vector<ObjectDefinition*>& my_lowest_objects);
 
   virtual bool evalBool() {return getKnownInside();}
@@ -0,0 +1,107 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef OBJECTPROGRAM_H
+#define OBJECTPROGRAM_H
+
+class ObjectProgram;
+
+#include "drnum.h"
+#include "objectdefinition.h"
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Flattened evaluation of a (combined) object definition.
+ *
+ * This is the boolean counterpart of LevelSetProgram: a tree of
+ * CombiObjectAnd/Or/AndNot nodes is compiled into a postfix program and
+ * evaluated for batches of points with element-wise loops on a stack of rows.
+ * The program does not use setKnownInside, hence it can be evaluated by
+ * several threads at a time, as long as each of them provides its own workspace.
+ */
+class ObjectProgram
+{
+
+public: // data types
+
+  enum operation_t { LOAD, AND, OR, ANDNOT };
+
+  struct instruction_t
+  {
+    operation_t op;
+    size_t      arg; ///< leaf index for LOAD, number of operands otherwise
+  };
+
+
+protected: // attributes
+
+  vector<ObjectDefinition*> m_Leaves;
+  vector<instruction_t>     m_Code;
+  size_t                    m_MaxStack;
+  size_t                    m_StackSize; ///< only used while compiling
+
+
+public: // methods
+
+  ObjectProgram();
+
+  /**
+   * Compile an object definition into a postfix program.
+   * @param object the root of the object tree
+   */
+  void compile(ObjectDefinition* object);
+
+  /**
+   * Append a leaf to the program (used by ObjectDefinition::compile).
+   * @param object the leaf object
+   */
+  void addLeaf(ObjectDefinition* object);
+
+  /**
+   * Append a combination operation to the program (used by CombiObject::compile).
+   * @param op the operation (AND, OR or ANDNOT)
+   * @param num_operands the number of operands on top of the stack
+   */
+  void addOperation(operation_t op, size_t num_operands);
+
+  /**
+   * Size of the workspace required to evaluate a batch of points.
+   * @param n the number of points of the batch
+   * @return the number of chars the workspace has to provide
+   */
+  size_t workspaceSize(size_t n) { return (m_Leaves.size() + m_MaxStack)*n; }
+
+  /**
+   * Evaluate the program for a batch of points.
+   * @param x the x coordinates of the points
+   * @param y the y coordinates of the points
+   * @param z the z coordinates of the points
+   * @param inside on return, 1 for points inside the object and 0 otherwise
+   * @param n the number of points
+   * @param work a workspace of at least workspaceSize(n) chars
+   */
+  void evaluate(const real* x, const real* y, const real* z, char* inside, size_t n, char* work);
+
+};
+
+#endif // OBJECTPROGRAM_H
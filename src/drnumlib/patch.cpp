@@ -32,11 +32,13 @@ Patch::Patch(PatchGrid *patch_grid, size_t num_seeklayers, size_t num_addprotect
   m_PatchGrid = patch_grid;
   m_Data = NULL;
   m_Active = NULL;
+  m_ActiveMaskChanged = true;
   m_NumFields = 0;
   m_NumVariables = 0;
   m_VariableSize = 0;
   m_FieldSize = 0;
   m_NumSplitFaces = 0;
+  m_SplitFaces = NULL;
   m_SeekExceptions = false;
   m_NumAddProtectLayers = num_addprotectlayers;
   m_NumSeekLayers = num_seeklayers;
@@ -712,6 +714,7 @@ void Patch::allocateData()
     m_IsSplitCell[i] = false;
     m_Active[i] = true;
   }
+  m_ActiveMaskChanged = true;
 }
 
 void Patch::deleteData()
@@ -730,14 +733,15 @@ void Patch::resize(size_t variable_size)
   allocateData();
 }
 
-void Patch::computeVariableDifference(size_t i_field1, size_t i_var1, size_t i_field2, size_t i_var2, real &max_norm, real &l2_norm)
+void Patch::computeVariableDifference(size_t i_field1, size_t i_var1, size_t i_field2, size_t i_var2, acc_real &max_norm, acc_real &l2_norm)
 {
   RESTRICT real* var1 = getVariable(i_field1, i_var1);
   RESTRICT real* var2 = getVariable(i_field2, i_var2);
   max_norm = 0.0;
   l2_norm  = 0.0;
   for (size_t i = 0; i < m_VariableSize; ++i) {
-    real diff = sqr(var2[i] - var1[i]);
+    acc_real delta = acc_real(var2[i]) - acc_real(var1[i]);
+    acc_real diff  = delta*delta;
     max_norm = max(max_norm, diff);
     l2_norm += diff;
   }
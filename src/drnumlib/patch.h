@@ -306,7 +306,7 @@ public: // methods
    * @param max_norm will hold the maximal absolute difference
    * @param l2_norm will hold the L2 norm of the difference
    */
-  void computeVariableDifference(size_t i_field1, size_t i_var1, size_t i_field2, size_t i_var2, real &max_norm, real &l2_norm);
+  void computeVariableDifference(size_t i_field1, size_t i_var1, size_t i_field2, size_t i_var2, acc_real &max_norm, acc_real &l2_norm);
 
 
   /// @todo The following 2 methods might perhaps go, as default is set construcion time (?)
@@ -707,6 +707,8 @@ public: // methods
 
   /**
    * @brief set the split interfaces of this patch
+   * The faces are sorted by cell and arranged in groups without shared cells (see getSplitGroupLimit).
+   * Previous split faces are replaced.
    * @param split_faces any STL container containing the split interfaces of the patch.
    */
   template <typename C> void setSplitFaces(const C &split_faces);
@@ -770,6 +772,12 @@ public: // methods
   size_t getSplitGroupLimit(size_t i) { return m_SplitGroupLimits[i]; }
   vector<size_t> getSplitGroupLimits() { return m_SplitGroupLimits; }
 
+  /**
+   * @brief Get the number of split face groups. The faces of a group belong to different cells.
+   * @return the number of groups
+   */
+  size_t getNumSplitGroups() { return max(size_t(1), m_SplitGroupLimits.size()) - 1; }
+
 
   /// @todo destructor
   virtual ~Patch();
@@ -895,32 +903,33 @@ inline void Patch::copyFieldToHost(size_t i_field)
 template <typename C>
 void Patch::setSplitFaces(const C &split_faces)
 {
-  m_NumSplitFaces = split_faces.size();
+  // compact copy, sorted by cell for locality
+  vector<splitface_t> faces(split_faces.begin(), split_faces.end());
+  sort(faces.begin(), faces.end());
+  delete [] m_SplitFaces;
+  m_NumSplitFaces = faces.size();
   m_SplitFaces = new splitface_t[m_NumSplitFaces];
-  list<splitface_t> remaining_faces;
-  list<splitface_t> group_faces;
-
-  list<size_t> remaining_cells;
 
   // mark split cells
-  {
-    typename C::const_iterator i;
-    for (i = split_faces.begin(); i != split_faces.end(); ++i) {
-      m_IsSplitCell[i->idx] = true;
-      if (i->inside) {
-        m_IsInsideCell[i->idx] = true;
-        remaining_cells.push_back(i->idx);
-      }
-      remaining_faces.push_back(*i);
+  vector<size_t> remaining_cells;
+  for (size_t i = 0; i < m_VariableSize; ++i) {
+    m_IsInsideCell[i] = false;
+    m_IsSplitCell[i] = false;
+  }
+  for (size_t i = 0; i < faces.size(); ++i) {
+    m_IsSplitCell[faces[i].idx] = true;
+    if (faces[i].inside) {
+      m_IsInsideCell[faces[i].idx] = true;
+      remaining_cells.push_back(faces[i].idx);
     }
   }
 
   // "fill" inside with marker field
   while (remaining_cells.size() > 0) {
-    list<size_t> cells = remaining_cells;
-    remaining_cells.clear();
-    for (list<size_t>::iterator i = cells.begin(); i != cells.end(); ++i) {
-      list<size_t> neighbours = getNeighbours(*i);
+    vector<size_t> cells;
+    cells.swap(remaining_cells);
+    for (size_t i = 0; i < cells.size(); ++i) {
+      list<size_t> neighbours = getNeighbours(cells[i]);
       for (list<size_t>::iterator j = neighbours.begin(); j != neighbours.end(); ++j) {
         if (!m_IsSplitCell[*j] && !m_IsInsideCell[*j]) {
           m_IsInsideCell[*j] = true;
@@ -930,32 +939,27 @@ void Patch::setSplitFaces(const C &split_faces)
     }
   }
 
-  // construct independent groups for parallel execution
-  size_t counter = 0;
-  m_SplitGroupLimits.clear();
-  m_SplitGroupLimits.push_back(counter);
-
-  while (remaining_faces.size() > 0) {
-    list<splitface_t> faces = remaining_faces;
-    remaining_faces.clear();
-    group_faces.clear();
-    vector<bool> cell_used(variableSize(), false);
-    for (list<splitface_t>::iterator i = faces.begin(); i != faces.end(); ++i) {
-      if (!cell_used[i->idx]) {
-        group_faces.push_back(*i);
-        cell_used[i->idx] = true;
-      } else {
-        remaining_faces.push_back(*i);
-      }
-    }
-    if (group_faces.size() == 0) {
-      BUG;
-    }
-    for (list<splitface_t>::iterator i = group_faces.begin(); i != group_faces.end(); ++i) {
-      m_SplitFaces[counter] = *i;
-      ++counter;
+  // construct independent groups for parallel execution:
+  // the n-th face of a cell goes to group n, hence a cell appears only once per group
+  vector<size_t> rank(faces.size(), 0);
+  size_t num_groups = 0;
+  for (size_t i = 0; i < faces.size(); ++i) {
+    if (i > 0 && faces[i].idx == faces[i-1].idx) {
+      rank[i] = rank[i-1] + 1;
     }
-    m_SplitGroupLimits.push_back(counter);
+    num_groups = max(num_groups, rank[i] + 1);
+  }
+  m_SplitGroupLimits.assign(num_groups + 1, 0);
+  for (size_t i = 0; i < faces.size(); ++i) {
+    ++m_SplitGroupLimits[rank[i] + 1];
+  }
+  for (size_t i_group = 0; i_group < num_groups; ++i_group) {
+    m_SplitGroupLimits[i_group + 1] += m_SplitGroupLimits[i_group];
+  }
+  vector<size_t> counter(m_SplitGroupLimits.begin(), m_SplitGroupLimits.end() - 1);
+  for (size_t i = 0; i < faces.size(); ++i) {
+    m_SplitFaces[counter[rank[i]]] = faces[i];
+    ++counter[rank[i]];
   }
 }
 
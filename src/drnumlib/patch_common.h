@@ -29,6 +29,7 @@ size_t  m_NumVariables; ///< number of variables (e.g. rho, rhou, ...)
 size_t  m_FieldSize;    ///< length of each field
 size_t  m_VariableSize; ///< length of each variable
 bool*   m_Active;       ///< a field indicating if a cell is active (e.g. for immersed boundaries)
+bool    m_ActiveMaskChanged; ///< m_Active has been modified since the last call of setActiveMaskChanged(false)
 
 PatchGrid* m_PatchGrid; ///< the patch grid this patch belongs to
 
@@ -489,12 +490,12 @@ CUDA_DH bool isInsideCell(size_t idx)
 
 CUDA_DH bool* getIsSplitCell()
 {
-  return m_IsInsideCell;
+  return m_IsSplitCell;
 }
 
 CUDA_DH bool isSplitCell(size_t idx)
 {
-  return m_IsInsideCell[idx];
+  return m_IsSplitCell[idx];
 }
 
 CUDA_DH bool isSplitFace(size_t idx1, size_t idx2)
@@ -502,10 +503,18 @@ CUDA_DH bool isSplitFace(size_t idx1, size_t idx2)
   return logicalXor(m_IsInsideCell[idx1], m_IsInsideCell[idx2]);
 }
 
-CUDA_DH void deactivate(size_t i_cell) { m_Active[i_cell] = false; }
-CUDA_DH void activate  (size_t i_cell) { m_Active[i_cell] = true; }
+CUDA_DH void deactivate(size_t i_cell) { m_Active[i_cell] = false; m_ActiveMaskChanged = true; }
+CUDA_DH void activate  (size_t i_cell) { m_Active[i_cell] = true;  m_ActiveMaskChanged = true; }
 CUDA_DH bool isActive  (size_t i_cell) { return m_Active[i_cell]; }
 
+/**
+ * Flag the active cells as modified. This has to be called after writing to getActive() directly,
+ * since iterators cache the active index ranges of a patch.
+ * @param changed the new state of the flag (false after rebuilding derived data)
+ */
+CUDA_DH void setActiveMaskChanged(bool changed = true) { m_ActiveMaskChanged = changed; }
+CUDA_DH bool activeMaskChanged() { return m_ActiveMaskChanged; }
+
 /**
  * Copy simple data attributes from another object.
  * The other object can have a different type as long as the required attributes are present.
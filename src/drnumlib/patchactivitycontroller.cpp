@@ -0,0 +1,216 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "patchactivitycontroller.h"
+
+#ifdef OPEN_MP
+#include <omp.h>
+#endif
+
+PatchActivityController::PatchActivityController(PatchGrid* patch_grid, real threshold, size_t num_quiet_steps, real tolerance)
+{
+  m_PatchGrid        = patch_grid;
+  m_Threshold        = threshold;
+  m_Tolerance        = tolerance;
+  m_NumQuietSteps    = max(size_t(1), num_quiet_steps);
+  m_NumFreezes       = 0;
+  m_NumReactivations = 0;
+  m_NumVars          = 0;
+  size_t num_patches = m_PatchGrid->getNumPatches();
+  if (num_patches > 0) {
+    m_NumVars = m_PatchGrid->getPatch(0)->numVariables();
+    if (m_PatchGrid->getPatch(0)->numFields() < 2) {
+      ERROR("patch activity control requires at least two fields");
+    }
+  }
+  m_Scale.resize(m_NumVars, 1.0);
+  m_Slots.resize(num_patches);
+  m_Controlled.resize(num_patches, true);
+  m_Frozen.resize(num_patches, false);
+  m_QuietCount.resize(num_patches, 0);
+  m_Change.resize(num_patches, 0.0);
+  m_Snapshot.resize(num_patches);
+}
+
+void PatchActivityController::addIterator(PatchIterator* iterator)
+{
+  for (size_t i = 0; i < iterator->numPatches(); ++i) {
+    size_t i_patch = iterator->getPatch(i)->getIndex();
+    if (i_patch >= m_Slots.size()) {
+      BUG;
+    }
+    slot_t slot;
+    slot.iterator = iterator;
+    slot.i_patch  = i;
+    m_Slots[i_patch].push_back(slot);
+  }
+}
+
+void PatchActivityController::addIterators(IteratorFeeder& feeder)
+{
+  for (size_t i_it = 0; i_it < feeder.numIterators(); ++i_it) {
+    addIterator(feeder.getIterator(i_it));
+  }
+}
+
+void PatchActivityController::setReferenceScale(const real* scale)
+{
+  for (size_t i_var = 0; i_var < m_NumVars; ++i_var) {
+    if (scale[i_var] <= 0) {
+      ERROR("reference scales have to be positive");
+    }
+    m_Scale[i_var] = scale[i_var];
+  }
+}
+
+void PatchActivityController::exclude(Patch* patch)
+{
+  size_t i_patch = patch->getIndex();
+  if (m_Frozen[i_patch]) {
+    reactivate(i_patch);
+  }
+  m_Controlled[i_patch] = false;
+}
+
+real PatchActivityController::computeChange(Patch* patch)
+{
+  real change = 0;
+  for (size_t i_var = 0; i_var < m_NumVars; ++i_var) {
+    real* var0 = patch->getVariable(0, i_var);
+    real* var1 = patch->getVariable(1, i_var);
+    real max_delta = 0;
+    for (size_t i = 0; i < patch->variableSize(); ++i) {
+      max_delta = max(max_delta, real(fabs(var0[i] - var1[i])));
+    }
+    change = max(change, max_delta/m_Scale[i_var]);
+  }
+  return change;
+}
+
+real PatchActivityController::computeDrift(size_t i_patch)
+{
+  Patch* patch = m_PatchGrid->getPatch(i_patch);
+  size_t  num_rec = patch->getNumReceivingCellsUnique();
+  size_t* rec     = patch->getReceivingCellIndicesUnique();
+  real*   snap    = &m_Snapshot[i_patch][0];
+  real drift = 0;
+  for (size_t i_var = 0; i_var < m_NumVars; ++i_var) {
+    real* var = patch->getVariable(0, i_var);
+    real max_delta = 0;
+    for (size_t i_rec = 0; i_rec < num_rec; ++i_rec) {
+      max_delta = max(max_delta, real(fabs(var[rec[i_rec]] - snap[i_var*num_rec + i_rec])));
+    }
+    drift = max(drift, max_delta/m_Scale[i_var]);
+  }
+  return drift;
+}
+
+void PatchActivityController::setActive(size_t i_patch, bool active)
+{
+  for (size_t i = 0; i < m_Slots[i_patch].size(); ++i) {
+    if (active) {
+      m_Slots[i_patch][i].iterator->activatePatch(m_Slots[i_patch][i].i_patch);
+    } else {
+      m_Slots[i_patch][i].iterator->deactivatePatch(m_Slots[i_patch][i].i_patch);
+    }
+  }
+}
+
+void PatchActivityController::freeze(size_t i_patch)
+{
+  Patch* patch = m_PatchGrid->getPatch(i_patch);
+  size_t  num_rec = patch->getNumReceivingCellsUnique();
+  size_t* rec     = patch->getReceivingCellIndicesUnique();
+  m_Snapshot[i_patch].resize(m_NumVars*num_rec + 1);
+  for (size_t i_var = 0; i_var < m_NumVars; ++i_var) {
+    real* var = patch->getVariable(0, i_var);
+    for (size_t i_rec = 0; i_rec < num_rec; ++i_rec) {
+      m_Snapshot[i_patch][i_var*num_rec + i_rec] = var[rec[i_rec]];
+    }
+  }
+  setActive(i_patch, false);
+  m_Frozen[i_patch] = true;
+  ++m_NumFreezes;
+}
+
+void PatchActivityController::reactivate(size_t i_patch)
+{
+  setActive(i_patch, true);
+  m_Frozen[i_patch] = false;
+  m_QuietCount[i_patch] = 0;
+  m_Snapshot[i_patch].clear();
+  ++m_NumReactivations;
+}
+
+void PatchActivityController::update()
+{
+  int num_patches = m_PatchGrid->getNumPatches();
+
+#ifndef DEBUG
+  #pragma omp parallel for
+#endif
+  for (int i_patch = 0; i_patch < num_patches; ++i_patch) {
+    if (m_Controlled[i_patch]) {
+      if (m_Frozen[i_patch]) {
+        m_Change[i_patch] = computeDrift(i_patch);
+      } else {
+        m_Change[i_patch] = computeChange(m_PatchGrid->getPatch(i_patch));
+      }
+    }
+  }
+
+  for (int i_patch = 0; i_patch < num_patches; ++i_patch) {
+    if (!m_Controlled[i_patch]) {
+      continue;
+    }
+    if (m_Frozen[i_patch]) {
+      if (m_Change[i_patch] > m_Tolerance) {
+        reactivate(i_patch);
+      }
+    } else if (m_Change[i_patch] < m_Threshold) {
+      ++m_QuietCount[i_patch];
+      if (m_QuietCount[i_patch] >= m_NumQuietSteps) {
+        freeze(i_patch);
+      }
+    } else {
+      m_QuietCount[i_patch] = 0;
+    }
+  }
+}
+
+void PatchActivityController::reactivateAll()
+{
+  for (size_t i_patch = 0; i_patch < m_Frozen.size(); ++i_patch) {
+    if (m_Frozen[i_patch]) {
+      reactivate(i_patch);
+    }
+  }
+}
+
+size_t PatchActivityController::numFrozenPatches()
+{
+  size_t N = 0;
+  for (size_t i_patch = 0; i_patch < m_Frozen.size(); ++i_patch) {
+    if (m_Frozen[i_patch]) {
+      ++N;
+    }
+  }
+  return N;
+}
@@ -0,0 +1,141 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef PATCHACTIVITYCONTROLLER_H
+#define PATCHACTIVITYCONTROLLER_H
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "iteratorfeeder.h"
+#include "iterators/patchiterator.h"
+
+#include <vector>
+
+/**
+ * Automatic freezing of quiescent patches.
+ *
+ * Patches whose solution does not change any more (e.g. far-field patches at
+ * free-stream conditions) are deactivated in all iterators holding them. A frozen
+ * patch keeps its data in field 0, so it still serves as a donor for its neighbours
+ * and it still receives donor data into its receiving cells. The received data are
+ * compared against a snapshot taken at the time of freezing; once they have drifted
+ * beyond the reactivation tolerance, the patch is activated again.
+ *
+ * The change of a patch is the maximal difference between field 0 and field 1 over
+ * all cells and variables, each variable divided by its reference scale (see
+ * setReferenceScale). The controller has to be called once per time step, after the
+ * time integration (field 1 then holds the solution of the previous time step).
+ *
+ * The controller only works on host data and is meant for CPU runs.
+ */
+class PatchActivityController
+{
+
+protected: // data types
+
+  struct slot_t
+  {
+    PatchIterator* iterator;
+    size_t         i_patch;
+  };
+
+
+protected: // attributes
+
+  PatchGrid*             m_PatchGrid;
+  size_t                 m_NumVars;
+  real                   m_Threshold;       ///< maximal scaled change per step of a quiescent patch
+  real                   m_Tolerance;       ///< maximal scaled drift of received data of a frozen patch
+  size_t                 m_NumQuietSteps;   ///< number of quiet steps before a patch gets frozen
+  vector<real>           m_Scale;           ///< reference scale of every variable
+  vector<vector<slot_t> > m_Slots;          ///< iterator slots of every patch
+  vector<bool>           m_Controlled;      ///< patch may be frozen
+  vector<bool>           m_Frozen;
+  vector<size_t>         m_QuietCount;
+  vector<real>           m_Change;          ///< last scaled change (active) or drift (frozen) of every patch
+  vector<vector<real> >  m_Snapshot;        ///< received data at the time of freezing
+  size_t                 m_NumFreezes;
+  size_t                 m_NumReactivations;
+
+
+protected: // methods
+
+  real computeChange(Patch* patch);
+  real computeDrift(size_t i_patch);
+  void freeze(size_t i_patch);
+  void reactivate(size_t i_patch);
+  void setActive(size_t i_patch, bool active);
+
+
+public: // methods
+
+  /**
+   * @param patch_grid the grid
+   * @param threshold maximal scaled change per time step of a patch considered quiescent
+   * @param num_quiet_steps number of consecutive quiet time steps before a patch gets frozen
+   * @param tolerance maximal scaled change of the received donor data of a frozen patch
+   */
+  PatchActivityController(PatchGrid* patch_grid, real threshold, size_t num_quiet_steps, real tolerance);
+
+  /**
+   * Register an iterator. Patches are frozen in all registered iterators.
+   * @param iterator the iterator to register
+   */
+  void addIterator(PatchIterator* iterator);
+
+  /**
+   * Register all iterators of an IteratorFeeder.
+   * @param feeder the IteratorFeeder
+   */
+  void addIterators(IteratorFeeder& feeder);
+
+  /**
+   * Set the reference scale of every variable.
+   * Changes are divided by these scales before they are compared with the threshold and the tolerance.
+   * @param scale the scales [number of variables]
+   */
+  void setReferenceScale(const real* scale);
+
+  /**
+   * Exclude a patch from the control (e.g. a coupling patch). The activity of the patch is not touched.
+   * @param patch the patch to exclude
+   */
+  void exclude(Patch* patch);
+
+  /**
+   * Check all patches; freeze quiescent ones and reactivate frozen ones with changed surroundings.
+   * Has to be called once per time step after the time integration.
+   */
+  void update();
+
+  /**
+   * Reactivate all frozen patches (e.g. after a change of the boundary conditions).
+   */
+  void reactivateAll();
+
+  size_t numFrozenPatches();
+  bool   frozen(size_t i_patch) { return m_Frozen[i_patch]; }
+  real   change(size_t i_patch) { return m_Change[i_patch]; }
+  size_t numFreezes() { return m_NumFreezes; }
+  size_t numReactivations() { return m_NumReactivations; }
+
+};
+
+#endif // PATCHACTIVITYCONTROLLER_H
@@ -28,6 +28,8 @@
 #include "patchgrid.h"
 #include "stringtools.h"
 #include "geometrytools.h"
+#include "cartesianstretchedpatch.h"
+#include "prismaticlayerpatch.h"
 
 PatchGrid::PatchGrid(size_t num_seeklayers, size_t num_addprotectlayers)
 {
@@ -500,6 +502,12 @@ void PatchGrid::readGrid(string gridfilename, real scale)
 
   // Say something
   cout << "Reading PatchGrid::readGrid() from file " << grid_file << " ... " << endl;
+  readGrid(s_grid, scale);
+  cout << "done. " << endl;
+}
+
+void PatchGrid::readGrid(istream& s_grid, real scale)
+{
   /** @todo Preliminary format. */
 
   // Read file contents
@@ -548,16 +556,32 @@ void PatchGrid::readGrid(string gridfilename, real scale)
       new_patch->readFromFile(iss, scale);
       m_PatchGroups->insertPatch(new_patch); /// @todo better outside of reading loop?
     }
+    //.... CartesianStretchedPatch
+    else if(patch_type == 1002) {
+      CartesianStretchedPatch* new_patch;
+      new_patch = new CartesianStretchedPatch(this);
+      size_t index = insertPatch(new_patch);
+      new_patch->setIndex(index);
+      new_patch->setPatchComment(patchcomment);
+      new_patch->readFromFile(iss, scale);
+      m_PatchGroups->insertPatch(new_patch);
+    }
     //.... Unstructured Patch
     else if(patch_type == 1010) {
-      // ...
+      //...... Create a new PrismaticLayerPatch
+      PrismaticLayerPatch* new_patch;
+      new_patch = new PrismaticLayerPatch(this);
+      size_t index = insertPatch(new_patch);
+      new_patch->setIndex(index);
+      new_patch->setPatchComment(patchcomment);
+      new_patch->readFromFile(iss, scale);
+      m_PatchGroups->insertPatch(new_patch);
     }
     else {
       cout << "unknown patch type code" << patch_type << endl;
       BUG;
     }
   }
-  cout << "done. " << endl;
 }
 
 void PatchGrid::writeData(size_t i_field, QString base_file_name, real time, int count)
@@ -699,14 +723,19 @@ bool PatchGrid::findCell(vec3_t xo, int &id_patch, int &id_cell)
   id_patch = -1;
   id_cell = -1;
   real min_distance = MAX_REAL;
-  for (size_t id_patch = 0; id_patch < getNumPatches(); ++id_patch) {
-    int id_cell_patch = getPatch(id_patch)->findCell(xo);
-    if (id_cell_patch) {
-      vec3_t xo_cell = getPatch(id_patch)->xyzoCell(id_cell_patch);
+  for (size_t i_patch = 0; i_patch < getNumPatches(); ++i_patch) {
+    Patch* patch = getPatch(i_patch);
+    // cheap rejection on bounding box, before transforming into patch coords
+    if (!GeometryTools::isInsideCartesianBox(xo, patch->accessBBoxXYZoMin(), patch->accessBBoxXYZoMax())) {
+      continue;
+    }
+    int id_cell_patch = patch->findCell(xo);
+    if (id_cell_patch >= 0) {
+      vec3_t xo_cell = patch->xyzoCell(id_cell_patch);
       real distance = (xo - xo_cell).abs();
       if (distance < min_distance) {
         min_distance = distance;
-        id_patch = id_patch;
+        id_patch = i_patch;
         id_cell = id_cell_patch;
       }
     }
@@ -163,6 +163,13 @@ public: // methods
    */
   void readGrid(string gridfilename = "/grid/patches", real scale = 1.0);
 
+  /**
+   * Read patch list from a stream in the format of a grid file.
+   * @param s_grid the stream to read from
+   * @param scale scaling factor for all coordinates
+   */
+  void readGrid(istream& s_grid, real scale = 1.0);
+
 
   /// @todo not implemented
   /**
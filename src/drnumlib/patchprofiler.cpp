@@ -0,0 +1,241 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "patchprofiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <fstream>
+
+PatchProfiler::PatchProfiler(PatchGrid *patch_grid)
+{
+  m_PatchGrid     = patch_grid;
+  m_ComputeRegion = "computePatch";
+  m_DonorRegion   = "copyDonorDataPatch";
+  m_Imbalance     = 1;
+}
+
+void PatchProfiler::setRegions(string compute_region, string donor_region)
+{
+  m_ComputeRegion = compute_region;
+  m_DonorRegion   = donor_region;
+}
+
+double PatchProfiler::median(vector<double> values)
+{
+  if (values.size() == 0) {
+    return 0;
+  }
+  size_t n = values.size()/2;
+  nth_element(values.begin(), values.begin() + n, values.end());
+  return values[n];
+}
+
+struct PatchProfilerCompare
+{
+  const vector<PatchProfiler::patch_info_t>* info;
+  bool operator()(size_t i1, size_t i2) const
+  {
+    return (*info)[i1].share > (*info)[i2].share;
+  }
+};
+
+void PatchProfiler::analyse()
+{
+  HardwareCounters::counters_t zero = {0, 0, 0};
+  size_t num_patches = m_PatchGrid->getNumPatches();
+  m_Info.resize(num_patches);
+
+  const Telemetry::region_t* compute = NULL;
+  const Telemetry::region_t* donor   = NULL;
+  for (size_t i_region = 0; i_region < global_telemetry.numRegions(); ++i_region) {
+    if (global_telemetry.getRegion(i_region).name == m_ComputeRegion) {
+      compute = &global_telemetry.getRegion(i_region);
+    }
+    if (global_telemetry.getRegion(i_region).name == m_DonorRegion) {
+      donor = &global_telemetry.getRegion(i_region);
+    }
+  }
+
+  // static data and measured times
+  double total_time = 0;
+  for (size_t i_patch = 0; i_patch < num_patches; ++i_patch) {
+    Patch* patch = m_PatchGrid->getPatch(i_patch);
+    patch_info_t& I = m_Info[i_patch];
+    I.index               = i_patch;
+    I.patch_type          = patch->accessPatchType();
+    I.num_cells           = patch->variableSize();
+    I.num_active          = 0;
+    for (size_t l = 0; l < patch->variableSize(); ++l) {
+      if (patch->isActive(l)) {
+        ++I.num_active;
+      }
+    }
+    I.donor_contributions = patch->getNumDonorWIConcat();
+
+    // per contribution: index, weight and all donor variables are read,
+    // every receiving cell is reset and written once
+    size_t nv = patch->numVariables();
+    I.donor_bytes  = double(I.donor_contributions)*(sizeof(size_t) + sizeof(real) + nv*sizeof(real));
+    I.donor_bytes += double(patch->getNumReceivingCellsUnique())*2*nv*sizeof(real);
+
+    I.compute_time  = 0;
+    I.compute_calls = 0;
+    I.counters      = zero;
+    if (compute && i_patch < compute->patch_time.size()) {
+      I.compute_time  = compute->patch_time[i_patch];
+      I.compute_calls = compute->patch_calls[i_patch];
+      I.counters      = compute->patch_counters[i_patch];
+    }
+    I.donor_time  = 0;
+    I.donor_calls = 0;
+    if (donor && i_patch < donor->patch_time.size()) {
+      I.donor_time  = donor->patch_time[i_patch];
+      I.donor_calls = donor->patch_calls[i_patch];
+    }
+    total_time += I.compute_time + I.donor_time;
+  }
+
+  // derived quantities
+  vector<double> cells, cps, ipc, mpc;
+  for (size_t i_patch = 0; i_patch < num_patches; ++i_patch) {
+    patch_info_t& I = m_Info[i_patch];
+    I.share            = (I.compute_time + I.donor_time)/max(1e-30, total_time);
+    I.cells_per_second = 0;
+    I.donor_bandwidth  = 0;
+    I.ipc              = 0;
+    I.misses_per_cell  = 0;
+    cells.push_back(I.num_cells);
+    if (I.compute_calls > 0 && I.compute_time > 0) {
+      I.cells_per_second = double(I.num_cells)*I.compute_calls/I.compute_time;
+      cps.push_back(I.cells_per_second);
+      if (I.counters.cycles > 0) {
+        I.ipc = double(I.counters.instructions)/double(I.counters.cycles);
+        I.misses_per_cell = double(I.counters.cache_misses)/(double(I.num_cells)*I.compute_calls);
+        ipc.push_back(I.ipc);
+        mpc.push_back(I.misses_per_cell);
+      }
+    }
+    if (I.donor_calls > 0 && I.donor_time > 0) {
+      I.donor_bandwidth = I.donor_bytes*I.donor_calls/I.donor_time;
+    }
+  }
+  double median_cells = median(cells);
+  double median_cps   = median(cps);
+  double median_ipc   = median(ipc);
+  double median_mpc   = median(mpc);
+
+  // flags
+  double max_cost  = 0;
+  double mean_cost = 0;
+  size_t num_timed = 0;
+  for (size_t i_patch = 0; i_patch < num_patches; ++i_patch) {
+    patch_info_t& I = m_Info[i_patch];
+    I.flags = "";
+    I.relative_cost = 0;
+    if (I.cells_per_second > 0) {
+      I.relative_cost = median_cps/I.cells_per_second;
+      max_cost   = max(max_cost, I.relative_cost);
+      mean_cost += I.relative_cost;
+      ++num_timed;
+      if (I.relative_cost > 1.5) {
+        I.flags += "slow ";
+      }
+    }
+    if (I.num_cells < 0.1*median_cells) {
+      I.flags += "small ";
+    }
+    if (I.num_active < 0.75*I.num_cells) {
+      I.flags += "inactive ";
+    }
+    if (I.donor_time > 0.25*I.compute_time && I.compute_time > 0) {
+      I.flags += "exchange ";
+    }
+    if (I.ipc > 0) {
+      if (I.misses_per_cell > 2*median_mpc || I.ipc < 0.5*median_ipc) {
+        I.flags += "memory ";
+      }
+    }
+    if (!I.flags.empty()) {
+      I.flags.resize(I.flags.size() - 1);
+    }
+  }
+  m_Imbalance = 1;
+  if (num_timed > 0 && mean_cost > 0) {
+    m_Imbalance = max_cost/(mean_cost/num_timed);
+  }
+
+  // ranking
+  m_Ranking.resize(num_patches);
+  for (size_t i_patch = 0; i_patch < num_patches; ++i_patch) {
+    m_Ranking[i_patch] = i_patch;
+  }
+  PatchProfilerCompare compare;
+  compare.info = &m_Info;
+  stable_sort(m_Ranking.begin(), m_Ranking.end(), compare);
+}
+
+void PatchProfiler::printReport(size_t max_patches)
+{
+  cout << "\nPatch hotspots (cost imbalance max/mean: " << setprecision(3) << m_Imbalance << "):\n";
+  cout << "  patch     cells  active%   time[s]  share%    Mcells/s  rel.cost  donor[MB/s]";
+  bool counters = global_telemetry.countersEnabled();
+  if (counters) {
+    cout << "    IPC  misses/cell";
+  }
+  cout << "  flags\n";
+  for (size_t i = 0; i < min(max_patches, m_Ranking.size()); ++i) {
+    const patch_info_t& I = m_Info[m_Ranking[i]];
+    cout << fixed;
+    cout << "  " << setw(5) << I.index;
+    cout << setw(10) << I.num_cells;
+    cout << setw(9) << setprecision(1) << 100.0*I.num_active/max(size_t(1), I.num_cells);
+    cout << setw(10) << setprecision(3) << I.compute_time + I.donor_time;
+    cout << setw(8) << setprecision(1) << 100*I.share;
+    cout << setw(12) << setprecision(2) << 1e-6*I.cells_per_second;
+    cout << setw(10) << setprecision(2) << I.relative_cost;
+    cout << setw(13) << setprecision(1) << 1e-6*I.donor_bandwidth;
+    if (counters) {
+      cout << setw(7) << setprecision(2) << I.ipc;
+      cout << setw(13) << setprecision(2) << I.misses_per_cell;
+    }
+    cout << "  " << I.flags << "\n";
+  }
+  cout.unsetf(ios::floatfield);
+  cout << setprecision(6) << endl;
+}
+
+void PatchProfiler::writeCsv(string file_name)
+{
+  ofstream file(file_name.c_str());
+  file << "# index, type, cells, active, donor_contributions, donor_bytes, compute_time, compute_calls, ";
+  file << "donor_time, donor_calls, share, cells_per_second, donor_bandwidth, relative_cost, ";
+  file << "cycles, instructions, cache_misses, ipc, misses_per_cell, flags\n";
+  file << setprecision(6);
+  for (size_t i_patch = 0; i_patch < m_Info.size(); ++i_patch) {
+    const patch_info_t& I = m_Info[i_patch];
+    file << I.index << ", " << I.patch_type << ", " << I.num_cells << ", " << I.num_active << ", ";
+    file << I.donor_contributions << ", " << I.donor_bytes << ", ";
+    file << I.compute_time << ", " << I.compute_calls << ", " << I.donor_time << ", " << I.donor_calls << ", ";
+    file << I.share << ", " << I.cells_per_second << ", " << I.donor_bandwidth << ", " << I.relative_cost << ", ";
+    file << I.counters.cycles << ", " << I.counters.instructions << ", " << I.counters.cache_misses << ", ";
+    file << I.ipc << ", " << I.misses_per_cell << ", " << I.flags << "\n";
+  }
+}
@@ -0,0 +1,128 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef PATCHPROFILER_H
+#define PATCHPROFILER_H
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "telemetry.h"
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Per-patch performance summary and hotspot ranking.
+ *
+ * Combines static patch data (cells, active cells, donor contributions) with the
+ * per-patch times and hardware counters gathered by the global Telemetry for the
+ * flux computation ("computePatch") and the donor exchange ("copyDonorDataPatch").
+ * Patches are ranked by their share of the total run time and flagged as:
+ *
+ *  - slow:     throughput (cells/s) less than 2/3 of the median of all patches
+ *  - small:    less than 10% of the median cell count (overhead dominated, merge candidate)
+ *  - inactive: more than 25% inactive cells (wasted work, split candidate)
+ *  - exchange: donor exchange takes more than 25% of the flux computation
+ *  - memory:   (hardware counters only) cache misses per cell above twice the median
+ *              or IPC below half of the median
+ *
+ * The CSV output has one line per patch, indexed as in the grid file, and can be
+ * read by Mesh.readProfile in drnum.py.
+ */
+class PatchProfiler
+{
+
+public: // data types
+
+  struct patch_info_t
+  {
+    size_t index;
+    size_t patch_type;
+    size_t num_cells;
+    size_t num_active;
+    size_t donor_contributions;   ///< concatenated donor cell contributions
+    double donor_bytes;           ///< estimated bytes moved per exchange
+    double compute_time;
+    size_t compute_calls;
+    double donor_time;
+    size_t donor_calls;
+    double share;                 ///< fraction of the total measured patch time
+    double cells_per_second;
+    double donor_bandwidth;       ///< bytes/s in the donor exchange
+    double relative_cost;         ///< cost per cell relative to the median patch
+    double ipc;
+    double misses_per_cell;
+    HardwareCounters::counters_t counters;
+    string flags;
+  };
+
+
+protected: // attributes
+
+  PatchGrid*           m_PatchGrid;
+  string               m_ComputeRegion;
+  string               m_DonorRegion;
+  vector<patch_info_t> m_Info;
+  vector<size_t>       m_Ranking;        ///< patch indices, most expensive first
+  double               m_Imbalance;      ///< max/mean of the cost per cell
+
+
+protected: // methods
+
+  static double median(vector<double> values);
+
+
+public: // methods
+
+  PatchProfiler(PatchGrid* patch_grid);
+
+  /**
+   * Select the telemetry regions which hold the per-patch times.
+   * @param compute_region region of the flux computation
+   * @param donor_region region of the donor exchange
+   */
+  void setRegions(string compute_region, string donor_region);
+
+  /**
+   * Gather all data and compute the ranking.
+   * Has to be called after the run (or whenever a report is needed).
+   */
+  void analyse();
+
+  /**
+   * Print the ranked hotspot report to stdout.
+   * @param max_patches maximal number of patches to list
+   */
+  void printReport(size_t max_patches = 20);
+
+  /**
+   * Write all per-patch data as CSV (one line per patch, ascending index).
+   * @param file_name the name of the file
+   */
+  void writeCsv(string file_name);
+
+  size_t numPatches() { return m_Info.size(); }
+  const patch_info_t& getInfo(size_t i_patch) { return m_Info[i_patch]; }
+
+};
+
+#endif // PATCHPROFILER_H
@@ -19,104 +19,896 @@
 // +                                                                      +
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 #include "prismaticlayerpatch.h"
+#include "math/smallsquarematrix.h"
 
-//#ifdef WITH_VTK
-//#include <vtkSmartPointer.h>
-//#include <vtkRectilinearGrid.h>
-//#include <vtkXMLRectilinearGridWriter.h>
-//#include <vtkFloatArray.h>
-//#include <vtkCellData.h>
-//#include <QVector>
-//#endif
+#include <map>
+#include <limits>
+
+#ifdef WITH_VTK
+#include <vtkCellType.h>
+#include <vtkPoints.h>
+#endif
 
 
 PrismaticLayerPatch::PrismaticLayerPatch(PatchGrid* patch_grid, size_t num_seeklayers, size_t num_addprotectlayers)
   : Patch(patch_grid, num_seeklayers, num_addprotectlayers)
 {
-  m_mypatchtype = 1101;
+  m_mypatchtype = 1010;
   m_Eps = 1.e-5; /// @todo need a better eps-handling.
-  m_Max2DNodeIndexOK = false;
+  m_Num2DNodes = 0;
+  m_Num2DNodesOK = false;
+  m_NumLayers = 0;
+  m_NumSeekOuter = num_seeklayers;
+  m_NumSeekLateral = num_seeklayers;
+  m_MinChLength = 0;
+  m_InterpolatorsOK = false;
 }
 
-bool PrismaticLayerPatch::readFromFile(istringstream& iss_input)
+
+bool PrismaticLayerPatch::readFromFile(istringstream& iss_input, real scale)
 {
-  // read number of layers
+  bool no_error = Patch::readFromFile(iss_input, scale);
+  // number of layers, nodes and faces of the reference surface
+  size_t num_layers, num_2d_nodes, num_2d_faces;
+  iss_input >> num_layers;
+  iss_input >> num_2d_nodes;
+  iss_input >> num_2d_faces;
+  if (num_layers == 0 || num_2d_faces == 0) {
+    ERROR("PrismaticLayerPatch needs at least one layer and one reference face");
+  }
+  // seek exceptions
+  size_t num_seek_outer, num_seek_lateral;
+  iss_input >> num_seek_outer;
+  iss_input >> num_seek_lateral;
   // read reference faces (2D indexing with index set each)
-  // read coordinates (full 3D node indexing)
-  findMax2DNodeIndex();
-  BUG; // not yet implemented
+  m_RefFacesTo2DNodes.clear();
+  vector<size_t> face_nodes;
+  for (size_t i_2d = 0; i_2d < num_2d_faces; i_2d++) {
+    size_t num_face_nodes;
+    iss_input >> num_face_nodes;
+    if (num_face_nodes < 3) {
+      ERROR("reference faces of a PrismaticLayerPatch need at least three nodes");
+    }
+    face_nodes.resize(num_face_nodes);
+    for (size_t i_node = 0; i_node < num_face_nodes; i_node++) {
+      iss_input >> face_nodes[i_node];
+    }
+    m_RefFacesTo2DNodes.feedDataSet(num_face_nodes, &face_nodes[0]);
+  }
+  findNum2DNodes();
+  if (m_Num2DNodes > num_2d_nodes) {
+    ERROR("node index of a reference face out of range");
+  }
+  m_Num2DNodes = num_2d_nodes;
+  m_NumLayers = num_layers;
+  // read coordinates (full 3D node indexing), scaled according to IO-scaling factor
+  m_Coords.resize((num_layers + 1)*num_2d_nodes);
+  for (size_t i_node = 0; i_node < m_Coords.size(); i_node++) {
+    iss_input >> m_Coords[i_node].m_X;
+    iss_input >> m_Coords[i_node].m_Y;
+    iss_input >> m_Coords[i_node].m_Z;
+    m_Coords[i_node].m_X *= m_IOScale;
+    m_Coords[i_node].m_Y *= m_IOScale;
+    m_Coords[i_node].m_Z *= m_IOScale;
+  }
+  if (iss_input.fail()) {
+    ERROR("unexpected end of PrismaticLayerPatch definition");
+  }
+  // apply patch modifiers
+  setSeekExceptions(num_seek_outer, num_seek_lateral);
+  deleteData();
+  Patch::resize(num_layers*num_2d_faces);
+  buildTopology();
+  buildRegions();
+  computeGeometry();
+  setupInterpolators();
+  // continue reading solver codes from file
+  Patch::readSolverCodes(iss_input);
+
+  /// @todo check before returning "true", see also patch.cpp
+  return no_error;
 }
 
 
-bool PrismaticLayerPatch::writeToFile(ifstream &s_mesh)
+void PrismaticLayerPatch::findNum2DNodes()
 {
+  vector<size_t> &node_list = m_RefFacesTo2DNodes.accessItemList();
+  m_Num2DNodes = 0;
+  for(size_t ii = 0; ii < node_list.size(); ii++) {
+    if(node_list[ii] + 1 > m_Num2DNodes) {
+      m_Num2DNodes = node_list[ii] + 1;
+    }
+  }
+  m_Num2DNodesOK = true;
 }
 
 
-void PrismaticLayerPatch::findMax2DNodeIndex()
+void PrismaticLayerPatch::buildTopology()
 {
-  vector<size_t> &node_list = m_RefFacesTo2DNodes.accessItemList();
-  m_Max2DNodeIndex = 0;
-  for(size_t ii = 0; ii < node_list.size(); ii++) {
-    if(node_list[ii] > m_Max2DNodeIndex) {
-      m_Max2DNodeIndex = node_list[ii];
+  size_t num_faces = num2DFaces();
+
+  // Collect edges of the reference surface. The first face visiting an edge defines its orientation.
+  map<pair<size_t, size_t>, size_t> edge_map;
+  vector<PrismEdge> edges;
+  vector<vector<size_t> > face_edges(num_faces);
+  vector<vector<size_t> > node_faces(m_Num2DNodes);
+  for (size_t i_2d = 0; i_2d < num_faces; i_2d++) {
+    size_t num_face_nodes = m_RefFacesTo2DNodes.numItems(i_2d);
+    for (size_t i_node = 0; i_node < num_face_nodes; i_node++) {
+      size_t node1 = m_RefFacesTo2DNodes.At(i_2d, i_node);
+      size_t node2 = m_RefFacesTo2DNodes.At(i_2d, (i_node + 1)%num_face_nodes);
+      node_faces[node1].push_back(i_2d);
+      pair<size_t, size_t> key(min(node1, node2), max(node1, node2));
+      map<pair<size_t, size_t>, size_t>::iterator i_map = edge_map.find(key);
+      if (i_map == edge_map.end()) {
+        PrismEdge edge;
+        edge.m_Node1 = node1;
+        edge.m_Node2 = node2;
+        edge.m_Face1 = i_2d;
+        edge.m_Face2 = i_2d;
+        edge.m_Boundary = true;
+        edge_map[key] = edges.size();
+        face_edges[i_2d].push_back(edges.size());
+        edges.push_back(edge);
+      } else {
+        PrismEdge& edge = edges[i_map->second];
+        if (!edge.m_Boundary) {
+          ERROR("reference surface of a PrismaticLayerPatch is not manifold");
+        }
+        if (edge.m_Node1 != node2) {
+          ERROR("inconsistent orientation of reference faces in a PrismaticLayerPatch");
+        }
+        edge.m_Face2 = i_2d;
+        edge.m_Boundary = false;
+        face_edges[i_2d].push_back(i_map->second);
+      }
+    }
+  }
+
+  // Group the edges (greedy colouring), so that the edges of a group do not share a reference face.
+  // The lateral faces of a group can then be processed in parallel without write conflicts.
+  vector<size_t> group(edges.size());
+  vector<vector<size_t> > face_groups(num_faces);
+  size_t num_groups = 0;
+  for (size_t i_edge = 0; i_edge < edges.size(); i_edge++) {
+    vector<size_t>& groups1 = face_groups[edges[i_edge].m_Face1];
+    vector<size_t>& groups2 = face_groups[edges[i_edge].m_Face2];
+    size_t i_group = 0;
+    while (find(groups1.begin(), groups1.end(), i_group) != groups1.end() ||
+           find(groups2.begin(), groups2.end(), i_group) != groups2.end()) {
+      i_group++;
+    }
+    group[i_edge] = i_group;
+    groups1.push_back(i_group);
+    if (!edges[i_edge].m_Boundary) {
+      groups2.push_back(i_group);
+    }
+    num_groups = max(num_groups, i_group + 1);
+  }
+  m_EdgeGroupLimits.assign(num_groups + 1, 0);
+  for (size_t i_edge = 0; i_edge < edges.size(); i_edge++) {
+    m_EdgeGroupLimits[group[i_edge] + 1]++;
+  }
+  for (size_t i_group = 0; i_group < num_groups; i_group++) {
+    m_EdgeGroupLimits[i_group + 1] += m_EdgeGroupLimits[i_group];
+  }
+  vector<size_t> new_index(edges.size());
+  {
+    vector<size_t> next = m_EdgeGroupLimits;
+    for (size_t i_edge = 0; i_edge < edges.size(); i_edge++) {
+      new_index[i_edge] = next[group[i_edge]]++;
+    }
+  }
+  m_Edges.resize(edges.size());
+  for (size_t i_edge = 0; i_edge < edges.size(); i_edge++) {
+    m_Edges[new_index[i_edge]] = edges[i_edge];
+  }
+  for (size_t i_2d = 0; i_2d < num_faces; i_2d++) {
+    for (size_t i = 0; i < face_edges[i_2d].size(); i++) {
+      face_edges[i_2d][i] = new_index[face_edges[i_2d][i]];
+    }
+  }
+  m_FaceEdges.buildFrom(face_edges);
+  m_NodeFaces.buildFrom(node_faces);
+
+  // Distance to the lateral boundary in face rings (front propagation from the boundary edges)
+  m_LateralRing.assign(num_faces, numeric_limits<size_t>::max());
+  vector<size_t> front;
+  for (size_t i_edge = 0; i_edge < m_Edges.size(); i_edge++) {
+    if (m_Edges[i_edge].m_Boundary && m_LateralRing[m_Edges[i_edge].m_Face1] != 0) {
+      m_LateralRing[m_Edges[i_edge].m_Face1] = 0;
+      front.push_back(m_Edges[i_edge].m_Face1);
+    }
+  }
+  size_t ring = 0;
+  while (front.size() > 0) {
+    vector<size_t> new_front;
+    for (size_t i_front = 0; i_front < front.size(); i_front++) {
+      size_t i_2d = front[i_front];
+      for (size_t i = 0; i < m_FaceEdges.numItems(i_2d); i++) {
+        const PrismEdge& edge = m_Edges[m_FaceEdges.At(i_2d, i)];
+        if (!edge.m_Boundary) {
+          size_t i_2d_neigh = edge.m_Face1 == i_2d ? edge.m_Face2 : edge.m_Face1;
+          if (m_LateralRing[i_2d_neigh] > ring + 1) {
+            m_LateralRing[i_2d_neigh] = ring + 1;
+            new_front.push_back(i_2d_neigh);
+          }
+        }
+      }
+    }
+    front.swap(new_front);
+    ring++;
+  }
+}
+
+
+void PrismaticLayerPatch::computeGeometry()
+{
+  size_t num_faces = num2DFaces();
+
+  // layer faces, area vectors point towards higher layers (right hand rule on reference faces)
+  m_LayerFaceNormals.resize(num_faces*(m_NumLayers + 1));
+  m_LayerFaceCentres.resize(num_faces*(m_NumLayers + 1));
+  for (size_t i_2d = 0; i_2d < num_faces; i_2d++) {
+    size_t num_face_nodes = m_RefFacesTo2DNodes.numItems(i_2d);
+    for (size_t i_level = 0; i_level <= m_NumLayers; i_level++) {
+      vec3_t x_face(0, 0, 0);
+      for (size_t i_node = 0; i_node < num_face_nodes; i_node++) {
+        x_face += xyzNode(nodeIndex(i_level, m_RefFacesTo2DNodes.At(i_2d, i_node)));
+      }
+      x_face *= real(1.0)/num_face_nodes;
+      vec3_t n_face(0, 0, 0);
+      for (size_t i_node = 0; i_node < num_face_nodes; i_node++) {
+        vec3_t x1 = xyzNode(nodeIndex(i_level, m_RefFacesTo2DNodes.At(i_2d, i_node)));
+        vec3_t x2 = xyzNode(nodeIndex(i_level, m_RefFacesTo2DNodes.At(i_2d, (i_node + 1)%num_face_nodes)));
+        vec3_t dx1 = x1 - x_face;
+        vec3_t dx2 = x2 - x_face;
+        n_face += real(0.5)*(dx1.cross(dx2));
+      }
+      m_LayerFaceNormals[i_2d*(m_NumLayers + 1) + i_level] = n_face;
+      m_LayerFaceCentres[i_2d*(m_NumLayers + 1) + i_level] = x_face;
+    }
+  }
+
+  // lateral faces, area vectors point from m_Face1 to m_Face2
+  m_EdgeFaceNormals.resize(m_Edges.size()*m_NumLayers);
+  m_EdgeFaceCentres.resize(m_Edges.size()*m_NumLayers);
+  for (size_t i_edge = 0; i_edge < m_Edges.size(); i_edge++) {
+    for (size_t i_layer = 0; i_layer < m_NumLayers; i_layer++) {
+      vec3_t x1 = xyzNode(nodeIndex(i_layer,     m_Edges[i_edge].m_Node1));
+      vec3_t x2 = xyzNode(nodeIndex(i_layer,     m_Edges[i_edge].m_Node2));
+      vec3_t x3 = xyzNode(nodeIndex(i_layer + 1, m_Edges[i_edge].m_Node2));
+      vec3_t x4 = xyzNode(nodeIndex(i_layer + 1, m_Edges[i_edge].m_Node1));
+      vec3_t d1 = x3 - x1;
+      vec3_t d2 = x4 - x2;
+      m_EdgeFaceNormals[i_edge*m_NumLayers + i_layer] = real(0.5)*(d1.cross(d2));
+      m_EdgeFaceCentres[i_edge*m_NumLayers + i_layer] = real(0.25)*(x1 + x2 + x3 + x4);
+    }
+  }
+
+  // cell centres (node averages) and volumes (divergence theorem)
+  m_CellCentres.assign(variableSize(), vec3_t(0, 0, 0));
+  m_CellVolumes.assign(variableSize(), 0);
+  for (size_t i_2d = 0; i_2d < num_faces; i_2d++) {
+    size_t num_face_nodes = m_RefFacesTo2DNodes.numItems(i_2d);
+    for (size_t i_layer = 0; i_layer < m_NumLayers; i_layer++) {
+      size_t l_cell = index(i_2d, i_layer);
+      vec3_t x_cell(0, 0, 0);
+      for (size_t i_node = 0; i_node < num_face_nodes; i_node++) {
+        x_cell += xyzNode(nodeIndex(i_layer,     m_RefFacesTo2DNodes.At(i_2d, i_node)));
+        x_cell += xyzNode(nodeIndex(i_layer + 1, m_RefFacesTo2DNodes.At(i_2d, i_node)));
+      }
+      m_CellCentres[l_cell] = real(0.5/num_face_nodes)*x_cell;
+      m_CellVolumes[l_cell] -= layerFaceCentre(i_2d, i_layer)*layerFaceNormal(i_2d, i_layer);
+      m_CellVolumes[l_cell] += layerFaceCentre(i_2d, i_layer + 1)*layerFaceNormal(i_2d, i_layer + 1);
+    }
+  }
+  for (size_t i_edge = 0; i_edge < m_Edges.size(); i_edge++) {
+    for (size_t i_layer = 0; i_layer < m_NumLayers; i_layer++) {
+      real flux = edgeFaceCentre(i_edge, i_layer)*edgeFaceNormal(i_edge, i_layer);
+      m_CellVolumes[index(m_Edges[i_edge].m_Face1, i_layer)] += flux;
+      if (!m_Edges[i_edge].m_Boundary) {
+        m_CellVolumes[index(m_Edges[i_edge].m_Face2, i_layer)] -= flux;
+      }
     }
   }
+  m_MinChLength = MAX_REAL;
+  for (size_t l_cell = 0; l_cell < variableSize(); l_cell++) {
+    m_CellVolumes[l_cell] /= 3;
+    if (m_CellVolumes[l_cell] <= 0) {
+      ERROR("non positive cell volume in a PrismaticLayerPatch (check orientation of reference faces)");
+    }
+    // the layer thickness is the characteristic length of the cell
+    size_t i_2d, i_layer;
+    ijk(l_cell, i_2d, i_layer);
+    real A = max(layerFaceNormal(i_2d, i_layer).abs(), layerFaceNormal(i_2d, i_layer + 1).abs());
+    m_MinChLength = min(m_MinChLength, m_CellVolumes[l_cell]/A);
+  }
 }
 
 
 void PrismaticLayerPatch::scaleRefParental(real scfactor)
 {
   Patch::scaleRefParental(scfactor);
-  BUG; // not implemented
+  for (size_t i_node = 0; i_node < m_Coords.size(); i_node++) {
+    m_Coords[i_node].m_X *= scfactor;
+    m_Coords[i_node].m_Y *= scfactor;
+    m_Coords[i_node].m_Z *= scfactor;
+  }
+  computeGeometry();
+  setupInterpolators();
 }
 
 
-void PrismaticLayerPatch::setSeekException(const size_t& i_bc,
-                                           const size_t& num_seeklayers)
+void PrismaticLayerPatch::setSeekExceptions(const size_t& num_seek_outer,
+                                            const size_t& num_seek_lateral)
 {
   m_SeekExceptions = true;
-  // set the individual protection exception for i_bc
-  BUG; // not implemented
+  m_NumSeekOuter = num_seek_outer;
+  m_NumSeekLateral = num_seek_lateral;
+}
+
+
+void PrismaticLayerPatch::buildRegions()
+{
+  // Seek zone: outer layers and face rings on the lateral boundary of the reference surface.
+  // The reference surface itself is a wall and never seeks. See also isSeekCell and isDonorCell.
+  if (!m_SeekExceptions) { // no seek exception on whole patch
+    m_NumSeekOuter = m_NumSeekLayers;
+    m_NumSeekLateral = m_NumSeekLayers;
+  } else {
+    // nothing to do: individual seek boundaries have been set on patch reading
+  }
+  if (m_NumSeekOuter > m_NumLayers) {
+    ERROR("more seek layers than cell layers in a PrismaticLayerPatch");
+  }
 }
 
 
 void PrismaticLayerPatch::buildBoundingBox()
 {
-  // go through all nodes to find limita upon coordinates
-  BUG; // not implemented
+  // go through all nodes to find limits upon coordinates
+  vec3_t xyzo_node = m_TransformInertial2This.transformReverse(xyzNode(0));
+  m_BBoxXYZoMin = xyzo_node;
+  m_BBoxXYZoMax = xyzo_node;
+  for (size_t i_node = 1; i_node < m_Coords.size(); i_node++) {
+    xyzo_node = m_TransformInertial2This.transformReverse(xyzNode(i_node));
+    m_BBoxXYZoMin.minimisePerCoord(xyzo_node);
+    m_BBoxXYZoMax.maximisePerCoord(xyzo_node);
+  }
+  m_BBoxOk = true;
 }
 
 
-void PrismaticLayerPatch::extractReceiveCells()
+void PrismaticLayerPatch::cellBoundingBox(const size_t& l_cell, vec3_t& xyz_min, vec3_t& xyz_max)
 {
-  BUG; // not implemented
+  size_t i_2d, i_layer;
+  ijk(l_cell, i_2d, i_layer);
+  xyz_min = xyzNode(nodeIndex(i_layer, m_RefFacesTo2DNodes.At(i_2d, 0)));
+  xyz_max = xyz_min;
+  for (size_t i_node = 0; i_node < m_RefFacesTo2DNodes.numItems(i_2d); i_node++) {
+    for (size_t i_level = i_layer; i_level <= i_layer + 1; i_level++) {
+      vec3_t xyz_node = xyzNode(nodeIndex(i_level, m_RefFacesTo2DNodes.At(i_2d, i_node)));
+      xyz_min.minimisePerCoord(xyz_node);
+      xyz_max.maximisePerCoord(xyz_node);
+    }
+  }
+}
+
+
+bool PrismaticLayerPatch::isInsideCell(const size_t& l_cell, const vec3_t& xyz)
+{
+  size_t i_2d, i_layer;
+  ijk(l_cell, i_2d, i_layer);
+  real tol = m_Eps*pow(m_CellVolumes[l_cell], real(1.0/3.0));
+  // signed distances to all faces of the cell, using outward normals
+  vec3_t n = real(-1)*layerFaceNormal(i_2d, i_layer);
+  if ((xyz - layerFaceCentre(i_2d, i_layer))*n > tol*n.abs()) {
+    return false;
+  }
+  n = layerFaceNormal(i_2d, i_layer + 1);
+  if ((xyz - layerFaceCentre(i_2d, i_layer + 1))*n > tol*n.abs()) {
+    return false;
+  }
+  for (size_t i = 0; i < m_FaceEdges.numItems(i_2d); i++) {
+    size_t i_edge = m_FaceEdges.At(i_2d, i);
+    n = edgeFaceNormal(i_edge, i_layer);
+    if (m_Edges[i_edge].m_Face1 != i_2d) {
+      n *= real(-1);
+    }
+    if ((xyz - edgeFaceCentre(i_edge, i_layer))*n > tol*n.abs()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void PrismaticLayerPatch::extractSeekCells()
+{
+  for (size_t l_cell = 0; l_cell < variableSize(); l_cell++) {
+    if (isSeekCell(l_cell)) {
+      m_ReceiveCells.push_back(l_cell);
+    }
+  }
+
+  // Eliminate duplicates from m_ReceiveCells
+  compactReceiveCellLists();
+  m_receiveCells_OK = true;
 }
 
 
 bool PrismaticLayerPatch::computeDependencies(const size_t& i_neighbour)
 {
-  BUG; // not implemented
+  bool found_dependency = false;
+  Patch* neighbour_patch = m_neighbours[i_neighbour].first;
+  CoordTransformVV trans = m_neighbours[i_neighbour].second;
+  // Process all receiving cells and get interpolation sets
+  //  - get own coeffs
+  //  - transform into system of neighbour patch
+  //  - interpolate there if receiving cell hits neighbours core region
+  for(size_t ll_rc=0; ll_rc < m_ReceiveCells.size(); ll_rc++) {
+    size_t l_rc = m_ReceiveCells[ll_rc];
+    vec3_t xyz_rc = xyzCell(l_rc);
+    vec3_t xxyyzz_rc = trans.transform(xyz_rc);
+    WeightedSet<real> w_set;
+    if(m_InterpolateData) {
+      if(neighbour_patch->computeCCDataInterpolCoeffs_V1(xxyyzz_rc[0], xxyyzz_rc[1], xxyyzz_rc[2],
+                                                         w_set)) {
+        m_InterCoeffData_WS[i_neighbour].push(ll_rc, l_rc, w_set);  // note: since l_rc are unique, no "add" is required
+        m_receive_cell_data_hits[ll_rc]++;
+        found_dependency = true;
+      }
+    }
+  }
+  return found_dependency;
+}
+
+
+bool PrismaticLayerPatch::checkBoxOverlap(const vec3_t& box_xyzo_min, const vec3_t& box_xyzo_max,
+                                          const bool& only_core)
+{
+  for (size_t l_cell = 0; l_cell < variableSize(); l_cell++) {
+    if (!only_core || !isSeekCell(l_cell)) {
+      vec3_t xyzo_cell = m_TransformInertial2This.transformReverse(m_CellCentres[l_cell]);
+      if (box_xyzo_min[0] <= xyzo_cell[0] &&
+          box_xyzo_min[1] <= xyzo_cell[1] &&
+          box_xyzo_min[2] <= xyzo_cell[2] &&
+          box_xyzo_max[0] >= xyzo_cell[0] &&
+          box_xyzo_max[1] >= xyzo_cell[1] &&
+          box_xyzo_max[2] >= xyzo_cell[2] ) {
+        return true;
+      }
+    }
+  }
+  return false;
 }
 
 
 void PrismaticLayerPatch::setupInterpolators()
 {
-  // nothing to be done here (??)
-  BUG; // not implemented
+  // Hash raster of all donor cells. A donor cell is inserted into all raster boxes
+  // covered by its bounding box, same as patches in PatchGrid::computeDependencies.
+  m_InterpolatorsOK = false;
+  vec3_t xyz_min(MAX_REAL, MAX_REAL, MAX_REAL);
+  vec3_t xyz_max(-MAX_REAL, -MAX_REAL, -MAX_REAL);
+  size_t num_donors = 0;
+  for (size_t l_cell = 0; l_cell < variableSize(); l_cell++) {
+    if (isDonorCell(l_cell)) {
+      vec3_t xyz_cell_min, xyz_cell_max;
+      cellBoundingBox(l_cell, xyz_cell_min, xyz_cell_max);
+      xyz_min.minimisePerCoord(xyz_cell_min);
+      xyz_max.maximisePerCoord(xyz_cell_max);
+      ++num_donors;
+    }
+  }
+  if (num_donors == 0) {
+    return;
+  }
+  //.. avoid flat raster directions
+  real pad = m_Eps*(xyz_max - xyz_min).abs();
+  xyz_min -= vec3_t(pad, pad, pad);
+  xyz_max += vec3_t(pad, pad, pad);
+  //.. approx. same deltas in x, y, z and about one donor cell per raster box
+  vec3_t delta_xyz = xyz_max - xyz_min;
+  real delta_resolve = pow(real(num_donors) / (delta_xyz[0] * delta_xyz[1] * delta_xyz[2]), real(1.0/3.0));
+  size_t i_np = max(size_t(1), size_t(delta_resolve * delta_xyz[0]));
+  size_t j_np = max(size_t(1), size_t(delta_resolve * delta_xyz[1]));
+  size_t k_np = max(size_t(1), size_t(delta_resolve * delta_xyz[2]));
+  m_HashRaster.setUp(xyz_min[0], xyz_min[1], xyz_min[2],
+                     xyz_max[0], xyz_max[1], xyz_max[2],
+                     i_np, j_np, k_np);
+  CoordTransformVV* trans = m_HashRaster.getTransformI2T();
+  for (size_t l_cell = 0; l_cell < variableSize(); l_cell++) {
+    if (isDonorCell(l_cell)) {
+      vec3_t xyz_cell_min, xyz_cell_max;
+      cellBoundingBox(l_cell, xyz_cell_min, xyz_cell_max);
+      xyz_cell_min = trans->transform(xyz_cell_min);
+      xyz_cell_max = trans->transform(xyz_cell_max);
+      size_t ic_min, jc_min, kc_min;
+      size_t ic_max, jc_max, kc_max;
+      bool inside_min = m_HashRaster.xyzToRefNode(xyz_cell_min[0], xyz_cell_min[1], xyz_cell_min[2],
+                                                  ic_min, jc_min, kc_min);
+      bool inside_max = m_HashRaster.xyzToRefNode(xyz_cell_max[0], xyz_cell_max[1], xyz_cell_max[2],
+                                                  ic_max, jc_max, kc_max);
+      if (!inside_min || !inside_max) {
+        BUG;
+      }
+      for (size_t ic_r = ic_min; ic_r <= ic_max; ic_r++) {
+        for (size_t jc_r = jc_min; jc_r <= jc_max; jc_r++) {
+          for (size_t kc_r = kc_min; kc_r <= kc_max; kc_r++) {
+            m_HashRaster.insert(ic_r, jc_r, kc_r, l_cell);
+          }
+        }
+      }
+    }
+  }
+  m_InterpolatorsOK = true;
 }
 
 
 bool PrismaticLayerPatch::computeCCDataInterpolCoeffs(real x, real y, real z,
                                                       WeightedSet<real>& w_set)
 {
-  BUG; // not implemented
+  if (!m_InterpolatorsOK) {
+    return false;
+  }
+
+  // find the donor cell containing (x, y, z)
+  vec3_t xyz(x, y, z);
+  vec3_t xyz_raster = m_HashRaster.getTransformI2T()->transform(xyz);
+  size_t ic, jc, kc;
+  if (!m_HashRaster.xyzToRefNode(xyz_raster[0], xyz_raster[1], xyz_raster[2], ic, jc, kc)) {
+    return false;
+  }
+  bool found = false;
+  size_t l_donor = 0;
+  for (size_t ll = 0; ll < m_HashRaster.getNumItems(ic, jc, kc); ll++) {
+    size_t l_cell = m_HashRaster.at(ic, jc, kc, ll);
+    if (isInsideCell(l_cell, xyz)) {
+      l_donor = l_cell;
+      found = true;
+      break;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  // stencil: the containing cell and its donor face neighbours
+  w_set.clearWS();
+  real h = pow(m_CellVolumes[l_donor], real(1.0/3.0));
+  if ((xyz - m_CellCentres[l_donor]).abs2() < sqr(m_Eps*h)) {
+    w_set.pushBack(l_donor, 1.);
+    return true;
+  }
+  vector<size_t> neighbours;
+  cellOverFaceNeighbours(l_donor, neighbours);
+  vector<size_t> stencil(1, l_donor);
+  for (size_t i = 0; i < neighbours.size(); i++) {
+    if (isDonorCell(neighbours[i])) {
+      stencil.push_back(neighbours[i]);
+    }
+  }
+
+  // Weighted least squares fit of a linear function on the stencil, which reproduces linear
+  // fields exactly. Coordinates are scaled per direction, as cells are very flat close to the wall.
+  vector<dvec4_t> a(stencil.size());
+  vector<double> omega(stencil.size());
+  dvec3_t scale(0, 0, 0);
+  for (size_t i = 0; i < stencil.size(); i++) {
+    vec3_t dx = m_CellCentres[stencil[i]] - m_CellCentres[l_donor];
+    vec3_t dx_p = m_CellCentres[stencil[i]] - xyz;
+    omega[i] = 1.0/(dx_p.abs2() + sqr(m_Eps*h));
+    for (size_t i_dim = 0; i_dim < 3; i_dim++) {
+      scale[i_dim] = max(scale[i_dim], double(fabs(dx[i_dim])));
+      a[i][i_dim + 1] = dx[i_dim];
+    }
+    a[i][0] = 1;
+  }
+  dvec4_t a_p;
+  a_p[0] = 1;
+  for (size_t i_dim = 0; i_dim < 3; i_dim++) {
+    a_p[i_dim + 1] = xyz[i_dim] - m_CellCentres[l_donor][i_dim];
+  }
+  double omega_max = *max_element(omega.begin(), omega.end());
+  SmallSquareMatrix<double, 4> M;
+  M.initAll(0);
+  bool degenerate = false;
+  for (size_t i_dim = 0; i_dim < 3; i_dim++) {
+    if (scale[i_dim] <= 0) {
+      degenerate = true;
+      scale[i_dim] = 1;
+    }
+    a_p[i_dim + 1] /= scale[i_dim];
+  }
+  for (size_t i = 0; i < stencil.size(); i++) {
+    omega[i] /= omega_max;
+    for (size_t i_dim = 0; i_dim < 3; i_dim++) {
+      a[i][i_dim + 1] /= scale[i_dim];
+    }
+    for (size_t row = 0; row < 4; row++) {
+      for (size_t col = 0; col < 4; col++) {
+        M[row][col] += omega[i]*a[i][row]*a[i][col];
+      }
+    }
+  }
+  if (!degenerate && fabs(M.det()) > 1e-8) {
+    dvec4_t b = M.inverse()*a_p;
+    for (size_t i = 0; i < stencil.size(); i++) {
+      w_set.pushBack(stencil[i], omega[i]*(b*a[i]));
+    }
+  } else {
+    // degenerate stencil: inverse distance weights
+    for (size_t i = 0; i < stencil.size(); i++) {
+      w_set.pushBack(stencil[i], omega[i]);
+    }
+  }
+  w_set.MultScalar(1./w_set.WeightSum());
+  //.. Eliminate round of contributors with below eps-weight
+  w_set.EliminateBelowEps(10*m_Eps, false, false);
+  //.. Ensure sum of weights to be 1. to correct eps-errors
+  w_set.adjustWeightSumShift(1.);
+  return true;
+}
+
+
+bool PrismaticLayerPatch::computeCCDataInterpolCoeffs_V1(real x, real y, real z,
+                                                         WeightedSet<real>& w_set)
+{
+  return computeCCDataInterpolCoeffs(x, y, z, w_set);
 }
 
+
 bool PrismaticLayerPatch::computeCCGrad1NInterpolCoeffs(real x, real y, real z,
                                                         real nx, real ny, real nz,
                                                         WeightedSet<real>& d_dn)
 {
-  BUG; // not implemented
+  // central difference of data interpolations over the smallest characteristic length
+  vec3_t n(nx, ny, nz);
+  n.normalise();
+  real h = m_MinChLength;
+  vec3_t xyz_p = vec3_t(x, y, z) + real(0.5)*h*n;
+  vec3_t xyz_m = vec3_t(x, y, z) - real(0.5)*h*n;
+  WeightedSet<real> w_p, w_m;
+  if (!computeCCDataInterpolCoeffs(xyz_p[0], xyz_p[1], xyz_p[2], w_p) ||
+      !computeCCDataInterpolCoeffs(xyz_m[0], xyz_m[1], xyz_m[2], w_m)) {
+    return false;
+  }
+  d_dn.clearWS();
+  for (size_t ll = 0; ll < w_p.getSize(); ll++) {
+    d_dn.pushBack(w_p.getIndex(ll), w_p.getWeight(ll)/h);
+  }
+  for (size_t ll = 0; ll < w_m.getSize(); ll++) {
+    d_dn.pushBack(w_m.getIndex(ll), -w_m.getWeight(ll)/h);
+  }
+  d_dn.Unify();
+  return true;
+}
+
+
+void PrismaticLayerPatch::xyzCell(const size_t& l_cell,
+                                  real& x_cell, real& y_cell, real& z_cell)
+{
+  x_cell = m_CellCentres[l_cell][0];
+  y_cell = m_CellCentres[l_cell][1];
+  z_cell = m_CellCentres[l_cell][2];
+}
+
+
+real PrismaticLayerPatch::computeMinChLength()
+{
+  return m_MinChLength;
+}
+
+
+void PrismaticLayerPatch::cellOverFaceNeighbours(const size_t& l_cell,
+                                                 vector<size_t>& l_cell_neighbours)
+{
+  size_t i_2d, i_layer;
+  ijk(l_cell, i_2d, i_layer);
+  l_cell_neighbours.clear();
+  // same k-line
+  if (i_layer > 0) {
+    l_cell_neighbours.push_back(l_cell - 1);
+  }
+  if (i_layer + 1 < m_NumLayers) {
+    l_cell_neighbours.push_back(l_cell + 1);
+  }
+  // same layer
+  for (size_t i = 0; i < m_FaceEdges.numItems(i_2d); i++) {
+    const PrismEdge& edge = m_Edges[m_FaceEdges.At(i_2d, i)];
+    if (!edge.m_Boundary) {
+      size_t i_2d_neigh = edge.m_Face1 == i_2d ? edge.m_Face2 : edge.m_Face1;
+      l_cell_neighbours.push_back(index(i_2d_neigh, i_layer));
+    }
+  }
+}
+
+
+void PrismaticLayerPatch::cellOverNodeNeighbours(const size_t& l_cell,
+                                                 vector<size_t>& l_cell_neighbours)
+{
+  size_t i_2d, i_layer;
+  ijk(l_cell, i_2d, i_layer);
+  vector<size_t> faces;
+  for (size_t i_node = 0; i_node < m_RefFacesTo2DNodes.numItems(i_2d); i_node++) {
+    size_t node = m_RefFacesTo2DNodes.At(i_2d, i_node);
+    for (size_t i = 0; i < m_NodeFaces.numItems(node); i++) {
+      faces.push_back(m_NodeFaces.At(node, i));
+    }
+  }
+  sort(faces.begin(), faces.end());
+  faces.erase(unique(faces.begin(), faces.end()), faces.end());
+  l_cell_neighbours.clear();
+  size_t layer_first = i_layer > 0 ? i_layer - 1 : 0;
+  size_t layer_last  = min(i_layer + 1, m_NumLayers - 1);
+  for (size_t i = 0; i < faces.size(); i++) {
+    for (size_t i_layer_neigh = layer_first; i_layer_neigh <= layer_last; i_layer_neigh++) {
+      size_t l_neigh = index(faces[i], i_layer_neigh);
+      if (l_neigh != l_cell) {
+        l_cell_neighbours.push_back(l_neigh);
+      }
+    }
+  }
 }
 
+
+void PrismaticLayerPatch::computeNablaVar(const size_t& field_index, const size_t& var_index, const size_t& l_cell,
+                                          real& dvar_dx, real& dvar_dy, real& dvar_dz)
+{
+  // weighted least squares on face neighbours
+  real* var = getVariable(field_index, var_index);
+  vector<size_t> neighbours;
+  cellOverFaceNeighbours(l_cell, neighbours);
+  mat3_t M;
+  M.initAll(0);
+  vec3_t b(0, 0, 0);
+  for (size_t i = 0; i < neighbours.size(); i++) {
+    vec3_t dx = m_CellCentres[neighbours[i]] - m_CellCentres[l_cell];
+    real w = 1.0/dx.abs2();
+    for (size_t i_dim = 0; i_dim < 3; i_dim++) {
+      for (size_t j_dim = 0; j_dim < 3; j_dim++) {
+        M[i_dim][j_dim] += w*dx[i_dim]*dx[j_dim];
+      }
+    }
+    b += w*(var[neighbours[i]] - var[l_cell])*dx;
+  }
+  vec3_t grad = M.inverse()*b;
+  dvar_dx = grad[0];
+  dvar_dy = grad[1];
+  dvar_dz = grad[2];
+}
+
+
+list<size_t> PrismaticLayerPatch::getNeighbours(size_t idx)
+{
+  vector<size_t> neighbours;
+  cellOverFaceNeighbours(idx, neighbours);
+  return list<size_t>(neighbours.begin(), neighbours.end());
+}
+
+
+#ifdef WITH_VTK
+vtkSmartPointer<vtkUnstructuredGrid> PrismaticLayerPatch::createVtkGrid(const vector<size_t>& cells)
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+
+  // nodes in use
+  vector<int> n2n(m_Coords.size(), -1);
+  size_t num_nodes = 0;
+  for (size_t i = 0; i < cells.size(); ++i) {
+    size_t i_2d, i_layer;
+    ijk(cells[i], i_2d, i_layer);
+    for (size_t i_node = 0; i_node < m_RefFacesTo2DNodes.numItems(i_2d); ++i_node) {
+      for (size_t i_level = i_layer; i_level <= i_layer + 1; ++i_level) {
+        size_t id_node = nodeIndex(i_level, m_RefFacesTo2DNodes.At(i_2d, i_node));
+        if (n2n[id_node] == -1) {
+          n2n[id_node] = num_nodes;
+          ++num_nodes;
+        }
+      }
+    }
+  }
+  points->SetNumberOfPoints(num_nodes);
+  for (size_t id_node = 0; id_node < m_Coords.size(); ++id_node) {
+    if (n2n[id_node] != -1) {
+      vec3_t xyzo_node = m_TransformInertial2This.transformReverse(xyzNode(id_node));
+      points->SetPoint(n2n[id_node], xyzo_node.data());
+    }
+  }
+  grid->SetPoints(points);
+
+  // cells: wedges, hexahedra and general polyhedra
+  grid->Allocate(cells.size());
+  for (size_t i = 0; i < cells.size(); ++i) {
+    size_t i_2d, i_layer;
+    ijk(cells[i], i_2d, i_layer);
+    size_t num_face_nodes = m_RefFacesTo2DNodes.numItems(i_2d);
+    vector<vtkIdType> bottom(num_face_nodes);
+    vector<vtkIdType> top(num_face_nodes);
+    for (size_t i_node = 0; i_node < num_face_nodes; ++i_node) {
+      bottom[i_node] = n2n[nodeIndex(i_layer,     m_RefFacesTo2DNodes.At(i_2d, i_node))];
+      top[i_node]    = n2n[nodeIndex(i_layer + 1, m_RefFacesTo2DNodes.At(i_2d, i_node))];
+    }
+    if (num_face_nodes == 3) {
+      // VTK expects the normal of the base triangle to point away from the top triangle
+      vtkIdType pts[6] = {bottom[0], bottom[2], bottom[1], top[0], top[2], top[1]};
+      grid->InsertNextCell(VTK_WEDGE, 6, pts);
+    } else if (num_face_nodes == 4) {
+      vtkIdType pts[8] = {bottom[0], bottom[1], bottom[2], bottom[3], top[0], top[1], top[2], top[3]};
+      grid->InsertNextCell(VTK_HEXAHEDRON, 8, pts);
+    } else {
+      vector<vtkIdType> pts(bottom);
+      pts.insert(pts.end(), top.begin(), top.end());
+      vector<vtkIdType> faces;
+      faces.push_back(num_face_nodes);
+      for (size_t i_node = 0; i_node < num_face_nodes; ++i_node) {
+        faces.push_back(bottom[num_face_nodes - 1 - i_node]);
+      }
+      faces.push_back(num_face_nodes);
+      faces.insert(faces.end(), top.begin(), top.end());
+      for (size_t i_node = 0; i_node < num_face_nodes; ++i_node) {
+        size_t i_next = (i_node + 1)%num_face_nodes;
+        faces.push_back(4);
+        faces.push_back(bottom[i_node]);
+        faces.push_back(bottom[i_next]);
+        faces.push_back(top[i_next]);
+        faces.push_back(top[i_node]);
+      }
+      grid->InsertNextCell(VTK_POLYHEDRON, pts.size(), &pts[0], num_face_nodes + 2, &faces[0]);
+    }
+  }
+  return grid;
+}
+
+
+vtkSmartPointer<vtkDataSet> PrismaticLayerPatch::createVtkDataSet(size_t i_field, const PostProcessingVariables &proc_vars)
+{
+  vector<size_t> cells;
+  for (size_t l_cell = 0; l_cell < variableSize(); ++l_cell) {
+    if (!isSeekCell(l_cell)) {
+      cells.push_back(l_cell);
+    }
+  }
+  vtkSmartPointer<vtkUnstructuredGrid> grid = createVtkGrid(cells);
+
+  real* raw_var = new real [numVariables()];
+  for (int i_var = 0; i_var < proc_vars.numScalars(); ++i_var) {
+    vtkSmartPointer<vtkFloatArray> var = vtkSmartPointer<vtkFloatArray>::New();
+    var->SetName(proc_vars.getScalarName(i_var).c_str());
+    var->SetNumberOfValues(cells.size());
+    grid->GetCellData()->AddArray(var);
+    for (size_t i = 0; i < cells.size(); ++i) {
+      getVarDim(numVariables(), i_field, cells[i], raw_var);
+      vec3_t x = xyzoCell(cells[i]);
+      var->SetValue(i, proc_vars.getScalar(i_var, raw_var, x));
+    }
+  }
+  for (int i_var = 0; i_var < proc_vars.numVectors(); ++i_var) {
+    vtkSmartPointer<vtkFloatArray> var = vtkSmartPointer<vtkFloatArray>::New();
+    var->SetName(proc_vars.getVectorName(i_var).c_str());
+    var->SetNumberOfComponents(3);
+    var->SetNumberOfTuples(cells.size());
+    grid->GetCellData()->AddArray(var);
+    for (size_t i = 0; i < cells.size(); ++i) {
+      getVarDim(numVariables(), i_field, cells[i], raw_var);
+      vec3_t x = xyzoCell(cells[i]);
+      vec3_t v = proc_vars.getVector(i_var, raw_var, x);
+      v = m_TransformInertial2This.transfreeReverse(v);
+      float vf[3];
+      vf[0] = v[0]; vf[1] = v[1]; vf[2] = v[2];
+      var->SetTuple(i, vf);
+    }
+  }
+  delete [] raw_var;
+  return grid;
+}
+
+
+vtkSmartPointer<vtkUnstructuredGrid> PrismaticLayerPatch::createVtkGridForCells(const list<size_t> &cells)
+{
+  return createVtkGrid(vector<size_t>(cells.begin(), cells.end()));
+}
+#endif
@@ -24,6 +24,7 @@
 struct Node;
 template <class T> class InsectionList;
 struct Prisms2Nodes;
+struct PrismEdge;
 struct BoundaryCode;
 class PrismaticLayerPatch;
 
@@ -33,13 +34,13 @@ class PrismaticLayerPatch;
 //#include <fstream>
 //#include <sstream>
 #include "patch.h"
+#include "vectorhashraster.h"
 
 #ifdef WITH_VTK
 #include <QString>
 #include <QVector>
 #include <vtkSmartPointer.h>
-#include <vtkRectilinearGrid.h>
-#include <vtkXMLRectilinearGridWriter.h>
+#include <vtkUnstructuredGrid.h>
 #include <vtkFloatArray.h>
 #include <vtkCellData.h>
 #endif
@@ -72,6 +73,13 @@ protected:
   vector<T> m_ItemList;
 
 public:
+  /** Get the number of entries in the first dimension.
+    *  @return the number of data sets
+    */
+  size_t size() const {
+    return m_Start.size();
+  }
+
   /** Get the number of entries in the second dimension.
     *  @param i index in first dimension
     *  @return the number of items stored for i
@@ -93,6 +101,15 @@ public:
     return m_ItemList[m_Start[i]+k];
   }
 
+  /** Data access method (read only)
+    *  @param i index in first dimension
+    *  @param k index in second dimension
+    *  @return the entry
+    */
+  T At(const size_t& i, const size_t& k) const {
+    return m_ItemList[m_Start[i]+k];
+  }
+
   /** Get the index of an entry in the item list
     *  @param i index in first dimension
     *  @param k index in second dimension
@@ -126,6 +143,23 @@ public:
     return i;
   }
 
+  /** Build from a vector of vectors, replacing all previous contents.
+    *  @param items the data sets to feed
+    */
+  void buildFrom(const vector<vector<T> >& items) {
+    clear();
+    for(size_t i = 0; i < items.size(); i++) {
+      m_Start.push_back(m_ItemList.size());
+      m_ItemList.insert(m_ItemList.end(), items[i].begin(), items[i].end());
+    }
+  }
+
+  /** Remove all data sets. */
+  void clear() {
+    m_Start.clear();
+    m_ItemList.clear();
+  }
+
   /**
     * Get a reference to m_ItemList.
     *  @return reference to m_ItemList.
@@ -135,14 +169,15 @@ public:
   }
 };
 
-/** Index sequences for nodes of prismatic cells.
+/** Node index offsets for prismatic cells. Node indices of a cell are obtained by
+  * adding the offsets to the 2D node indices of its reference face.
   */
 struct Prisms2Nodes
 {
-  /** Starting index of nodes of the bottom face of the cell.*/
+  /** Offset of the nodes of the bottom face of the cell.*/
   size_t m_StartBottom;
 
-  /** Starting index of nodes of the top face of the cell.*/
+  /** Offset of the nodes of the top face of the cell.*/
   size_t m_StartTop;
 
   /** Number of nodes forming the bottom and top face each.*/
@@ -150,6 +185,29 @@ struct Prisms2Nodes
 };
 
 
+/** Edge of the reference surface. Each edge generates one lateral face per cell layer.
+  * The node sequence m_Node1 -> m_Node2 follows the node sequence of m_Face1, so
+  * the lateral face normals point from m_Face1 towards m_Face2.
+  */
+struct PrismEdge
+{
+  /** First node of the edge (2D indexing). */
+  size_t m_Node1;
+
+  /** Second node of the edge (2D indexing). */
+  size_t m_Node2;
+
+  /** Reference face on the left side of the edge. */
+  size_t m_Face1;
+
+  /** Reference face on the right side of the edge. Only valid, if !m_Boundary. */
+  size_t m_Face2;
+
+  /** Flag indicating the edge is on the lateral boundary of the reference surface. */
+  bool m_Boundary;
+};
+
+
 /** Boundary code reference.
   * @todo all
 */
@@ -180,6 +238,21 @@ struct BoundaryCode
   *      - top face nodes of cell:    2D-node-indicees of i_2d, incremented by num_2d_nodes * (i_layer + 1)
   *        (note reversed right hand rule for faces)
   *
+  * Cells are stored in wall normal k-lines: l_cell = i_2d * num_layers + i_layer. All cells above a
+  * face of the reference surface are contiguous in memory.
+  *
+  * Regions:
+  *  - The outer m_NumSeekOuter layers and the columns within m_NumSeekLateral face rings of the lateral
+  *    boundary of the reference surface are seeking data from donor patches.
+  *  - The reference surface itself (layer 0) is a wall and never seeks.
+  *  - m_NumAddProtectLayers further layers/rings are protected (no donor access from other patches).
+  *
+  * Definition as read from the patch grid file (patch type 1010), following the general patch data:
+  *  - num_layers num_2d_nodes num_2d_faces
+  *  - num_seek_outer num_seek_lateral (seek layers on the outer side and face rings on the lateral boundary)
+  *  - num_2d_faces reference faces: num_face_nodes node_0 ... node_(num_face_nodes-1)
+  *  - (num_layers + 1) * num_2d_nodes node coordinates x y z, layer by layer
+  *  - solver codes
   */
 class PrismaticLayerPatch : public Patch
 {
@@ -196,11 +269,62 @@ protected: // attributes
   /** Coordinates of all nodes (3D indexing). */
   vector<Node> m_Coords;
 
-  /** Max Index in 2D-nodes. I.g. equal to total number of nodes per 2D layer. */
-  size_t m_Max2DNodeIndex;
+  /** Number of nodes per 2D layer. */
+  size_t m_Num2DNodes;
 
   /** Flag to mark m_Num2DNodes as being available. */
-  bool m_Max2DNodeIndexOK;
+  bool m_Num2DNodesOK;
+
+  /** Number of cell layers. */
+  size_t m_NumLayers;
+
+  /** Number of seeking cell layers on the outer side of the patch. */
+  size_t m_NumSeekOuter;
+
+  /** Number of seeking face rings on the lateral boundary of the reference surface. */
+  size_t m_NumSeekLateral;
+
+  /** Edges of the reference surface, sorted by groups (see m_EdgeGroupLimits). */
+  vector<PrismEdge> m_Edges;
+
+  /** Edge group limits. The edges of a group do not share a reference face. */
+  vector<size_t> m_EdgeGroupLimits;
+
+  /** Edges of the reference faces. */
+  InsectionList<size_t> m_FaceEdges;
+
+  /** Reference faces sharing a node (2D indexing). */
+  InsectionList<size_t> m_NodeFaces;
+
+  /** Distance of reference faces to the lateral boundary in face rings. */
+  vector<size_t> m_LateralRing;
+
+  /** Cell centres. */
+  vector<vec3_t> m_CellCentres;
+
+  /** Cell volumes. */
+  vector<real> m_CellVolumes;
+
+  /** Area vectors of the layer faces, (num_layers + 1) per reference face, pointing towards higher layers. */
+  vector<vec3_t> m_LayerFaceNormals;
+
+  /** Centres of the layer faces, indexing as m_LayerFaceNormals. */
+  vector<vec3_t> m_LayerFaceCentres;
+
+  /** Area vectors of the lateral faces, num_layers per edge, pointing from PrismEdge::m_Face1 to PrismEdge::m_Face2. */
+  vector<vec3_t> m_EdgeFaceNormals;
+
+  /** Centres of the lateral faces, indexing as m_EdgeFaceNormals. */
+  vector<vec3_t> m_EdgeFaceCentres;
+
+  /** Smallest layer thickness. */
+  real m_MinChLength;
+
+  /** Hash raster of donor cells for interpolation requests of other patches. */
+  VectorHashRaster<size_t> m_HashRaster;
+
+  /** Flag indicating m_HashRaster has been set up. */
+  bool m_InterpolatorsOK;
 
   /** Boundary condition reference on patch. */
   vector<BoundaryCode> m_BC;
@@ -210,8 +334,43 @@ protected: // attributes
 
 protected: // methods
 
-  virtual void extractReceiveCells();
   virtual void buildBoundingBox();
+  virtual void buildRegions();
+
+  /**
+    * Build edges, edge groups and neighbourship lists of the reference surface.
+    */
+  void buildTopology();
+
+  /**
+    * Compute cell centres, volumes and face area vectors.
+    */
+  void computeGeometry();
+
+  /**
+    * Check, if a point is inside a cell (convex cell approximation).
+    * @param l_cell the cell index
+    * @param xyz the point in the coords of this patch
+    * @return true, if xyz is inside l_cell
+    */
+  bool isInsideCell(const size_t& l_cell, const vec3_t& xyz);
+
+  /**
+    * Compute the bounding box of a cell in the coords of this patch.
+    * @param l_cell the cell index
+    * @param xyz_min lowest coordinates (return reference)
+    * @param xyz_max highest coordinates (return reference)
+    */
+  void cellBoundingBox(const size_t& l_cell, vec3_t& xyz_min, vec3_t& xyz_max);
+
+#ifdef WITH_VTK
+  /**
+    * Create an unstructured VTK grid (inertial coords) for a set of cells.
+    * @param cells the cells to include
+    * @return the grid
+    */
+  vtkSmartPointer<vtkUnstructuredGrid> createVtkGrid(const vector<size_t>& cells);
+#endif
 
 public: // methods
 
@@ -226,24 +385,17 @@ public: // methods
 
   /**
     * Read mesh data from file
-    * @param s_mesh the stream to read from
+    * @param iss_input the stream to read from
+    * @param scale scaling factor for coordinates
     * @return true, if successful
     */
-  virtual bool readFromFile(istringstream& iss_input);
-
-
-  /**
-    * Write mesh data to file
-    * @param s_mesh the stream to write to
-    * @return true, if successful
-    */
-  virtual bool writeToFile(ifstream& s_mesh);
+  virtual bool readFromFile(istringstream& iss_input, real scale = 1.0);
 
 
   /**
     * Compute number of nodes in 2D layer.
     */
-  void findMax2DNodeIndex();
+  void findNum2DNodes();
 
 
   /**
@@ -256,12 +408,18 @@ public: // methods
 
 
   /**
-    * Set a single seek exception on a boundary identified by a bcode
-    * @param i_bc the boundary code for which to set the exception
-    * @param num_seeklayers number of seek layer to set for i_bc
+    * Set individual seek layers for the outer and the lateral boundaries.
+    * @param num_seek_outer number of seeking cell layers on the outer side
+    * @param num_seek_lateral number of seeking face rings on the lateral boundary
+    */
+  void setSeekExceptions(const size_t& num_seek_outer,
+                         const size_t& num_seek_lateral);
+
+
+  /**
+    * Extract set of data seeking cells on the outer and lateral boundaries of the patch.
     */
-  void setSeekException(const size_t& i_bc,
-                        const size_t& num_seeklayers);
+  virtual void extractSeekCells();
 
 
   /**
@@ -283,13 +441,13 @@ public: // methods
 
   /**
    * Set up interpolation methods for giving data to foreign patches.
-   * Example: Build up Split- or Octrees for search operations, etc ... depending on patch type.
-   * @param num_protection number of overlap cell layers in which no data access is permissible.
+   * Builds a hash raster of all donor cells.
    */
   virtual void setupInterpolators();
 
   /**
-   * Get data interpolation coeff-sets.
+   * Get data interpolation coeff-sets. Weights result from a weighted linear least squares
+   * fit on the containing cell and its donor face neighbours.
    * @param x the x-value in the coords of the present patch
    * @param y the y-value in the coords of the present patch
    * @param z the z-value in the coords of the present patch
@@ -299,6 +457,9 @@ public: // methods
   virtual bool computeCCDataInterpolCoeffs(real x, real y, real z,
                                            WeightedSet<real>& w_set);
 
+  virtual bool computeCCDataInterpolCoeffs_V1(real x, real y, real z,
+                                              WeightedSet<real>& w_set);
+
   /**
    * Get directional derivative (grad*n) interpolation coeff-sets.
    * @param x the x-value in the coords of the present patch
@@ -314,94 +475,118 @@ public: // methods
 					     real nx, real ny, real nz,
                                              WeightedSet<real>& w_set);
 
+  /**
+    * Check overlap with a box defined in xyzo.
+    * @param box_xyzo_min lower coords of box
+    * @param box_xyzo_min upper coords of box
+    * @param only_core indicates to analise only core region of patch
+    * @return true, if overlap exists
+    */
+  virtual bool checkBoxOverlap(const vec3_t& box_xyzo_min, const vec3_t& box_xyzo_max,
+                               const bool& only_core = true);
+
+  virtual void xyzCell(const size_t& l_cell,
+                       real& x_cell, real& y_cell, real& z_cell);
+
+  vec3_t xyzCell(const size_t& l_cell) const { return m_CellCentres[l_cell]; }
+
+  /** Compute ...
+    * @return smallest characteristic length (smallest layer thickness).
+    */
+  virtual real computeMinChLength();
+
+  virtual void cellOverFaceNeighbours(const size_t& l_c,
+                                      vector<size_t>& l_cell_neighbours);
+
+  virtual void cellOverNodeNeighbours(const size_t& l_c,
+                                      vector<size_t>& l_cell_neighbours);
 
+  /**
+    * Compute gradients (least squares over face neighbours). Attention: slow, not intended
+    * for use in numerical core modules.
+    * @param m_FieldIndex
+    * @param m_VarIndex
+    * @param l_cell 1D-cell-index in patch
+    * @param dvar_dx x-coord of gradient
+    * @param dvar_dy y-coord of gradient
+    * @param dvar_dz z-coord of gradient
+    */
+  virtual void computeNablaVar(const size_t& field_index, const size_t& var_index, const size_t& l_cell,
+                               real& dvar_dx, real& dvar_dy, real& dvar_dz);
+
+  virtual list<size_t> getNeighbours(size_t idx);
 
 #ifdef WITH_VTK
-  template <typename TVariables> void writeToVtk(size_t i_field, QString file_name, const TVariables& variables);
+  virtual vtkSmartPointer<vtkDataSet> createVtkDataSet(size_t i_field, const PostProcessingVariables& proc_vars);
+  virtual vtkSmartPointer<vtkUnstructuredGrid> createVtkGridForCells(const list<size_t> &cells);
 #endif
 
+  size_t numLayers() const { return m_NumLayers; }
+  size_t num2DFaces() const { return m_RefFacesTo2DNodes.size(); }
+  size_t num2DNodes() const { return m_Num2DNodes; }
+  size_t numEdges() const { return m_Edges.size(); }
+  size_t numEdgeGroups() const { return max(size_t(1), m_EdgeGroupLimits.size()) - 1; }
+  size_t getEdgeGroupLimit(size_t i) const { return m_EdgeGroupLimits[i]; }
+  const PrismEdge& getEdge(size_t i_edge) const { return m_Edges[i_edge]; }
+
+  size_t index(size_t i_2d, size_t i_layer) const { return i_2d*m_NumLayers + i_layer; }
+  void   ijk(size_t l_cell, size_t& i_2d, size_t& i_layer) const { i_2d = l_cell/m_NumLayers; i_layer = l_cell%m_NumLayers; }
+  size_t nodeIndex(size_t i_level, size_t i_node_2d) const { return i_level*m_Num2DNodes + i_node_2d; }
+  vec3_t xyzNode(size_t i_node) const { return vec3_t(m_Coords[i_node].m_X, m_Coords[i_node].m_Y, m_Coords[i_node].m_Z); }
+
+  real   cellVolume(size_t l_cell) const { return m_CellVolumes[l_cell]; }
+  vec3_t layerFaceNormal(size_t i_2d, size_t i_level) const { return m_LayerFaceNormals[i_2d*(m_NumLayers + 1) + i_level]; }
+  vec3_t layerFaceCentre(size_t i_2d, size_t i_level) const { return m_LayerFaceCentres[i_2d*(m_NumLayers + 1) + i_level]; }
+  vec3_t edgeFaceNormal(size_t i_edge, size_t i_layer) const { return m_EdgeFaceNormals[i_edge*m_NumLayers + i_layer]; }
+  vec3_t edgeFaceCentre(size_t i_edge, size_t i_layer) const { return m_EdgeFaceCentres[i_edge*m_NumLayers + i_layer]; }
+
+  /**
+    * Check, if a cell seeks data from donor patches.
+    * @param l_cell the cell index
+    * @return true, if l_cell is in the seek zone
+    */
+  bool isSeekCell(size_t l_cell) const;
+
+  /**
+    * Check, if a cell may serve as a donor for other patches.
+    * @param l_cell the cell index
+    * @return true, if l_cell is outside the protection zone
+    */
+  bool isDonorCell(size_t l_cell) const;
+
 };
 
 
 void PrismaticLayerPatch::prisms2Nodes(const size_t& i_layer, const size_t& i_2d,
                                        Prisms2Nodes& nodes_3D)
 {
-  nodes_3D.m_StartBottom = i_layer * m_Max2DNodeIndex + m_RefFacesTo2DNodes.ItemIndex(i_2d);
-  nodes_3D.m_StartTop    = (i_layer + 1) * m_Max2DNodeIndex + m_RefFacesTo2DNodes.ItemIndex(i_2d);
+  nodes_3D.m_StartBottom = i_layer * m_Num2DNodes;
+  nodes_3D.m_StartTop    = (i_layer + 1) * m_Num2DNodes;
   nodes_3D.m_NumFaceNodes = m_RefFacesTo2DNodes.numItems(i_2d);
 }
 
 
-//#ifdef WITH_VTK
-//template <typename TVariables>
-//void PrismaticLayerPatch::writeToVtk(size_t i_field, QString file_name, const TVariables& variables)
-//{
-//  vtkSmartPointer<vtkRectilinearGrid> grid = vtkSmartPointer<vtkRectilinearGrid>::New();
-
-//  vtkSmartPointer<vtkFloatArray> xc = vtkSmartPointer<vtkFloatArray>::New();
-//  for (size_t i = 0; i < m_NumI + 1; ++i) {
-//    xc->InsertNextValue(i*dx());
-//  }
-
-//  vtkSmartPointer<vtkFloatArray> yc = vtkSmartPointer<vtkFloatArray>::New();
-//  for (size_t j = 0; j < m_NumJ + 1; ++j) {
-//    yc->InsertNextValue(j*dy());
-//  }
-
-//  vtkSmartPointer<vtkFloatArray> zc = vtkSmartPointer<vtkFloatArray>::New();
-//  for (size_t k = 0; k < m_NumK + 1; ++k) {
-//    zc->InsertNextValue(k*dz());
-//  }
-
-//  grid->SetDimensions(m_NumI + 1, m_NumJ + 1, m_NumK + 1);
-//  grid->SetXCoordinates(xc);
-//  grid->SetYCoordinates(yc);
-//  grid->SetZCoordinates(zc);
-
-//  real* raw_var = new real [numVariables()];
-//  for (int i_var = 0; i_var < variables.numScalars(); ++i_var) {
-//    vtkSmartPointer<vtkFloatArray> var = vtkSmartPointer<vtkFloatArray>::New();
-//    var->SetName(qPrintable(variables.getScalarName(i_var)));
-//    var->SetNumberOfValues(variableSize());
-//    grid->GetCellData()->AddArray(var);
-//    vtkIdType id = 0;
-//    for (size_t k = 0; k < m_NumK; ++k) {
-//      for (size_t j = 0; j < m_NumJ; ++j) {
-//        for (size_t i = 0; i < m_NumI; ++i) {
-//          getVar(i_field, i, j, k, raw_var);
-//          var->SetValue(id, variables.getScalar(i_var, raw_var));
-//          ++id;
-//        }
-//      }
-//    }
-//  }
-//  for (int i_var = 0; i_var < variables.numVectors(); ++i_var) {
-//    vtkSmartPointer<vtkFloatArray> var = vtkSmartPointer<vtkFloatArray>::New();
-//    var->SetName(qPrintable(variables.getVectorName(i_var)));
-//    var->SetNumberOfComponents(3);
-//    var->SetNumberOfTuples(variableSize());
-//    grid->GetCellData()->AddArray(var);
-//    vtkIdType id = 0;
-//    for (size_t k = 0; k < m_NumK; ++k) {
-//      for (size_t j = 0; j < m_NumJ; ++j) {
-//        for (size_t i = 0; i < m_NumI; ++i) {
-//          getVar(i_field, i, j, k, raw_var);
-//          vec3_t v = variables.getVector(i_var, raw_var);
-//          float vf[3];
-//          vf[0] = v[0]; vf[1] = v[1]; vf[2] = v[2];
-//          var->SetTuple(id, vf);
-//          ++id;
-//        }
-//      }
-//    }
-//  }
-//  delete [] raw_var;
-
-//  vtkSmartPointer<vtkXMLRectilinearGridWriter> vtr = vtkSmartPointer<vtkXMLRectilinearGridWriter>::New();
-//  vtr->SetFileName(qPrintable(file_name + ".vtr"));
-//  vtr->SetInput(grid);
-//  vtr->Write();
-//}
-//#endif
+inline bool PrismaticLayerPatch::isSeekCell(size_t l_cell) const
+{
+  size_t i_2d, i_layer;
+  ijk(l_cell, i_2d, i_layer);
+  return i_layer + m_NumSeekOuter >= m_NumLayers || m_LateralRing[i_2d] < m_NumSeekLateral;
+}
+
+
+inline bool PrismaticLayerPatch::isDonorCell(size_t l_cell) const
+{
+  size_t i_2d, i_layer;
+  ijk(l_cell, i_2d, i_layer);
+  size_t num_prot_outer = 0;
+  size_t num_prot_lateral = 0;
+  if (m_NumSeekOuter > 0) {
+    num_prot_outer = m_NumSeekOuter + m_NumAddProtectLayers;
+  }
+  if (m_NumSeekLateral > 0) {
+    num_prot_lateral = m_NumSeekLateral + m_NumAddProtectLayers;
+  }
+  return i_layer + num_prot_outer < m_NumLayers && m_LateralRing[i_2d] >= num_prot_lateral;
+}
 
 #endif // PRISMATICLAYERPATCH_H
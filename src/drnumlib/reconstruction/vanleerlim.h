@@ -21,7 +21,7 @@
 #ifndef VANLEERLIM_H
 #define VANLEERLIM_H
 
-#include "blockcfd.h"
+#include "drnum.h"
 
 struct VanLeerLim
 {
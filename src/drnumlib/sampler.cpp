@@ -0,0 +1,276 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "sampler.h"
+#include "geometrytools.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef OPEN_MP
+#include <omp.h>
+#endif
+
+Sampler::Sampler(PatchGrid* patch_grid, string file_name, size_t interval, size_t i_field)
+{
+  m_PatchGrid = patch_grid;
+  m_FileName  = file_name;
+  m_Interval  = max(size_t(1), interval);
+  m_IField    = i_field;
+  m_NumVars   = 0;
+  m_Count     = 0;
+  m_SetupDone = false;
+}
+
+void Sampler::addPoint(vec3_t xo)
+{
+  m_Points.push_back(xo);
+  m_SetupDone = false;
+}
+
+void Sampler::addLine(vec3_t xo1, vec3_t xo2, size_t num_points)
+{
+  if (num_points < 2) {
+    addPoint(xo1);
+    return;
+  }
+  for (size_t i = 0; i < num_points; ++i) {
+    real s = real(i)/real(num_points - 1);
+    addPoint(xo1 + s*(xo2 - xo1));
+  }
+}
+
+void Sampler::addPlane(vec3_t xo, vec3_t a, vec3_t b, size_t num_a, size_t num_b)
+{
+  for (size_t j = 0; j < num_b; ++j) {
+    real t = 0;
+    if (num_b > 1) {
+      t = real(j)/real(num_b - 1);
+    }
+    for (size_t i = 0; i < num_a; ++i) {
+      real s = 0;
+      if (num_a > 1) {
+        s = real(i)/real(num_a - 1);
+      }
+      addPoint(xo + s*a + t*b);
+    }
+  }
+}
+
+void Sampler::readDefinition(string file_name)
+{
+  ifstream file(file_name.c_str());
+  if (!file) {
+    ERROR("unable to open sampler definition file");
+  }
+  string line;
+  while (getline(file, line)) {
+    istringstream iss(line);
+    string key;
+    if (!(iss >> key) || key[0] == '#') {
+      continue;
+    }
+    if (key == "point") {
+      vec3_t x;
+      iss >> x[0] >> x[1] >> x[2];
+      addPoint(x);
+    } else if (key == "line") {
+      vec3_t x1, x2;
+      size_t n;
+      iss >> x1[0] >> x1[1] >> x1[2] >> x2[0] >> x2[1] >> x2[2] >> n;
+      addLine(x1, x2, n);
+    } else if (key == "plane") {
+      vec3_t x, a, b;
+      size_t na, nb;
+      iss >> x[0] >> x[1] >> x[2] >> a[0] >> a[1] >> a[2] >> b[0] >> b[1] >> b[2] >> na >> nb;
+      addPlane(x, a, b, na, nb);
+    } else {
+      cout << "unknown sampler keyword \"" << key << "\"" << endl;
+      ERROR("error in sampler definition file");
+    }
+    if (iss.fail()) {
+      cout << line << endl;
+      ERROR("error in sampler definition file");
+    }
+  }
+}
+
+bool Sampler::computeStencil(vec3_t xo, stencil_t& stencil)
+{
+  real min_length = MAX_REAL;
+  bool found = false;
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    Patch* patch = m_PatchGrid->getPatch(i_patch);
+    if (!GeometryTools::isInsideCartesianBox(xo, patch->accessBBoxXYZoMin(), patch->accessBBoxXYZoMax())) {
+      continue;
+    }
+    real length = patch->computeMinChLength();
+    if (length >= min_length) {
+      continue;
+    }
+    vec3_t x = patch->getTransformInertial2This().transform(xo);
+    WeightedSet<real> w_set;
+    if (patch->computeCCDataInterpolCoeffs_V1(x[0], x[1], x[2], w_set)) {
+      if (w_set.getSize() > 8) {
+        BUG;
+      }
+      stencil.i_patch = i_patch;
+      for (size_t i = 0; i < 8; ++i) {
+        stencil.index[i]  = 0;
+        stencil.weight[i] = 0;
+      }
+      for (size_t i = 0; i < w_set.getSize(); ++i) {
+        stencil.index[i]  = w_set.getIndex(i);
+        stencil.weight[i] = w_set.getWeight(i);
+      }
+      min_length = length;
+      found = true;
+    }
+  }
+  return found;
+}
+
+void Sampler::setup()
+{
+  if (m_PatchGrid->getNumPatches() == 0) {
+    ERROR("cannot set up a sampler on an empty grid");
+  }
+  m_NumVars = m_PatchGrid->getPatch(0)->numVariables();
+  m_Stencils.clear();
+  m_PointIndex.clear();
+
+  // resolve all points; every point is independent
+  // (bounding boxes are built beforehand, as they are created on demand)
+  m_PatchGrid->buildBoundingBox(false);
+  vector<stencil_t> stencils(m_Points.size());
+  vector<int> found(m_Points.size(), 0);
+#ifndef DEBUG
+  #pragma omp parallel for
+#endif
+  for (int i_point = 0; i_point < int(m_Points.size()); ++i_point) {
+    if (computeStencil(m_Points[i_point], stencils[i_point])) {
+      found[i_point] = 1;
+    }
+  }
+  size_t num_lost = 0;
+  for (size_t i_point = 0; i_point < m_Points.size(); ++i_point) {
+    if (found[i_point]) {
+      stencils[i_point].i_point = m_PointIndex.size();
+      m_PointIndex.push_back(i_point);
+      m_Stencils.push_back(stencils[i_point]);
+    } else {
+      ++num_lost;
+    }
+  }
+  if (num_lost > 0) {
+    cout << "Sampler \"" << m_FileName << "\": " << num_lost << " point(s) outside of the grid have been ignored" << endl;
+  }
+
+  // sort stencils by patch and address to get a cache friendly gather
+  vector<pair<pair<size_t, size_t>, size_t> > order(m_Stencils.size());
+  for (size_t i = 0; i < m_Stencils.size(); ++i) {
+    order[i].first.first  = m_Stencils[i].i_patch;
+    order[i].first.second = m_Stencils[i].index[0];
+    order[i].second = i;
+  }
+  sort(order.begin(), order.end());
+  vector<stencil_t> sorted_stencils(m_Stencils.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    sorted_stencils[i] = m_Stencils[order[i].second];
+  }
+  m_Stencils = sorted_stencils;
+  m_Buffer.resize(m_PointIndex.size()*m_NumVars);
+
+  // create the file or check the header of an existing one
+  ifstream old_file(m_FileName.c_str(), ios::binary);
+  if (old_file) {
+    char magic[8];
+    int version, num_points, num_vars;
+    old_file.read(magic, 8);
+    old_file.read((char*) &version, sizeof(int));
+    old_file.read((char*) &num_points, sizeof(int));
+    old_file.read((char*) &num_vars, sizeof(int));
+    if (!old_file || strncmp(magic, "DRNUMSMP", 8) != 0 || version != 1 ||
+        num_points != int(m_PointIndex.size()) || num_vars != int(m_NumVars)) {
+      cout << m_FileName << endl;
+      ERROR("existing sampler file does not match the sampler definition");
+    }
+  } else {
+    ofstream file(m_FileName.c_str(), ios::binary);
+    if (!file) {
+      ERROR("unable to create sampler file");
+    }
+    writeHeader(file);
+  }
+  m_SetupDone = true;
+}
+
+void Sampler::writeHeader(ofstream& file)
+{
+  int version    = 1;
+  int num_points = m_PointIndex.size();
+  int num_vars   = m_NumVars;
+  file.write("DRNUMSMP", 8);
+  file.write((const char*) &version, sizeof(int));
+  file.write((const char*) &num_points, sizeof(int));
+  file.write((const char*) &num_vars, sizeof(int));
+  for (size_t i = 0; i < m_PointIndex.size(); ++i) {
+    vec3_t xo = m_Points[m_PointIndex[i]];
+    double x[3] = {xo[0], xo[1], xo[2]};
+    file.write((const char*) x, 3*sizeof(double));
+  }
+}
+
+void Sampler::sample(real t)
+{
+  if (due()) {
+    write(t);
+  }
+  ++m_Count;
+}
+
+void Sampler::write(real t)
+{
+  if (!m_SetupDone) {
+    setup();
+  }
+  for (size_t i_stencil = 0; i_stencil < m_Stencils.size(); ++i_stencil) {
+    const stencil_t& S = m_Stencils[i_stencil];
+    Patch* patch = m_PatchGrid->getPatch(S.i_patch);
+    float* buffer = &m_Buffer[S.i_point*m_NumVars];
+    for (size_t i_var = 0; i_var < m_NumVars; ++i_var) {
+      real* var = patch->getVariable(m_IField, i_var);
+      real v = 0;
+      for (size_t i = 0; i < 8; ++i) {
+        v += S.weight[i]*var[S.index[i]];
+      }
+      buffer[i_var] = v;
+    }
+  }
+  ofstream file(m_FileName.c_str(), ios::binary | ios::app);
+  if (!file) {
+    ERROR("unable to write to sampler file");
+  }
+  double td = t;
+  file.write((const char*) &td, sizeof(double));
+  if (m_Buffer.size() > 0) {
+    file.write((const char*) &m_Buffer[0], m_Buffer.size()*sizeof(float));
+  }
+}
@@ -0,0 +1,168 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "drnum.h"
+#include "patchgrid.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * In-situ sampling of field data on points, lines and planes.
+ *
+ * All sampling points are resolved once in setup(): for every point the
+ * finest patch able to interpolate is searched and the eight donor cells
+ * and trilinear weights of computeCCDataInterpolCoeffs_V1 are stored in flat
+ * arrays, sorted by patch and cell address. A call to sample() then only
+ * gathers these stencils and appends one record to a binary time-series file.
+ *
+ * File layout (native byte order):
+ *  header: char[8] "DRNUMSMP", int version, int num_points, int num_vars,
+ *          num_points x 3 doubles (inertial coordinates of the points)
+ *  record: double t, num_points x num_vars floats
+ *
+ * If the file exists already, its header is checked and records are appended,
+ * which allows to continue a time series after a restart.
+ *
+ * @note Data are taken from the host copy of the patches. For GPU runs the
+ *       field has to be copied to the host before sample() is called.
+ */
+class Sampler
+{
+
+protected: // data types
+
+  struct stencil_t
+  {
+    size_t i_patch;
+    size_t i_point;   ///< output slot of this stencil
+    size_t index[8];
+    real   weight[8];
+  };
+
+
+protected: // attributes
+
+  PatchGrid*       m_PatchGrid;
+  size_t           m_IField;       ///< field to sample from
+  size_t           m_NumVars;      ///< number of variables per point
+  size_t           m_Interval;     ///< sample only every m_Interval calls of sample()
+  size_t           m_Count;        ///< number of calls of sample()
+  string           m_FileName;
+  vector<vec3_t>   m_Points;       ///< requested sampling points (inertial coords)
+  vector<size_t>   m_PointIndex;   ///< index in m_Points for every output slot
+  vector<stencil_t> m_Stencils;    ///< donor stencils, sorted by patch and address
+  vector<float>    m_Buffer;       ///< output buffer for one record
+  bool             m_SetupDone;
+
+
+protected: // methods
+
+  /**
+   * Find the best donor patch for a point and compute its stencil.
+   * The finest patch (smallest characteristic length) is preferred.
+   * @param xo the point in inertial coordinates
+   * @param stencil the resulting stencil (return reference)
+   * @return true, if a stencil could be found
+   */
+  bool computeStencil(vec3_t xo, stencil_t& stencil);
+
+  void writeHeader(ofstream& file);
+
+
+public: // methods
+
+  /**
+   * @param patch_grid the grid to sample
+   * @param file_name name of the time-series file
+   * @param interval sample every interval-th call of sample()
+   * @param i_field field to sample from
+   */
+  Sampler(PatchGrid* patch_grid, string file_name, size_t interval = 1, size_t i_field = 0);
+
+  /**
+   * Add a single probe.
+   * @param xo position in inertial coordinates
+   */
+  void addPoint(vec3_t xo);
+
+  /**
+   * Add a line of equidistant probes including both end points.
+   * @param xo1 start point
+   * @param xo2 end point
+   * @param num_points number of points on the line
+   */
+  void addLine(vec3_t xo1, vec3_t xo2, size_t num_points);
+
+  /**
+   * Add a plane of probes, spanned by two edge vectors.
+   * @param xo origin (corner) of the plane
+   * @param a first edge vector
+   * @param b second edge vector
+   * @param num_a number of points along a
+   * @param num_b number of points along b
+   */
+  void addPlane(vec3_t xo, vec3_t a, vec3_t b, size_t num_a, size_t num_b);
+
+  /**
+   * Read sampler definitions from a text file. Known keywords (one per line):
+   *  point x y z
+   *  line  x1 y1 z1  x2 y2 z2  n
+   *  plane x y z  ax ay az  bx by bz  na nb
+   * Lines starting with '#' are ignored.
+   * @param file_name the definition file
+   */
+  void readDefinition(string file_name);
+
+  /**
+   * Resolve donor stencils for all points. Must be called after
+   * PatchGrid::computeDependencies and before the first sample().
+   */
+  void setup();
+
+  /**
+   * Count a time step and write a record, if due.
+   * @param t the current simulation time
+   */
+  void sample(real t);
+
+  /**
+   * Write a record regardless of the sampling interval.
+   * @param t the current simulation time
+   */
+  void write(real t);
+
+  /**
+   * Check if the next call of sample() will write a record.
+   * @return true, if a record is due
+   */
+  bool due() { return m_Count % m_Interval == 0; }
+
+  size_t numPoints() { return m_PointIndex.size(); }
+
+};
+
+#endif // SAMPLER_H
@@ -0,0 +1,101 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "sparsebrickgrid.h"
+
+SparseBrickGrid::SparseBrickGrid()
+{
+  m_NumI = 0;
+  m_NumJ = 0;
+  m_NumK = 0;
+  m_NumBricksI = 0;
+  m_NumBricksJ = 0;
+  m_NumBricksK = 0;
+}
+
+void SparseBrickGrid::resize(size_t num_i, size_t num_j, size_t num_k, real background)
+{
+  m_NumI = num_i;
+  m_NumJ = num_j;
+  m_NumK = num_k;
+  m_NumBricksI = (num_i + BRICK - 1)/BRICK;
+  m_NumBricksJ = (num_j + BRICK - 1)/BRICK;
+  m_NumBricksK = (num_k + BRICK - 1)/BRICK;
+  size_t num_bricks = m_NumBricksI*m_NumBricksJ*m_NumBricksK;
+  m_BrickIndex.assign(num_bricks, -1);
+  m_TileValue.assign(num_bricks, background);
+  m_Data.clear();
+  m_FreeBricks.clear();
+}
+
+void SparseBrickGrid::allocateBrick(size_t bi, size_t bj, size_t bk)
+{
+  size_t b = brick(bi, bj, bk);
+  if (m_BrickIndex[b] >= 0) {
+    return;
+  }
+  if (m_FreeBricks.size() > 0) {
+    m_BrickIndex[b] = m_FreeBricks.back();
+    m_FreeBricks.pop_back();
+  } else {
+    m_BrickIndex[b] = m_Data.size()/BRICK3;
+    m_Data.resize(m_Data.size() + BRICK3);
+  }
+  real* data = &m_Data[m_BrickIndex[b]*BRICK3];
+  for (size_t i = 0; i < BRICK3; ++i) {
+    data[i] = m_TileValue[b];
+  }
+}
+
+void SparseBrickGrid::setTile(size_t bi, size_t bj, size_t bk, real v)
+{
+  size_t b = brick(bi, bj, bk);
+  if (m_BrickIndex[b] >= 0) {
+    m_FreeBricks.push_back(m_BrickIndex[b]);
+    m_BrickIndex[b] = -1;
+  }
+  m_TileValue[b] = v;
+}
+
+void SparseBrickGrid::prune(real limit)
+{
+  vector<real> data;
+  data.reserve(m_Data.size());
+  for (size_t b = 0; b < m_BrickIndex.size(); ++b) {
+    if (m_BrickIndex[b] >= 0) {
+      real* values = &m_Data[m_BrickIndex[b]*BRICK3];
+      real v_min = values[0];
+      for (size_t i = 1; i < BRICK3; ++i) {
+        if (fabs(values[i]) < fabs(v_min)) {
+          v_min = values[i];
+        }
+      }
+      if (fabs(v_min) >= limit) {
+        m_TileValue[b] = v_min;
+        m_BrickIndex[b] = -1;
+      } else {
+        m_BrickIndex[b] = data.size()/BRICK3;
+        data.insert(data.end(), values, values + BRICK3);
+      }
+    }
+  }
+  m_Data.swap(data);
+  m_FreeBricks.clear();
+}
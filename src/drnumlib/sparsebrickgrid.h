@@ -0,0 +1,144 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef SPARSEBRICKGRID_H
+#define SPARSEBRICKGRID_H
+
+class SparseBrickGrid;
+
+#include "drnum.h"
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Sparse storage of a scalar on a structured (i,j,k) grid.
+ *
+ * The grid is split into bricks of BRICK^3 values. Only bricks which are explicitly
+ * written are allocated; all other bricks are tiles with a single constant value.
+ * This is meant for level sets, where exact values are required in a narrow band
+ * around the surface only, while the rest of the domain just needs the correct sign.
+ *
+ * Values of a brick are stored contiguously (k fastest).
+ */
+class SparseBrickGrid
+{
+
+public: // data types
+
+  static const size_t BRICK = 8;
+  static const size_t BRICK3 = BRICK*BRICK*BRICK;
+
+
+protected: // attributes
+
+  size_t       m_NumI, m_NumJ, m_NumK;                ///< number of values in i, j and k direction
+  size_t       m_NumBricksI, m_NumBricksJ, m_NumBricksK; ///< number of bricks in i, j and k direction
+  vector<int>  m_BrickIndex;                           ///< index of allocated bricks (-1 for tiles)
+  vector<real> m_TileValue;                            ///< constant value of a brick if it is a tile
+  vector<real> m_Data;                                 ///< values of all allocated bricks
+  vector<int>  m_FreeBricks;                           ///< released storage slots in m_Data
+
+
+protected: // methods
+
+  size_t brick(size_t bi, size_t bj, size_t bk) const { return bi*m_NumBricksJ*m_NumBricksK + bj*m_NumBricksK + bk; }
+  size_t local(size_t i, size_t j, size_t k) const    { return (i%BRICK)*BRICK*BRICK + (j%BRICK)*BRICK + k%BRICK; }
+
+
+public: // methods
+
+  SparseBrickGrid();
+
+  /**
+   * Set the size of the grid. All existing bricks are removed.
+   * @param num_i number of values in i direction
+   * @param num_j number of values in j direction
+   * @param num_k number of values in k direction
+   * @param background the initial tile value of all bricks
+   */
+  void resize(size_t num_i, size_t num_j, size_t num_k, real background);
+
+  size_t sizeI() const          { return m_NumI; }
+  size_t sizeJ() const          { return m_NumJ; }
+  size_t sizeK() const          { return m_NumK; }
+  size_t numBricksI() const     { return m_NumBricksI; }
+  size_t numBricksJ() const     { return m_NumBricksJ; }
+  size_t numBricksK() const     { return m_NumBricksK; }
+  size_t numBricks() const      { return m_BrickIndex.size(); }
+  size_t numAllocatedBricks() const { return m_Data.size()/BRICK3 - m_FreeBricks.size(); }
+
+  /**
+   * Check if a brick is allocated.
+   * @param bi i-index of the brick
+   * @param bj j-index of the brick
+   * @param bk k-index of the brick
+   * @return true if the brick stores individual values, false if it is a tile
+   */
+  bool isAllocated(size_t bi, size_t bj, size_t bk) const { return m_BrickIndex[brick(bi, bj, bk)] >= 0; }
+
+  real get(size_t i, size_t j, size_t k) const
+  {
+    size_t b = brick(i/BRICK, j/BRICK, k/BRICK);
+    int i_data = m_BrickIndex[b];
+    if (i_data < 0) {
+      return m_TileValue[b];
+    }
+    return m_Data[i_data*BRICK3 + local(i, j, k)];
+  }
+
+  /**
+   * Set a single value. The brick will be allocated if required.
+   * Not thread safe, if the brick is not allocated yet.
+   */
+  void set(size_t i, size_t j, size_t k, real v)
+  {
+    size_t b = brick(i/BRICK, j/BRICK, k/BRICK);
+    if (m_BrickIndex[b] < 0) {
+      allocateBrick(i/BRICK, j/BRICK, k/BRICK);
+    }
+    m_Data[m_BrickIndex[b]*BRICK3 + local(i, j, k)] = v;
+  }
+
+  /**
+   * Allocate a brick. All values are initialised with the tile value.
+   * Nothing happens if the brick has already been allocated.
+   */
+  void allocateBrick(size_t bi, size_t bj, size_t bk);
+
+  /**
+   * Turn a brick into a tile with a constant value.
+   * The storage of the brick will be reused by the next allocation.
+   */
+  void setTile(size_t bi, size_t bj, size_t bk, real v);
+
+  real getTile(size_t bi, size_t bj, size_t bk) const { return m_TileValue[brick(bi, bj, bk)]; }
+
+  /**
+   * Remove all bricks which do not contain a value with |v| < limit.
+   * The tiles get the value with the smallest magnitude of their former brick.
+   * @param limit the magnitude required to keep a brick
+   */
+  void prune(real limit);
+
+};
+
+#endif // SPARSEBRICKGRID_H
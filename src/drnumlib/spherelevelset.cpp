@@ -30,3 +30,18 @@ real SphereLevelSet::calcDistance (const real &xo, const real &yo, const real &z
 
   return distance;
 }
+
+void SphereLevelSet::calcDistances(const real* xo, const real* yo, const real* zo, real* g, size_t n)
+{
+  // plain loop without virtual calls, so that it can be vectorised
+  real x_c = m_XoCenter;
+  real y_c = m_YoCenter;
+  real z_c = m_ZoCenter;
+  real radius = m_Radius;
+  for (size_t i = 0; i < n; ++i) {
+    real dx = xo[i] - x_c;
+    real dy = yo[i] - y_c;
+    real dz = zo[i] - z_c;
+    g[i] = sqrt(dx*dx + dy*dy + dz*dz) - radius;
+  }
+}
@@ -27,6 +27,8 @@ public:
   void setParams (real xo_center, real yo_center, real zo_center, real radius);
 
   virtual real calcDistance (const real& xo, const real& yo, const real& zo);
+  virtual void calcDistances(const real* xo, const real* yo, const real* zo, real* g, size_t n);
+  virtual real getLipschitz() { return 1.0; } // (signed) distance function
 
 };
 
@@ -48,3 +48,27 @@ bool SphereObject::isInside (const real &xo, const real &yo, const real &zo)
 
   return (q_dist < m_QRadius);
 }
+
+
+bool SphereObject::getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max)
+{
+  xyzo_min = vec3_t(m_XoCenter - m_Radius, m_YoCenter - m_Radius, m_ZoCenter - m_Radius);
+  xyzo_max = vec3_t(m_XoCenter + m_Radius, m_YoCenter + m_Radius, m_ZoCenter + m_Radius);
+  return true;
+}
+
+
+void SphereObject::checkInside(const real* xo, const real* yo, const real* zo, char* inside, size_t n)
+{
+  // plain loop without virtual calls, so that it can be vectorised
+  real x_c = m_XoCenter;
+  real y_c = m_YoCenter;
+  real z_c = m_ZoCenter;
+  real q_radius = m_QRadius;
+  for (size_t i = 0; i < n; ++i) {
+    real dx = xo[i] - x_c;
+    real dy = yo[i] - y_c;
+    real dz = zo[i] - z_c;
+    inside[i] = (dx*dx + dy*dy + dz*dz < q_radius);
+  }
+}
@@ -44,6 +44,8 @@ public:
   void setParams (real xo_center, real yo_center, real zo_center, real radius);
 
   virtual bool isInside (const real& xo, const real& yo, const real& zo);
+  virtual void checkInside(const real* xo, const real* yo, const real* zo, char* inside, size_t n);
+  virtual bool getBoundingBox(vec3_t& xyzo_min, vec3_t& xyzo_max);
 
 };
 
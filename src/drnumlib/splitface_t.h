@@ -21,20 +21,35 @@
 #ifndef SPLITFACE_T_H
 #define SPLITFACE_T_H
 
+/**
+ * A cell face of a Cartesian patch which is crossed by an immersed boundary (sign change of G).
+ * Every crossed face is stored twice, once for each of the two cells.
+ */
 struct splitface_t
 {
-  size_t idx;
-  size_t idx_neigh;
-  real nx;
+  size_t idx;       ///< the cell this face belongs to
+  size_t idx_neigh; ///< the cell on the other side of the face
+  real nx;          ///< face normal (scaled with the face area), pointing into cell idx
   real ny;
   real nz;
-  real wnx;
+  real wnx;         ///< unit wall normal, pointing into the fluid
   real wny;
   real wnz;
-  real dist;
-  real h1;
-  real h2;
-  bool inside;
+  real dist;        ///< wall distance of cell idx
+  real h1;          ///< fraction of the cell distance between the centre of idx and the wall
+  real h2;          ///< fraction of the cell distance between the wall and the centre of idx_neigh
+  bool inside;      ///< true if idx is inside of the body (G < 0)
 };
 
+/**
+ * Order of split faces (by cell, then by neighbour cell).
+ */
+inline bool operator<(const splitface_t& face1, const splitface_t& face2)
+{
+  if (face1.idx != face2.idx) {
+    return face1.idx < face2.idx;
+  }
+  return face1.idx_neigh < face2.idx_neigh;
+}
+
 #endif // SPLITFACE_T_H
@@ -0,0 +1,223 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef SPLITFACEBUILDER_H
+#define SPLITFACEBUILDER_H
+
+template <typename LS>
+class SplitFaceBuilder;
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "cartesianpatch.h"
+#include "splitface_t.h"
+#include "telemetry.h"
+
+#ifdef OPEN_MP
+#include <omp.h>
+#endif
+
+/**
+ * Construction of the split faces (see splitface_t) of all Cartesian patches from a level set.
+ *
+ * The patches are cut into slabs of constant i, which are processed in parallel. The faces
+ * of a patch are then handed over to Patch::setSplitFaces, which sorts them and builds
+ * the conflict-free groups used by CartesianIterator. The result can be stored with
+ * SplitFaceFile, in order to skip the construction in later runs.
+ */
+template <typename LS>
+class SplitFaceBuilder
+{
+
+protected: // attributes
+
+  PatchGrid* m_PatchGrid;
+  LS         m_Ls;
+  size_t     m_NumFaces;
+
+
+protected: // methods
+
+  vec3_t gradG(CartesianPatch* patch, size_t i, size_t j, size_t k);
+  void   addFaces(CartesianPatch* patch, size_t i1, size_t j1, size_t k1, size_t i2, size_t j2, size_t k2, real A, int dir, vector<splitface_t>& faces);
+
+
+public: // methods
+
+  /**
+   * @param patch_grid the grid
+   * @param ls the level set (e.g. BrickLevelSet)
+   */
+  SplitFaceBuilder(PatchGrid* patch_grid, LS ls);
+
+  /**
+   * Find the split faces of all Cartesian patches. Has to be called after the level set has been computed.
+   */
+  void build();
+
+  size_t numFaces() { return m_NumFaces; }
+
+};
+
+
+template <typename LS>
+SplitFaceBuilder<LS>::SplitFaceBuilder(PatchGrid* patch_grid, LS ls)
+{
+  m_PatchGrid = patch_grid;
+  m_Ls        = ls;
+  m_NumFaces  = 0;
+}
+
+template <typename LS>
+vec3_t SplitFaceBuilder<LS>::gradG(CartesianPatch* patch, size_t i, size_t j, size_t k)
+{
+  size_t i1 = max(size_t(1), i) - 1, i2 = min(patch->sizeI() - 1, i + 1);
+  size_t j1 = max(size_t(1), j) - 1, j2 = min(patch->sizeJ() - 1, j + 1);
+  size_t k1 = max(size_t(1), k) - 1, k2 = min(patch->sizeK() - 1, k + 1);
+  vec3_t grad(0, 0, 0);
+  if (i2 > i1) {
+    grad[0] = (m_Ls.G(*patch, i2, j, k) - m_Ls.G(*patch, i1, j, k))/((i2 - i1)*patch->dx());
+  }
+  if (j2 > j1) {
+    grad[1] = (m_Ls.G(*patch, i, j2, k) - m_Ls.G(*patch, i, j1, k))/((j2 - j1)*patch->dy());
+  }
+  if (k2 > k1) {
+    grad[2] = (m_Ls.G(*patch, i, j, k2) - m_Ls.G(*patch, i, j, k1))/((k2 - k1)*patch->dz());
+  }
+  return grad;
+}
+
+template <typename LS>
+void SplitFaceBuilder<LS>::addFaces(CartesianPatch* patch, size_t i1, size_t j1, size_t k1, size_t i2, size_t j2, size_t k2, real A, int dir, vector<splitface_t>& faces)
+{
+  real G1 = m_Ls.G(*patch, i1, j1, k1);
+  real G2 = m_Ls.G(*patch, i2, j2, k2);
+  if ((G1 < 0) == (G2 < 0)) {
+    return;
+  }
+
+  // wall normal from both cells; (i2,j2,k2) is the upper neighbour in direction dir
+  vec3_t wn = gradG(patch, i1, j1, k1) + gradG(patch, i2, j2, k2);
+  if (wn.abs() < 1e-20) {
+    wn = vec3_t(0, 0, 0);
+    wn[dir] = G2 > G1 ? 1 : -1;
+  }
+  wn.normalise();
+  real h1 = fabs(G1)/(fabs(G1) + fabs(G2));
+
+  splitface_t face;
+  face.wnx = wn[0];
+  face.wny = wn[1];
+  face.wnz = wn[2];
+
+  // face of the lower cell (normal points in negative direction)
+  face.idx       = patch->index(i1, j1, k1);
+  face.idx_neigh = patch->index(i2, j2, k2);
+  face.nx        = dir == 0 ? -A : 0;
+  face.ny        = dir == 1 ? -A : 0;
+  face.nz        = dir == 2 ? -A : 0;
+  face.dist      = fabs(G1);
+  face.h1        = h1;
+  face.h2        = 1 - h1;
+  face.inside    = G1 < 0;
+  faces.push_back(face);
+
+  // face of the upper cell
+  swap(face.idx, face.idx_neigh);
+  face.nx     = -face.nx;
+  face.ny     = -face.ny;
+  face.nz     = -face.nz;
+  face.dist   = fabs(G2);
+  face.h1     = 1 - h1;
+  face.h2     = h1;
+  face.inside = G2 < 0;
+  faces.push_back(face);
+}
+
+template <typename LS>
+void SplitFaceBuilder<LS>::build()
+{
+  ScopedTimer timer("splitFaces");
+
+  // slabs of constant i for all Cartesian patches
+  vector<CartesianPatch*>  patches;
+  vector<pair<int, int> >  slabs;
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    CartesianPatch* patch = dynamic_cast<CartesianPatch*>(m_PatchGrid->getPatch(i_patch));
+    if (patch) {
+      if (patch->accessPatchType() == 1002) {
+        ERROR("split faces are not supported on stretched patches");
+      }
+      for (size_t i = 0; i < patch->sizeI(); ++i) {
+        slabs.push_back(pair<int, int>(patches.size(), i));
+      }
+      patches.push_back(patch);
+    }
+  }
+  vector<vector<splitface_t> > slab_faces(slabs.size());
+
+#ifndef DEBUG
+  #pragma omp parallel for schedule(dynamic)
+#endif
+  for (int i_slab = 0; i_slab < int(slabs.size()); ++i_slab) {
+    CartesianPatch* patch = patches[slabs[i_slab].first];
+    size_t i = slabs[i_slab].second;
+    real Ax = patch->dy()*patch->dz();
+    real Ay = patch->dx()*patch->dz();
+    real Az = patch->dx()*patch->dy();
+    vector<splitface_t>& faces = slab_faces[i_slab];
+    for (size_t j = 0; j < patch->sizeJ(); ++j) {
+      for (size_t k = 0; k < patch->sizeK(); ++k) {
+        if (i + 1 < patch->sizeI()) {
+          addFaces(patch, i, j, k, i + 1, j, k, Ax, 0, faces);
+        }
+        if (j + 1 < patch->sizeJ()) {
+          addFaces(patch, i, j, k, i, j + 1, k, Ay, 1, faces);
+        }
+        if (k + 1 < patch->sizeK()) {
+          addFaces(patch, i, j, k, i, j, k + 1, Az, 2, faces);
+        }
+      }
+    }
+  }
+
+  // slabs of a patch are contiguous
+  vector<size_t> first_slab(patches.size() + 1, slabs.size());
+  for (int i_slab = int(slabs.size()) - 1; i_slab >= 0; --i_slab) {
+    first_slab[slabs[i_slab].first] = i_slab;
+  }
+  size_t num_faces = 0;
+
+#ifndef DEBUG
+  #pragma omp parallel for schedule(dynamic) reduction(+:num_faces)
+#endif
+  for (int i_patch = 0; i_patch < int(patches.size()); ++i_patch) {
+    vector<splitface_t> faces;
+    for (size_t i_slab = first_slab[i_patch]; i_slab < first_slab[i_patch + 1]; ++i_slab) {
+      faces.insert(faces.end(), slab_faces[i_slab].begin(), slab_faces[i_slab].end());
+    }
+    patches[i_patch]->setSplitFaces(faces);
+    num_faces += faces.size();
+  }
+  m_NumFaces = num_faces;
+  cout << m_NumFaces << " split faces" << endl;
+}
+
+#endif // SPLITFACEBUILDER_H
@@ -0,0 +1,103 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "splitfacefile.h"
+#include "levelsetfile.h"
+
+#include <fstream>
+#include <string.h>
+
+static const int SPLITFACEFILE_VERSION = 1;
+
+SplitFaceFile::SplitFaceFile(PatchGrid *patch_grid, string geometry_file_name)
+{
+  m_PatchGrid    = patch_grid;
+  m_GridHash     = LevelSetFile::gridHash(patch_grid);
+  m_GeometryHash = LevelSetFile::fileHash(geometry_file_name);
+}
+
+void SplitFaceFile::write(string file_name)
+{
+  header_t header;
+  memset(&header, 0, sizeof(header));
+  strncpy(header.magic, "DRNUMSF", 8);
+  header.version       = SPLITFACEFILE_VERSION;
+  header.face_size     = sizeof(splitface_t);
+  header.grid_hash     = m_GridHash;
+  header.geometry_hash = m_GeometryHash;
+  header.num_patches   = m_PatchGrid->getNumPatches();
+
+  ofstream file(file_name.c_str(), ios::binary);
+  if (!file) {
+    ERROR("cannot write split face file");
+  }
+  file.write(reinterpret_cast<char*>(&header), sizeof(header));
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    Patch* patch = m_PatchGrid->getPatch(i_patch);
+    unsigned long long num_faces = patch->getNumSplitFaces();
+    file.write(reinterpret_cast<char*>(&num_faces), sizeof(num_faces));
+    if (num_faces > 0) {
+      file.write(reinterpret_cast<char*>(patch->getSplitFaces()), num_faces*sizeof(splitface_t));
+    }
+  }
+}
+
+bool SplitFaceFile::read(string file_name)
+{
+  ifstream file(file_name.c_str(), ios::binary);
+  if (!file) {
+    return false;
+  }
+  header_t header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || strncmp(header.magic, "DRNUMSF", 8) != 0) {
+    return false;
+  }
+  if (header.version != SPLITFACEFILE_VERSION || header.face_size != int(sizeof(splitface_t))) {
+    return false;
+  }
+  if (header.grid_hash != m_GridHash || header.geometry_hash != m_GeometryHash) {
+    return false;
+  }
+  if (header.num_patches != m_PatchGrid->getNumPatches()) {
+    return false;
+  }
+
+  // read everything before any patch is modified
+  vector<vector<splitface_t> > faces(m_PatchGrid->getNumPatches());
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    unsigned long long num_faces = 0;
+    file.read(reinterpret_cast<char*>(&num_faces), sizeof(num_faces));
+    if (!file || num_faces > 6*m_PatchGrid->getPatch(i_patch)->variableSize()) {
+      return false;
+    }
+    faces[i_patch].resize(num_faces);
+    if (num_faces > 0) {
+      file.read(reinterpret_cast<char*>(&faces[i_patch][0]), num_faces*sizeof(splitface_t));
+    }
+    if (!file) {
+      return false;
+    }
+  }
+  for (size_t i_patch = 0; i_patch < m_PatchGrid->getNumPatches(); ++i_patch) {
+    m_PatchGrid->getPatch(i_patch)->setSplitFaces(faces[i_patch]);
+  }
+  return true;
+}
@@ -0,0 +1,89 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef SPLITFACEFILE_H
+#define SPLITFACEFILE_H
+
+#include "drnum.h"
+#include "patchgrid.h"
+#include "splitface_t.h"
+
+#include <string>
+
+using namespace std;
+
+/**
+ * Binary cache of the split faces (see SplitFaceBuilder) for a grid and geometry pair.
+ *
+ * The file is keyed like a LevelSetFile (hash of the grid and of the geometry file),
+ * so stored split faces are only used if neither the grid nor the geometry have changed.
+ *
+ * File layout (native byte order):
+ *  header:  char[8] "DRNUMSF", int version, int sizeof(splitface_t),
+ *           uint64 grid hash, uint64 geometry hash, uint64 number of patches
+ *  data:    uint64 number of faces, number of faces x splitface_t for every patch
+ */
+class SplitFaceFile
+{
+
+protected: // data types
+
+  struct header_t
+  {
+    char               magic[8];
+    int                version;
+    int                face_size;
+    unsigned long long grid_hash;
+    unsigned long long geometry_hash;
+    unsigned long long num_patches;
+  };
+
+
+protected: // attributes
+
+  PatchGrid*         m_PatchGrid;
+  unsigned long long m_GridHash;
+  unsigned long long m_GeometryHash;
+
+
+public: // methods
+
+  /**
+   * @param patch_grid the grid (patches must have been created already)
+   * @param geometry_file_name the geometry file (only used for the hash)
+   */
+  SplitFaceFile(PatchGrid* patch_grid, string geometry_file_name);
+
+  /**
+   * Store the split faces of all patches.
+   * @param file_name the name of the split face file
+   */
+  void write(string file_name);
+
+  /**
+   * Load the split faces of all patches, if the file matches grid and geometry.
+   * @param file_name the name of the split face file
+   * @return true if the split faces have been loaded
+   */
+  bool read(string file_name);
+
+};
+
+#endif // SPLITFACEFILE_H
@@ -0,0 +1,154 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef TABULATEDGAS_H
+#define TABULATEDGAS_H
+
+#include "gastable.h"
+
+/**
+ * Common implementation of the gas interface (see PerfectGas) for gases described by a GasTable.
+ * TGas has to provide a static method table() returning the GasTable (host or device copy).
+ * The heat capacities cp(var) and cv(var) are the caloric values h/T and e/T, which keeps
+ * the flux functions exact (they assume e = cv*T and h = cp*T); gamma(var) is the
+ * thermodynamic ratio of specific heats and used for the speed of sound.
+ * Calls without a state return the values at the reference temperature of the table; they are
+ * only exact at that temperature and should not be used in flux functions (use the state-based
+ * versions there).
+ */
+template <class TGas>
+class TabulatedGas
+{
+
+protected: // static methods
+
+  static CUDA_DH real temperature(real* var);
+  static CUDA_DH real internalEnergy(real* var);
+
+
+public: // static methods
+
+  static CUDA_DH real R(real* = NULL)       { return TGas::table().m_R; }
+  static CUDA_DH real gamma(real* var = NULL) { return TGas::table().gamma(temperature(var)); }
+  static CUDA_DH real cv(real* var = NULL);
+  static CUDA_DH real cp(real* var = NULL)    { return cv(var) + R(); }
+  static CUDA_DH real mu(real* var = NULL)    { return TGas::table().mu(temperature(var)); }
+  static CUDA_DH real k(real* var = NULL)     { return TGas::table().k(temperature(var)); }
+  static CUDA_DH real Pr(real* var = NULL);
+
+  static CUDA_DH void primitiveToConservative(real p, real T, real* var);
+  static CUDA_DH void primitiveToConservative(real p, real T, real u, real v, real w, real* var);
+  static CUDA_DH void primitiveToConservative(real p, real T, vec3_t U, real* var);
+  static CUDA_DH void conservativeToPrimitive(real* var, real& p, real& T);
+  static CUDA_DH void conservativeToPrimitive(real* var, real& p, real& T, real& u, real& v, real& w);
+  static CUDA_DH void conservativeToPrimitive(real* var, real& p, real& T, vec3_t& U);
+
+};
+
+
+template <class TGas>
+inline CUDA_DH real TabulatedGas<TGas>::internalEnergy(real* var)
+{
+  real ir = real(1)/var[0];
+  countFlops(11);
+  return (var[4] - real(0.5)*ir*(var[1]*var[1] + var[2]*var[2] + var[3]*var[3]))*ir;
+}
+
+template <class TGas>
+inline CUDA_DH real TabulatedGas<TGas>::temperature(real* var)
+{
+  if (!var) {
+    return TGas::table().m_TRef;
+  }
+  return TGas::table().T(internalEnergy(var));
+}
+
+template <class TGas>
+inline CUDA_DH real TabulatedGas<TGas>::cv(real* var)
+{
+  const GasTable& table = TGas::table();
+  if (!var) {
+    return table.e(table.m_TRef)/table.m_TRef;
+  }
+  real e = internalEnergy(var);
+  countFlops(1);
+  return e/table.T(e);
+}
+
+template <class TGas>
+inline CUDA_DH real TabulatedGas<TGas>::Pr(real* var)
+{
+  const GasTable& table = TGas::table();
+  real T = temperature(var);
+  countFlops(4);
+  return table.mu(T)*(table.e(T)/T + table.m_R)/table.k(T);
+}
+
+template <class TGas>
+inline CUDA_DH void TabulatedGas<TGas>::primitiveToConservative(real p, real T, real* var)
+{
+  primitiveToConservative(p, T, 0, 0, 0, var);
+}
+
+template <class TGas>
+inline CUDA_DH void TabulatedGas<TGas>::primitiveToConservative(real p, real T, real u, real v, real w, real* var)
+{
+  const GasTable& table = TGas::table();
+  var[0] = p/(table.m_R*T);
+  var[1] = var[0]*u;
+  var[2] = var[0]*v;
+  var[3] = var[0]*w;
+  var[4] = var[0]*(table.e(T) + real(0.5)*(u*u + v*v + w*w));
+  countFlops(13);
+}
+
+template <class TGas>
+inline CUDA_DH void TabulatedGas<TGas>::primitiveToConservative(real p, real T, vec3_t U, real* var)
+{
+  primitiveToConservative(p, T, U[0], U[1], U[2], var);
+}
+
+template <class TGas>
+inline CUDA_DH void TabulatedGas<TGas>::conservativeToPrimitive(real* var, real& p, real& T)
+{
+  T = temperature(var);
+  p = var[0]*TGas::table().m_R*T;
+  countFlops(2);
+}
+
+template <class TGas>
+inline CUDA_DH void TabulatedGas<TGas>::conservativeToPrimitive(real* var, real& p, real& T, real& u, real& v, real& w)
+{
+  real ir = real(1)/var[0];
+  u = var[1]*ir;
+  v = var[2]*ir;
+  w = var[3]*ir;
+  T = TGas::table().T(var[4]*ir - real(0.5)*(u*u + v*v + w*w));
+  p = var[0]*TGas::table().m_R*T;
+  countFlops(14);
+}
+
+template <class TGas>
+inline CUDA_DH void TabulatedGas<TGas>::conservativeToPrimitive(real* var, real& p, real& T, vec3_t& U)
+{
+  conservativeToPrimitive(var, p, T, U[0], U[1], U[2]);
+}
+
+#endif // TABULATEDGAS_H
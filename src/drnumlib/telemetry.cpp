@@ -0,0 +1,278 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "telemetry.h"
+
+#include <sys/time.h>
+#include <time.h>
+#include <iomanip>
+
+Telemetry global_telemetry;
+
+Telemetry::Telemetry()
+{
+  m_Trace     = false;
+  m_MaxEvents = 0;
+  m_NumSteps  = 0;
+  m_StartTime = wallTime();
+  m_LastPrintTime = m_StartTime;
+  m_StepLogColumns = 0;
+}
+
+double Telemetry::wallTime()
+{
+#ifdef CLOCK_MONOTONIC
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return double(ts.tv_sec) + 1e-9*double(ts.tv_nsec);
+#else
+  timeval tv;
+  gettimeofday(&tv, NULL);
+  return double(tv.tv_sec) + 1e-6*double(tv.tv_usec);
+#endif
+}
+
+size_t Telemetry::region(string name)
+{
+  map<string,size_t>::iterator i = m_RegionIndex.find(name);
+  if (i != m_RegionIndex.end()) {
+    return i->second;
+  }
+  region_t new_region;
+  new_region.name     = name;
+  new_region.total    = 0;
+  new_region.step     = 0;
+  new_region.step_min = 0;
+  new_region.step_max = 0;
+  new_region.calls    = 0;
+  m_Regions.push_back(new_region);
+  m_RegionIndex[name] = m_Regions.size() - 1;
+  return m_Regions.size() - 1;
+}
+
+void Telemetry::record(size_t i_region, double start, double stop, int i_patch)
+{
+  region_t& R = m_Regions[i_region];
+  double dt = stop - start;
+  R.total += dt;
+  R.step  += dt;
+  ++R.calls;
+  if (i_patch >= 0) {
+    if (size_t(i_patch) >= R.patch_time.size()) {
+      HardwareCounters::counters_t zero = {0, 0, 0};
+      R.patch_time.resize(i_patch + 1, 0);
+      R.patch_calls.resize(i_patch + 1, 0);
+      R.patch_counters.resize(i_patch + 1, zero);
+    }
+    R.patch_time[i_patch] += dt;
+    ++R.patch_calls[i_patch];
+  }
+  if (m_Trace && m_Events.size() < m_MaxEvents) {
+    event_t event;
+    event.i_region = i_region;
+    event.i_patch  = i_patch;
+    event.start    = start - m_StartTime;
+    event.duration = dt;
+    m_Events.push_back(event);
+  }
+}
+
+void Telemetry::recordCounters(size_t i_region, size_t i_patch, const HardwareCounters::counters_t &start, const HardwareCounters::counters_t &stop)
+{
+  region_t& R = m_Regions[i_region];
+  if (i_patch >= R.patch_counters.size()) {
+    HardwareCounters::counters_t zero = {0, 0, 0};
+    R.patch_time.resize(i_patch + 1, 0);
+    R.patch_calls.resize(i_patch + 1, 0);
+    R.patch_counters.resize(i_patch + 1, zero);
+  }
+  R.patch_counters[i_patch].cycles       += stop.cycles - start.cycles;
+  R.patch_counters[i_patch].instructions += stop.instructions - start.instructions;
+  R.patch_counters[i_patch].cache_misses += stop.cache_misses - start.cache_misses;
+}
+
+void Telemetry::start()
+{
+  for (size_t i = 0; i < m_Regions.size(); ++i) {
+    region_t& R = m_Regions[i];
+    R.total    = 0;
+    R.step     = 0;
+    R.step_min = 0;
+    R.step_max = 0;
+    R.calls    = 0;
+    R.patch_time.clear();
+    R.patch_calls.clear();
+    R.patch_counters.clear();
+  }
+  m_Events.clear();
+  m_NumSteps = 0;
+  m_StartTime = wallTime();
+  m_LastPrintTime = m_StartTime;
+}
+
+void Telemetry::writeStepLogHeader()
+{
+  m_StepLog << "# step, time";
+  for (size_t i = 0; i < m_Regions.size(); ++i) {
+    m_StepLog << ", " << m_Regions[i].name;
+  }
+  m_StepLog << endl;
+  m_StepLogColumns = m_Regions.size();
+}
+
+void Telemetry::nextStep()
+{
+  if (m_StepLog.is_open()) {
+    if (m_StepLogColumns != m_Regions.size()) {
+      // new regions have been added; the header has to be repeated
+      writeStepLogHeader();
+    }
+    m_StepLog << m_NumSteps << ", " << elapsed();
+  }
+  for (size_t i = 0; i < m_Regions.size(); ++i) {
+    region_t& R = m_Regions[i];
+    if (m_NumSteps == 0) {
+      R.step_min = R.step;
+      R.step_max = R.step;
+    } else {
+      R.step_min = min(R.step_min, R.step);
+      R.step_max = max(R.step_max, R.step);
+    }
+    if (m_StepLog.is_open()) {
+      m_StepLog << ", " << R.step;
+    }
+    R.step = 0;
+  }
+  if (m_StepLog.is_open()) {
+    m_StepLog << "\n";
+  }
+  ++m_NumSteps;
+}
+
+void Telemetry::setOutput(string base_name)
+{
+  m_BaseName = base_name;
+  if (m_StepLog.is_open()) {
+    m_StepLog.close();
+  }
+  m_StepLog.open((base_name + ".csv").c_str());
+  m_StepLog << setprecision(6);
+  m_StepLogColumns = 0;
+}
+
+void Telemetry::print()
+{
+  double now = wallTime();
+  cout << fixed << setprecision(3);
+  cout << now - m_StartTime << " seconds since timing began, ";
+  cout << now - m_LastPrintTime << " seconds since last timing output" << endl;
+  double total = max(1e-30, now - m_StartTime);
+  for (size_t i = 0; i < m_Regions.size(); ++i) {
+    cout << "  " << setw(20) << left << m_Regions[i].name << right;
+    cout << setw(12) << m_Regions[i].total << " s";
+    cout << setw(8) << setprecision(1) << 100*m_Regions[i].total/total << " %" << setprecision(3) << endl;
+  }
+  cout.unsetf(ios::floatfield);
+  cout << setprecision(6);
+  m_LastPrintTime = now;
+}
+
+void Telemetry::writeJson(string file_name)
+{
+  ofstream file(file_name.c_str());
+  file << setprecision(9);
+  file << "{\n";
+  file << "  \"wall_time\": " << elapsed() << ",\n";
+  file << "  \"num_steps\": " << m_NumSteps << ",\n";
+  file << "  \"regions\": [\n";
+  for (size_t i = 0; i < m_Regions.size(); ++i) {
+    const region_t& R = m_Regions[i];
+    file << "    {\n";
+    file << "      \"name\": \"" << R.name << "\",\n";
+    file << "      \"total\": " << R.total << ",\n";
+    file << "      \"calls\": " << R.calls << ",\n";
+    file << "      \"step_mean\": " << R.total/max(size_t(1), m_NumSteps) << ",\n";
+    file << "      \"step_min\": " << R.step_min << ",\n";
+    file << "      \"step_max\": " << R.step_max << ",\n";
+    file << "      \"patches\": [";
+    bool first = true;
+    for (size_t i_patch = 0; i_patch < R.patch_time.size(); ++i_patch) {
+      if (R.patch_calls[i_patch] > 0) {
+        if (!first) {
+          file << ",";
+        }
+        file << "\n        {\"patch\": " << i_patch << ", \"total\": " << R.patch_time[i_patch];
+        file << ", \"calls\": " << R.patch_calls[i_patch];
+        if (countersEnabled()) {
+          file << ", \"cycles\": " << R.patch_counters[i_patch].cycles;
+          file << ", \"instructions\": " << R.patch_counters[i_patch].instructions;
+          file << ", \"cache_misses\": " << R.patch_counters[i_patch].cache_misses;
+        }
+        file << "}";
+        first = false;
+      }
+    }
+    if (!first) {
+      file << "\n      ";
+    }
+    file << "]\n";
+    file << "    }";
+    if (i + 1 < m_Regions.size()) {
+      file << ",";
+    }
+    file << "\n";
+  }
+  file << "  ]\n";
+  file << "}\n";
+}
+
+void Telemetry::writeTrace(string file_name)
+{
+  ofstream file(file_name.c_str());
+  file << fixed << setprecision(3);
+  file << "{\"traceEvents\": [\n";
+  for (size_t i = 0; i < m_Events.size(); ++i) {
+    const event_t& E = m_Events[i];
+    file << "{\"name\": \"" << m_Regions[E.i_region].name << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": 0";
+    file << ", \"ts\": " << 1e6*E.start << ", \"dur\": " << 1e6*E.duration;
+    if (E.i_patch >= 0) {
+      file << ", \"args\": {\"patch\": " << E.i_patch << "}";
+    }
+    file << "}";
+    if (i + 1 < m_Events.size()) {
+      file << ",";
+    }
+    file << "\n";
+  }
+  file << "]}\n";
+}
+
+void Telemetry::writeOutput()
+{
+  if (m_StepLog.is_open()) {
+    m_StepLog.flush();
+  }
+  if (!m_BaseName.empty()) {
+    writeJson(m_BaseName + ".json");
+    if (m_Trace) {
+      writeTrace(m_BaseName + "_trace.json");
+    }
+  }
+}
@@ -0,0 +1,234 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "drnum.h"
+#include "hardwarecounters.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <fstream>
+
+using namespace std;
+
+/**
+ * Light-weight run-time instrumentation.
+ *
+ * Named regions are timed with a monotonic high resolution clock (see ScopedTimer).
+ * Times are accumulated in total, per time step (nextStep) and per patch. A summary
+ * can be written as JSON, the per-step history is streamed to a CSV file and all
+ * individual events can optionally be kept for a Chrome trace ("chrome://tracing").
+ * Per-patch events can additionally accumulate hardware counters (see HardwareCounters).
+ *
+ * Timers must only be used outside of OpenMP parallel regions.
+ */
+class Telemetry
+{
+
+public: // data types
+
+  struct region_t
+  {
+    string         name;
+    double         total;        ///< accumulated wall time [s]
+    double         step;         ///< wall time in the current step [s]
+    double         step_min;     ///< minimal wall time per step [s]
+    double         step_max;     ///< maximal wall time per step [s]
+    size_t         calls;
+    vector<double> patch_time;   ///< accumulated wall time per patch [s]
+    vector<size_t> patch_calls;
+    vector<HardwareCounters::counters_t> patch_counters;
+  };
+
+  struct event_t
+  {
+    size_t i_region;
+    int    i_patch;
+    double start;
+    double duration;
+  };
+
+
+protected: // attributes
+
+  vector<region_t>   m_Regions;
+  map<string,size_t> m_RegionIndex;
+  vector<event_t>    m_Events;
+  bool               m_Trace;
+  size_t             m_MaxEvents;
+  size_t             m_NumSteps;
+  double             m_StartTime;
+  double             m_LastPrintTime;
+  string             m_BaseName;
+  ofstream           m_StepLog;
+  size_t             m_StepLogColumns;  ///< number of regions in the last CSV header
+  HardwareCounters   m_Counters;
+
+
+protected: // methods
+
+  void writeStepLogHeader();
+
+
+public: // methods
+
+  Telemetry();
+
+  /**
+   * Current wall clock time.
+   * @return time in seconds (monotonic clock, arbitrary origin)
+   */
+  static double wallTime();
+
+  /**
+   * Get the index of a region; the region is created if required.
+   * @param name the name of the region
+   * @return the index of the region
+   */
+  size_t region(string name);
+
+  /**
+   * Add a timed event.
+   * @param i_region the region index
+   * @param start start time (see wallTime)
+   * @param stop stop time (see wallTime)
+   * @param i_patch the patch index or -1 for events not related to a patch
+   */
+  void record(size_t i_region, double start, double stop, int i_patch = -1);
+
+  /**
+   * Add hardware counter differences to a per-patch event.
+   * @param i_region the region index
+   * @param i_patch the patch index
+   * @param start counter values at the start of the event
+   * @param stop counter values at the end of the event
+   */
+  void recordCounters(size_t i_region, size_t i_patch, const HardwareCounters::counters_t& start, const HardwareCounters::counters_t& stop);
+
+  /**
+   * Reset all timers and restart the clock.
+   */
+  void start();
+
+  /**
+   * Close the current time step.
+   */
+  void nextStep();
+
+  /**
+   * Set the base name for JSON, CSV and trace output.
+   * The per-step history is written to <base_name>.csv from now on.
+   * @param base_name base of the file names
+   */
+  void setOutput(string base_name);
+
+  /**
+   * Keep all events for a Chrome trace file.
+   * @param max_events upper limit of kept events
+   */
+  void enableTrace(size_t max_events = 1000000) { m_Trace = true; m_MaxEvents = max_events; }
+
+  /**
+   * Count hardware events for per-patch regions.
+   * @return true if the hardware counters are available
+   */
+  bool enableCounters() { return m_Counters.open(); }
+
+  bool countersEnabled() { return m_Counters.available(); }
+  void readCounters(HardwareCounters::counters_t& counters) { m_Counters.read(counters); }
+
+  double elapsed() { return wallTime() - m_StartTime; }
+  size_t numSteps() { return m_NumSteps; }
+  size_t numRegions() { return m_Regions.size(); }
+  const region_t& getRegion(size_t i_region) { return m_Regions[i_region]; }
+
+  /**
+   * Print a short break-down of the run time to stdout.
+   */
+  void print();
+
+  void writeJson(string file_name);
+  void writeTrace(string file_name);
+
+  /**
+   * Write all requested output files (see setOutput).
+   */
+  void writeOutput();
+
+};
+
+extern Telemetry global_telemetry;
+
+
+/**
+ * Time the life time of an object as a region of the global telemetry.
+ */
+class ScopedTimer
+{
+
+  size_t m_Region;
+  int    m_Patch;
+  double m_Start;
+  bool   m_Count;
+
+  HardwareCounters::counters_t m_StartCounters;
+
+  void begin()
+  {
+    m_Count = m_Patch >= 0 && global_telemetry.countersEnabled();
+    if (m_Count) {
+      global_telemetry.readCounters(m_StartCounters);
+    }
+    m_Start = Telemetry::wallTime();
+  }
+
+public:
+
+  ScopedTimer(const string& name, int i_patch = -1)
+  {
+    m_Region = global_telemetry.region(name);
+    m_Patch  = i_patch;
+    begin();
+  }
+
+  ScopedTimer(size_t i_region, int i_patch = -1)
+  {
+    m_Region = i_region;
+    m_Patch  = i_patch;
+    begin();
+  }
+
+  ~ScopedTimer()
+  {
+    double stop = Telemetry::wallTime();
+    if (m_Count) {
+      HardwareCounters::counters_t stop_counters;
+      global_telemetry.readCounters(stop_counters);
+      global_telemetry.recordCounters(m_Region, m_Patch, m_StartCounters, stop_counters);
+    }
+    global_telemetry.record(m_Region, m_Start, stop, m_Patch);
+  }
+
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,92 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef THERMALLYPERFECTGAS_H
+#define THERMALLYPERFECTGAS_H
+
+#include "tabulatedgas.h"
+
+#ifdef __CUDACC__
+static __constant__ GasTable thermally_perfect_gas_device_table;
+#endif
+
+/**
+ * Host copy of the table; initialised with dry air in the range 200 K to 3000 K.
+ */
+inline GasTable& thermallyPerfectGasHostTable()
+{
+  struct DefaultTable : public GasTable
+  {
+    DefaultTable() { build(vector<GasSpecies>(1, GasSpecies::get("air")), vector<real>(1, 1), 200, 3000, 300, false); }
+  };
+  static DefaultTable table;
+  return table;
+}
+
+/**
+ * Thermally perfect gas with a single species: cp, gamma, mu and k depend on the temperature
+ * and are looked up in uniform tables (no transcendental functions per face).
+ * The default is dry air; call setup() to change species, range or interpolation.
+ * For GPU runs updateDevice() has to be called after setup() from the CUDA translation unit.
+ */
+class ThermallyPerfectGas : public TabulatedGas<ThermallyPerfectGas>
+{
+
+public: // static methods
+
+  static CUDA_DH const GasTable& table();
+
+  /**
+   * Build the lookup tables.
+   * @param species the name of the species (see GasSpecies::get)
+   * @param T_min lower limit of the table range
+   * @param T_max upper limit of the table range
+   * @param cubic cubic instead of linear interpolation
+   * @param T_ref temperature for property requests without a state
+   */
+  static void setup(string species = "air", real T_min = 200, real T_max = 3000, bool cubic = false, real T_ref = 300);
+
+  static void updateDevice();
+
+};
+
+
+inline CUDA_DH const GasTable& ThermallyPerfectGas::table()
+{
+#ifdef __CUDA_ARCH__
+  return thermally_perfect_gas_device_table;
+#else
+  return thermallyPerfectGasHostTable();
+#endif
+}
+
+inline void ThermallyPerfectGas::setup(string species, real T_min, real T_max, bool cubic, real T_ref)
+{
+  thermallyPerfectGasHostTable().build(vector<GasSpecies>(1, GasSpecies::get(species)), vector<real>(1, 1), T_min, T_max, T_ref, cubic);
+}
+
+inline void ThermallyPerfectGas::updateDevice()
+{
+#ifdef __CUDACC__
+  cudaMemcpyToSymbol(thermally_perfect_gas_device_table, &thermallyPerfectGasHostTable(), sizeof(GasTable));
+#endif
+}
+
+#endif // THERMALLYPERFECTGAS_H
@@ -19,6 +19,7 @@
 // +                                                                      +
 // ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
 #include "timeintegration.h"
+#include "telemetry.h"
 
 TimeIntegration::TimeIntegration()
 {
@@ -27,6 +28,7 @@ TimeIntegration::TimeIntegration()
 
 void TimeIntegration::copyField(size_t i_src, size_t i_dst)
 {
+  ScopedTimer timer("copyField");
   for (list<PatchIterator*>::iterator i = m_Iterators.begin(); i != m_Iterators.end(); ++i) {
     (*i)->copyField(i_src, i_dst);
   }
@@ -35,6 +37,7 @@ void TimeIntegration::copyField(size_t i_src, size_t i_dst)
 
 void TimeIntegration::computeIterators(real factor)
 {
+  ScopedTimer timer("computeIterators");
   for (list<PatchIterator*>::iterator i = m_Iterators.begin(); i != m_Iterators.end(); ++i) {
     (*i)->computeAll(factor);
   }
@@ -42,6 +45,7 @@ void TimeIntegration::computeIterators(real factor)
 
 void TimeIntegration::copyDonorData(size_t i_field)
 {
+  ScopedTimer timer("copyDonorData");
   for (list<PatchIterator*>::iterator i = m_Iterators.begin(); i != m_Iterators.end(); ++i) {
     (*i)->copyDonorData(i_field);
   }
@@ -49,6 +53,7 @@ void TimeIntegration::copyDonorData(size_t i_field)
 
 void TimeIntegration::runPostOperations()
 {
+  ScopedTimer timer("runPostOperations");
   for (list<GenericOperation*>::iterator i = m_PostOperations.begin(); i != m_PostOperations.end(); ++i) {
     (*(*i))();
   }
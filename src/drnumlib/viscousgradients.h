@@ -0,0 +1,126 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef VISCOUSGRADIENTS_H
+#define VISCOUSGRADIENTS_H
+
+#include "drnum.h"
+
+/**
+ * Per-cell scratch data for viscous fluxes.
+ * The primitive variables, their gradients and the transport coefficients are computed once
+ * per patch and stage (see CompressibleCachedViscFlux::computeGradients) and then read by the
+ * face loops. The storage is owned by the iterator and only grows.
+ */
+class ViscousGradients
+{
+
+public: // data types
+
+  enum
+  {
+    U = 0, V, W, T,
+    DU_DX, DU_DY, DU_DZ,
+    DV_DX, DV_DY, DV_DZ,
+    DW_DX, DW_DY, DW_DZ,
+    DT_DX, DT_DY, DT_DZ,
+    MU, MU_T, K,
+    NUM_FIELDS
+  };
+
+
+private: // attributes
+
+  real*  m_Data;
+  size_t m_Length;
+  size_t m_Size;
+
+
+private: // methods
+
+  ViscousGradients(const ViscousGradients&);
+  ViscousGradients& operator=(const ViscousGradients&);
+
+
+public: // methods
+
+  ViscousGradients() : m_Data(NULL), m_Length(0), m_Size(0) {}
+  ~ViscousGradients() { delete [] m_Data; }
+
+  /**
+   * Set the number of cells; the buffer is only reallocated if it has to grow.
+   * @param size the number of cells of the current patch
+   */
+  void resize(size_t size)
+  {
+    if (size > m_Length) {
+      delete [] m_Data;
+      m_Data = new real [size*NUM_FIELDS];
+      m_Length = size;
+    }
+    m_Size = size;
+  }
+
+  size_t size() { return m_Size; }
+
+  real* field(size_t i_field) { return m_Data + i_field*m_Size; }
+  real& f(size_t i_field, size_t idx) { return m_Data[i_field*m_Size + idx]; }
+
+};
+
+
+/**
+ * Runs the gradient pre-pass of an operator before its face loops.
+ * Operators which consume ViscousGradients declare the type gradient_cache_t and provide
+ * computeGradients(PATCH*, ViscousGradients*); for all other operators this is a no-op.
+ */
+template <typename OP>
+struct ViscousGradientPass
+{
+  typedef char yes_t;
+  typedef long no_t;
+
+  template <typename T> static yes_t test(typename T::gradient_cache_t*);
+  template <typename T> static no_t  test(...);
+
+  enum { active = sizeof(test<OP>(0)) == sizeof(yes_t) };
+
+  template <bool ACTIVE, int DUMMY = 0>
+  struct Apply
+  {
+    template <typename PATCH> static void apply(OP&, PATCH*, ViscousGradients*) {}
+  };
+
+  template <int DUMMY>
+  struct Apply<true, DUMMY>
+  {
+    template <typename PATCH> static void apply(OP& op, PATCH* patch, ViscousGradients* gradients)
+    {
+      op.computeGradients(patch, gradients);
+    }
+  };
+
+  template <typename PATCH> static void apply(OP& op, PATCH* patch, ViscousGradients* gradients)
+  {
+    Apply<active>::apply(op, patch, gradients);
+  }
+};
+
+#endif // VISCOUSGRADIENTS_H
@@ -0,0 +1,184 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#include "windingnumber.h"
+
+#include <algorithm>
+
+WindingNumber::WindingNumber()
+{
+  m_Beta     = 2.0;
+  m_LeafSize = 8;
+}
+
+void WindingNumber::clear()
+{
+  m_Triangles.clear();
+  m_Order.clear();
+  m_Centres.clear();
+  m_Nodes.clear();
+}
+
+void WindingNumber::addTriangle(dvec3_t a, dvec3_t b, dvec3_t c)
+{
+  triangle_t T;
+  T.a = a;
+  T.b = b;
+  T.c = c;
+  m_Triangles.push_back(T);
+}
+
+struct WindingNumberCompare
+{
+  const vector<dvec3_t>* centres;
+  int dim;
+  bool operator()(size_t i1, size_t i2) const
+  {
+    return (*centres)[i1][dim] < (*centres)[i2][dim];
+  }
+};
+
+int WindingNumber::buildNode(size_t first, size_t last)
+{
+  node_t node;
+  node.first  = first;
+  node.last   = last;
+  node.child1 = -1;
+  node.child2 = -1;
+
+  // area weighted centre and normal
+  node.centre = dvec3_t(0, 0, 0);
+  node.normal = dvec3_t(0, 0, 0);
+  double area = 0;
+  dvec3_t x_min(1e99, 1e99, 1e99);
+  dvec3_t x_max(-1e99, -1e99, -1e99);
+  for (size_t i = first; i < last; ++i) {
+    const triangle_t& T = m_Triangles[m_Order[i]];
+    dvec3_t u = T.b - T.a;
+    dvec3_t v = T.c - T.a;
+    dvec3_t n = u.cross(v);
+    n *= 0.5;
+    double A = n.abs();
+    dvec3_t x = T.a + T.b + T.c;
+    x *= 1.0/3.0;
+    node.normal += n;
+    node.centre += A*x;
+    area += A;
+    for (int i_dim = 0; i_dim < 3; ++i_dim) {
+      x_min[i_dim] = min(x_min[i_dim], min(T.a[i_dim], min(T.b[i_dim], T.c[i_dim])));
+      x_max[i_dim] = max(x_max[i_dim], max(T.a[i_dim], max(T.b[i_dim], T.c[i_dim])));
+    }
+  }
+  if (area > 0) {
+    node.centre *= 1.0/area;
+  } else {
+    node.centre = 0.5*(x_min + x_max);
+  }
+  node.radius = 0;
+  for (size_t i = first; i < last; ++i) {
+    const triangle_t& T = m_Triangles[m_Order[i]];
+    dvec3_t da = T.a - node.centre;
+    dvec3_t db = T.b - node.centre;
+    dvec3_t dc = T.c - node.centre;
+    node.radius = max(node.radius, max(da.abs(), max(db.abs(), dc.abs())));
+  }
+
+  int i_node = m_Nodes.size();
+  m_Nodes.push_back(node);
+
+  if (last - first > m_LeafSize) {
+
+    // median split along the largest extent
+    int dim = 0;
+    for (int i_dim = 1; i_dim < 3; ++i_dim) {
+      if (x_max[i_dim] - x_min[i_dim] > x_max[dim] - x_min[dim]) {
+        dim = i_dim;
+      }
+    }
+    WindingNumberCompare compare;
+    compare.centres = &m_Centres;
+    compare.dim = dim;
+    size_t middle = (first + last)/2;
+    nth_element(m_Order.begin() + first, m_Order.begin() + middle, m_Order.begin() + last, compare);
+    int child1 = buildNode(first, middle);
+    int child2 = buildNode(middle, last);
+    m_Nodes[i_node].child1 = child1;
+    m_Nodes[i_node].child2 = child2;
+  }
+  return i_node;
+}
+
+void WindingNumber::setup()
+{
+  m_Nodes.clear();
+  m_Order.resize(m_Triangles.size());
+  m_Centres.resize(m_Triangles.size());
+  for (size_t i = 0; i < m_Order.size(); ++i) {
+    m_Order[i] = i;
+    m_Centres[i] = m_Triangles[i].a + m_Triangles[i].b + m_Triangles[i].c;
+    m_Centres[i] *= 1.0/3.0;
+  }
+  if (m_Triangles.size() > 0) {
+    buildNode(0, m_Triangles.size());
+  }
+}
+
+double WindingNumber::solidAngle(const triangle_t &T, const dvec3_t &x) const
+{
+  // Van Oosterom and Strackee
+  dvec3_t a = T.a - x;
+  dvec3_t b = T.b - x;
+  dvec3_t c = T.c - x;
+  double la = a.abs();
+  double lb = b.abs();
+  double lc = c.abs();
+  dvec3_t bxc = b.cross(c);
+  double numerator   = a*bxc;
+  double denominator = la*lb*lc + (a*b)*lc + (b*c)*la + (c*a)*lb;
+  return 2*atan2(numerator, denominator);
+}
+
+double WindingNumber::evaluate(int i_node, const dvec3_t &x) const
+{
+  const node_t& node = m_Nodes[i_node];
+  dvec3_t d = node.centre - x;
+  double dist = d.abs();
+  if (dist > m_Beta*node.radius) {
+    // dipole approximation of the whole cluster
+    return (d*node.normal)/(dist*dist*dist);
+  }
+  if (node.child1 < 0) {
+    double omega = 0;
+    for (size_t i = node.first; i < node.last; ++i) {
+      omega += solidAngle(m_Triangles[m_Order[i]], x);
+    }
+    return omega;
+  }
+  return evaluate(node.child1, x) + evaluate(node.child2, x);
+}
+
+double WindingNumber::compute(vec3_t x) const
+{
+  if (m_Nodes.size() == 0) {
+    return 0;
+  }
+  dvec3_t xd(x[0], x[1], x[2]);
+  return evaluate(0, xd)/(4*M_PI);
+}
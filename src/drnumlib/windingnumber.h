@@ -0,0 +1,124 @@
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// +                                                                      +
+// + This file is part of DrNUM.                                          +
+// +                                                                      +
+// + Copyright 2013 numrax GmbH, enGits GmbH                              +
+// +                                                                      +
+// + DrNUM is free software: you can redistribute it and/or modify        +
+// + it under the terms of the GNU General Public License as published by +
+// + the Free Software Foundation, either version 3 of the License, or    +
+// + (at your option) any later version.                                  +
+// +                                                                      +
+// + DrNUM is distributed in the hope that it will be useful,             +
+// + but WITHOUT ANY WARRANTY; without even the implied warranty of       +
+// + MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        +
+// + GNU General Public License for more details.                         +
+// +                                                                      +
+// + You should have received a copy of the GNU General Public License    +
+// + along with DrNUM. If not, see <http://www.gnu.org/licenses/>.        +
+// +                                                                      +
+// ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+#ifndef WINDINGNUMBER_H
+#define WINDINGNUMBER_H
+
+#include "drnum.h"
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * Generalized winding number of a triangulated surface.
+ *
+ * The winding number is the sum of the solid angles of all triangles (divided by 4*pi).
+ * It is 1 inside and 0 outside of closed, consistently oriented surfaces and degrades
+ * gracefully for surfaces with holes, gaps or overlaps, which makes it a robust inside/outside
+ * criterion (w > 0.5).
+ *
+ * The evaluation uses a bounding volume hierarchy in the spirit of Barnes-Hut: clusters
+ * which are far away (distance > beta*radius) are represented by their area weighted
+ * normal (dipole approximation), close clusters are resolved down to the triangles.
+ *
+ * Reference: G. Barill et al., "Fast Winding Numbers for Soups and Clouds", ACM TOG 37(4), 2018.
+ */
+class WindingNumber
+{
+
+protected: // data types
+
+  struct triangle_t
+  {
+    dvec3_t a, b, c;
+  };
+
+  struct node_t
+  {
+    dvec3_t centre;   ///< area weighted centre of the triangles
+    dvec3_t normal;   ///< sum of the area weighted normals
+    double  radius;   ///< radius of a sphere around centre holding all vertices
+    size_t  first;    ///< first triangle (in m_Order)
+    size_t  last;     ///< triangle after last (in m_Order)
+    int     child1;   ///< first child or -1 for leaves
+    int     child2;   ///< second child or -1 for leaves
+  };
+
+
+protected: // attributes
+
+  vector<triangle_t> m_Triangles;
+  vector<size_t>     m_Order;
+  vector<dvec3_t>    m_Centres;   ///< triangle centres (used to build the hierarchy)
+  vector<node_t>     m_Nodes;
+  double             m_Beta;      ///< accuracy parameter (larger is more accurate)
+  size_t             m_LeafSize;  ///< maximal number of triangles in a leaf
+
+
+protected: // methods
+
+  int    buildNode(size_t first, size_t last);
+  double solidAngle(const triangle_t& T, const dvec3_t& x) const;
+  double evaluate(int i_node, const dvec3_t& x) const;
+
+
+public: // methods
+
+  WindingNumber();
+
+  /**
+   * Clear the triangle set.
+   */
+  void clear();
+
+  /**
+   * Add a triangle (counter-clockwise seen from the outside).
+   */
+  void addTriangle(dvec3_t a, dvec3_t b, dvec3_t c);
+
+  /**
+   * Build the hierarchy. Has to be called after all triangles have been added.
+   */
+  void setup();
+
+  /**
+   * Set the accuracy parameter.
+   * @param beta clusters are approximated if their distance exceeds beta times their radius
+   */
+  void setBeta(double beta) { m_Beta = beta; }
+
+  /**
+   * Compute the winding number (thread-safe after setup).
+   * @param x the query point
+   * @return the winding number
+   */
+  double compute(vec3_t x) const;
+
+  /**
+   * Check if a point is inside of the surface.
+   * @param x the query point
+   * @return true if the winding number is larger than 0.5
+   */
+  bool isInside(vec3_t x) const { return compute(x) > 0.5; }
+
+};
+
+#endif // WINDINGNUMBER_H